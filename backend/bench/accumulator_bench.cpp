@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "infrastructure/bm25_engine.hpp"
+#include "shared/simd_kernels.hpp"
+
+using DocuTrace::Infrastructure::BM25Engine;
+using DocuTrace::Infrastructure::ScoreAccumulator;
+using DocuTrace::Infrastructure::SearchResult;
+using DocuTrace::Shared::SimdKernels;
+using DocuTrace::Shared::SimdLevel;
+
+namespace
+{
+    constexpr size_t DOCUMENTS = 100'000;
+    constexpr size_t QUERIES = 500;
+
+    std::vector<std::string> synthetic_vocabulary(std::mt19937& random)
+    {
+        const std::string letters = "bcdfglmnprstvaeiou";
+        std::vector<std::string> vocabulary(20'000);
+        for (auto& word : vocabulary)
+        {
+            int length = 4 + static_cast<int>(random() % 6);
+            for (int i = 0; i < length; ++i)
+            {
+                word += letters[random() % letters.size()];
+            }
+        }
+        return vocabulary;
+    }
+
+    // Sesgo hacia las primeras palabras: términos frecuentes y raros
+    const std::string& skewed_word(const std::vector<std::string>& vocabulary, std::mt19937& random)
+    {
+        return vocabulary[random() % (1 + random() % vocabulary.size())];
+    }
+
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    struct Run
+    {
+        std::vector<std::vector<SearchResult>> results;
+        double seconds = 0.0;
+    };
+
+    Run run_queries(const BM25Engine& engine, const std::vector<std::string>& queries, size_t k)
+    {
+        Run run;
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& query : queries)
+        {
+            run.results.push_back(engine.Search(query, k));
+        }
+        run.seconds = seconds_since(start);
+        return run;
+    }
+
+    // Fracción de los k mejores exactos que también devuelve el modo aproximado, y resultados
+    // comunes cuya puntuación no coincide (deberían ser 0: se vuelven a puntuar en double)
+    void compare(const Run& exact, const Run& approximate, double& recall, size_t& mismatches)
+    {
+        size_t expected = 0;
+        size_t found = 0;
+        mismatches = 0;
+        for (size_t q = 0; q < exact.results.size(); ++q)
+        {
+            std::unordered_map<uint64_t, double> scores;
+            for (const auto& result : approximate.results[q])
+            {
+                scores.emplace(result.document_id, result.score);
+            }
+            for (const auto& result : exact.results[q])
+            {
+                ++expected;
+                auto it = scores.find(result.document_id);
+                if (it != scores.end())
+                {
+                    ++found;
+                    mismatches += it->second != result.score ? 1 : 0;
+                }
+            }
+        }
+        recall = expected > 0 ? static_cast<double>(found) / static_cast<double>(expected) : 1.0;
+    }
+} // namespace
+
+int main()
+{
+    std::mt19937 random(11);
+    const std::vector<std::string> vocabulary = synthetic_vocabulary(random);
+
+    std::vector<std::string> documents(DOCUMENTS);
+    for (auto& document : documents)
+    {
+        for (int word = 0; word < 200; ++word)
+        {
+            document += skewed_word(vocabulary, random) + ' ';
+        }
+    }
+
+    std::vector<std::string> queries(QUERIES);
+    for (auto& query : queries)
+    {
+        const int words = 2 + static_cast<int>(random() % 4);
+        for (int word = 0; word < words; ++word)
+        {
+            query += skewed_word(vocabulary, random) + ' ';
+        }
+    }
+
+    BM25Engine engine;
+    engine.IndexDocuments(documents, 1, 0, 1000);
+    std::printf("Documentos: %zu, consultas: %zu, SIMD: %s\n", DOCUMENTS, QUERIES,
+                SimdKernels::LevelName(SimdKernels::GetLevel()));
+
+    struct Mode
+    {
+        const char* name;
+        ScoreAccumulator accumulator;
+        SimdLevel level;
+        size_t bytes;
+    };
+    const SimdLevel best = SimdKernels::DetectLevel();
+    const Mode modes[] = {{"double", ScoreAccumulator::DOUBLE, best, sizeof(double)},
+                          {"float32 escalar", ScoreAccumulator::FLOAT32, SimdLevel::SCALAR,
+                           sizeof(float)},
+                          {"float32", ScoreAccumulator::FLOAT32, best, sizeof(float)},
+                          {"uint16", ScoreAccumulator::UINT16, best, sizeof(uint16_t)}};
+
+    for (size_t k : {10, 100})
+    {
+        std::printf("\nTop %zu\n", k);
+        engine.SetScoreAccumulator(ScoreAccumulator::DOUBLE);
+        const Run exact = run_queries(engine, queries, k);
+
+        for (const Mode& mode : modes)
+        {
+            SimdKernels::SetLevel(mode.level);
+            engine.SetScoreAccumulator(mode.accumulator);
+            const Run run = run_queries(engine, queries, k);
+
+            double recall = 0.0;
+            size_t mismatches = 0;
+            compare(exact, run, recall, mismatches);
+            std::printf("  %-16s %7.0f consultas/s  acumuladores %6.1f MB  recall@%zu %.4f  "
+                        "puntuaciones distintas %zu\n",
+                        mode.name, QUERIES / run.seconds, DOCUMENTS * mode.bytes / 1e6, k, recall,
+                        mismatches);
+        }
+        SimdKernels::SetLevel(best);
+    }
+    return 0;
+}
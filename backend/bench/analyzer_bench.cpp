@@ -0,0 +1,155 @@
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "infrastructure/bm25_engine.hpp"
+#include "shared/text_analyzer.hpp"
+
+using DocuTrace::Infrastructure::BM25Engine;
+using DocuTrace::Shared::AnalyzerOptions;
+using DocuTrace::Shared::TextAnalyzer;
+
+namespace
+{
+    constexpr int QUERY_REPETITIONS = 5;
+
+    // Documentos .txt de un directorio (p. ej. test_data/docs_es generado por generator.py)
+    std::vector<std::string> load_directory(const std::filesystem::path& directory)
+    {
+        std::vector<std::string> documents;
+        for (const auto& entry : std::filesystem::directory_iterator(directory))
+        {
+            if (entry.path().extension() != ".txt")
+            {
+                continue;
+            }
+            std::ifstream file(entry.path());
+            std::stringstream buffer;
+            buffer << file.rdbuf();
+            documents.push_back(buffer.str());
+        }
+        return documents;
+    }
+
+    // Corpus sintético: raíces aleatorias con flexiones y un 40% de stopwords
+    std::vector<std::string> synthetic_corpus(size_t count)
+    {
+        std::mt19937 random(7);
+        const std::string consonants = "bcdfglmnprstv";
+        const std::string vowels = "aeiou";
+        const std::vector<std::string> endings = {"o",   "os",  "a",    "as",     "ado",
+                                                  "ada", "ar",  "ando", "cion",   "ciones",
+                                                  "al",  "ales", "idad", "idades", "mente"};
+
+        std::vector<std::string> stems(3000);
+        for (auto& stem : stems)
+        {
+            for (int syllable = 0; syllable < 3; ++syllable)
+            {
+                stem += consonants[random() % consonants.size()];
+                stem += vowels[random() % vowels.size()];
+            }
+            stem += consonants[random() % consonants.size()];
+        }
+
+        std::vector<double> weights;
+        for (size_t i = 0; i < stems.size(); ++i)
+        {
+            weights.push_back(1.0 / static_cast<double>(i + 1));
+        }
+        std::discrete_distribution<size_t> zipf(weights.begin(), weights.end());
+        const auto& stopwords = TextAnalyzer::DefaultSpanishStopwords();
+
+        std::vector<std::string> documents(count);
+        for (auto& document : documents)
+        {
+            for (int word = 0; word < 300; ++word)
+            {
+                if (random() % 10 < 4)
+                {
+                    document += stopwords[random() % 40];
+                }
+                else
+                {
+                    document += stems[zipf(random)] + endings[random() % endings.size()];
+                }
+                document += ' ';
+            }
+        }
+        return documents;
+    }
+
+    // Consultas con stopwords y flexiones sobre palabras del propio corpus
+    std::vector<std::string> make_queries(const std::vector<std::string>& documents)
+    {
+        std::vector<std::string> queries;
+        std::mt19937 random(11);
+        for (int i = 0; i < 20; ++i)
+        {
+            std::vector<std::string> words;
+            std::stringstream stream(documents[random() % documents.size()]);
+            std::string word;
+            while (stream >> word)
+            {
+                words.push_back(word);
+            }
+            if (words.size() < 4)
+            {
+                continue;
+            }
+            size_t start = random() % (words.size() - 3);
+            queries.push_back(words[start] + " " + words[start + 1] + " " + words[start + 2] +
+                              " " + words[start + 3]);
+        }
+        return queries;
+    }
+
+    void run(const char* name, const std::vector<std::string>& documents, AnalyzerOptions options)
+    {
+        BM25Engine engine(std::make_shared<TextAnalyzer>(options));
+
+        auto start = std::chrono::steady_clock::now();
+        engine.IndexDocuments(documents, 1);
+        std::chrono::duration<double> index_time = std::chrono::steady_clock::now() - start;
+
+        const std::vector<std::string> queries = make_queries(documents);
+
+        start = std::chrono::steady_clock::now();
+        size_t results = 0;
+        for (int i = 0; i < QUERY_REPETITIONS; ++i)
+        {
+            for (const auto& query : queries)
+            {
+                results += engine.Search(query).size();
+            }
+        }
+        std::chrono::duration<double> query_time = std::chrono::steady_clock::now() - start;
+
+        const size_t postings = engine.GetPostingCount();
+        std::printf("%-22s términos %8zu  postings %10zu (~%.1f MB)  indexado %7.1f ms  "
+                    "consulta %8.1f us  (%zu resultados)\n",
+                    name, engine.GetTermCount(), postings,
+                    postings * (sizeof(uint32_t) * 2) / (1024.0 * 1024.0),
+                    index_time.count() * 1e3,
+                    query_time.count() * 1e6 / (QUERY_REPETITIONS * queries.size()), results);
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> documents =
+        argc > 1 ? load_directory(argv[1]) : synthetic_corpus(5'000);
+    std::printf("Documentos: %zu%s\n\n", documents.size(), argc > 1 ? "" : " (sintéticos)");
+
+    run("sin análisis", documents, {false, false, ""});
+    run("solo stopwords", documents, {false, true, ""});
+    run("solo stemming", documents, {true, false, ""});
+    run("stopwords + stemming", documents, {true, true, ""});
+
+    return 0;
+}
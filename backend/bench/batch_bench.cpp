@@ -0,0 +1,98 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "infrastructure/sharded_engine.hpp"
+
+using DocuTrace::Infrastructure::BatchQuery;
+using DocuTrace::Infrastructure::ShardedEngine;
+
+namespace
+{
+    constexpr size_t DOCUMENTS = 50'000;
+    constexpr size_t QUERIES = 2'000;
+
+    std::vector<std::string> synthetic_vocabulary(std::mt19937& random)
+    {
+        const std::string letters = "bcdfglmnprstvaeiou";
+        std::vector<std::string> vocabulary(20'000);
+        for (auto& word : vocabulary)
+        {
+            int length = 4 + static_cast<int>(random() % 6);
+            for (int i = 0; i < length; ++i)
+            {
+                word += letters[random() % letters.size()];
+            }
+        }
+        return vocabulary;
+    }
+
+    // Sesgo hacia las primeras palabras: términos frecuentes y raros
+    const std::string& skewed_word(const std::vector<std::string>& vocabulary, std::mt19937& random)
+    {
+        return vocabulary[random() % (1 + random() % vocabulary.size())];
+    }
+
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+} // namespace
+
+int main()
+{
+    std::mt19937 random(11);
+    const std::vector<std::string> vocabulary = synthetic_vocabulary(random);
+
+    std::vector<std::string> documents(DOCUMENTS);
+    for (auto& document : documents)
+    {
+        for (int word = 0; word < 200; ++word)
+        {
+            document += skewed_word(vocabulary, random) + ' ';
+        }
+    }
+
+    // Consultas de 2 a 4 palabras con la misma distribución: comparten términos frecuentes
+    std::vector<BatchQuery> queries(QUERIES);
+    for (auto& query : queries)
+    {
+        const int words = 2 + static_cast<int>(random() % 3);
+        for (int word = 0; word < words; ++word)
+        {
+            query.query += skewed_word(vocabulary, random) + ' ';
+        }
+        query.max_results = 10;
+    }
+
+    std::printf("Documentos: %zu, consultas: %zu\n\n", DOCUMENTS, QUERIES);
+    for (size_t shards : {1, 4})
+    {
+        ShardedEngine engine(shards, nullptr);
+        engine.IndexDocuments(documents, 1, 0, 1000);
+
+        // Una a una, como las haría un cliente por /api/search
+        auto start = std::chrono::steady_clock::now();
+        size_t results = 0;
+        for (const auto& query : queries)
+        {
+            results += engine.Search(query.query, query.max_results, query.options).size();
+        }
+        const double sequential = seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        size_t batch_results = 0;
+        for (const auto& list : engine.SearchBatch(queries))
+        {
+            batch_results += list.size();
+        }
+        const double batch = seconds_since(start);
+
+        std::printf("%zu particiones: una a una %7.0f consultas/s, lote %7.0f consultas/s "
+                    "(x%.1f, %zu/%zu resultados)\n",
+                    shards, QUERIES / sequential, QUERIES / batch, sequential / batch, results,
+                    batch_results);
+    }
+    return 0;
+}
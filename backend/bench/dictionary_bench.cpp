@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "infrastructure/suggestion_index.hpp"
+#include "infrastructure/term_dictionary.hpp"
+
+using DocuTrace::Infrastructure::SuggestionIndex;
+using DocuTrace::Infrastructure::TermDictionary;
+
+namespace
+{
+    constexpr int LOOKUPS = 2'000;
+
+    // Términos sintéticos con sílabas del español: muchos prefijos compartidos como en un
+    // diccionario real
+    std::string make_term(std::mt19937& random)
+    {
+        static const char* syllables[] = {"ca", "co",  "ma",  "me",   "pa",  "pi",   "ta",  "to",
+                                          "la", "lo",  "sa",  "se",   "ra",  "ri",   "na",  "ne",
+                                          "bra", "tre", "cion", "dad", "ment", "ist", "or", "an"};
+        std::string term;
+        int count = 2 + static_cast<int>(random() % 4);
+        for (int i = 0; i < count; ++i)
+        {
+            term += syllables[random() % std::size(syllables)];
+        }
+        return term;
+    }
+
+    // Introduce una errata: sustitución, borrado o transposición
+    std::string misspell(std::string term, std::mt19937& random)
+    {
+        size_t position = random() % (term.size() - 1);
+        switch (random() % 3)
+        {
+        case 0:
+            term[position] = static_cast<char>('a' + random() % 26);
+            break;
+        case 1:
+            term.erase(position, 1);
+            break;
+        default:
+            std::swap(term[position], term[position + 1]);
+            break;
+        }
+        return term;
+    }
+
+    template <typename Function> double microseconds_per_call(Function&& function)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < LOOKUPS; ++i)
+        {
+            function(i);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() * 1e6 / LOOKUPS;
+    }
+
+    // Latencia de /api/suggest: prefijos de 1 a 4 letras como al teclear
+    void bench_suggestions(const std::vector<std::string>& terms, std::mt19937& random)
+    {
+        SuggestionIndex suggestions;
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::string> document(1);
+        for (size_t i = 0; i < terms.size(); ++i)
+        {
+            // Frecuencias tipo Zipf: unas pocas palabras aparecen en muchos documentos
+            document[0] = terms[i];
+            size_t frequency = 1 + terms.size() / (100 * (i + 1));
+            for (size_t f = 0; f < frequency; ++f)
+            {
+                suggestions.AddDocument(document);
+            }
+        }
+        std::chrono::duration<double> build_time = std::chrono::steady_clock::now() - start;
+
+        std::vector<double> latencies(LOOKUPS);
+        size_t returned = 0;
+        for (int i = 0; i < LOOKUPS; ++i)
+        {
+            const std::string& term = terms[random() % terms.size()];
+            std::string prefix = term.substr(0, 1 + i % 4);
+            auto query_start = std::chrono::steady_clock::now();
+            returned += suggestions.Suggest(prefix, SuggestionIndex::MAX_SUGGESTIONS).size();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - query_start;
+            latencies[i] = elapsed.count() * 1e6;
+        }
+        std::sort(latencies.begin(), latencies.end());
+
+        std::printf("\nSugerencias: %zu palabras, construcción %.0f ms\n",
+                    suggestions.GetWordCount(), build_time.count() * 1e3);
+        std::printf("  top-%zu por prefijo       p50 %6.2f us  p99 %6.2f us  (%.1f por consulta)\n",
+                    SuggestionIndex::MAX_SUGGESTIONS, latencies[LOOKUPS / 2],
+                    latencies[LOOKUPS * 99 / 100], static_cast<double>(returned) / LOOKUPS);
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t term_count = argc > 1 ? std::stoul(argv[1]) : 1'000'000;
+    std::mt19937 random(5);
+
+    TermDictionary dictionary;
+    std::vector<std::string> terms;
+    terms.reserve(term_count);
+    auto start = std::chrono::steady_clock::now();
+    while (dictionary.Size() < term_count)
+    {
+        std::string term = make_term(random);
+        if (dictionary.Insert(term))
+        {
+            terms.push_back(std::move(term));
+        }
+    }
+    std::chrono::duration<double> build_time = std::chrono::steady_clock::now() - start;
+    std::printf("Términos: %zu  nodos: %zu  construcción: %.0f ms\n\n", dictionary.Size(),
+                dictionary.GetNodeCount(), build_time.count() * 1e3);
+
+    std::vector<std::string> targets(LOOKUPS);
+    std::vector<std::string> typos(LOOKUPS);
+    for (int i = 0; i < LOOKUPS; ++i)
+    {
+        targets[i] = terms[random() % terms.size()];
+        typos[i] = misspell(targets[i], random);
+    }
+
+    size_t found = 0;
+    double exact = microseconds_per_call([&](int i) { found += dictionary.Contains(targets[i]); });
+    std::printf("  %-22s %8.2f us/consulta\n", "exacto", exact);
+
+    double prefix = microseconds_per_call(
+        [&](int i) { found += dictionary.PrefixSearch(targets[i].substr(0, 4), 50).size(); });
+    std::printf("  %-22s %8.2f us/consulta\n", "prefijo (50 términos)", prefix);
+
+    for (int distance = 1; distance <= 2; ++distance)
+    {
+        size_t hits = 0;
+        double fuzzy = microseconds_per_call(
+            [&](int i)
+            {
+                for (const auto& match : dictionary.FuzzySearch(typos[i], distance))
+                {
+                    hits += match.term == targets[i];
+                }
+            });
+        std::printf("  difuso (%d ediciones)    %8.2f us/consulta  (recupera %.1f%%)\n", distance,
+                    fuzzy, 100.0 * hits / LOOKUPS);
+    }
+
+    bench_suggestions(terms, random);
+    return found == 0;
+}
@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <map>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+#include "infrastructure/doc_values.hpp"
+
+using DocuTrace::Infrastructure::DocumentMetadata;
+using DocuTrace::Infrastructure::DocValues;
+using DocuTrace::Infrastructure::FacetCounts;
+using DocuTrace::Infrastructure::FacetField;
+using DocuTrace::Infrastructure::InternalDocumentId;
+using DocuTrace::Infrastructure::QueryField;
+using DocuTrace::Infrastructure::QueryNode;
+
+namespace
+{
+    constexpr size_t DOCUMENTS = 1'000'000;
+    constexpr int REPETITIONS = 10;
+    constexpr size_t TOP = 100;
+
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Milisegundos por repetición de work()
+    template <typename Work> double measure(Work&& work)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < REPETITIONS; ++r)
+        {
+            work();
+        }
+        return seconds_since(start) * 1000.0 / REPETITIONS;
+    }
+
+    // Bytes de la disposición por filas anterior: un DocumentMetadata por documento
+    size_t row_bytes(const std::vector<DocumentMetadata>& rows)
+    {
+        size_t bytes = rows.capacity() * sizeof(DocumentMetadata);
+        for (const auto& row : rows)
+        {
+            // Las cadenas cortas caben en el propio std::string (SSO de 15 bytes)
+            bytes += row.filename.size() > 15 ? row.filename.capacity() + 1 : 0;
+            bytes += row.directory.size() > 15 ? row.directory.capacity() + 1 : 0;
+        }
+        return bytes;
+    }
+
+    void report(const char* operation, double rows_ms, double columns_ms, size_t checksum)
+    {
+        std::printf("  %-22s filas %8.2f ms  columnas %7.2f ms  (x%.1f)  [%zu]\n", operation,
+                    rows_ms, columns_ms, rows_ms / columns_ms, checksum);
+    }
+} // namespace
+
+int main()
+{
+    std::mt19937 random(5);
+    const char* extensions[] = {"pdf", "txt", "docx", "md", "html", "csv", "log", "json"};
+    std::vector<std::string> directories;
+    for (int d = 0; d < 400; ++d)
+    {
+        directories.push_back("/srv/documentos/departamento_" + std::to_string(d % 20) +
+                              "/proyecto_" + std::to_string(d));
+    }
+
+    // Cinco años de fechas; los IDs crecen con la fecha como al rastrear una carpeta
+    const std::time_t first = 1'577'836'800; // 2020-01-01
+    const std::time_t span = 5 * 365 * 24 * 3600;
+    std::vector<DocumentMetadata> rows(DOCUMENTS);
+    DocValues columns;
+    columns.Reserve(DOCUMENTS);
+    for (size_t i = 0; i < DOCUMENTS; ++i)
+    {
+        auto& row = rows[i];
+        row.filename = "informe_" + std::to_string(random() % 100'000) + "." +
+                       extensions[random() % std::size(extensions)];
+        row.timestamp = first + static_cast<std::time_t>(i * span / DOCUMENTS);
+        row.directory = directories[random() % directories.size()];
+        columns.Add(row);
+    }
+
+    // Conjunto resultado de una consulta: un documento de cada tres
+    std::vector<InternalDocumentId> matching;
+    for (size_t i = 0; i < DOCUMENTS; i += 3)
+    {
+        matching.push_back(static_cast<InternalDocumentId>(i));
+    }
+
+    std::printf("Documentos: %zu, coincidentes: %zu\n", DOCUMENTS, matching.size());
+    std::printf("  memoria                filas %8.1f MB  columnas %7.1f MB\n",
+                row_bytes(rows) / 1e6, columns.GetMemoryUsage() / 1e6);
+
+    // ext:pdf
+    {
+        size_t row_count = 0;
+        size_t column_count = 0;
+        const double rows_ms = measure(
+            [&]()
+            {
+                row_count = 0;
+                for (const auto& row : rows)
+                {
+                    row_count += DocValues::ExtensionOf(row.filename) == "pdf" ? 1 : 0;
+                }
+            });
+        QueryNode filter;
+        filter.field = QueryField::EXTENSION;
+        filter.filter_value = "pdf";
+        const double columns_ms = measure(
+            [&]()
+            {
+                const auto bitset = columns.Filter(filter);
+                column_count = 0;
+                for (size_t i = 0; i < DOCUMENTS; ++i)
+                {
+                    column_count += bitset.Test(static_cast<InternalDocumentId>(i)) ? 1 : 0;
+                }
+            });
+        report("filtro ext:pdf", rows_ms, columns_ms, row_count == column_count ? row_count : 0);
+    }
+
+    // after:2023-01-01
+    {
+        const std::time_t after = 1'672'531'200;
+        size_t row_count = 0;
+        size_t column_count = 0;
+        const double rows_ms = measure(
+            [&]()
+            {
+                row_count = 0;
+                for (const auto& row : rows)
+                {
+                    row_count += row.timestamp >= after ? 1 : 0;
+                }
+            });
+        QueryNode filter;
+        filter.field = QueryField::AFTER;
+        filter.filter_timestamp = after;
+        const double columns_ms = measure(
+            [&]()
+            {
+                const auto bitset = columns.Filter(filter);
+                column_count = 0;
+                for (size_t i = 0; i < DOCUMENTS; ++i)
+                {
+                    column_count += bitset.Test(static_cast<InternalDocumentId>(i)) ? 1 : 0;
+                }
+            });
+        report("filtro after:", rows_ms, columns_ms, row_count == column_count ? row_count : 0);
+    }
+
+    // Facetas por extensión y por mes sobre el conjunto resultado
+    for (FacetField field : {FacetField::EXTENSION, FacetField::MONTH, FacetField::DIRECTORY})
+    {
+        std::map<std::string, uint64_t> row_counts;
+        const double rows_ms = measure(
+            [&]()
+            {
+                row_counts.clear();
+                for (InternalDocumentId id : matching)
+                {
+                    const auto& row = rows[id];
+                    if (field == FacetField::EXTENSION)
+                    {
+                        row_counts[DocValues::ExtensionOf(row.filename)]++;
+                    }
+                    else if (field == FacetField::DIRECTORY)
+                    {
+                        row_counts[row.directory]++;
+                    }
+                    else
+                    {
+                        std::tm tm{};
+                        gmtime_r(&row.timestamp, &tm);
+                        char month[16];
+                        std::strftime(month, sizeof(month), "%Y-%m", &tm);
+                        row_counts[month]++;
+                    }
+                }
+            });
+        FacetCounts counts;
+        const double columns_ms = measure(
+            [&]()
+            {
+                counts = {};
+                columns.CountFacets(matching, {field}, counts);
+            });
+        const std::string name = std::string("faceta ") + DocValues::FacetFieldName(field);
+        report(name.c_str(), rows_ms, columns_ms,
+               row_counts == counts.fields[field] ? row_counts.size() : 0);
+    }
+
+    // Top 100 por nombre de archivo (sort=filename)
+    {
+        std::vector<InternalDocumentId> row_top;
+        std::vector<InternalDocumentId> column_top;
+        auto top_by = [&matching](std::vector<InternalDocumentId>& top, auto&& before)
+        {
+            top = matching;
+            std::partial_sort(top.begin(), top.begin() + TOP, top.end(), before);
+            top.resize(TOP);
+        };
+        const double rows_ms = measure(
+            [&]()
+            {
+                top_by(row_top, [&rows](InternalDocumentId a, InternalDocumentId b)
+                       { return rows[a].filename < rows[b].filename; });
+            });
+        const double columns_ms = measure(
+            [&]()
+            {
+                top_by(column_top, [&columns](InternalDocumentId a, InternalDocumentId b)
+                       { return columns.GetFilename(a) < columns.GetFilename(b); });
+            });
+        report("top 100 por nombre", rows_ms, columns_ms, row_top == column_top ? TOP : 0);
+    }
+    return 0;
+}
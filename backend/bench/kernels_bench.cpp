@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "shared/simd_kernels.hpp"
+
+using DocuTrace::Shared::SimdKernels;
+using DocuTrace::Shared::SimdLevel;
+
+namespace
+{
+    constexpr int REPETITIONS = 50;
+
+    // Lista ordenada sin repetidos con densidad aproximada count / universe
+    std::vector<uint32_t> make_postings(std::mt19937& random, size_t count, uint32_t universe)
+    {
+        std::vector<uint32_t> values(count);
+        std::uniform_int_distribution<uint32_t> distribution(0, universe - 1);
+        for (auto& value : values)
+        {
+            value = distribution(random);
+        }
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+        return values;
+    }
+
+    template <typename Function> double seconds(Function&& function)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < REPETITIONS; ++i)
+        {
+            function();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    void bench_decode(const std::vector<uint32_t>& postings)
+    {
+        // Huecos menos uno entre IDs consecutivos de la lista
+        std::vector<uint32_t> gaps(postings.size());
+        for (size_t i = 0; i < postings.size(); ++i)
+        {
+            gaps[i] = i == 0 ? postings[0] : postings[i] - postings[i - 1] - 1;
+        }
+        std::vector<uint8_t> encoded(SimdKernels::PackedMaxBytes(gaps.size()));
+        size_t bytes = SimdKernels::EncodePacked(gaps.data(), gaps.size(), encoded.data());
+        std::vector<uint32_t> decoded(gaps.size());
+
+        std::printf("Bloques empaquetados: %zu huecos, %.2f bits/hueco\n", gaps.size(),
+                    8.0 * static_cast<double>(bytes) / gaps.size());
+
+        auto run = [&](const char* name, auto decode)
+        {
+            double elapsed =
+                seconds([&] { decode(encoded.data(), bytes, gaps.size(), decoded.data()); });
+            std::printf("  %-8s %8.1f M enteros/s%s\n", name,
+                        gaps.size() * REPETITIONS / elapsed / 1e6,
+                        decoded == gaps ? "" : " (ERROR)");
+        };
+
+        run("scalar", SimdKernels::DecodePackedScalar);
+        if (SimdKernels::DetectLevel() >= SimdLevel::AVX2)
+        {
+            run("avx2", SimdKernels::DecodePackedAvx2);
+        }
+    }
+
+    void bench_intersect(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b)
+    {
+        std::vector<uint32_t> out(std::min(a.size(), b.size()));
+        std::printf("Intersección %zu x %zu\n", a.size(), b.size());
+
+        auto run = [&](const char* name, auto intersect)
+        {
+            size_t matches = 0;
+            double elapsed = seconds(
+                [&] { matches = intersect(a.data(), a.size(), b.data(), b.size(), out.data()); });
+            std::printf("  %-8s %8.1f M enteros/s (%zu coincidencias)\n", name,
+                        (a.size() + b.size()) * REPETITIONS / elapsed / 1e6, matches);
+        };
+
+        run("scalar", SimdKernels::IntersectScalar);
+        run("gallop", SimdKernels::IntersectGalloping);
+        if (SimdKernels::DetectLevel() >= SimdLevel::SSE)
+        {
+            run("sse", SimdKernels::IntersectSse);
+        }
+        if (SimdKernels::DetectLevel() >= SimdLevel::AVX2)
+        {
+            run("avx2", SimdKernels::IntersectAvx2);
+        }
+    }
+} // namespace
+
+int main()
+{
+    std::mt19937 random(42);
+    std::printf("Nivel detectado: %s\n\n", SimdKernels::LevelName(SimdKernels::DetectLevel()));
+
+    const auto dense = make_postings(random, 1'000'000, 4'000'000);
+    const auto sparse = make_postings(random, 1'000'000, 400'000'000);
+    bench_decode(dense);
+    bench_decode(sparse);
+    std::printf("\n");
+
+    const auto similar = make_postings(random, 1'000'000, 4'000'000);
+    const auto small = make_postings(random, 10'000, 4'000'000);
+    bench_intersect(dense, similar);
+    bench_intersect(small, dense);
+
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+#include "infrastructure/bm25_engine.hpp"
+
+using DocuTrace::Infrastructure::BM25Engine;
+using DocuTrace::Infrastructure::MemoryStatistics;
+
+namespace
+{
+    constexpr size_t DOCUMENTS = 20'000;
+    constexpr int QUERIES = 2'000;
+
+    std::vector<std::string> synthetic_corpus(std::mt19937& random)
+    {
+        const std::string letters = "bcdfglmnprstvaeiou";
+        std::vector<std::string> vocabulary(20'000);
+        for (auto& word : vocabulary)
+        {
+            int length = 4 + static_cast<int>(random() % 6);
+            for (int i = 0; i < length; ++i)
+            {
+                word += letters[random() % letters.size()];
+            }
+        }
+
+        std::vector<std::string> documents(DOCUMENTS);
+        for (auto& document : documents)
+        {
+            for (int word = 0; word < 200; ++word)
+            {
+                // Sesgo hacia las primeras palabras: términos frecuentes y raros
+                size_t index = random() % (1 + random() % vocabulary.size());
+                document += vocabulary[index] + ' ';
+            }
+        }
+        return documents;
+    }
+
+    double percentile(std::vector<double> values, double fraction)
+    {
+        std::sort(values.begin(), values.end());
+        return values[static_cast<size_t>(fraction * (values.size() - 1))];
+    }
+
+    double share(uint64_t part, uint64_t total)
+    {
+        return total == 0 ? 0.0 : 100.0 * static_cast<double>(part) / static_cast<double>(total);
+    }
+} // namespace
+
+// Uso: docutrace-memory-bench [directorio del nivel frío]
+int main(int argc, char** argv)
+{
+    const std::filesystem::path cold_directory =
+        argc > 1 ? std::filesystem::path(argv[1]) : std::filesystem::temp_directory_path();
+
+    std::mt19937 random(3);
+    const std::vector<std::string> documents = synthetic_corpus(random);
+    std::vector<std::string> queries;
+    for (int i = 0; i < 64; ++i)
+    {
+        const std::string& document = documents[random() % documents.size()];
+        size_t start = document.find(' ', random() % (document.size() / 2)) + 1;
+        queries.push_back(document.substr(start, document.find(' ', start + 20) - start));
+    }
+
+    // Tamaño sin límite como referencia para los presupuestos
+    size_t full_size = 0;
+    {
+        BM25Engine engine;
+        engine.IndexDocuments(documents, 1, 0, 1000);
+        full_size = engine.GetMemoryStatistics().resident_bytes;
+    }
+    std::printf("Documentos: %zu, postings y textos: %.1f MB, nivel frío en %s\n\n",
+                documents.size(), full_size / 1048576.0, cold_directory.c_str());
+
+    for (int percent : {0, 75, 50, 25, 10})
+    {
+        BM25Engine engine;
+        if (percent > 0)
+        {
+            engine.SetMemoryBudget(full_size * percent / 100, cold_directory);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        engine.IndexDocuments(documents, 1, 0, 1000);
+        std::chrono::duration<double> index_time = std::chrono::steady_clock::now() - start;
+
+        std::vector<double> latencies;
+        for (int i = 0; i < QUERIES; ++i)
+        {
+            auto query_start = std::chrono::steady_clock::now();
+            engine.Search(queries[i % queries.size()], 10);
+            latencies.push_back(std::chrono::duration<double, std::micro>(
+                                    std::chrono::steady_clock::now() - query_start)
+                                    .count());
+        }
+
+        MemoryStatistics memory = engine.GetMemoryStatistics();
+        std::printf("%-10s RAM %6.1f MB  frío %6.1f MB  indexado %6.0f ms  p50 %7.0f us  "
+                    "p99 %7.0f us  postings frías %5.1f%%  textos fríos %5.1f%%\n",
+                    percent == 0 ? "sin límite" : (std::to_string(percent) + "%").c_str(),
+                    memory.resident_bytes / 1048576.0, memory.cold_bytes / 1048576.0,
+                    index_time.count() * 1e3, percentile(latencies, 0.5),
+                    percentile(latencies, 0.99),
+                    share(memory.posting_hits_cold,
+                          memory.posting_hits_cold + memory.posting_hits_resident),
+                    share(memory.document_hits_cold,
+                          memory.document_hits_cold + memory.document_hits_resident));
+    }
+    return 0;
+}
@@ -0,0 +1,216 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "infrastructure/ranking_models.hpp"
+
+using namespace DocuTrace::Infrastructure;
+
+namespace
+{
+    constexpr int REPETITIONS = 50;
+    constexpr size_t DOCUMENTS = 1000000;
+
+    struct Lengths
+    {
+        std::vector<uint32_t> values;
+
+        uint32_t GetLength(InternalDocumentId document_id) const
+        {
+            return values[document_id];
+        }
+    };
+
+    struct Corpus
+    {
+        Lengths lengths;
+        std::vector<bool> tombstones;
+        FilenameField filenames;
+        std::vector<InternalDocumentId> documents;
+        std::vector<uint32_t> frequencies;
+        TermContext term;
+    };
+
+    // Un término que aparece en ~1 de cada 4 documentos, con el 2 % eliminados
+    Corpus make_corpus()
+    {
+        std::mt19937 random(42);
+        std::uniform_int_distribution<uint32_t> length(20, 2000);
+        std::geometric_distribution<uint32_t> frequency(0.4);
+        std::bernoulli_distribution contains(0.25);
+        std::bernoulli_distribution deleted(0.02);
+        std::bernoulli_distribution in_filename(0.1);
+
+        Corpus corpus;
+        corpus.lengths.values.resize(DOCUMENTS);
+        corpus.tombstones.resize(DOCUMENTS);
+        long long total_length = 0;
+        for (InternalDocumentId id = 0; id < DOCUMENTS; ++id)
+        {
+            corpus.lengths.values[id] = length(random);
+            total_length += corpus.lengths.values[id];
+            corpus.tombstones[id] = deleted(random);
+            std::vector<std::string> filename = {"informe", std::to_string(id % 97)};
+            if (in_filename(random))
+            {
+                filename.push_back("contrato");
+            }
+            corpus.filenames.AddDocument(id, filename);
+            if (contains(random))
+            {
+                corpus.documents.push_back(id);
+                corpus.frequencies.push_back(1 + frequency(random));
+            }
+        }
+
+        corpus.term.document_count = DOCUMENTS;
+        corpus.term.document_frequency = static_cast<double>(corpus.documents.size());
+        corpus.term.average_length = static_cast<double>(total_length) / DOCUMENTS;
+        corpus.term.average_filename_length =
+            static_cast<double>(corpus.filenames.GetTotalLength()) / DOCUMENTS;
+        corpus.term.term_hash = FilenameField::HashTerm("contrato");
+        corpus.term.filename_field = &corpus.filenames;
+        return corpus;
+    }
+
+    template <typename Function> double seconds(Function&& function)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < REPETITIONS; ++i)
+        {
+            function();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    // Bucle anterior a las políticas: constantes fijas y el idf recalculado en cada posting
+    constexpr double K1 = 1.2;
+    constexpr double B = 0.75;
+
+    double legacy_score(double n, double f, double N, double dl, double avdl)
+    {
+        double idf = std::log((N - n + 0.5) / (n + 0.5));
+        double tf_component = (f * (K1 + 1)) / (f + K1 * (1 - B + B * dl / avdl));
+        return idf * tf_component;
+    }
+
+    void legacy_accumulate(const Corpus& corpus, std::vector<double>& scores)
+    {
+        const double N = corpus.term.document_count;
+        const double n = corpus.term.document_frequency;
+        const double avdl = corpus.term.average_length;
+        for (size_t i = 0; i < corpus.documents.size(); ++i)
+        {
+            InternalDocumentId doc_id = corpus.documents[i];
+            if (corpus.tombstones[doc_id])
+            {
+                continue;
+            }
+            double f = static_cast<double>(corpus.frequencies[i]);
+            double dl = static_cast<double>(corpus.lengths.GetLength(doc_id));
+            scores[doc_id] += legacy_score(n, f, N, dl, avdl);
+        }
+    }
+
+    // Alternativa descartada: un modelo intercambiable con una llamada virtual por posting
+    struct VirtualScorer
+    {
+        virtual ~VirtualScorer() = default;
+        virtual double Score(InternalDocumentId document_id, double f, double dl) const = 0;
+    };
+
+    template <typename Policy> struct VirtualPolicy : VirtualScorer
+    {
+        Policy policy;
+
+        explicit VirtualPolicy(const Policy& policy) : policy(policy)
+        {
+        }
+
+        double Score(InternalDocumentId document_id, double f, double dl) const override
+        {
+            return policy(document_id, f, dl);
+        }
+    };
+
+    void virtual_accumulate(const Corpus& corpus, const VirtualScorer& scorer,
+                            std::vector<double>& scores)
+    {
+        for (size_t i = 0; i < corpus.documents.size(); ++i)
+        {
+            InternalDocumentId doc_id = corpus.documents[i];
+            if (corpus.tombstones[doc_id])
+            {
+                continue;
+            }
+            double f = static_cast<double>(corpus.frequencies[i]);
+            double dl = static_cast<double>(corpus.lengths.GetLength(doc_id));
+            scores[doc_id] += scorer.Score(doc_id, f, dl);
+        }
+    }
+
+    void report(const char* name, double elapsed, const Corpus& corpus)
+    {
+        std::printf("  %-22s %8.1f M postings/s\n", name,
+                    corpus.documents.size() * REPETITIONS / elapsed / 1e6);
+    }
+
+    bool same_scores(const std::vector<double>& a, const std::vector<double>& b)
+    {
+        return a == b;
+    }
+} // namespace
+
+int main()
+{
+    Corpus corpus = make_corpus();
+    std::printf("Puntuación de %zu postings (%zu documentos)\n", corpus.documents.size(),
+                DOCUMENTS);
+
+    std::vector<double> reference(DOCUMENTS, 0.0);
+    report("bucle anterior", seconds([&] { legacy_accumulate(corpus, reference); }), corpus);
+
+    const RankingParameters bm25;
+    std::vector<double> scores(DOCUMENTS, 0.0);
+    const Bm25Policy bm25_policy(bm25, corpus.term);
+    report("Bm25Policy",
+           seconds(
+               [&]
+               {
+                   AccumulatePostings(bm25_policy, 1.0, corpus.documents, corpus.frequencies,
+                                      corpus.lengths, corpus.tombstones, scores);
+               }),
+           corpus);
+    std::printf("  resultados idénticos al bucle anterior: %s\n",
+                same_scores(reference, scores) ? "sí" : "NO");
+
+    std::fill(scores.begin(), scores.end(), 0.0);
+    std::unique_ptr<VirtualScorer> scorer =
+        std::make_unique<VirtualPolicy<Bm25Policy>>(bm25_policy);
+    report("Bm25 (virtual)", seconds([&] { virtual_accumulate(corpus, *scorer, scores); }),
+           corpus);
+
+    for (RankingModel model : {RankingModel::BM25_PLUS, RankingModel::BM25L, RankingModel::BM25F})
+    {
+        const RankingParameters parameters = RankingParameters::ForModel(model);
+        std::fill(scores.begin(), scores.end(), 0.0);
+        const double elapsed = VisitRankingModel(
+            model,
+            [&]<typename Policy>()
+            {
+                const Policy policy(parameters, corpus.term);
+                return seconds(
+                    [&]
+                    {
+                        AccumulatePostings(policy, 1.0, corpus.documents, corpus.frequencies,
+                                           corpus.lengths, corpus.tombstones, scores);
+                    });
+            });
+        report(RankingParameters::ModelName(model), elapsed, corpus);
+    }
+    return 0;
+}
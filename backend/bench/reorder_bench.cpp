@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "infrastructure/bm25_engine.hpp"
+#include "shared/binary_io.hpp"
+
+using DocuTrace::Infrastructure::BM25Engine;
+using DocuTrace::Infrastructure::DocumentOrder;
+using DocuTrace::Infrastructure::QueryOptions;
+using DocuTrace::Infrastructure::ReorderStatistics;
+using DocuTrace::Infrastructure::SearchResult;
+using DocuTrace::Infrastructure::TwoPhaseOptions;
+
+namespace
+{
+    constexpr size_t TOPICS = 200;
+    constexpr size_t TOPIC_WORDS = 300;
+    constexpr size_t QUERIES = 300;
+    constexpr size_t TOP_K = 10;
+    constexpr int QUERY_ROUNDS = 5;
+
+    // Documentos .txt de un directorio (p. ej. test_data/docs_es generado por generator.py)
+    std::vector<std::string> load_directory(const std::filesystem::path& directory)
+    {
+        std::vector<std::string> documents;
+        for (const auto& entry : std::filesystem::directory_iterator(directory))
+        {
+            if (entry.path().extension() != ".txt")
+            {
+                continue;
+            }
+            std::ifstream file(entry.path());
+            std::stringstream buffer;
+            buffer << file.rdbuf();
+            documents.push_back(buffer.str());
+        }
+        return documents;
+    }
+
+    std::vector<std::string> synthetic_vocabulary(std::mt19937& random, size_t size)
+    {
+        const std::string letters = "bcdfglmnprstvaeiou";
+        std::vector<std::string> vocabulary(size);
+        for (auto& word : vocabulary)
+        {
+            const int length = 5 + static_cast<int>(random() % 5);
+            for (int i = 0; i < length; ++i)
+            {
+                word += letters[random() % letters.size()];
+            }
+        }
+        return vocabulary;
+    }
+
+    // Corpus por temas llegados en orden aleatorio: cada documento mezcla palabras de su tema
+    // con otras de todo el vocabulario, como una carpeta con proyectos entremezclados
+    struct Corpus
+    {
+        std::vector<std::string> documents;
+        std::vector<std::vector<std::string>> topics;
+    };
+
+    Corpus synthetic_corpus(size_t count)
+    {
+        std::mt19937 random(11);
+        const std::vector<std::string> vocabulary = synthetic_vocabulary(random, 30'000);
+
+        Corpus corpus;
+        corpus.topics.resize(TOPICS);
+        for (auto& topic : corpus.topics)
+        {
+            for (size_t word = 0; word < TOPIC_WORDS; ++word)
+            {
+                topic.push_back(vocabulary[random() % vocabulary.size()]);
+            }
+        }
+
+        corpus.documents.resize(count);
+        for (auto& document : corpus.documents)
+        {
+            const auto& topic = corpus.topics[random() % TOPICS];
+            for (int word = 0; word < 120; ++word)
+            {
+                document += (random() % 10 < 7 ? topic[random() % (1 + random() % TOPIC_WORDS)]
+                                                : vocabulary[random() % vocabulary.size()]) +
+                            ' ';
+            }
+        }
+        return corpus;
+    }
+
+    // Consultas de un mismo tema (con un directorio, palabras de documentos al azar)
+    std::vector<std::string> make_queries(const Corpus& corpus, bool conjunctive)
+    {
+        std::mt19937 random(conjunctive ? 5 : 3);
+        std::vector<std::string> queries(QUERIES);
+        for (auto& query : queries)
+        {
+            const int words = conjunctive ? 2 : 3;
+            if (!corpus.topics.empty())
+            {
+                const auto& topic = corpus.topics[random() % corpus.topics.size()];
+                for (int word = 0; word < words; ++word)
+                {
+                    query += (conjunctive ? "+" : "") + topic[random() % 60] + ' ';
+                }
+                continue;
+            }
+            std::istringstream text(corpus.documents[random() % corpus.documents.size()]);
+            std::vector<std::string> document_words{std::istream_iterator<std::string>(text),
+                                                    std::istream_iterator<std::string>()};
+            for (int word = 0; word < words && !document_words.empty(); ++word)
+            {
+                query += (conjunctive ? "+" : "") +
+                         document_words[random() % document_words.size()] + ' ';
+            }
+        }
+        return queries;
+    }
+
+    // Mejor de QUERY_ROUNDS pasadas, para que no cuente el ruido de otros procesos
+    double milliseconds_per_query(const BM25Engine& engine,
+                                  const std::vector<std::string>& queries,
+                                  const QueryOptions& options,
+                                  std::vector<std::vector<SearchResult>>* results = nullptr)
+    {
+        double best = 0.0;
+        for (int round = 0; round < QUERY_ROUNDS; ++round)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for (const auto& query : queries)
+            {
+                auto found = engine.Search(query, TOP_K, options);
+                if (results && round == 0)
+                {
+                    results->push_back(std::move(found));
+                }
+            }
+            std::chrono::duration<double, std::milli> elapsed =
+                std::chrono::steady_clock::now() - start;
+            const double milliseconds = elapsed.count() / static_cast<double>(queries.size());
+            best = round == 0 ? milliseconds : std::min(best, milliseconds);
+        }
+        return best;
+    }
+
+    // Tamaño del segmento sin los textos, que ocupan lo mismo en cualquier orden
+    uint64_t segment_bytes(const BM25Engine& engine, uint64_t text_bytes)
+    {
+        std::ostringstream out;
+        DocuTrace::Shared::BinaryWriter writer(out);
+        engine.WriteSegment(writer);
+        return writer.GetSize() - text_bytes;
+    }
+
+    struct Measure
+    {
+        uint64_t segment = 0;
+        double or_ms = 0.0;
+        double and_ms = 0.0;
+        double two_phase_ms = 0.0;
+        std::vector<std::vector<SearchResult>> results;
+    };
+
+    Measure measure(const BM25Engine& engine, uint64_t text_bytes,
+                    const std::vector<std::string>& disjunctive,
+                    const std::vector<std::string>& conjunctive)
+    {
+        Measure result;
+        QueryOptions exact;
+        exact.omit_content = true;
+        QueryOptions cascade = exact;
+        cascade.two_phase = TwoPhaseOptions{100, engine.GetDocumentCount() / 10, 0.0};
+
+        result.segment = segment_bytes(engine, text_bytes);
+        result.or_ms = milliseconds_per_query(engine, disjunctive, exact, &result.results);
+        result.and_ms = milliseconds_per_query(engine, conjunctive, exact, &result.results);
+        result.two_phase_ms = milliseconds_per_query(engine, disjunctive, cascade);
+        return result;
+    }
+
+    // Consultas con el mismo top-k (IDs y puntuaciones) en los dos órdenes
+    double identical_fraction(const Measure& a, const Measure& b)
+    {
+        size_t identical = 0;
+        for (size_t q = 0; q < a.results.size(); ++q)
+        {
+            bool same = a.results[q].size() == b.results[q].size();
+            for (size_t i = 0; same && i < a.results[q].size(); ++i)
+            {
+                same = a.results[q][i].document_id == b.results[q][i].document_id &&
+                       std::abs(a.results[q][i].score - b.results[q][i].score) < 1e-9;
+            }
+            identical += same ? 1 : 0;
+        }
+        return a.results.empty() ? 1.0
+                                 : static_cast<double>(identical) /
+                                       static_cast<double>(a.results.size());
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Corpus corpus;
+    if (argc > 1)
+    {
+        corpus.documents = load_directory(argv[1]);
+    }
+    else
+    {
+        corpus = synthetic_corpus(100'000);
+    }
+    std::printf("Documentos: %zu%s\n", corpus.documents.size(), argc > 1 ? "" : " (sintéticos)");
+    const std::vector<std::string> disjunctive = make_queries(corpus, false);
+    const std::vector<std::string> conjunctive = make_queries(corpus, true);
+
+    BM25Engine engine;
+    engine.SetCompactionRatio(1.0);
+    engine.SetTwoPhaseSampling(0);
+    engine.IndexDocuments(corpus.documents, 1, 0, 1000);
+    const size_t postings = engine.GetPostingCount();
+    uint64_t text_bytes = 0;
+    for (const auto& document : corpus.documents)
+    {
+        text_bytes += document.size();
+    }
+    const Measure arrival = measure(engine, text_bytes, disjunctive, conjunctive);
+
+    engine.SetDocumentOrder(DocumentOrder::BISECTION);
+    engine.Compact();
+    const ReorderStatistics reorder = engine.GetReorderStatistics();
+    const Measure bisection = measure(engine, text_bytes, disjunctive, conjunctive);
+
+    std::printf("Postings: %zu (%.1f MB con el formato 2, sin comprimir)\n", postings,
+                static_cast<double>(postings * 8) / 1e6);
+    std::printf("Bisección: %llu ms\n\n", static_cast<unsigned long long>(reorder.duration_ms));
+    std::printf("%-10s %12s %12s %10s %10s %10s\n", "orden", "bits/hueco", "sin textos MB",
+                "OR ms", "AND ms", "2 fases ms");
+    std::printf("%-10s %12.2f %12.1f %10.3f %10.3f %10.3f\n", "arrival",
+                reorder.GetBitsPerPostingBefore(), static_cast<double>(arrival.segment) / 1e6,
+                arrival.or_ms, arrival.and_ms, arrival.two_phase_ms);
+    std::printf("%-10s %12.2f %12.1f %10.3f %10.3f %10.3f\n", "bisection",
+                reorder.GetBitsPerPostingAfter(), static_cast<double>(bisection.segment) / 1e6,
+                bisection.or_ms, bisection.and_ms, bisection.two_phase_ms);
+    std::printf("\nConsultas con el mismo top %zu: %.1f %%\n", TOP_K,
+                100.0 * identical_fraction(arrival, bisection));
+    return 0;
+}
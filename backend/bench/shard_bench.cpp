@@ -0,0 +1,93 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "infrastructure/sharded_engine.hpp"
+
+using DocuTrace::Infrastructure::ShardedEngine;
+
+namespace
+{
+    constexpr size_t DOCUMENTS = 20'000;
+    constexpr int QUERIES_PER_CLIENT = 200;
+
+    std::vector<std::string> synthetic_corpus(std::mt19937& random)
+    {
+        const std::string letters = "bcdfglmnprstvaeiou";
+        std::vector<std::string> vocabulary(20'000);
+        for (auto& word : vocabulary)
+        {
+            int length = 4 + static_cast<int>(random() % 6);
+            for (int i = 0; i < length; ++i)
+            {
+                word += letters[random() % letters.size()];
+            }
+        }
+
+        std::vector<std::string> documents(DOCUMENTS);
+        for (auto& document : documents)
+        {
+            for (int word = 0; word < 200; ++word)
+            {
+                // Sesgo hacia las primeras palabras: términos frecuentes y raros
+                size_t index = random() % (1 + random() % vocabulary.size());
+                document += vocabulary[index] + ' ';
+            }
+        }
+        return documents;
+    }
+} // namespace
+
+int main()
+{
+    std::mt19937 random(3);
+    const std::vector<std::string> documents = synthetic_corpus(random);
+    std::vector<std::string> queries;
+    for (int i = 0; i < 64; ++i)
+    {
+        const std::string& document = documents[random() % documents.size()];
+        size_t start = document.find(' ', random() % (document.size() / 2)) + 1;
+        queries.push_back(document.substr(start, document.find(' ', start + 20) - start));
+    }
+
+    const unsigned clients = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("Documentos: %zu, clientes concurrentes: %u\n\n", documents.size(), clients);
+
+    for (size_t shards : {1, 2, 4, 8, 16})
+    {
+        ShardedEngine engine(shards, nullptr);
+
+        auto start = std::chrono::steady_clock::now();
+        engine.IndexDocuments(documents, 1, 0, 1000);
+        std::chrono::duration<double> index_time = std::chrono::steady_clock::now() - start;
+
+        std::atomic<size_t> results{0};
+        start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (unsigned client = 0; client < clients; ++client)
+        {
+            threads.emplace_back(
+                [&, client]()
+                {
+                    for (int i = 0; i < QUERIES_PER_CLIENT; ++i)
+                    {
+                        const auto& query = queries[(client * 7 + i) % queries.size()];
+                        results += engine.Search(query, 10).size();
+                    }
+                });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        std::chrono::duration<double> query_time = std::chrono::steady_clock::now() - start;
+
+        std::printf("%2zu particiones  indexado %7.0f ms  %8.0f consultas/s  (%zu resultados)\n",
+                    shards, index_time.count() * 1e3,
+                    clients * QUERIES_PER_CLIENT / query_time.count(), results.load());
+    }
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "infrastructure/term_filter.hpp"
+
+using DocuTrace::Infrastructure::TermFilter;
+
+namespace
+{
+    constexpr size_t LOOKUPS = 1'000'000;
+
+    std::string make_term(std::mt19937& random)
+    {
+        const std::string letters = "bcdfglmnprstvaeiou";
+        std::string term;
+        const int length = 4 + static_cast<int>(random() % 8);
+        for (int i = 0; i < length; ++i)
+        {
+            term += letters[random() % letters.size()];
+        }
+        return term;
+    }
+
+    // found acumula los encontrados para que el compilador no quite las búsquedas
+    template <typename Lookup>
+    double nanoseconds_per_lookup(const std::vector<std::string>& queries, Lookup&& lookup,
+                                  size_t& found)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < LOOKUPS; ++i)
+        {
+            found += lookup(queries[i % queries.size()]) ? 1 : 0;
+        }
+        std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+        return elapsed.count() / static_cast<double>(LOOKUPS);
+    }
+} // namespace
+
+int main()
+{
+    // ns por búsqueda en el diccionario solo y con el filtro delante, de términos ausentes y
+    // presentes
+    std::printf("%-9s %9s %7s %9s %11s %11s %11s %11s\n", "términos", "bits/term", "FP %",
+                "build ms", "aus. map", "aus. filtro", "pres. map", "pres. filtro");
+    size_t found = 0;
+    for (size_t term_count : {10'000, 100'000, 1'000'000})
+    {
+        std::mt19937 random(static_cast<unsigned>(term_count));
+        // Mismo diccionario que InvertedIndex: un std::map por término
+        std::map<std::string, int> dictionary;
+        while (dictionary.size() < term_count)
+        {
+            dictionary.emplace(make_term(random), 0);
+        }
+
+        std::vector<uint64_t> hashes;
+        for (const auto& [term, value] : dictionary)
+        {
+            hashes.push_back(TermFilter::Hash(term));
+        }
+        const auto start = std::chrono::steady_clock::now();
+        TermFilter filter;
+        filter.Build(std::move(hashes));
+        std::chrono::duration<double, std::milli> build = std::chrono::steady_clock::now() - start;
+
+        // Palabras de la consulta que esta partición no tiene (la mayoría en particiones
+        // pequeñas) y otras que sí
+        std::vector<std::string> absent;
+        while (absent.size() < 100'000)
+        {
+            absent.push_back(make_term(random) + "x");
+        }
+        std::vector<std::string> present;
+        for (const auto& [term, value] : dictionary)
+        {
+            if (random() % 10 == 0)
+            {
+                present.push_back(term);
+            }
+        }
+
+        auto map_only = [&](const std::string& term) { return dictionary.contains(term); };
+        auto filtered = [&](const std::string& term)
+        { return filter.MayContain(TermFilter::Hash(term)) && dictionary.contains(term); };
+
+        size_t false_positives = 0;
+        for (const auto& term : absent)
+        {
+            false_positives += filter.MayContain(TermFilter::Hash(term)) ? 1 : 0;
+        }
+
+        const double absent_map = nanoseconds_per_lookup(absent, map_only, found);
+        const double absent_filter = nanoseconds_per_lookup(absent, filtered, found);
+        const double present_map = nanoseconds_per_lookup(present, map_only, found);
+        const double present_filter = nanoseconds_per_lookup(present, filtered, found);
+
+        std::printf("%-9zu %9.2f %7.3f %9.1f %11.1f %11.1f %11.1f %11.1f\n", term_count,
+                    static_cast<double>(filter.GetSizeBytes() * 8) / term_count,
+                    100.0 * false_positives / absent.size(), build.count(), absent_map,
+                    absent_filter, present_map, present_filter);
+    }
+    std::printf("\nEncontrados: %zu\n", found);
+    return 0;
+}
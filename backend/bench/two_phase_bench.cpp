@@ -0,0 +1,148 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "infrastructure/bm25_engine.hpp"
+
+using DocuTrace::Infrastructure::BM25Engine;
+using DocuTrace::Infrastructure::QueryOptions;
+using DocuTrace::Infrastructure::SearchResult;
+using DocuTrace::Infrastructure::TwoPhaseOptions;
+
+namespace
+{
+    constexpr size_t QUERIES = 300;
+    constexpr size_t TOP_K = 10;
+
+    std::vector<std::string> synthetic_vocabulary(std::mt19937& random)
+    {
+        const std::string letters = "bcdfglmnprstvaeiou";
+        std::vector<std::string> vocabulary(20'000);
+        for (auto& word : vocabulary)
+        {
+            int length = 4 + static_cast<int>(random() % 6);
+            for (int i = 0; i < length; ++i)
+            {
+                word += letters[random() % letters.size()];
+            }
+        }
+        return vocabulary;
+    }
+
+    // Sesgo hacia las primeras palabras: términos frecuentes y raros
+    const std::string& skewed_word(const std::vector<std::string>& vocabulary, std::mt19937& random)
+    {
+        return vocabulary[random() % (1 + random() % vocabulary.size())];
+    }
+
+    // Una de las COMMON_WORDS palabras que están en más de la mitad de los documentos
+    constexpr size_t COMMON_WORDS = 50;
+
+    const std::string& common_word(const std::vector<std::string>& vocabulary,
+                                   std::mt19937& random)
+    {
+        return vocabulary[random() % COMMON_WORDS];
+    }
+
+    struct Run
+    {
+        std::vector<std::vector<SearchResult>> results;
+        double milliseconds = 0.0;
+    };
+
+    Run run_queries(const BM25Engine& engine, const std::vector<std::string>& queries,
+                    const QueryOptions& options)
+    {
+        Run run;
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& query : queries)
+        {
+            run.results.push_back(engine.Search(query, TOP_K, options));
+        }
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        run.milliseconds = elapsed.count() / static_cast<double>(queries.size());
+        return run;
+    }
+
+    // Fracción de los TOP_K exactos que también devuelve la cascada
+    double recall(const Run& exact, const Run& cascade)
+    {
+        size_t expected = 0;
+        size_t found = 0;
+        for (size_t q = 0; q < exact.results.size(); ++q)
+        {
+            std::unordered_set<uint64_t> returned;
+            for (const auto& result : cascade.results[q])
+            {
+                returned.insert(result.document_id);
+            }
+            for (const auto& result : exact.results[q])
+            {
+                ++expected;
+                found += returned.contains(result.document_id) ? 1 : 0;
+            }
+        }
+        return expected > 0 ? static_cast<double>(found) / static_cast<double>(expected) : 1.0;
+    }
+} // namespace
+
+int main()
+{
+    std::mt19937 random(23);
+    const std::vector<std::string> vocabulary = synthetic_vocabulary(random);
+
+    // Dos palabras comunes (las listas largas que la primera fase deja para la segunda) y de
+    // una a cuatro del resto
+    std::vector<std::string> queries(QUERIES);
+    for (auto& query : queries)
+    {
+        query = common_word(vocabulary, random) + ' ' + common_word(vocabulary, random) + ' ';
+        const int words = 1 + static_cast<int>(random() % 4);
+        for (int word = 0; word < words; ++word)
+        {
+            query += skewed_word(vocabulary, random) + ' ';
+        }
+    }
+
+    QueryOptions exact;
+    exact.omit_content = true;
+    std::printf("Top %zu, %zu consultas de 3 a 6 términos (ms por consulta)\n", TOP_K, QUERIES);
+
+    BM25Engine engine;
+    engine.SetCompactionRatio(1.0);
+    engine.SetTwoPhaseSampling(0);
+    size_t indexed = 0;
+    for (size_t corpus : {25'000, 50'000, 100'000, 200'000})
+    {
+        std::vector<std::string> documents(corpus - indexed);
+        for (auto& document : documents)
+        {
+            for (int word = 0; word < 200; ++word)
+            {
+                document += (random() % 5 == 0 ? common_word(vocabulary, random)
+                                                : skewed_word(vocabulary, random)) +
+                            ' ';
+            }
+        }
+        engine.IndexDocuments(documents, 1 + indexed, 0, 1000);
+        indexed = corpus;
+
+        const Run reference = run_queries(engine, queries, exact);
+        std::printf("\n%zu documentos: exacta %.2f ms\n", corpus, reference.milliseconds);
+        for (size_t budget : {corpus / 10, corpus / 2})
+        {
+            for (size_t candidates : {100, 1000})
+            {
+                QueryOptions cascade = exact;
+                cascade.two_phase = TwoPhaseOptions{candidates, budget, 0.0};
+                const Run run = run_queries(engine, queries, cascade);
+                std::printf("  %4zu candidatos, %7zu postings: %6.2f ms  recall@%zu %.4f\n",
+                            candidates, budget, run.milliseconds, TOP_K, recall(reference, run));
+            }
+        }
+    }
+    return 0;
+}
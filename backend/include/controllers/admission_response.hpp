@@ -0,0 +1,15 @@
+#pragma once
+
+#include "crow/app.h"
+#include "services/admission_control.hpp"
+
+namespace DocuTrace::Controllers
+{
+    /**
+     * @brief Respuesta de una petición que el control de admisión no dejó pasar
+     * @return 429 si la consulta es demasiado cara para la carga actual, 503 si el servidor
+     *         está saturado; las dos con Retry-After
+     */
+    crow::response RejectedResponse(const Services::Admission& admission);
+
+} // namespace DocuTrace::Controllers
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <memory>
+#include "crow/app.h"
+#include "crow/middlewares/cors.h"
+#include "infrastructure/content_hash_table.hpp"
+#include "infrastructure/document_catalog.hpp"
+#include "services/admission_control.hpp"
+#include "services/search_service.hpp"
+
+namespace DocuTrace::Controllers
+{
+    /**
+     * @brief Rutas para eliminar y reemplazar documentos ya subidos
+     */
+    class DocumentController
+    {
+      private:
+        std::shared_ptr<Services::SearchService> search_service_;
+        std::shared_ptr<Infrastructure::DocumentCatalog> catalog_;
+        std::shared_ptr<Infrastructure::ContentHashTable> content_hashes_;
+        // PUT entra como INGEST (el borrado es O(1) y no pide turno)
+        std::shared_ptr<Services::AdmissionControl> admission_;
+
+        crow::response HandleDelete(uint64_t document_id);
+        crow::response HandleUpdate(const crow::request& req, uint64_t document_id);
+
+      public:
+        DocumentController(std::shared_ptr<Services::SearchService> search_service,
+                           std::shared_ptr<Infrastructure::DocumentCatalog> catalog,
+                           std::shared_ptr<Infrastructure::ContentHashTable> content_hashes,
+                           std::shared_ptr<Services::AdmissionControl> admission);
+
+        // No copyable
+        DocumentController(const DocumentController&) = delete;
+        DocumentController& operator=(const DocumentController&) = delete;
+
+        void RegisterRoutes(crow::App<crow::CORSHandler>& app);
+    };
+
+} // namespace DocuTrace::Controllers
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include "crow/app.h"
+#include "shared/compression.hpp"
+#include "shared/structured_writer.hpp"
+
+namespace DocuTrace::Controllers
+{
+    /**
+     * @brief Respuesta serializada según Accept (JSON, MessagePack o CBOR) y comprimida según
+     *        Accept-Encoding (gzip o deflate)
+     * @note El StructuredWriter vacía bloques de 64 KB que pasan por zlib según se escriben:
+     *       del cuerpo sin comprimir solo existe un bloque a la vez. Las respuestas de menos
+     *       de MIN_COMPRESSED_BYTES se envían sin comprimir
+     * @example ResponseEncoder encoder(req, 1); encoder.Writer().BeginObject(1); ...
+     *          return encoder.Finish();
+     */
+    class ResponseEncoder
+    {
+      private:
+        static constexpr size_t MIN_COMPRESSED_BYTES = 1024;
+
+        bool sequence_;
+        int compression_level_;
+        Shared::ContentEncoding encoding_ = Shared::ContentEncoding::IDENTITY;
+        // Cuerpo final (comprimido si ya se empezó a comprimir)
+        std::string body_;
+        // Inicio sin comprimir mientras no se sabe si compensa comprimir
+        std::string pending_;
+        std::unique_ptr<Shared::StreamCompressor> compressor_;
+        Shared::StructuredWriter writer_;
+
+        void Consume(std::string_view chunk);
+
+      public:
+        /**
+         * @param compression_level Nivel de zlib (0 = no comprimir nunca)
+         * @param sequence true si el cuerpo es una secuencia de valores (JSON por líneas)
+         */
+        ResponseEncoder(const crow::request& req, int compression_level, bool sequence = false);
+
+        ResponseEncoder(const ResponseEncoder&) = delete;
+        ResponseEncoder& operator=(const ResponseEncoder&) = delete;
+
+        Shared::StructuredWriter& Writer()
+        {
+            return writer_;
+        }
+
+        /**
+         * @brief Cierra la serialización y la compresión y arma la respuesta con sus cabeceras
+         */
+        crow::response Finish(int code = 200);
+
+        /**
+         * @brief Formato preferido en una cabecera Accept (JSON si no pide uno binario)
+         * @example NegotiateFormat("application/msgpack, application/json") → MSGPACK
+         */
+        static Shared::WireFormat NegotiateFormat(std::string_view accept);
+
+        /**
+         * @brief gzip o deflate si Accept-Encoding los admite (q > 0), si no IDENTITY
+         */
+        static Shared::ContentEncoding NegotiateEncoding(std::string_view accept_encoding);
+    };
+
+} // namespace DocuTrace::Controllers
@@ -3,6 +3,8 @@
 #include <memory>
 #include "crow/app.h"
 #include "crow/middlewares/cors.h"
+#include "services/admission_control.hpp"
+#include "services/folder_crawler.hpp"
 #include "services/search_service.hpp"
 
 namespace DocuTrace::Controllers
@@ -11,9 +13,22 @@ namespace DocuTrace::Controllers
     {
       private:
         std::shared_ptr<Services::SearchService> search_service_;
+        // Nivel de zlib de las respuestas de búsqueda (0 = sin comprimir)
+        int compression_level_;
+        // Turnos de /api/search (INTERACTIVE) y /api/search/batch (BATCH)
+        std::shared_ptr<Services::AdmissionControl> admission_;
+        // Solo con CRAWL_DIRS, para /api/stats
+        std::shared_ptr<const Services::FolderCrawler> crawler_;
 
       public:
-        explicit SearchController(std::shared_ptr<Services::SearchService> service);
+        /**
+         * @param compression_level RESPONSE_COMPRESSION_LEVEL (0-9)
+         * @param admission Control de admisión compartido con la ingesta
+         * @param crawler Rastreador de carpetas, si está activo
+         */
+        SearchController(std::shared_ptr<Services::SearchService> service, int compression_level,
+                         std::shared_ptr<Services::AdmissionControl> admission,
+                         std::shared_ptr<const Services::FolderCrawler> crawler = nullptr);
         ~SearchController() = default;
 
         // No copyable pero movible
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include "crow/app.h"
+#include "crow/middlewares/cors.h"
+#include "services/search_service.hpp"
+
+namespace DocuTrace::Controllers
+{
+    /**
+     * @brief Endpoints internos de un worker en la búsqueda distribuida
+     * @note Solo se registran con NODE_ROLE=worker; no deben exponerse fuera de la red interna
+     */
+    class ShardController
+    {
+      private:
+        using Phase = std::function<std::string(const std::string&)>;
+
+        std::shared_ptr<Services::SearchService> search_service_;
+
+        /**
+         * @brief Ejecuta una fase y la envuelve en una respuesta JSON (400 si falla)
+         */
+        static crow::response HandlePhase(const crow::request& req, const Phase& phase);
+
+      public:
+        explicit ShardController(std::shared_ptr<Services::SearchService> service);
+        ~ShardController() = default;
+
+        // No copyable pero movible
+        ShardController(const ShardController&) = delete;
+        ShardController& operator=(const ShardController&) = delete;
+        ShardController(ShardController&&) = default;
+        ShardController& operator=(ShardController&&) = default;
+
+        // Registrar todas las rutas en la app de Crow
+        void RegisterRoutes(crow::App<crow::CORSHandler>& app);
+    };
+
+} // namespace DocuTrace::Controllers
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+#include "crow/app.h"
+#include "crow/middlewares/cors.h"
+#include "models/search_models.hpp"
+#include "services/folder_crawler.hpp"
+#include "services/search_service.hpp"
+
+namespace DocuTrace::Controllers
+{
+    /**
+     * @brief Rutas para crear, listar, restaurar y borrar copias de seguridad en caliente
+     * @note Solo se registran si el nodo admite escrituras (no en una réplica)
+     */
+    class SnapshotController
+    {
+      private:
+        std::shared_ptr<Services::SearchService> search_service_;
+        // Opcional: tras restaurar vuelve a leer las carpetas rastreadas
+        std::shared_ptr<Services::FolderCrawler> crawler_;
+
+        static crow::json::wvalue ToJson(const Models::SnapshotInfo& snapshot);
+
+        crow::response HandleCreate(const crow::request& req);
+        crow::response HandleRestore(const std::string& name);
+
+      public:
+        SnapshotController(std::shared_ptr<Services::SearchService> search_service,
+                           std::shared_ptr<Services::FolderCrawler> crawler = nullptr);
+
+        // No copyable
+        SnapshotController(const SnapshotController&) = delete;
+        SnapshotController& operator=(const SnapshotController&) = delete;
+
+        void RegisterRoutes(crow::App<crow::CORSHandler>& app);
+    };
+
+} // namespace DocuTrace::Controllers
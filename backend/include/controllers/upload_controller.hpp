@@ -3,6 +3,9 @@
 #include <memory>
 #include "crow/app.h"
 #include "crow/middlewares/cors.h"
+#include "infrastructure/content_hash_table.hpp"
+#include "infrastructure/document_catalog.hpp"
+#include "services/admission_control.hpp"
 #include "services/search_service.hpp"
 
 namespace DocuTrace::Controllers
@@ -11,9 +14,21 @@ namespace DocuTrace::Controllers
     {
       private:
         std::shared_ptr<Services::SearchService> search_service_;
+        std::shared_ptr<Infrastructure::DocumentCatalog> catalog_;
+        std::shared_ptr<Infrastructure::ContentHashTable> content_hashes_;
+        // Las subidas entran como INGEST: ceden el turno a las búsquedas
+        std::shared_ptr<Services::AdmissionControl> admission_;
+
+        /**
+         * @brief Calcula el hash de los documentos ya persistidos que aún no están en la tabla
+         */
+        void BackfillContentHashes();
 
       public:
-        explicit UploadController(std::shared_ptr<Services::SearchService> search_service);
+        UploadController(std::shared_ptr<Services::SearchService> search_service,
+                         std::shared_ptr<Infrastructure::DocumentCatalog> catalog,
+                         std::shared_ptr<Infrastructure::ContentHashTable> content_hashes,
+                         std::shared_ptr<Services::AdmissionControl> admission);
 
         void RegisterRoutes(crow::App<crow::CORSHandler>& app);
     };
@@ -1,10 +1,32 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <future>
 #include <map>
+#include <memory>
 #include <mutex>
-#include <set>
+#include <optional>
+#include <shared_mutex>
+#include <span>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
+#include "infrastructure/doc_values.hpp"
+#include "infrastructure/document_id_map.hpp"
+#include "infrastructure/document_reordering.hpp"
+#include "infrastructure/document_store.hpp"
+#include "infrastructure/query_parser.hpp"
+#include "infrastructure/suggestion_index.hpp"
+#include "infrastructure/term_dictionary.hpp"
+#include "infrastructure/term_filter.hpp"
+#include "shared/binary_io.hpp"
+#include "shared/mapped_file.hpp"
+#include "shared/text_analyzer.hpp"
 
 namespace DocuTrace::Infrastructure
 {
@@ -21,80 +43,826 @@ namespace DocuTrace::Infrastructure
     {
         std::string content;
         double score;
-        int document_id;
+        ExternalDocumentId document_id;
+        // Nodo remoto que devolvió el resultado (vacío = índice local)
+        std::string node;
+        // Metadatos del documento: los muestra la respuesta y ordenan con QueryOptions::sort
+        std::string filename;
+        std::time_t timestamp = 0;
 
-        SearchResult(const std::string& content, double score, int doc_id)
+        SearchResult(const std::string& content, double score, ExternalDocumentId doc_id)
             : content(content), score(score), document_id(doc_id)
         {
         }
+
+        /**
+         * @brief Orden de los resultados: mayor puntuación y, a igualdad, menor ID y nodo
+         * @note Determinista para que el resultado no dependa del reparto en particiones
+         */
+        static bool Ranks(const SearchResult& a, const SearchResult& b)
+        {
+            if (a.score != b.score)
+            {
+                return a.score > b.score;
+            }
+            if (a.document_id != b.document_id)
+            {
+                return a.document_id < b.document_id;
+            }
+            return a.node < b.node;
+        }
+
+        /**
+         * @brief Orden por un campo de metadatos (nombres por bytes) y, a igualdad, Ranks
+         */
+        static bool SortsBefore(const SearchResult& a, const SearchResult& b,
+                                const SortOrder& sort)
+        {
+            const int order = sort.field == SortField::TIMESTAMP
+                                  ? (a.timestamp < b.timestamp ? -1 : a.timestamp > b.timestamp)
+                                  : a.filename.compare(b.filename);
+            if (order != 0)
+            {
+                return sort.descending ? order > 0 : order < 0;
+            }
+            return Ranks(a, b);
+        }
+    };
+
+    /**
+     * @brief Estadísticas BM25 de la colección (N, longitud media y df de la consulta)
+     * @note Con varias particiones se suman las de todas para puntuar igual que un índice
+     *       único
+     */
+    struct CorpusStatistics
+    {
+        size_t document_count = 0;
+        long long total_length = 0;
+        // Términos de los nombres de archivo (segundo campo de BM25F)
+        long long filename_total_length = 0;
+        std::unordered_map<std::string, size_t> document_frequencies;
+
+        double GetAverageLength() const;
+        double GetAverageFilenameLength() const;
+        size_t GetDocumentFrequency(const std::string& term) const;
+        void Merge(const CorpusStatistics& other);
+    };
+
+    /**
+     * @brief Término del diccionario en que puede expandirse una palabra* o palabra~
+     */
+    struct TermExpansion
+    {
+        int distance = 0;
+        size_t document_frequency = 0;
+    };
+
+    /**
+     * @brief Expansiones candidatas de cada TERM de prefijo o difuso de una consulta
+     * @note Se acumulan de todas las particiones antes de elegir las mejores, para que cada
+     *       palabra se expanda a los mismos términos en todas
+     */
+    struct QueryExpansions
+    {
+        std::unordered_map<const QueryNode*, std::unordered_map<std::string, TermExpansion>> terms;
+
+        /**
+         * @brief Añade un candidato (distancia mínima, frecuencias sumadas)
+         */
+        void Add(const QueryNode* node, const std::string& term, int distance,
+                 size_t document_frequency);
+        void Merge(const QueryExpansions& other);
+    };
+
+    /**
+     * @brief Consulta de una búsqueda por lotes
+     */
+    struct BatchQuery
+    {
+        std::string query;
+        size_t max_results = 10;
+        QueryOptions options;
+    };
+
+    /**
+     * @brief Lista de postings de un término ordenada por ID interno
+     * @note En el nivel frío los vectores quedan vacíos y las postings están en el archivo
+     *       mapeado del índice
+     */
+    struct PostingList
+    {
+        std::vector<InternalDocumentId> documents;
+        std::vector<uint32_t> frequencies;
+        // Posición en el archivo frío (solo si cold_count > 0)
+        uint64_t cold_offset = 0;
+        uint32_t cold_count = 0;
+        // Entradas de documentos eliminados que siguen en la lista hasta la compactación
+        uint32_t deleted_count = 0;
+        // Consultas y escrituras recientes; se reduce a la mitad en cada expulsión
+        mutable uint32_t accesses = 0;
+
+        bool IsCold() const
+        {
+            return cold_count > 0;
+        }
+
+        size_t Size() const
+        {
+            return IsCold() ? cold_count : documents.size();
+        }
+    };
+
+    /**
+     * @brief Postings de un término, estén en RAM o en el archivo mapeado
+     * @note Válida mientras se mantenga el lock del motor
+     */
+    struct PostingView
+    {
+        std::span<const InternalDocumentId> documents;
+        std::span<const uint32_t> frequencies;
+
+        size_t Size() const
+        {
+            return documents.size();
+        }
     };
 
     /**
      * @brief Índice invertido optimizado para BM25
-     * @note Implementación de infraestructura - maneja almacenamiento
+     * @note Implementación de infraestructura - maneja almacenamiento.
+     *       No es thread-safe por sí mismo; BM25Engine sincroniza el acceso
      */
     class InvertedIndex
     {
       private:
-        // Documentos que contienen cada palabra
-        std::map<std::string, std::set<int>> document_frequency_;
-        // Frecuencia de cada palabra en cada documento
-        std::map<std::string, std::map<int, int>> term_frequency_;
-        // Mutex para operaciones concurrentes
-        mutable std::mutex mutex_;
+        // Postings de cada palabra (IDs internos ordenados + frecuencias)
+        std::map<std::string, PostingList> postings_;
+        // Mismos términos que postings_ en un trie para prefijos y búsqueda difusa
+        TermDictionary dictionary_;
+        size_t posting_count_ = 0;
+
+        // Filtro de los términos que había al sellar (nullopt = sin sellar) y hashes de los
+        // añadidos después, que el filtro no conoce
+        std::optional<TermFilter> term_filter_;
+        std::unordered_set<uint64_t> unsealed_terms_;
+        mutable TermFilterHits filter_hits_;
+
+        // Nivel frío: listas largas y poco consultadas en un archivo mapeado
+        std::unique_ptr<Shared::MappedFile> cold_;
+        std::filesystem::path cold_directory_;
+        size_t cold_posting_count_ = 0;
+        // Bytes del archivo de listas que volvieron a RAM al modificarse
+        uint64_t cold_garbage_bytes_ = 0;
+        mutable Shared::TierHits hits_;
+
+        /**
+         * @brief Lista de un término; el filtro descarta los ausentes antes del diccionario
+         */
+        const PostingList* Find(const std::string& term) const;
+        PostingView View(const PostingList& list) const;
+
+        /**
+         * @brief Apunta un término recién creado para que el filtro sellado no lo descarte
+         */
+        void NoteNewTerm(const std::string& term);
+
+        /**
+         * @brief Devuelve a RAM una lista fría antes de modificarla
+         */
+        void Promote(PostingList& list);
+
+        /**
+         * @brief Escribe una lista en el archivo nuevo de una reescritura (lo crea si hace falta)
+         * @return Posición de la lista o nullopt si falló la escritura
+         */
+        std::optional<uint64_t> StoreCold(std::unique_ptr<Shared::MappedFile>& file,
+                                          std::span<const InternalDocumentId> documents,
+                                          std::span<const uint32_t> frequencies);
+
+        /**
+         * @brief Copia las listas frías a un archivo nuevo sin las que volvieron a RAM
+         */
+        void RewriteColdLists();
 
       public:
-        void AddTerm(const std::string& term, int document_id);
-        void AddTerms(const std::vector<std::string>& terms, int document_id);
-        int GetDocumentFrequency(const std::string& term, int document_id) const;
+        // IDs internos y frecuencias de 32 bits
+        static constexpr size_t BYTES_PER_POSTING = 8;
+
+        void AddTerm(const std::string& term, InternalDocumentId document_id);
+        void AddTerms(const std::vector<std::string>& terms, InternalDocumentId document_id);
+        int GetDocumentFrequency(const std::string& term, InternalDocumentId document_id) const;
+
+        /**
+         * @brief Documentos vivos que contienen el término (df), sin los eliminados que la
+         *        lista aún conserva
+         */
         int GetIndexFrequency(const std::string& term) const;
-        std::set<int> GetDocuments(const std::string& term) const;
+
+        /**
+         * @brief Descuenta un documento eliminado del df de sus términos
+         * @param terms Términos analizados del documento (los repetidos cuentan una vez)
+         * @note Solo cuenta los términos cuya lista contiene de verdad el documento
+         */
+        void MarkDeleted(const std::vector<std::string>& terms, InternalDocumentId document_id);
+
+        /**
+         * @brief Obtiene la lista de postings de un término para recorrerla
+         * @return Vista de la lista o nullopt si el término no existe
+         * @note Cuenta el acierto en su nivel; si es fría pide al kernel que la lea ya
+         */
+        std::optional<PostingView> GetPostings(const std::string& term) const;
+
+        /**
+         * @brief Añade la lista completa de un término nuevo (carga de segmentos)
+         */
+        void AddPostingList(const std::string& term, PostingList list);
+
+        /**
+         * @brief Recorre todas las listas en orden alfabético sin contar aciertos
+         */
+        template <typename Function> void ForEachPostingList(Function&& function) const
+        {
+            for (const auto& [term, list] : postings_)
+            {
+                function(term, View(list));
+            }
+        }
+
+        /**
+         * @brief Baja al archivo frío las listas menos usadas entre las de al menos
+         *        min_postings entradas (las cortas se quedan siempre en RAM)
+         * @param bytes Bytes de RAM que se quieren liberar
+         * @return Bytes liberados
+         * @throws std::runtime_error si no se puede crear o escribir el archivo
+         */
+        size_t SpillColdLists(size_t bytes, size_t min_postings,
+                              const std::filesystem::path& directory);
+
+        size_t GetResidentBytes() const
+        {
+            return (posting_count_ - cold_posting_count_) * BYTES_PER_POSTING;
+        }
+
+        uint64_t GetColdBytes() const
+        {
+            return cold_posting_count_ * BYTES_PER_POSTING;
+        }
+
+        const Shared::TierHits& GetHits() const
+        {
+            return hits_;
+        }
+
+        /**
+         * @brief Construye el filtro con los términos actuales (sellado)
+         * @return false si no se pudo construir: las búsquedas van todas al diccionario
+         */
+        bool SealTermFilter();
+
+        /**
+         * @brief Instala un filtro ya construido con todos los términos (carga de segmentos)
+         */
+        void SetTermFilter(TermFilter filter);
+
+        const std::optional<TermFilter>& GetTermFilter() const
+        {
+            return term_filter_;
+        }
+
+        /**
+         * @brief Términos que el filtro no cubre (todos si no se ha sellado)
+         */
+        size_t GetUnsealedTermCount() const
+        {
+            return term_filter_ ? unsealed_terms_.size() : postings_.size();
+        }
+
+        const TermFilterHits& GetFilterHits() const
+        {
+            return filter_hits_;
+        }
+
+        /**
+         * @brief Elimina los documentos marcados y renumera los restantes
+         * @param remap Nuevo ID por cada ID interno actual (INVALID_ID = eliminar); si
+         *        reordena, las listas se vuelven a ordenar por ID
+         * @return Número de entradas (término, documento) eliminadas
+         * @note Las listas frías se compactan a un archivo nuevo de una en una, sin
+         *       cargarlas todas en RAM. Al terminar se vuelve a sellar el filtro de términos
+         */
+        size_t Compact(const std::vector<InternalDocumentId>& remap);
+
+        size_t GetTermCount() const
+        {
+            return postings_.size();
+        }
+
+        const TermDictionary& GetDictionary() const
+        {
+            return dictionary_;
+        }
+
+        /**
+         * @brief Número total de entradas (término, documento) del índice
+         */
+        size_t GetPostingCount() const
+        {
+            return posting_count_;
+        }
+
         void Clear();
     };
 
     /**
-     * @brief Tabla de longitudes de documentos
-     * @note Optimizada con cache para longitud promedio
+     * @brief Tabla de longitudes de documentos indexada por ID interno
+     * @note Mantiene la suma total para corregir la longitud promedio en O(1)
      */
     class DocumentLengthTable
     {
       private:
-        std::map<int, int> lengths_;
-        mutable double average_length_cache_ = -1.0;
-        mutable bool cache_valid_ = false;
-        mutable std::mutex mutex_;
+        std::vector<uint32_t> lengths_;
+        size_t document_count_ = 0;
+        long long total_length_ = 0;
 
       public:
-        void AddDocument(int document_id, int length);
-        int GetLength(int document_id) const;
+        void AddDocument(InternalDocumentId document_id, int length);
+        void RemoveDocument(InternalDocumentId document_id);
+        int GetLength(InternalDocumentId document_id) const
+        {
+            return document_id < lengths_.size() ? static_cast<int>(lengths_[document_id]) : 0;
+        }
         double GetAverageLength() const;
+        long long GetTotalLength() const
+        {
+            return total_length_;
+        }
+        // Longitud por ID interno (0 en eliminados) para los kernels que la leen con gather
+        const uint32_t* Data() const
+        {
+            return lengths_.data();
+        }
+        void Compact(const std::vector<InternalDocumentId>& remap, size_t live_count);
         void Clear();
     };
 
+    /**
+     * @brief Uso de memoria del índice y aciertos por nivel (RAM o archivo mapeado)
+     * @note resident_bytes cuenta postings y textos, no el diccionario ni los metadatos
+     *       (metadata_bytes, siempre en RAM)
+     */
+    struct MemoryStatistics
+    {
+        size_t budget_bytes = 0;
+        size_t resident_bytes = 0;
+        uint64_t cold_bytes = 0;
+        size_t metadata_bytes = 0;
+        uint64_t posting_hits_resident = 0;
+        uint64_t posting_hits_cold = 0;
+        uint64_t document_hits_resident = 0;
+        uint64_t document_hits_cold = 0;
+
+        void Merge(const MemoryStatistics& other);
+    };
+
+    /**
+     * @brief Consultas en dos fases: coste de cada fase y calidad frente a la búsqueda exacta
+     * @note La calidad se mide en una de cada N consultas (SetTwoPhaseSampling) repitiéndola
+     *       sin cascada: recall = resultados exactos que la cascada también devolvió
+     */
+    struct TwoPhaseStatistics
+    {
+        uint64_t queries = 0;
+        uint64_t candidates = 0;
+        // Términos que la primera fase dejó para la segunda por superar el presupuesto
+        uint64_t deferred_terms = 0;
+        uint64_t first_phase_us = 0;
+        uint64_t second_phase_us = 0;
+        uint64_t sampled_queries = 0;
+        uint64_t sampled_expected = 0;
+        uint64_t sampled_matched = 0;
+
+        /**
+         * @return Recall de las consultas muestreadas (1 si no hay ninguna)
+         */
+        double GetRecall() const;
+        void Merge(const TwoPhaseStatistics& other);
+    };
+
+    /**
+     * @brief Parte de una consulta con hora límite (QueryOptions::deadline) que se puntuó
+     * @note Cada término pesa su aportación máxima por posting (peso × UpperBound) por el
+     *       número de postings que hay que leer; la calidad es la fracción de ese peso
+     *       leída antes de la hora límite. Los términos se leen de más a menos aportación,
+     *       así que con la mitad del tiempo suele leerse mucho más de la mitad del peso
+     */
+    struct SearchCoverage
+    {
+        // Se agotó el tiempo antes de leer todas las postings
+        bool partial = false;
+        double scored_weight = 0.0;
+        double total_weight = 0.0;
+
+        /**
+         * @return scored_weight / total_weight (1 si no había nada que leer)
+         */
+        double GetQuality() const;
+        void Merge(const SearchCoverage& other);
+    };
+
+    /**
+     * @brief Precisión de los acumuladores de la puntuación clásica (SCORE_ACCUMULATOR)
+     * @note DOUBLE es exacto. FLOAT32 y UINT16 ocupan la mitad y la cuarta parte por documento
+     *       y calculan las aportaciones en float (de 8 en 8 con AVX2 en BM25). Los mejores
+     *       candidatos se vuelven a puntuar en double: las puntuaciones devueltas son exactas
+     *       y solo puede cambiar qué documentos entran en el top-k (bench/accumulator_bench)
+     */
+    enum class ScoreAccumulator
+    {
+        DOUBLE,
+        FLOAT32,
+        UINT16
+    };
+
     /**
      * @brief Motor de búsqueda BM25 completo con soporte para indexación concurrente
-     * @note Capa de infraestructura - implementación concreta del algoritmo
+     * @note Capa de infraestructura - implementación concreta del algoritmo.
+     *       Los documentos se identifican por su ID externo estable; internamente se
+     *       usan IDs densos para que la memoria escale con los documentos vivos
      */
     class BM25Engine
     {
       private:
-        static constexpr double K1 = 1.2;
-        static constexpr double B = 0.75;
         static constexpr size_t DEFAULT_BATCH_SIZE = 1000;
+        static constexpr double DEFAULT_COMPACTION_RATIO = 0.2;
+        static constexpr double DEFAULT_FUZZY_PENALTY = 0.5;
+        static constexpr size_t DEFAULT_MAX_EXPANSIONS = 50;
+        // Candidatos que se vuelven a puntuar en double tras acumular en FLOAT32 o UINT16:
+        // el doble de los pedidos y al menos MIN_RESCORE_CANDIDATES
+        static constexpr size_t RESCORE_FACTOR = 2;
+        static constexpr size_t MIN_RESCORE_CANDIDATES = 64;
+        // Error relativo que se tolera al cortar por una suma en float
+        static constexpr double FLOAT_SCORE_MARGIN = 1e-5;
+        // Postings por bloque de aportaciones en float
+        static constexpr size_t IMPACT_BLOCK_SIZE = 256;
+        // La primera fase de dos usa pares (ID, aportación) en vez de acumuladores densos
+        // mientras recorre menos de una posting por cada SPARSE_FIRST_PHASE_RATIO documentos
+        static constexpr size_t SPARSE_FIRST_PHASE_RATIO = 64;
+        // Consultas por hilo al repartir un lote
+        static constexpr size_t MIN_BATCH_QUERIES_PER_THREAD = 8;
+        // Términos recorridos por orden alfabético antes de elegir los más frecuentes
+        static constexpr size_t EXPANSION_SCAN_LIMIT = 1000;
+        // Longitud de las palabras que se ofrecen como sugerencia
+        static constexpr size_t MIN_SUGGESTION_LENGTH = 3;
+        static constexpr size_t MAX_SUGGESTION_LENGTH = 32;
+        // Las listas más cortas no bajan nunca al nivel frío
+        static constexpr size_t MIN_COLD_POSTINGS = 128;
+        // Documentos nuevos que esperan a reordenarse antes de lanzar la bisección sola
+        static constexpr size_t MIN_REORDER_DOCUMENTS = 256;
+        // Términos nuevos que esperan fuera del filtro antes de volver a sellarlo
+        static constexpr size_t MIN_UNSEALED_TERMS = 1024;
+        // Cabecera de los segmentos ("DTSEGMNT") y versión de su formato; se siguen leyendo
+        // los de versiones desde MIN_SEGMENT_FORMAT
+        static constexpr uint64_t SEGMENT_MAGIC = 0x544e4d4745535444ULL;
+        static constexpr uint32_t SEGMENT_FORMAT = 4;
+        static constexpr uint32_t MIN_SEGMENT_FORMAT = 1;
 
+        // Misma cadena de análisis para indexar y para consultar
+        std::shared_ptr<const Shared::TextAnalyzer> analyzer_;
         InvertedIndex index_;
         DocumentLengthTable document_lengths_;
-        std::vector<std::string> documents_;
-        mutable std::mutex documents_mutex_;
+        DocumentIdMap document_ids_;
+        // Contenido por ID interno
+        DocumentStore documents_;
+        // Metadatos por ID interno en columnas (filtros, facetas y orden por campo)
+        DocValues doc_values_;
+        // Nombres de archivo analizados por ID interno (BM25F)
+        FilenameField filename_field_;
+        // Bitmap de IDs internos eliminados cuyas entradas siguen en el índice
+        std::vector<bool> tombstones_;
+        size_t tombstone_count_ = 0;
+        double compaction_ratio_ = DEFAULT_COMPACTION_RATIO;
+        // Orden que deja la compactación y documentos añadidos desde la última bisección
+        DocumentOrder document_order_ = DocumentOrder::ARRIVAL;
+        size_t unordered_count_ = 0;
+        // Cambia cada vez que se renumeran los IDs internos
+        uint64_t layout_generation_ = 0;
+        ReorderStatistics reorder_statistics_;
+        double fuzzy_penalty_ = DEFAULT_FUZZY_PENALTY;
+        size_t max_expansions_ = DEFAULT_MAX_EXPANSIONS;
+        // Modelo de las consultas que no eligen otro (QueryOptions::ranking)
+        RankingParameters ranking_;
+        ScoreAccumulator score_accumulator_ = ScoreAccumulator::DOUBLE;
+        // Consultas en dos fases: una de cada two_phase_sampling_ se repite exacta (0 = nunca)
+        size_t two_phase_sampling_ = 0;
+        mutable std::atomic<uint64_t> two_phase_queries_{0};
+        mutable std::atomic<uint64_t> two_phase_candidates_{0};
+        mutable std::atomic<uint64_t> two_phase_deferred_terms_{0};
+        mutable std::atomic<uint64_t> two_phase_first_us_{0};
+        mutable std::atomic<uint64_t> two_phase_second_us_{0};
+        mutable std::atomic<uint64_t> two_phase_sampled_{0};
+        mutable std::atomic<uint64_t> two_phase_expected_{0};
+        mutable std::atomic<uint64_t> two_phase_matched_{0};
+        mutable std::shared_mutex documents_mutex_;
+        // Palabras sin stemming para /api/suggest; con lock propio para no competir con
+        // las búsquedas ni la indexación
+        SuggestionIndex suggestions_;
+
+        // Compactación en segundo plano; compaction_mutex_ protege compaction_future_
+        std::mutex compaction_mutex_;
+        std::future<void> compaction_future_;
+        // Cambia con cada escritura ya completa (índice y sugerencias), no al compactar
+        std::atomic<uint64_t> version_{0};
+
+        // Presupuesto de RAM para postings y textos (0 = sin límite)
+        size_t memory_budget_ = 0;
+        std::filesystem::path cold_directory_;
+        // Uso a partir del cual se vuelve a expulsar; sube si lo que queda no se puede bajar
+        size_t spill_threshold_ = 0;
+        bool cold_storage_failed_ = false;
 
-        double CalculateBM25Score(double n, double f, double N, double dl, double avdl) const;
         std::vector<std::string> TokenizeAndNormalize(const std::string& text) const;
-        void IndexDocumentBatch(const std::vector<std::string>& batch, size_t start_id);
+
+        /**
+         * @brief Aplica stopwords y stemming a palabras ya tokenizadas
+         */
+        std::vector<std::string> AnalyzeWords(const std::vector<std::string>& words) const;
+
+        /**
+         * @brief Palabras distintas de un documento que merecen sugerirse (sin stopwords,
+         *        números ni palabras muy cortas o largas)
+         */
+        std::vector<std::string> SuggestionWords(std::vector<std::string> words) const;
+        void IndexDocumentBatch(const std::vector<std::string>& batch,
+                                ExternalDocumentId first_document_id);
         size_t GetOptimalThreadCount(size_t document_count) const;
 
+        /**
+         * @brief Versión de un documento recién marcada como eliminada
+         */
+        struct RemovedDocument
+        {
+            InternalDocumentId internal_id = 0;
+            // Si cambia antes de descontar su df, la compactación ya purgó sus entradas
+            uint64_t layout_generation = 0;
+            std::string content;
+        };
+
+        /**
+         * @brief Inserta un documento ya tokenizado (requiere lock exclusivo)
+         * @return Versión reemplazada (nullopt si el ID era nuevo)
+         */
+        std::optional<RemovedDocument> IndexTokensLocked(ExternalDocumentId document_id,
+                                                         const std::string& content,
+                                                         const std::vector<std::string>& tokens,
+                                                         const DocumentMetadata& metadata);
+
+        /**
+         * @brief Estadísticas con que Policy puntúa las postings de un término
+         */
+        TermContext MakeTermContext(const std::string& term,
+                                    const CorpusStatistics& statistics) const;
+
+        /**
+         * @brief Puntúa un conjunto de candidatos ya filtrados (requiere lock compartido)
+         * @note Recorre cada lista de postings galopando sobre los candidatos
+         */
+        template <typename Policy>
+        std::vector<double> ScoreCandidates(const RankingParameters& ranking,
+                                            const std::vector<WeightedTerm>& terms,
+                                            const std::vector<InternalDocumentId>& candidates,
+                                            const CorpusStatistics& statistics) const;
+
+        /**
+         * @brief Término de una consulta con hora límite, con su peso en SearchCoverage
+         */
+        template <typename Policy>
+        struct ImpactTerm
+        {
+            double weight;
+            Policy policy;
+            PostingView postings;
+            double impact;
+        };
+
+        /**
+         * @brief Términos de terms con postings, de más a menos aportación máxima por posting
+         */
+        template <typename Policy>
+        std::vector<ImpactTerm<Policy>> ImpactOrderedTerms(const RankingParameters& ranking,
+                                                           const std::vector<WeightedTerm>& terms,
+                                                           const CorpusStatistics& statistics,
+                                                           SearchCoverage& coverage) const;
+
+        /**
+         * @brief ScoreCandidates que se detiene en deadline (requiere lock compartido)
+         * @note Recorre los términos en orden de aportación y mira el reloj cada bloque de
+         *       candidatos; los candidatos conservan las puntuaciones parciales
+         */
+        template <typename Policy>
+        std::vector<double> ScoreCandidatesAnytime(
+            const RankingParameters& ranking, const std::vector<WeightedTerm>& terms,
+            const std::vector<InternalDocumentId>& candidates, const CorpusStatistics& statistics,
+            std::chrono::steady_clock::time_point deadline, SearchCoverage& coverage) const;
+
+        struct ScoredDocument
+        {
+            InternalDocumentId document_id;
+            double score;
+        };
+
+        /**
+         * @brief Aportaciones en float de las postings [begin, begin + count) de un término
+         */
+        template <typename Policy>
+        void ComputeImpacts(const Policy& policy, const PostingView& postings, size_t begin,
+                            size_t count, float* out) const;
+
+        /**
+         * @brief Puntuación clásica con acumuladores Accumulator (float o uint16_t)
+         * @return Los mejores candidatos con su puntuación exacta, o nullopt si la
+         *         cuantización no sirve (aportaciones negativas en UINT16)
+         * @note Requiere lock compartido
+         */
+        template <typename Policy, typename Accumulator>
+        std::optional<std::vector<ScoredDocument>> ScoreDisjunctionApproximate(
+            const RankingParameters& ranking, const std::vector<WeightedTerm>& terms,
+            const CorpusStatistics& statistics, size_t max_results) const;
+
+        /**
+         * @brief Puntuación clásica en dos fases (requiere lock compartido)
+         * @return Los candidatos de la primera fase con su puntuación exacta (más la de
+         *         cercanía si options.proximity_weight > 0)
+         */
+        template <typename Policy>
+        std::vector<ScoredDocument> ScoreTwoPhase(const RankingParameters& ranking,
+                                                  const std::vector<WeightedTerm>& terms,
+                                                  const CorpusStatistics& statistics,
+                                                  const TwoPhaseOptions& options,
+                                                  size_t max_results) const;
+
+        /**
+         * @brief Cercanía de los términos de la consulta en un texto
+         * @return (m - 1) / (w - m + 1) para la ventana más corta de w palabras con los m
+         *         términos distintos que aparecen (m - 1 si están seguidos, 0 si m < 2)
+         */
+        double ProximityScore(std::string_view content,
+                              const std::vector<WeightedTerm>& terms) const;
+
+        /**
+         * @brief Puntuación clásica: suma BM25 sobre todas las postings (requiere lock)
+         */
+        template <typename Policy>
+        std::vector<ScoredDocument> ScoreDisjunction(const RankingParameters& ranking,
+                                                     const std::vector<WeightedTerm>& terms,
+                                                     const CorpusStatistics& statistics) const;
+
+        /**
+         * @brief Puntuación clásica que se detiene en deadline (requiere lock compartido)
+         * @note Término a término en orden de aportación, mirando el reloj cada bloque de
+         *       postings: al agotarse el tiempo devuelve los documentos tocados hasta ahí
+         *       con su puntuación parcial. Al menos un bloque se puntúa siempre
+         */
+        template <typename Policy>
+        std::vector<ScoredDocument> ScoreDisjunctionAnytime(
+            const RankingParameters& ranking, const std::vector<WeightedTerm>& terms,
+            const CorpusStatistics& statistics, std::chrono::steady_clock::time_point deadline,
+            SearchCoverage& coverage) const;
+
+        /**
+         * @brief Aportación de cada posting de un término (0 en documentos eliminados)
+         * @note No depende de la consulta: un lote la calcula una vez por término distinto y
+         *       cada consulta solo la multiplica por su peso
+         */
+        struct TermContribution
+        {
+            std::optional<PostingView> postings;
+            std::vector<double> scores;
+        };
+
+        /**
+         * @brief Resuelve las consultas [begin, end) de un lote (requiere lock compartido)
+         * @note Las consultas clásicas suman las aportaciones en el mismo orden que
+         *       ScoreDisjunction, así que puntúan exactamente igual que por separado. Se
+         *       acumulan siempre en double (ScoreAccumulator no se aplica al lote)
+         */
+        void SearchBatchRangeLocked(const std::vector<std::unique_ptr<QueryNode>>& roots,
+                                    const std::vector<BatchQuery>& queries,
+                                    const CorpusStatistics& statistics, size_t begin, size_t end,
+                                    std::vector<std::vector<SearchResult>>& results) const;
+
+        /**
+         * @brief Reparte las consultas de un lote en bloques entre hilos
+         * @note Requiere lock compartido en el hilo que llama: los hilos del reparto leen el
+         *       índice sin tomarlo mientras este espera a que terminen
+         */
+        std::vector<std::vector<SearchResult>> SearchBatchLocked(
+            const std::vector<std::unique_ptr<QueryNode>>& roots,
+            const std::vector<BatchQuery>& queries, const CorpusStatistics& statistics,
+            size_t num_threads) const;
+
+        /**
+         * @brief Los max_results mejores con su contenido y metadatos (requiere lock
+         *        compartido)
+         * @note Aplica sort, search_after y omit_content de options
+         */
+        std::vector<SearchResult> TopResultsLocked(std::vector<ScoredDocument>& hits,
+                                                   size_t max_results,
+                                                   const QueryOptions& options) const;
+
+        /**
+         * @brief Busca en el diccionario los términos de los TERM de prefijo y difusos
+         *        (requiere lock compartido)
+         */
+        void CollectExpansionsLocked(const QueryNode& node, QueryExpansions& expansions) const;
+
+        /**
+         * @brief Postings que leería node (requiere lock compartido; ver EstimateCost)
+         */
+        uint64_t EstimateCostLocked(const QueryNode& node) const;
+
+        /**
+         * @brief Sustituye los TERM de prefijo y difusos por sus expansiones
+         * @note Se quedan como máximo max_expansions_ términos: los más frecuentes para
+         *       prefijos y los más cercanos (luego los más frecuentes) para difusos
+         */
+        void ApplyExpansionsLocked(QueryNode& node, const QueryExpansions& expansions) const;
+
+        /**
+         * @brief Suma N, la longitud total y el df de cada término distinto de terms
+         */
+        void CollectStatisticsLocked(const std::vector<WeightedTerm>& terms,
+                                     CorpusStatistics& statistics) const;
+        /**
+         * @param facets Si no es nullptr, suma los recuentos de options.facets
+         * @param coverage Si no es nullptr, suma lo puntuado antes de options.deadline
+         */
+        std::vector<SearchResult> SearchLocked(const QueryNode& root,
+                                               const CorpusStatistics& statistics,
+                                               size_t max_results, const QueryOptions& options,
+                                               FacetCounts* facets,
+                                               SearchCoverage* coverage = nullptr) const;
+
+        /**
+         * @brief Marca un ID interno como eliminado en O(1) (requiere lock exclusivo)
+         * @return Versión eliminada, para ForgetRemoved
+         * @note No toca las listas ni el df de sus términos
+         */
+        RemovedDocument TombstoneLocked(InternalDocumentId internal_id);
+
+        /**
+         * @brief Quita las versiones eliminadas de las sugerencias y descuenta su df
+         * @note Debe llamarse sin mantener documents_mutex_: el texto se analiza sin lock y
+         *       el lock exclusivo solo se toma para ajustar los contadores
+         */
+        void ForgetRemoved(const std::vector<RemovedDocument>& removed);
+
+        /**
+         * @brief Orden por bisección calculado fuera del lock exclusivo
+         */
+        struct ReorderPlan
+        {
+            // IDs internos de los documentos vivos al planificar, en su nuevo orden
+            std::vector<InternalDocumentId> order;
+            // IDs internos que había al planificar; los posteriores van al final
+            size_t document_count = 0;
+            uint64_t layout_generation = 0;
+            uint64_t postings = 0;
+            double gap_bits_before = 0.0;
+        };
+
+        /**
+         * @brief Copia las listas vivas con lock compartido y calcula su bisección sin lock
+         * @return nullopt con DocumentOrder::ARRIVAL o si no hay documentos nuevos
+         */
+        std::optional<ReorderPlan> PlanReorder() const;
+
+        /**
+         * @brief Purga documentos eliminados y renumera IDs internos (requiere lock exclusivo)
+         * @param plan Orden de los documentos vivos (nullptr = el de llegada)
+         * @note Sin nada que purgar ni reordenar solo sella el filtro de términos si hay
+         *       términos nuevos
+         */
+        size_t CompactLocked(const ReorderPlan* plan = nullptr);
+
+        /**
+         * @brief Lanza la compactación en segundo plano si se superó el umbral
+         * @note Debe llamarse sin mantener documents_mutex_
+         */
+        void ScheduleCompactionIfNeeded();
+
+        /**
+         * @brief Si se supera el presupuesto, baja al nivel frío primero textos y luego las
+         *        listas largas menos consultadas (requiere lock exclusivo)
+         * @note Si el archivo frío falla se avisa una vez y el índice sigue en RAM
+         */
+        void EnforceMemoryBudgetLocked();
+
       public:
-        BM25Engine() = default;
-        ~BM25Engine() = default;
+        /**
+         * @param analyzer Cadena de análisis (nullptr = stemming y stopwords por defecto)
+         */
+        explicit BM25Engine(std::shared_ptr<const Shared::TextAnalyzer> analyzer = nullptr);
+        ~BM25Engine();
 
         // No copyable pero movible
         BM25Engine(const BM25Engine&) = delete;
@@ -102,27 +870,241 @@ namespace DocuTrace::Infrastructure
 
         /**
          * @brief Indexa un documento de forma segura para concurrencia
+         * @param document_id ID externo estable del documento
          * @param content Contenido del documento a indexar
+         * @param metadata Nombre de archivo y fecha usados por los filtros de consulta
+         * @note Si el ID ya existía, el contenido anterior se reemplaza
          */
-        void IndexDocument(size_t document_id, const std::string& content);
+        void IndexDocument(ExternalDocumentId document_id, const std::string& content,
+                           const DocumentMetadata& metadata = {});
 
         /**
          * @brief Indexa múltiples documentos de forma concurrente
          * @param documents Vector de documentos a indexar
+         * @param first_document_id ID externo del primer documento (los demás son consecutivos)
          * @param num_threads Número de hilos a usar (0 = auto)
          * @param batch_size Tamaño del lote por hilo
          * @return Número de documentos indexados
          */
-        size_t IndexDocuments(const std::vector<std::string>& documents, size_t num_threads = 0,
+        size_t IndexDocuments(const std::vector<std::string>& documents,
+                              ExternalDocumentId first_document_id, size_t num_threads = 0,
                               size_t batch_size = DEFAULT_BATCH_SIZE);
 
-        std::vector<SearchResult> Search(const std::string& query, size_t max_results = 50) const;
+        /**
+         * @brief Marca un documento como eliminado en O(1)
+         * @param document_id ID externo del documento
+         * @return true si el documento existía
+         * @note Las entradas del índice se purgan luego en la compactación. El df de sus
+         *       términos se descuenta al volver, tras analizar el texto fuera del lock
+         */
+        bool DeleteDocument(ExternalDocumentId document_id);
+
+        /**
+         * @brief Reemplaza el contenido de un documento existente
+         * @return true si el documento existía y se reindexó
+         */
+        bool UpdateDocument(ExternalDocumentId document_id, const std::string& content,
+                            const DocumentMetadata& metadata = {});
+
+        /**
+         * @brief Purga de inmediato las entradas de documentos eliminados
+         * @return Número de entradas eliminadas del índice
+         * @note Con DocumentOrder::BISECTION y documentos nuevos también los reordena; la
+         *       bisección se calcula sin bloquear búsquedas ni escrituras. Siempre deja
+         *       sellado el filtro de términos
+         */
+        size_t Compact();
+
+        /**
+         * @brief Fracción de documentos eliminados que dispara la compactación automática
+         * @note Con DocumentOrder::BISECTION también la dispara esa fracción de documentos
+         *       nuevos sin reordenar (al menos MIN_REORDER_DOCUMENTS), y esa fracción de
+         *       términos fuera del filtro (al menos MIN_UNSEALED_TERMS) vuelve a sellarlo
+         */
+        void SetCompactionRatio(double ratio);
+
+        /**
+         * @brief Orden de los IDs internos que deja cada compactación
+         */
+        void SetDocumentOrder(DocumentOrder order);
+
+        /**
+         * @brief Limita la RAM de postings y textos; lo que no cabe pasa a archivos mapeados
+         * @param bytes Presupuesto (0 = sin límite)
+         * @param directory Directorio de los archivos temporales del nivel frío
+         */
+        void SetMemoryBudget(size_t bytes, const std::filesystem::path& directory);
+
+        /**
+         * @brief Ajusta la expansión de prefijos y erratas
+         * @param fuzzy_penalty Factor por edición aplicado a la puntuación (peso = factor^d)
+         * @param max_expansions Máximo de términos en que se expande cada palabra
+         */
+        void SetExpansionLimits(double fuzzy_penalty, size_t max_expansions);
+
+        /**
+         * @brief Modelo y parámetros de puntuación por defecto
+         * @note Una consulta puede elegir otros con QueryOptions::ranking
+         */
+        void SetRankingParameters(const RankingParameters& ranking);
+
+        /**
+         * @brief Precisión de los acumuladores de las consultas clásicas
+         * @note Las consultas con search_after y las de un lote se puntúan siempre en double
+         */
+        void SetScoreAccumulator(ScoreAccumulator accumulator);
+
+        /**
+         * @brief Interpreta "double", "float32" o "uint16"
+         * @return false si el valor no es reconocido
+         */
+        static bool ParseScoreAccumulator(const std::string& value, ScoreAccumulator& accumulator);
+
+        /**
+         * @brief Repite sin cascada una de cada every consultas en dos fases para medir su
+         *        recall (0 = nunca)
+         */
+        void SetTwoPhaseSampling(size_t every);
+        static const char* ScoreAccumulatorName(ScoreAccumulator accumulator);
+
+        /**
+         * @brief Busca documentos con el lenguaje de consulta booleano
+         * @note Las consultas sin operadores ni filtros usan la puntuación clásica (OR de
+         *       términos); el resto se planifica con QueryEvaluator y solo se puntúan
+         *       los candidatos que cumplen la expresión.
+         *       palabra* y palabra~N (u options) se expanden contra el diccionario de términos.
+         *       Devuelve los max_results mejores por SearchResult::Ranks (o por
+         *       SearchResult::SortsBefore con options.sort). Con facets y options.facets
+         *       suma además los documentos que casan por valor de cada campo; facetas y sort
+         *       puntúan siempre de forma exacta, sin dos fases ni acumuladores reducidos.
+         *       Con options.deadline tampoco: se puntúa por orden de aportación de los
+         *       términos y, si se agota el tiempo, se devuelven los mejores hasta entonces
+         *       (coverage indica cuánto se leyó)
+         */
+        std::vector<SearchResult> Search(const std::string& query, size_t max_results = 50,
+                                         const QueryOptions& options = {},
+                                         FacetCounts* facets = nullptr,
+                                         SearchCoverage* coverage = nullptr) const;
+
+        // Fases de Search por separado para buscar en varias particiones (ShardedEngine):
+        // analizar, expandir con el diccionario global, sumar estadísticas y puntuar
+
+        std::unique_ptr<QueryNode> ParseQuery(const std::string& query,
+                                              const QueryOptions& options = {}) const;
+        void CollectExpansions(const QueryNode& root, QueryExpansions& expansions) const;
+        void ApplyExpansions(QueryNode& root, const QueryExpansions& expansions) const;
+        void CollectStatistics(const QueryNode& root, CorpusStatistics& statistics) const;
+
+        /**
+         * @brief Coste estimado de evaluar una consulta sin expandir: postings que leería
+         * @note Solo consulta el diccionario. Los términos exactos cuentan su df; los de
+         *       prefijo, la suma de los max_expansions_ más frecuentes que empiezan así; los
+         *       difusos, max_expansions_ listas de longitud media (buscarlos ya costaría lo
+         *       que se quiere evitar); los filtros, un recorrido de todos los documentos
+         */
+        uint64_t EstimateCost(const QueryNode& root) const;
+
+        /**
+         * @brief Puntúa una consulta ya expandida con estadísticas de toda la colección
+         * @param options Se usa todo salvo lo que afecta al análisis (ya hecho)
+         */
+        std::vector<SearchResult> Search(const QueryNode& root, const CorpusStatistics& statistics,
+                                         size_t max_results, const QueryOptions& options = {},
+                                         FacetCounts* facets = nullptr,
+                                         SearchCoverage* coverage = nullptr) const;
+
+        /**
+         * @brief Texto actual de cada documento (nullopt si ya no está en el índice)
+         * @note Un cursor guarda solo IDs y puntuaciones y recupera aquí el texto de cada
+         *       página
+         */
+        std::vector<std::optional<std::string>> GetContents(
+            const std::vector<ExternalDocumentId>& document_ids) const;
+
+        /**
+         * @brief IDs externos de los documentos vivos, en orden de ID interno
+         */
+        std::vector<ExternalDocumentId> GetDocumentIds() const;
+
+        /**
+         * @brief Resuelve un lote de consultas con un solo lock y una pasada por término
+         * @param num_threads Hilos entre los que repartir las consultas (0 = auto)
+         * @return Resultados de cada consulta, en orden; iguales a los de Search
+         * @note Análisis, expansiones y estadísticas se hacen una vez para todo el lote, y
+         *       cada lista de postings se lee y puntúa una vez por bloque de consultas
+         */
+        std::vector<std::vector<SearchResult>> SearchBatch(const std::vector<BatchQuery>& queries,
+                                                           size_t num_threads = 0) const;
+
+        // Fases de SearchBatch por separado para ShardedEngine (roots[i] ya expandida; las
+        // consultas vacías no tienen cláusulas)
+
+        void CollectStatistics(const std::vector<std::unique_ptr<QueryNode>>& roots,
+                               CorpusStatistics& statistics) const;
+        std::vector<std::vector<SearchResult>> SearchBatch(
+            const std::vector<std::unique_ptr<QueryNode>>& roots,
+            const std::vector<BatchQuery>& queries, const CorpusStatistics& statistics,
+            size_t num_threads) const;
+
+        /**
+         * @brief Completa la última palabra de prefix con las más frecuentes del índice
+         * @param limit Máximo de sugerencias (como mucho SuggestionIndex::MAX_SUGGESTIONS)
+         * @note Solo toma el lock del índice de sugerencias, no el de documentos
+         * @example Suggest("machu pic", 5) → {{"picchu", 12}, {"pico", 3}}
+         */
+        std::vector<Suggestion> Suggest(const std::string& prefix, size_t limit) const;
+
+        /**
+         * @brief Escribe el estado como un segmento inmutable: solo documentos vivos, ya
+         *        compactados, con sus postings y las palabras de sugerencia
+         * @return Versión del contenido escrito (ver GetVersion)
+         * @throws std::runtime_error si falla la escritura
+         */
+        uint64_t WriteSegment(Shared::BinaryWriter& writer) const;
+
+        /**
+         * @brief Sustituye el contenido por el de un segmento sin volver a analizar el texto
+         * @throws std::runtime_error si el segmento está truncado o no es de este formato
+         */
+        void ReadSegment(Shared::BinaryReader& reader);
+
+        /**
+         * @brief Contador que cambia con cada alta, baja o modificación
+         */
+        uint64_t GetVersion() const
+        {
+            return version_.load();
+        }
+
         void Clear();
         size_t GetDocumentCount() const
         {
-            std::lock_guard<std::mutex> lock(documents_mutex_);
-            return documents_.size();
+            std::shared_lock<std::shared_mutex> lock(documents_mutex_);
+            return document_ids_.Size();
+        }
+        size_t GetTombstoneCount() const
+        {
+            std::shared_lock<std::shared_mutex> lock(documents_mutex_);
+            return tombstone_count_;
+        }
+        size_t GetTermCount() const
+        {
+            std::shared_lock<std::shared_mutex> lock(documents_mutex_);
+            return index_.GetTermCount();
+        }
+        size_t GetPostingCount() const
+        {
+            std::shared_lock<std::shared_mutex> lock(documents_mutex_);
+            return index_.GetPostingCount();
+        }
+        size_t GetSuggestionWordCount() const
+        {
+            return suggestions_.GetWordCount();
         }
+        MemoryStatistics GetMemoryStatistics() const;
+        TwoPhaseStatistics GetTwoPhaseStatistics() const;
+        ReorderStatistics GetReorderStatistics() const;
+        TermFilterStatistics GetTermFilterStatistics() const;
     };
 
-} // namespace DocuTrace::Infrastructure
\ No newline at end of file
+} // namespace DocuTrace::Infrastructure
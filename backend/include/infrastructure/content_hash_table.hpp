@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "infrastructure/document_catalog.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    /**
+     * @brief Copia de un documento ya indexado que se registró sin reindexar
+     */
+    struct DocumentAlias
+    {
+        std::string filename;
+        std::time_t timestamp;
+    };
+
+    /**
+     * @brief Entrada de la tabla hash → documento
+     */
+    struct ContentHashEntry
+    {
+        uint64_t content_hash;
+        uint64_t document_id;
+        uint64_t simhash = 0;
+        std::vector<DocumentAlias> aliases;
+    };
+
+    /**
+     * @brief Documento casi idéntico encontrado por distancia de SimHash
+     */
+    struct NearDuplicateMatch
+    {
+        uint64_t document_id;
+        int distance;
+    };
+
+    /**
+     * @brief Configuración de la detección de documentos casi idénticos
+     */
+    struct NearDuplicateOptions
+    {
+        bool enabled = false;
+        // Entre 0 y 63: con 64 bits distintos dos firmas no comparten ninguna banda
+        int max_distance = 3;
+    };
+
+    /**
+     * @brief Tabla persistente de hashes de contenido para deduplicar en la ingesta
+     * @note Se guarda como JSON compacto junto a document_index.json, más un registro
+     *       (content_hashes.log) con una línea por cambio desde la última reescritura; segura
+     *       para concurrencia
+     */
+    class ContentHashTable
+    {
+      public:
+        static constexpr const char* FILE_NAME = "content_hashes.json";
+        // Cambios en el registro a partir de los cuales se reescribe la tabla, si la tabla es
+        // más pequeña; así cada cambio cuesta O(1) amortizado
+        static constexpr size_t MIN_LOG_RECORDS = 1024;
+
+      private:
+        std::filesystem::path file_path_;
+        std::filesystem::path log_path_;
+        // Líneas en log_path_; la tabla en disco es file_path_ más esas líneas
+        mutable size_t log_records_ = 0;
+        std::unordered_map<uint64_t, ContentHashEntry> entries_;
+        std::unordered_map<uint64_t, uint64_t> hash_by_document_;
+        NearDuplicateOptions near_duplicate_options_;
+        // Por banda de la firma SimHash: valor de la banda → hashes de contenido con ese valor.
+        // Con max_distance + 1 bandas dos firmas a esa distancia coinciden en al menos una
+        std::vector<std::unordered_map<uint64_t, std::vector<uint64_t>>> simhash_bands_;
+        mutable std::mutex mutex_;
+
+        void Load();
+        void LoadLog();
+
+        /**
+         * @brief Reescribe la tabla completa y vacía el registro
+         */
+        void Save() const;
+        bool SaveTo(const std::filesystem::path& file) const;
+
+        /**
+         * @brief Añade un cambio (una línea JSON) al registro, o reescribe la tabla si el
+         *        registro ya es tan grande como ella o no se puede escribir
+         */
+        void Append(const std::string& record) const;
+
+        std::vector<DocumentAlias> RemoveDocumentLocked(uint64_t document_id);
+
+        /**
+         * @brief Valor de la banda band (de simhash_bands_.size()) dentro de la firma
+         */
+        uint64_t BandValue(uint64_t simhash, size_t band) const;
+
+        /**
+         * @brief Register sin lock ni persistencia
+         * @param dropped Recibe los alias del contenido anterior del documento
+         * @return false si el contenido ya pertenece a otro documento; entonces el documento
+         *         solo pierde su hash anterior
+         */
+        bool RegisterLocked(uint64_t content_hash, uint64_t document_id, uint64_t simhash,
+                            std::vector<DocumentAlias>& dropped);
+
+        void IndexSimHashLocked(const ContentHashEntry& entry);
+        void UnindexSimHashLocked(const ContentHashEntry& entry);
+
+      public:
+        explicit ContentHashTable(std::filesystem::path file_path,
+                                  NearDuplicateOptions near_duplicate_options = {});
+
+        // No copyable
+        ContentHashTable(const ContentHashTable&) = delete;
+        ContentHashTable& operator=(const ContentHashTable&) = delete;
+
+        /**
+         * @brief Busca el documento que tiene exactamente este contenido
+         * @return ID del documento original o std::nullopt si es nuevo
+         */
+        std::optional<uint64_t> Find(uint64_t content_hash) const;
+
+        /**
+         * @brief Busca el documento más parecido dentro de la distancia de Hamming configurada
+         * @param simhash Firma SimHash del contenido nuevo
+         * @note Solo compara con las firmas que comparten alguna banda con la nueva
+         */
+        std::optional<NearDuplicateMatch> FindNearDuplicate(uint64_t simhash) const;
+
+        const NearDuplicateOptions& GetNearDuplicateOptions() const
+        {
+            return near_duplicate_options_;
+        }
+
+        /**
+         * @brief Registra el contenido de un documento y persiste la tabla
+         * @return Alias del contenido anterior, que se pierden al cambiar el hash
+         * @note Si el documento ya tenía otro hash (actualización), la entrada anterior se
+         *       descarta; con el mismo hash conserva sus alias. Si el contenido pertenece a
+         *       otro documento, esa entrada no cambia y este documento queda sin hash
+         */
+        std::vector<DocumentAlias> Register(uint64_t content_hash, uint64_t document_id,
+                                            uint64_t simhash = 0);
+
+        /**
+         * @brief Registra una copia de un contenido ya existente y persiste la tabla
+         * @return ID del documento original o std::nullopt si el hash no existe
+         */
+        std::optional<uint64_t> AddAlias(uint64_t content_hash, const std::string& filename);
+
+        /**
+         * @brief Olvida el hash y los alias de un documento eliminado
+         * @return Alias que se descartan con él (vacío si no estaba registrado) para que quien
+         *         borra pueda informar de ellos
+         */
+        std::vector<DocumentAlias> RemoveDocument(uint64_t document_id);
+
+        bool ContainsDocument(uint64_t document_id) const;
+        size_t Size() const;
+
+        /**
+         * @brief Calcula el hash de los documentos del catálogo que aún no están en la tabla
+         * @return Documentos añadidos
+         */
+        size_t Backfill(const std::vector<CatalogEntry>& entries);
+
+        /**
+         * @brief Enlaza en file la tabla tal como está ahora, sin copiar datos
+         * @return true si hubo que copiarla (el destino no admite enlaces) o escribirla (la
+         *         tabla aún no estaba en disco)
+         * @throws std::runtime_error si no se puede enlazar ni escribir
+         * @note Los cambios pendientes en el registro se vuelcan antes a la tabla. Es seguro
+         *       porque Save reemplaza el archivo con un renombrado
+         */
+        bool Pin(const std::filesystem::path& file) const;
+
+        /**
+         * @brief Sustituye la tabla por una fijada con Pin
+         * @param file Tabla de la copia; si no existe (copias anteriores) la tabla se vacía y
+         *        quien restaura la reconstruye con Backfill
+         * @throws std::runtime_error si no se puede restaurar el archivo
+         */
+        void Restore(const std::filesystem::path& file);
+    };
+
+} // namespace DocuTrace::Infrastructure
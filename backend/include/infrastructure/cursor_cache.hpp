@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "infrastructure/sharded_engine.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    /**
+     * @brief Clasificación de una búsqueda paginada, calculada una sola vez
+     * @note En local guarda solo IDs y puntuaciones junto al índice en que se calculó: una
+     *       réplica que carga otra generación no cambia las páginas de un cursor abierto. En
+     *       modo coordinador los resultados llegan de los workers ya con su texto
+     */
+    struct CursorSnapshot
+    {
+        std::string query;
+        QueryOptions options;
+        std::vector<SearchResult> ranking;
+        // Índice fijado al abrir el cursor (nullptr en modo coordinador)
+        std::shared_ptr<const ShardedEngine> engine;
+        // La clasificación se cortó en CursorCache::MAX_RANKING: tras el último resultado
+        // se sigue con search-after
+        bool truncated = false;
+        size_t nodes_total = 0;
+        size_t nodes_failed = 0;
+    };
+
+    /**
+     * @brief Cursor encontrado y posición de la página pedida
+     */
+    struct CursorPosition
+    {
+        std::shared_ptr<const CursorSnapshot> snapshot;
+        uint64_t id = 0;
+        size_t offset = 0;
+    };
+
+    /**
+     * @brief Cursores abiertos por token opaco, con caducidad por inactividad
+     * @note El token lleva el ID del cursor y la posición de la página ("<id>-<offset>"):
+     *       repetir una petición devuelve la misma página. Segura para concurrencia
+     * @example auto id = cache.Insert(snapshot); cache.Find(CursorCache::MakeToken(id, 20))
+     */
+    class CursorCache
+    {
+      public:
+        // Resultados que se clasifican al abrir un cursor
+        static constexpr size_t MAX_RANKING = 1000;
+
+      private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Entry
+        {
+            std::shared_ptr<const CursorSnapshot> snapshot;
+            Clock::time_point last_access;
+        };
+
+        std::chrono::seconds ttl_;
+        size_t capacity_;
+        mutable std::mutex mutex_;
+        std::unordered_map<uint64_t, Entry> entries_;
+        std::mt19937_64 random_;
+
+        /**
+         * @brief Descarta los caducados y, si sigue lleno, el de acceso más antiguo
+         */
+        void EvictLocked(Clock::time_point now);
+
+      public:
+        /**
+         * @param ttl Inactividad tras la que un cursor se descarta
+         * @param capacity Máximo de cursores abiertos a la vez
+         */
+        CursorCache(std::chrono::seconds ttl, size_t capacity);
+
+        /**
+         * @return ID del cursor para MakeToken
+         */
+        uint64_t Insert(std::shared_ptr<const CursorSnapshot> snapshot);
+
+        /**
+         * @brief Busca el cursor de un token y renueva su caducidad
+         * @return nullopt si el token no es válido o el cursor caducó
+         */
+        std::optional<CursorPosition> Find(const std::string& token);
+
+        static std::string MakeToken(uint64_t id, size_t offset);
+
+        size_t Size() const;
+    };
+
+} // namespace DocuTrace::Infrastructure
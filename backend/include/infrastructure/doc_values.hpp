@@ -0,0 +1,221 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "infrastructure/document_id_map.hpp"
+#include "infrastructure/query_parser.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    /**
+     * @brief Metadatos filtrables de un documento (filename:, ext:, dir:, after:, before:)
+     */
+    struct DocumentMetadata
+    {
+        std::string filename;
+        std::time_t timestamp = 0;
+        // Carpeta de origen (vacía en los documentos subidos por /api/upload)
+        std::string directory;
+    };
+
+    /**
+     * @brief Documentos que casan por campo y valor (AAAA-MM en MONTH)
+     * @note Con varias particiones o nodos se suman: los valores viajan como texto porque
+     *       cada partición codifica los suyos
+     */
+    struct FacetCounts
+    {
+        std::map<FacetField, std::map<std::string, uint64_t>> fields;
+
+        void Merge(const FacetCounts& other);
+    };
+
+    /**
+     * @brief Bitset compacto sobre el espacio de IDs internos
+     */
+    class DocumentBitset
+    {
+      private:
+        std::vector<uint64_t> words_;
+
+      public:
+        explicit DocumentBitset(size_t size = 0) : words_((size + 63) / 64, 0)
+        {
+        }
+
+        void Set(InternalDocumentId id)
+        {
+            words_[id >> 6] |= (1ULL << (id & 63));
+        }
+
+        bool Test(InternalDocumentId id) const
+        {
+            return (id >> 6) < words_.size() && (words_[id >> 6] >> (id & 63)) & 1ULL;
+        }
+
+        /**
+         * @brief Rellena los primeros size bits con matches(id), una palabra de 64 a la vez
+         */
+        template <typename Predicate> void Assign(size_t size, Predicate&& matches)
+        {
+            words_.assign((size + 63) / 64, 0);
+            for (size_t word = 0; word < words_.size(); ++word)
+            {
+                const size_t begin = word * 64;
+                const size_t end = std::min(size, begin + 64);
+                uint64_t bits = 0;
+                for (size_t id = begin; id < end; ++id)
+                {
+                    bits |= static_cast<uint64_t>(matches(static_cast<InternalDocumentId>(id)))
+                            << (id - begin);
+                }
+                words_[word] = bits;
+            }
+        }
+
+        /**
+         * @brief Intersección (o diferencia si exclude) con otro bitset del mismo tamaño
+         */
+        void Combine(const DocumentBitset& other, bool exclude)
+        {
+            for (size_t word = 0; word < words_.size(); ++word)
+            {
+                words_[word] &= exclude ? ~other.words_[word] : other.words_[word];
+            }
+        }
+    };
+
+    /**
+     * @brief Metadatos por ID interno en columnas: fechas en un array denso, extensiones y
+     *        directorios codificados con un diccionario y los nombres en un único buffer
+     * @note Filtros, facetas y orden recorren una sola columna contigua en vez de una
+     *       estructura con tres strings por documento. Los diccionarios solo crecen hasta
+     *       la siguiente compactación. No es thread-safe por sí mismo; BM25Engine sincroniza
+     *       el acceso
+     */
+    class DocValues
+    {
+      private:
+        /**
+         * @brief Valores distintos de una columna; el código 0 es el valor vacío
+         */
+        class Dictionary
+        {
+          private:
+            std::vector<std::string> values_{std::string()};
+            std::unordered_map<std::string, uint32_t> codes_{{std::string(), 0}};
+
+          public:
+            uint32_t Encode(const std::string& value);
+            std::optional<uint32_t> Find(const std::string& value) const;
+
+            const std::string& Decode(uint32_t code) const
+            {
+                return values_[code];
+            }
+
+            const std::vector<std::string>& GetValues() const
+            {
+                return values_;
+            }
+
+            size_t GetMemoryUsage() const;
+        };
+
+        std::vector<int64_t> timestamps_;
+        std::vector<uint32_t> extensions_;
+        std::vector<uint32_t> directories_;
+        // Nombre del documento i: filenames_[filename_offsets_[i], filename_offsets_[i + 1])
+        std::string filenames_;
+        std::vector<uint64_t> filename_offsets_{0};
+        Dictionary extension_dictionary_;
+        Dictionary directory_dictionary_;
+
+      public:
+        /**
+         * @brief Extensión en minúsculas y sin el punto ("informe.PDF" → "pdf")
+         */
+        static std::string ExtensionOf(std::string_view filename);
+
+        /**
+         * @brief Interpreta "extension", "month" o "directory"
+         * @return false si el valor no es reconocido
+         */
+        static bool ParseFacetField(const std::string& value, FacetField& field);
+        static const char* FacetFieldName(FacetField field);
+
+        /**
+         * @brief Interpreta "timestamp" o "filename", con '-' delante para orden descendente
+         * @return false si el valor no es reconocido
+         */
+        static bool ParseSortOrder(const std::string& value, SortOrder& sort);
+        static std::string SortOrderName(const SortOrder& sort);
+
+        void Reserve(size_t count);
+
+        /**
+         * @brief Añade los metadatos del siguiente ID interno (Size())
+         */
+        void Add(const DocumentMetadata& metadata);
+
+        size_t Size() const
+        {
+            return timestamps_.size();
+        }
+
+        std::time_t GetTimestamp(InternalDocumentId document_id) const
+        {
+            return static_cast<std::time_t>(timestamps_[document_id]);
+        }
+
+        /**
+         * @return Vista válida hasta la siguiente modificación
+         */
+        std::string_view GetFilename(InternalDocumentId document_id) const
+        {
+            return std::string_view(filenames_)
+                .substr(filename_offsets_[document_id],
+                        filename_offsets_[document_id + 1] - filename_offsets_[document_id]);
+        }
+
+        const std::string& GetDirectory(InternalDocumentId document_id) const
+        {
+            return directory_dictionary_.Decode(directories_[document_id]);
+        }
+
+        /**
+         * @brief Documentos que cumplen un nodo FILTER, en una pasada por su columna
+         * @note Las extensiones y directorios se resuelven una vez contra el diccionario y
+         *       la pasada solo compara códigos
+         */
+        DocumentBitset Filter(const QueryNode& filter) const;
+
+        /**
+         * @brief Suma a counts los documentos por valor de cada campo de fields
+         * @note Una pasada por la columna de cada campo contando por código (o por mes) en
+         *       un array; los códigos se traducen a texto al final
+         */
+        void CountFacets(std::span<const InternalDocumentId> documents,
+                         const std::vector<FacetField>& fields, FacetCounts& counts) const;
+
+        /**
+         * @brief Conserva solo los documentos vivos con su nuevo ID y rehace los diccionarios
+         */
+        void Compact(const std::vector<InternalDocumentId>& remap, size_t live_count);
+        void Clear();
+
+        /**
+         * @brief Bytes de las columnas, el buffer de nombres y los diccionarios
+         */
+        size_t GetMemoryUsage() const;
+    };
+
+} // namespace DocuTrace::Infrastructure
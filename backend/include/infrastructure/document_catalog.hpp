@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace DocuTrace::Infrastructure
+{
+    /**
+     * @brief Metadatos persistidos de un documento subido
+     */
+    struct CatalogEntry
+    {
+        // ID externo estable, nunca se reutiliza
+        uint64_t id;
+        std::string filename;
+        std::string path;
+        std::time_t timestamp;
+    };
+
+    /**
+     * @brief Estado del catálogo fijado en una copia de seguridad (ver DocumentCatalog::Pin)
+     */
+    struct CatalogSnapshot
+    {
+        std::vector<CatalogEntry> entries;
+        // Último ID reservado en ese instante
+        uint64_t last_id = 0;
+        size_t linked_files = 0;
+        // Archivos que hubo que copiar porque el destino no admite enlaces
+        size_t copied_files = 0;
+    };
+
+    /**
+     * @brief Catálogo de documentos persistido en document_index.json y last_id.txt
+     * @note Capa de infraestructura - única dueña de los archivos del catálogo
+     */
+    class DocumentCatalog
+    {
+      private:
+        std::filesystem::path data_root_;
+        std::filesystem::path index_file_;
+        std::filesystem::path last_id_file_;
+        std::vector<CatalogEntry> entries_;
+        mutable std::mutex mutex_;
+        // Ver LockMutations
+        std::mutex mutation_mutex_;
+
+        void Load();
+        void Save() const;
+        bool SaveTo(const std::filesystem::path& file) const;
+        uint64_t ReadLastIdLocked() const;
+
+        /**
+         * @brief Ruta del archivo de un documento dentro de una copia de seguridad
+         * @return Vacía si el archivo está fuera del directorio de datos (no se enlaza)
+         */
+        std::filesystem::path SnapshotPath(const std::filesystem::path& directory,
+                                           const CatalogEntry& entry) const;
+
+      public:
+        explicit DocumentCatalog(std::filesystem::path data_root);
+
+        // No copyable
+        DocumentCatalog(const DocumentCatalog&) = delete;
+        DocumentCatalog& operator=(const DocumentCatalog&) = delete;
+
+        const std::filesystem::path& GetDataRoot() const
+        {
+            return data_root_;
+        }
+
+        std::filesystem::path GetDocsPath() const
+        {
+            return data_root_ / "docs";
+        }
+
+        /**
+         * @brief Reserva el siguiente ID de documento y lo persiste en last_id.txt
+         */
+        uint64_t NextId();
+
+        /**
+         * @brief Reserva un rango de IDs consecutivos
+         * @param count Número de IDs a reservar
+         * @return Primer ID del rango
+         */
+        uint64_t ReserveIds(uint64_t count);
+
+        /**
+         * @brief Añade una entrada al catálogo y lo persiste
+         */
+        void Add(const CatalogEntry& entry);
+
+        std::optional<CatalogEntry> Find(uint64_t id) const;
+
+        /**
+         * @brief Elimina la entrada de un documento
+         * @return true si existía
+         */
+        bool Remove(uint64_t id);
+
+        /**
+         * @brief Actualiza la marca de tiempo de un documento reemplazado
+         * @return true si existía
+         */
+        bool Touch(uint64_t id);
+
+        std::vector<CatalogEntry> GetEntries() const;
+
+        /**
+         * @brief Serializa las altas, cambios y bajas de documentos completas
+         * @note Quien sube, reemplaza o elimina un documento lo mantiene desde que consulta la
+         *       tabla de hashes hasta que la actualiza, para que ninguna otra operación vea el
+         *       catálogo, el índice y la tabla a medio cambiar. Es independiente del lock de
+         *       las entradas: los métodos del catálogo no lo toman
+         */
+        std::unique_lock<std::mutex> LockMutations();
+
+        /**
+         * @brief Enlaza en directory el catálogo y los archivos de sus documentos tal como
+         *        están ahora, sin copiar datos
+         * @return Estado fijado
+         * @throws std::runtime_error si falta un archivo o no se puede enlazar
+         * @note Las altas y bajas esperan mientras se enlaza (una operación de metadatos por
+         *       archivo); la indexación y las búsquedas siguen. Es seguro porque ningún
+         *       archivo se modifica en el sitio: se reemplazan con un renombrado
+         */
+        CatalogSnapshot Pin(const std::filesystem::path& directory) const;
+
+        /**
+         * @brief Sustituye el catálogo y los archivos de los documentos por los de una copia
+         *        hecha con Pin
+         * @return Entradas restauradas
+         * @throws std::runtime_error si la copia está incompleta (no se toca nada)
+         * @note last_id.txt no retrocede: los IDs nunca se reutilizan. Se borran los
+         *       archivos de los documentos que no están en la copia
+         */
+        std::vector<CatalogEntry> Restore(const std::filesystem::path& directory);
+    };
+
+} // namespace DocuTrace::Infrastructure
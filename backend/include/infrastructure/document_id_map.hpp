@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace DocuTrace::Infrastructure
+{
+    /**
+     * @brief ID estable de un documento (el del catálogo, persistido entre reinicios)
+     */
+    using ExternalDocumentId = uint64_t;
+
+    /**
+     * @brief ID denso y compacto usado por las listas de postings y los acumuladores
+     */
+    using InternalDocumentId = uint32_t;
+
+    /**
+     * @brief Traducción entre IDs externos estables e IDs internos densos
+     * @note No es thread-safe por sí mismo; BM25Engine sincroniza el acceso
+     */
+    class DocumentIdMap
+    {
+      private:
+        std::unordered_map<ExternalDocumentId, InternalDocumentId> internal_ids_;
+        std::vector<ExternalDocumentId> external_ids_;
+
+      public:
+        static constexpr InternalDocumentId INVALID_ID =
+            std::numeric_limits<InternalDocumentId>::max();
+
+        std::optional<InternalDocumentId> Find(ExternalDocumentId external_id) const;
+
+        /**
+         * @brief Asigna el siguiente ID interno libre a un ID externo
+         * @return Nuevo ID interno (siempre mayor que todos los anteriores)
+         * @note Si el ID externo ya tenía uno, la asignación anterior queda huérfana
+         */
+        InternalDocumentId Assign(ExternalDocumentId external_id);
+
+        ExternalDocumentId GetExternal(InternalDocumentId internal_id) const
+        {
+            return external_ids_[internal_id];
+        }
+
+        /**
+         * @brief Libera el ID externo; su ID interno se recupera en la compactación
+         */
+        void Release(ExternalDocumentId external_id);
+
+        /**
+         * @brief Renumera los IDs internos tras una compactación
+         * @param remap Nuevo ID por cada ID interno actual (INVALID_ID = eliminado)
+         * @param live_count Número de IDs que sobreviven
+         */
+        void Compact(const std::vector<InternalDocumentId>& remap, size_t live_count);
+
+        /**
+         * @brief IDs actuales de los supervivientes de un remapeo, ordenados por su nuevo ID
+         * @note El remapeo puede reordenar (DocumentOrder::BISECTION); las estructuras que se
+         *       reconstruyen por orden de ID lo recorren con esto
+         */
+        static std::vector<InternalDocumentId> SurvivorsInOrder(
+            const std::vector<InternalDocumentId>& remap, size_t live_count);
+
+        /**
+         * @brief Número de documentos con un ID externo vigente
+         */
+        size_t Size() const
+        {
+            return internal_ids_.size();
+        }
+
+        /**
+         * @brief Número de IDs internos asignados, incluidos los pendientes de compactar
+         */
+        size_t Capacity() const
+        {
+            return external_ids_.size();
+        }
+
+        void Clear();
+    };
+
+} // namespace DocuTrace::Infrastructure
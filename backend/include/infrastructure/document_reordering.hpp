@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include "infrastructure/document_id_map.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    /**
+     * @brief Orden de los IDs internos que deja la compactación (DOCUMENT_ORDER)
+     * @note ARRIVAL conserva el orden de llegada. BISECTION acerca los documentos que
+     *       comparten términos (bisección recursiva del grafo documento-término): los huecos
+     *       entre IDs consecutivos de cada lista se acortan y los segmentos ocupan menos
+     *       (bench/reorder_bench)
+     */
+    enum class DocumentOrder
+    {
+        ARRIVAL,
+        BISECTION
+    };
+
+    /**
+     * @brief Parámetros de la bisección
+     */
+    struct ReorderOptions
+    {
+        // Pasadas de intercambio por partición (se para antes si ya no mejora)
+        size_t iterations = 20;
+        // Las particiones de este tamaño o menos ya no se dividen
+        size_t min_partition = 16;
+        // Los términos de un solo documento no acercan a ningún otro
+        size_t min_document_frequency = 2;
+        // Niveles cuyas dos mitades se reparten entre hilos (hasta 2^n tareas)
+        size_t parallel_depth = 2;
+    };
+
+    /**
+     * @brief Efecto de las reordenaciones de un motor
+     * @note gap_bits es la suma de log2(hueco) de todas las postings: lo que ocuparía cada
+     *       lista con un código de huecos ideal, la medida que la bisección minimiza
+     */
+    struct ReorderStatistics
+    {
+        uint64_t runs = 0;
+        // De la última reordenación de cada partición
+        uint64_t documents = 0;
+        uint64_t postings = 0;
+        double gap_bits_before = 0.0;
+        double gap_bits_after = 0.0;
+        // Acumulado de todas
+        uint64_t duration_ms = 0;
+
+        double GetBitsPerPostingBefore() const;
+        double GetBitsPerPostingAfter() const;
+        void Merge(const ReorderStatistics& other);
+    };
+
+    /**
+     * @brief Reordenación de documentos por bisección recursiva del grafo (BP)
+     * @note Divide los documentos en dos mitades e intercambia los pares que más reducen el
+     *       coste estimado de los huecos (Σ d·log2(n / (d + 1)) por término, con d sus
+     *       documentos en cada mitad de n); luego repite en cada mitad. Coste
+     *       O(postings · iterations · log2(documentos / min_partition))
+     */
+    class DocumentReordering
+    {
+      public:
+        /**
+         * @brief Orden de los documentos que acorta los huecos de las listas
+         * @param document_count Documentos que se ordenan (IDs densos desde 0)
+         * @param lists Listas de postings con IDs ordenados y menores que document_count
+         * @return Los IDs de 0 a document_count - 1 en su nuevo orden
+         */
+        static std::vector<InternalDocumentId> Bisect(
+            size_t document_count, const std::vector<std::vector<InternalDocumentId>>& lists,
+            const ReorderOptions& options = {});
+
+        /**
+         * @brief Σ log2(hueco) de una lista ordenada (el primer ID cuenta desde -1)
+         */
+        static double GapBits(std::span<const InternalDocumentId> list);
+
+        /**
+         * @brief Interpreta "arrival" o "bisection"
+         * @return false si el valor no es reconocido
+         */
+        static bool ParseOrder(const std::string& value, DocumentOrder& order);
+        static const char* OrderName(DocumentOrder order);
+    };
+
+} // namespace DocuTrace::Infrastructure
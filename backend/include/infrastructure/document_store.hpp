@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "infrastructure/document_id_map.hpp"
+#include "shared/mapped_file.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    /**
+     * @brief Texto de los documentos por ID interno, en RAM o en un archivo mapeado
+     * @note Con presupuesto de memoria los textos más antiguos pasan al archivo: solo se
+     *       leen para los resultados que se devuelven. No es thread-safe por sí mismo;
+     *       BM25Engine sincroniza el acceso
+     */
+    class DocumentStore
+    {
+      private:
+        struct Entry
+        {
+            std::string text;
+            // Posición en el archivo frío (solo si cold_size > 0)
+            uint64_t cold_offset = 0;
+            uint32_t cold_size = 0;
+        };
+
+        std::vector<Entry> entries_;
+        std::unique_ptr<Shared::MappedFile> cold_;
+        std::filesystem::path cold_directory_;
+        size_t resident_bytes_ = 0;
+        uint64_t cold_bytes_ = 0;
+        // Los textos se bajan al nivel frío en orden de ID: los anteriores ya lo están
+        size_t spill_cursor_ = 0;
+        mutable Shared::TierHits hits_;
+
+      public:
+        void Reserve(size_t count)
+        {
+            entries_.reserve(count);
+        }
+
+        void Add(std::string text);
+
+        /**
+         * @brief Texto de un documento, contando el acierto en su nivel
+         * @return Vista válida hasta la siguiente modificación del almacén
+         */
+        std::string_view Get(InternalDocumentId document_id) const;
+
+        /**
+         * @brief Como Get pero sin contar en las estadísticas (volcados y segmentos)
+         */
+        std::string_view Peek(InternalDocumentId document_id) const;
+
+        /**
+         * @brief Libera el texto de un documento eliminado
+         * @return Texto que tenía
+         */
+        std::string Release(InternalDocumentId document_id);
+
+        /**
+         * @brief Conserva solo los documentos vivos con su nuevo ID
+         * @note Los textos fríos se copian a un archivo nuevo sin pasar por RAM
+         */
+        void Compact(const std::vector<InternalDocumentId>& remap, size_t live_count);
+
+        /**
+         * @brief Baja al archivo frío los textos más antiguos que sigan en RAM
+         * @param bytes Bytes de RAM que se quieren liberar
+         * @return Bytes liberados
+         * @throws std::runtime_error si no se puede crear o escribir el archivo
+         */
+        size_t SpillOldest(size_t bytes, const std::filesystem::path& directory);
+
+        size_t Size() const
+        {
+            return entries_.size();
+        }
+
+        size_t GetResidentBytes() const
+        {
+            return resident_bytes_;
+        }
+
+        uint64_t GetColdBytes() const
+        {
+            return cold_bytes_;
+        }
+
+        const Shared::TierHits& GetHits() const
+        {
+            return hits_;
+        }
+
+        void Clear();
+    };
+
+} // namespace DocuTrace::Infrastructure
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include "infrastructure/sharded_engine.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    /**
+     * @brief Segmento sellado de una partición: archivo inmutable con su versión
+     */
+    struct SegmentInfo
+    {
+        std::string file;
+        uint64_t version = 0;
+        uint64_t size = 0;
+        uint64_t checksum = 0;
+    };
+
+    /**
+     * @brief Manifiesto de una generación publicada: un segmento por partición
+     * @note Se escribe en un temporal y se renombra, así que un lector nunca ve uno a medias
+     */
+    struct ReplicationManifest
+    {
+        static constexpr const char* FILE_NAME = "manifest.json";
+
+        // Instancia que publica (cambia al reiniciar el escritor) y número de generación
+        std::string writer;
+        uint64_t generation = 0;
+        int64_t published_at_ms = 0;
+        std::vector<SegmentInfo> segments;
+
+        bool IsSameGeneration(const ReplicationManifest& other) const
+        {
+            return writer == other.writer && generation == other.generation;
+        }
+
+        /**
+         * @return nullopt si el archivo no existe o no es un manifiesto válido
+         */
+        static std::optional<ReplicationManifest> Read(const std::filesystem::path& file);
+
+        /**
+         * @throws std::runtime_error si no se puede escribir
+         */
+        void Write(const std::filesystem::path& file) const;
+    };
+
+    /**
+     * @brief Estado de la replicación para las métricas
+     */
+    struct ReplicationStatus
+    {
+        uint64_t generation = 0;
+        uint64_t latest_generation = 0;
+        // Tiempo desde que se publicó una generación que la réplica aún no sirve (0 = al día)
+        int64_t lag_ms = 0;
+    };
+
+    /**
+     * @brief Lado escritor: sella en segmentos las particiones que cambiaron y publica un
+     *        manifiesto nuevo en el directorio compartido
+     * @note Las particiones sin cambios reutilizan su segmento anterior. Se conservan los
+     *       archivos de la generación previa para las réplicas que aún la estén leyendo
+     */
+    class SegmentPublisher
+    {
+      private:
+        std::filesystem::path directory_;
+        std::string writer_id_;
+        // Solo lo modifica Publish; el lock protege las lecturas de GetStatus
+        mutable std::mutex status_mutex_;
+        std::optional<ReplicationManifest> current_;
+        std::vector<std::string> previous_files_;
+        // Partición sellada en cada segmento de current_: un índice sustituido (réplica o
+        // restauración) puede repetir la versión de otro
+        std::vector<std::weak_ptr<const BM25Engine>> sealed_shards_;
+
+        /**
+         * @brief Borra los segmentos que no usan ni la generación actual ni la anterior
+         */
+        void RemoveUnusedSegments() const;
+
+      public:
+        /**
+         * @param directory Directorio compartido con las réplicas (se crea si no existe)
+         */
+        explicit SegmentPublisher(std::filesystem::path directory);
+
+        /**
+         * @brief Publica una generación nueva si alguna partición cambió
+         * @return true si se publicó
+         * @throws std::runtime_error si falla la escritura
+         */
+        bool Publish(const ShardedEngine& engine);
+
+        ReplicationStatus GetStatus() const;
+    };
+
+    /**
+     * @brief Lado réplica: carga los segmentos nuevos del directorio compartido sin volver a
+     *        analizar los documentos
+     * @note Las particiones cuyo segmento no cambió se comparten con el índice anterior
+     */
+    class SegmentReplica
+    {
+      private:
+        std::filesystem::path directory_;
+        std::shared_ptr<const Shared::TextAnalyzer> analyzer_;
+        std::vector<std::shared_ptr<BM25Engine>> shards_;
+
+        // Generación servida y última vista en el directorio, para calcular el retraso
+        mutable std::mutex status_mutex_;
+        std::optional<ReplicationManifest> loaded_;
+        std::optional<ReplicationManifest> latest_;
+
+        std::shared_ptr<BM25Engine> LoadSegment(const SegmentInfo& segment) const;
+
+      public:
+        SegmentReplica(std::filesystem::path directory,
+                       std::shared_ptr<const Shared::TextAnalyzer> analyzer);
+
+        /**
+         * @brief Carga la última generación publicada si es distinta de la actual
+         * @return Índice completo para sustituir al que se sirve (nullptr si no hay cambios)
+         * @throws std::runtime_error si un segmento falta, está truncado o no coincide con
+         *         el manifiesto (se reintenta en la siguiente llamada)
+         */
+        std::shared_ptr<ShardedEngine> Refresh();
+
+        ReplicationStatus GetStatus() const;
+    };
+
+} // namespace DocuTrace::Infrastructure
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "infrastructure/bm25_engine.hpp"
+#include "infrastructure/query_parser.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    /**
+     * @brief Conjunto ordenado de IDs internos
+     */
+    using DocumentSet = std::vector<InternalDocumentId>;
+
+    /**
+     * @brief Planificador y evaluador de consultas booleanas sobre el índice invertido
+     * @note Ordena las intersecciones por longitud de postings ascendente, delega las
+     *       operaciones de conjuntos en Shared::SimdKernels (SIMD o galope según tamaños) y
+     *       aplica los filtros de metadatos como bitset antes de puntuar, una pasada por
+     *       columna de DocValues. Requiere que el llamador mantenga el lock del motor
+     */
+    class QueryEvaluator
+    {
+      private:
+        const InvertedIndex& index_;
+        const std::vector<bool>& tombstones_;
+        const DocValues& doc_values_;
+
+        DocumentSet EvaluateNode(const QueryNode& node) const;
+        DocumentSet EvaluateTerm(const QueryNode& node) const;
+        DocumentSet EvaluateGroup(const QueryNode& node) const;
+
+      public:
+        QueryEvaluator(const InvertedIndex& index, const std::vector<bool>& tombstones,
+                       const DocValues& doc_values);
+
+        /**
+         * @brief Calcula los documentos vivos que satisfacen la consulta
+         * @return IDs internos ordenados
+         */
+        DocumentSet Evaluate(const QueryNode& root) const;
+
+        /**
+         * @brief Estima el coste de evaluar un nodo (número de postings a recorrer)
+         */
+        size_t EstimateCost(const QueryNode& node) const;
+
+        static DocumentSet Intersect(const DocumentSet& a, const DocumentSet& b);
+        static DocumentSet Union(std::span<const InternalDocumentId> a,
+                                 std::span<const InternalDocumentId> b);
+        static DocumentSet Difference(const DocumentSet& a, const DocumentSet& b);
+    };
+
+} // namespace DocuTrace::Infrastructure
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "infrastructure/ranking_models.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    /**
+     * @brief Papel de una cláusula dentro de su grupo
+     * @note MUST: obligatoria, SHOULD: opcional (suma puntuación), MUST_NOT: excluye
+     */
+    enum class QueryOccur
+    {
+        MUST,
+        SHOULD,
+        MUST_NOT
+    };
+
+    /**
+     * @brief Campo de metadatos filtrable
+     */
+    enum class QueryField
+    {
+        FILENAME,
+        AFTER,
+        BEFORE,
+        // Extensión exacta (ext:pdf)
+        EXTENSION,
+        // Directorio o cualquiera por debajo (dir:/datos/informes)
+        DIRECTORY
+    };
+
+    /**
+     * @brief Forma de casar un término contra el diccionario
+     * @note EXACT: término analizado; PREFIX: palabra* (autocompletado);
+     *       FUZZY: palabra~N (tolerancia a erratas, N = 1 o 2 ediciones)
+     */
+    enum class QueryMatch
+    {
+        EXACT,
+        PREFIX,
+        FUZZY
+    };
+
+    /**
+     * @brief Puntuación e ID externo del último resultado ya entregado (search-after)
+     */
+    struct SearchAfter
+    {
+        double score = 0.0;
+        uint64_t document_id = 0;
+    };
+
+    /**
+     * @brief Búsqueda en cascada: una primera fase barata elige candidatos y la segunda solo
+     *        puntúa esos de forma exacta
+     * @note La primera fase recorre las postings de los términos de menos a más frecuentes
+     *       hasta agotar posting_budget (el más raro siempre entra); los demás términos solo
+     *       suman en la segunda fase
+     */
+    struct TwoPhaseOptions
+    {
+        // Candidatos que pasan a la segunda fase (al menos los resultados pedidos)
+        size_t candidates = 300;
+        size_t posting_budget = 100000;
+        // Peso de la cercanía de los términos en el texto (0 = solo el modelo de puntuación)
+        double proximity_weight = 0.0;
+    };
+
+    /**
+     * @brief Campo por el que contar los documentos que casan (facetas)
+     * @note MONTH agrupa por mes UTC de la fecha (AAAA-MM); los documentos sin extensión,
+     *       sin directorio o sin fecha (0) no cuentan en ese campo
+     */
+    enum class FacetField
+    {
+        EXTENSION,
+        MONTH,
+        DIRECTORY
+    };
+
+    enum class SortField
+    {
+        TIMESTAMP,
+        FILENAME
+    };
+
+    /**
+     * @brief Orden de los resultados por un campo de metadatos en vez de por puntuación
+     * @note A igualdad de campo se ordena como SearchResult::Ranks
+     */
+    struct SortOrder
+    {
+        SortField field = SortField::TIMESTAMP;
+        bool descending = false;
+    };
+
+    /**
+     * @brief Opciones de búsqueda que no forman parte del texto de la consulta
+     */
+    struct QueryOptions
+    {
+        // Trata la última palabra como prefijo (búsqueda mientras se escribe)
+        bool prefix_last = false;
+        // Ediciones toleradas en palabras sin coincidencia exacta (0 = desactivado, máx. 2)
+        int fuzzy_edits = 0;
+        // Solo los resultados que SearchResult::Ranks ordena después de esta clave
+        std::optional<SearchAfter> search_after;
+        // Resultados sin texto: quien pagina con un cursor lo recupera página a página
+        bool omit_content = false;
+        // Modelo de puntuación de esta consulta (nullopt = el del motor)
+        std::optional<RankingParameters> ranking;
+        // Solo en consultas sin operadores ni filtros y sin search_after, facets ni sort
+        std::optional<TwoPhaseOptions> two_phase;
+        // Recuentos de los documentos que casan por cada campo (ver FacetCounts)
+        std::vector<FacetField> facets;
+        // Orden por un campo de metadatos; no se combina con search_after
+        std::optional<SortOrder> sort;
+        // Hora límite de la puntuación: al llegar se devuelve lo puntuado hasta entonces (ver
+        // SearchCoverage). No se combina con search_after: las páginas no serían coherentes
+        std::optional<std::chrono::steady_clock::time_point> deadline;
+    };
+
+    /**
+     * @brief Término puntuable con su peso (las expansiones difusas puntúan menos)
+     */
+    struct WeightedTerm
+    {
+        std::string term;
+        double weight = 1.0;
+    };
+
+    struct QueryNode;
+
+    struct QueryClause
+    {
+        QueryOccur occur;
+        std::unique_ptr<QueryNode> node;
+    };
+
+    /**
+     * @brief Nodo del árbol de consulta
+     * @note TERM: tokens normalizados de una palabra; FILTER: condición sobre metadatos;
+     *       GROUP: combinación booleana de cláusulas.
+     *       Los TERM con PREFIX o FUZZY los expande BM25Engine contra el diccionario antes
+     *       de evaluarlos: tokens pasa a contener los términos encontrados
+     */
+    struct QueryNode
+    {
+        enum class Type
+        {
+            TERM,
+            FILTER,
+            GROUP
+        };
+
+        Type type;
+        std::vector<std::string> tokens;
+        QueryField field = QueryField::FILENAME;
+        std::string filter_value;
+        std::time_t filter_timestamp = 0;
+        std::vector<QueryClause> clauses;
+
+        QueryMatch match = QueryMatch::EXACT;
+        // Palabra en minúsculas y sin acentos, sin stemming (patrón de PREFIX/FUZZY)
+        std::string pattern;
+        int max_edits = 0;
+        // FUZZY implícito (QueryOptions::fuzzy_edits): solo si la palabra no existe tal cual
+        bool fuzzy_fallback = false;
+        // Peso de cada token tras la expansión (vacío = todos 1.0)
+        std::vector<double> weights;
+
+        /**
+         * @brief true si el grupo solo contiene términos opcionales (consulta clásica OR)
+         */
+        bool IsPlainDisjunction() const;
+
+        /**
+         * @brief Términos que aportan puntuación (los de cláusulas MUST y SHOULD)
+         */
+        void CollectScoringTerms(std::vector<WeightedTerm>& terms) const;
+
+        /**
+         * @brief true si algún TERM es de prefijo o difuso y hay que expandirlo
+         */
+        bool HasExpandableTerms() const;
+
+        /**
+         * @brief TERM de prefijo o difusos en preorden
+         * @note El orden es estable para una misma consulta y opciones: identifica cada
+         *       término entre nodos que analizan la consulta por separado
+         */
+        void CollectExpandableTerms(std::vector<const QueryNode*>& terms) const;
+    };
+
+    /**
+     * @brief Parser de consultas booleanas con campos
+     * @note Sintaxis: palabras sueltas (OR implícito), +obligatorio, -excluido, AND, OR, NOT,
+     *       paréntesis, "frase" (todos sus términos obligatorios), filename:valor, ext:pdf,
+     *       dir:/ruta, after:AAAA-MM-DD y before:AAAA-MM-DD (o epoch), prefijo* y
+     *       errata~ / errata~2.
+     *       Precedencia: NOT > AND > OR
+     */
+    class QueryParser
+    {
+      public:
+        using Normalizer = std::function<std::vector<std::string>(const std::string&)>;
+
+      private:
+        static constexpr int MAX_EDITS = 2;
+
+        struct Token
+        {
+            enum class Kind
+            {
+                WORD,
+                AND,
+                OR,
+                NOT,
+                LPAREN,
+                RPAREN
+            };
+
+            Kind kind;
+            std::string text;
+            char modifier = '\0';
+            // Palabra entre comillas: todos sus términos son obligatorios
+            bool phrase = false;
+        };
+
+        Normalizer normalize_;
+        Normalizer fold_;
+        QueryOptions options_;
+        std::vector<Token> tokens_;
+        size_t position_ = 0;
+
+        static std::vector<Token> Lex(const std::string& query);
+        bool AtEnd() const;
+        bool Peek(Token::Kind kind) const;
+
+        std::unique_ptr<QueryNode> ParseOr();
+        std::unique_ptr<QueryNode> ParseAnd(QueryOccur& occur);
+        std::unique_ptr<QueryNode> ParseUnary(QueryOccur& occur);
+        std::unique_ptr<QueryNode> MakeWord(const std::string& text, bool phrase);
+
+        /**
+         * @brief Crea un TERM de prefijo o difuso si la palabra lo pide (o fuzzy_edits > 0)
+         * @return nullptr si la palabra se busca de forma exacta
+         */
+        std::unique_ptr<QueryNode> MakeExpandable(const std::string& text);
+
+      public:
+        /**
+         * @param normalize Cadena de análisis completa (la del índice)
+         * @param fold Tokenizado sin stopwords ni stemming para los patrones de prefijo y
+         *        difusos (nullptr = sin soporte de palabra* ni palabra~)
+         */
+        explicit QueryParser(Normalizer normalize, Normalizer fold = nullptr);
+
+        /**
+         * @brief Convierte el texto de la consulta en un árbol
+         * @return Grupo raíz (vacío si la consulta no contiene nada utilizable)
+         */
+        std::unique_ptr<QueryNode> Parse(const std::string& query,
+                                         const QueryOptions& options = {});
+
+        /**
+         * @brief Interpreta una fecha AAAA-MM-DD (UTC) o un epoch en segundos
+         * @return true si el valor es válido
+         */
+        static bool ParseTimestamp(const std::string& value, std::time_t& timestamp);
+    };
+
+} // namespace DocuTrace::Infrastructure
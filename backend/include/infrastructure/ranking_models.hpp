@@ -0,0 +1,297 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "infrastructure/document_id_map.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    /**
+     * @brief Modelo de puntuación (RANKING_MODEL o ranking= por consulta)
+     * @note BM25_PLUS suma delta a la parte de frecuencia para no penalizar de más los
+     *       documentos largos; BM25L desplaza en delta la frecuencia normalizada; BM25F
+     *       combina el texto con el nombre de archivo como segundo campo
+     */
+    enum class RankingModel
+    {
+        BM25,
+        BM25_PLUS,
+        BM25L,
+        BM25F
+    };
+
+    /**
+     * @brief Modelo y parámetros con que se puntúa una consulta
+     */
+    struct RankingParameters
+    {
+        RankingModel model = RankingModel::BM25;
+        double k1 = 1.2;
+        double b = 0.75;
+        // BM25+ y BM25L (ForModel pone 0.5 en BM25L)
+        double delta = 1.0;
+        // BM25F: peso del nombre de archivo frente al texto (1) y su normalización por longitud
+        double filename_weight = 2.0;
+        double filename_b = 0.5;
+
+        bool IsValid() const
+        {
+            return k1 >= 0.0 && b >= 0.0 && b <= 1.0 && delta >= 0.0 && filename_weight >= 0.0 &&
+                   filename_b >= 0.0 && filename_b <= 1.0;
+        }
+
+        /**
+         * @brief Parámetros por defecto de un modelo
+         */
+        static RankingParameters ForModel(RankingModel model);
+
+        /**
+         * @example ParseModel("bm25plus") → BM25_PLUS; ParseModel("tfidf") → nullopt
+         */
+        static std::optional<RankingModel> ParseModel(std::string_view name);
+        static const char* ModelName(RankingModel model);
+    };
+
+    /**
+     * @brief Términos analizados del nombre de archivo de cada documento (segundo campo de
+     *        BM25F)
+     * @note Guarda el hash de cada término y no su texto: basta para contar coincidencias.
+     *       Los IDs internos se añaden en orden, como los metadatos. No es thread-safe por sí
+     *       mismo; BM25Engine sincroniza el acceso
+     */
+    class FilenameField
+    {
+      private:
+        std::vector<uint64_t> terms_;
+        // Términos del documento id: terms_[offsets_[id], offsets_[id + 1])
+        std::vector<uint32_t> offsets_{0};
+        long long total_length_ = 0;
+
+      public:
+        static uint64_t HashTerm(std::string_view term);
+
+        void AddDocument(InternalDocumentId document_id, const std::vector<std::string>& terms);
+        void RemoveDocument(InternalDocumentId document_id);
+
+        uint32_t GetLength(InternalDocumentId document_id) const
+        {
+            return offsets_[document_id + 1] - offsets_[document_id];
+        }
+
+        /**
+         * @brief Veces que aparece el término (por su hash) en el nombre del documento
+         */
+        uint32_t Count(InternalDocumentId document_id, uint64_t term_hash) const
+        {
+            uint32_t count = 0;
+            for (uint32_t i = offsets_[document_id]; i < offsets_[document_id + 1]; ++i)
+            {
+                count += terms_[i] == term_hash ? 1 : 0;
+            }
+            return count;
+        }
+
+        long long GetTotalLength() const
+        {
+            return total_length_;
+        }
+
+        void Compact(const std::vector<InternalDocumentId>& remap, size_t live_count);
+        void Clear();
+    };
+
+    /**
+     * @brief Estadísticas de un término y de la colección con que se puntúan sus postings
+     */
+    struct TermContext
+    {
+        double document_count = 0.0;
+        double document_frequency = 0.0;
+        double average_length = 0.0;
+        // Solo BM25F
+        double average_filename_length = 0.0;
+        uint64_t term_hash = 0;
+        const FilenameField* filename_field = nullptr;
+    };
+
+    inline double InverseDocumentFrequency(double N, double n)
+    {
+        return std::log((N - n + 0.5) / (n + 0.5));
+    }
+
+    // Políticas de puntuación: se construyen una vez por término de la consulta (idf y
+    // parámetros precalculados) y se llaman por posting con la frecuencia del término (f) y
+    // la longitud del documento (dl). Son tipos concretos para que los bucles de puntuación
+    // se instancien por modelo, sin llamadas indirectas por posting. UpperBound es el límite
+    // de la aportación de un posting cuando f crece
+
+    struct Bm25Policy
+    {
+        double idf;
+        double k1;
+        double b;
+        double avdl;
+
+        Bm25Policy(const RankingParameters& parameters, const TermContext& term)
+            : idf(InverseDocumentFrequency(term.document_count, term.document_frequency)),
+              k1(parameters.k1), b(parameters.b), avdl(term.average_length)
+        {
+        }
+
+        double operator()(InternalDocumentId, double f, double dl) const
+        {
+            return idf * ((f * (k1 + 1)) / (f + k1 * (1 - b + b * dl / avdl)));
+        }
+
+        double UpperBound() const
+        {
+            return idf * (k1 + 1);
+        }
+    };
+
+    struct Bm25PlusPolicy
+    {
+        Bm25Policy bm25;
+        double delta;
+
+        Bm25PlusPolicy(const RankingParameters& parameters, const TermContext& term)
+            : bm25(parameters, term), delta(parameters.delta)
+        {
+        }
+
+        double operator()(InternalDocumentId, double f, double dl) const
+        {
+            const double tf_component =
+                (f * (bm25.k1 + 1)) / (f + bm25.k1 * (1 - bm25.b + bm25.b * dl / bm25.avdl));
+            return bm25.idf * (tf_component + delta);
+        }
+
+        double UpperBound() const
+        {
+            return bm25.idf * (bm25.k1 + 1 + delta);
+        }
+    };
+
+    struct Bm25LPolicy
+    {
+        Bm25Policy bm25;
+        double delta;
+
+        Bm25LPolicy(const RankingParameters& parameters, const TermContext& term)
+            : bm25(parameters, term), delta(parameters.delta)
+        {
+        }
+
+        double operator()(InternalDocumentId, double f, double dl) const
+        {
+            const double c = f / (1 - bm25.b + bm25.b * dl / bm25.avdl) + delta;
+            return bm25.idf * (((bm25.k1 + 1) * c) / (bm25.k1 + c));
+        }
+
+        double UpperBound() const
+        {
+            return bm25.UpperBound();
+        }
+    };
+
+    /**
+     * @brief BM25F de dos campos: la frecuencia normalizada del texto y la del nombre de
+     *        archivo (con su peso) se suman antes de saturar con k1
+     * @note Solo puntúa documentos que contienen el término en el texto: las postings no
+     *       incluyen los nombres de archivo
+     */
+    struct Bm25FPolicy
+    {
+        Bm25Policy bm25;
+        double filename_weight;
+        double filename_b;
+        double average_filename_length;
+        uint64_t term_hash;
+        const FilenameField* filename_field;
+
+        Bm25FPolicy(const RankingParameters& parameters, const TermContext& term)
+            : bm25(parameters, term), filename_weight(parameters.filename_weight),
+              filename_b(parameters.filename_b),
+              average_filename_length(term.average_filename_length), term_hash(term.term_hash),
+              filename_field(term.filename_field)
+        {
+        }
+
+        double operator()(InternalDocumentId document_id, double f, double dl) const
+        {
+            double tf = f / (1 - bm25.b + bm25.b * dl / bm25.avdl);
+            if (filename_weight > 0.0 && average_filename_length > 0.0)
+            {
+                const uint32_t in_filename = filename_field->Count(document_id, term_hash);
+                if (in_filename > 0)
+                {
+                    const double fl = filename_field->GetLength(document_id);
+                    tf += filename_weight * in_filename /
+                          (1 - filename_b + filename_b * fl / average_filename_length);
+                }
+            }
+            return bm25.idf * ((tf * (bm25.k1 + 1)) / (bm25.k1 + tf));
+        }
+
+        double UpperBound() const
+        {
+            return bm25.UpperBound();
+        }
+    };
+
+    /**
+     * @brief Llama a visitor.template operator()<Policy>() con la política del modelo
+     * @note El modelo se elige aquí una vez por consulta (o por término); dentro de visitor
+     *       todo el bucle queda especializado
+     * @example VisitRankingModel(model, [&]<typename Policy>() { return Score<Policy>(); })
+     */
+    template <typename Visitor>
+    decltype(auto) VisitRankingModel(RankingModel model, Visitor&& visitor)
+    {
+        switch (model)
+        {
+        case RankingModel::BM25_PLUS:
+            return visitor.template operator()<Bm25PlusPolicy>();
+        case RankingModel::BM25L:
+            return visitor.template operator()<Bm25LPolicy>();
+        case RankingModel::BM25F:
+            return visitor.template operator()<Bm25FPolicy>();
+        case RankingModel::BM25:
+            break;
+        }
+        return visitor.template operator()<Bm25Policy>();
+    }
+
+    /**
+     * @brief Bucle interno de la puntuación clásica: suma weight * policy(...) de cada
+     *        posting a su acumulador, sin los documentos eliminados
+     * @param lengths Cualquier tabla con GetLength(id) (DocumentLengthTable en el motor)
+     */
+    template <typename Policy, typename Lengths>
+    void AccumulatePostings(const Policy& policy, double weight,
+                            std::span<const InternalDocumentId> documents,
+                            std::span<const uint32_t> frequencies, const Lengths& lengths,
+                            const std::vector<bool>& tombstones, std::vector<double>& scores)
+    {
+        for (size_t i = 0; i < documents.size(); ++i)
+        {
+            const InternalDocumentId document_id = documents[i];
+
+            // Documentos eliminados pendientes de compactación
+            if (tombstones[document_id])
+            {
+                continue;
+            }
+
+            const double f = static_cast<double>(frequencies[i]);
+            const double dl = static_cast<double>(lengths.GetLength(document_id));
+            scores[document_id] += weight * policy(document_id, f, dl);
+        }
+    }
+
+} // namespace DocuTrace::Infrastructure
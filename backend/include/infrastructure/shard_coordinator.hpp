@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include "infrastructure/sharded_engine.hpp"
+#include "shared/thread_pool.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    /**
+     * @brief Worker remoto (host:puerto de otra instancia con NODE_ROLE=worker)
+     */
+    struct ShardNode
+    {
+        std::string host;
+        uint16_t port = 0;
+
+        std::string GetName() const
+        {
+            return host + ":" + std::to_string(port);
+        }
+    };
+
+    /**
+     * @brief Resultado de una búsqueda distribuida
+     * @note Los nodos que fallan o no responden a tiempo en una fase quedan fuera de las
+     *       siguientes: la respuesta es parcial pero se sirve igualmente
+     */
+    struct DistributedResults
+    {
+        std::vector<SearchResult> results;
+        // Suma de las de todos los nodos que respondieron (QueryOptions::facets)
+        FacetCounts facets;
+        // Suma de lo que puntuó cada nodo antes de QueryOptions::deadline
+        SearchCoverage coverage;
+        size_t node_count = 0;
+        size_t failed_nodes = 0;
+    };
+
+    /**
+     * @brief Reparte /api/search entre workers por HTTP y mezcla sus top-k
+     * @note Mismas fases que ShardedEngine::Search, con nodos en lugar de particiones:
+     *       expansiones (si hay palabra* o palabra~), estadísticas globales (N, df, longitud)
+     *       y top-k de cada nodo puntuado con ellas. El índice local del coordinador participa
+     *       como un nodo más
+     */
+    class ShardCoordinator
+    {
+      private:
+        std::vector<ShardNode> nodes_;
+        std::chrono::milliseconds timeout_;
+        std::unique_ptr<Shared::ThreadPool> pool_;
+
+        /**
+         * @brief Envía body a path en los nodos activos sin esperar la respuesta
+         * @return Un future por nodo (inválido para los nodos ya descartados)
+         */
+        std::vector<std::future<std::string>> Send(const char* path, const std::string& body,
+                                                   const std::vector<bool>& active) const;
+
+        /**
+         * @brief Espera las respuestas y descarta los nodos que fallan
+         * @return Cuerpo de cada respuesta (vacío para los nodos descartados)
+         */
+        std::vector<std::string> Receive(std::vector<std::future<std::string>>& futures,
+                                         std::vector<bool>& active) const;
+
+      public:
+        /**
+         * @param nodes Workers a consultar
+         * @param timeout Plazo de cada petición a un worker (una por fase)
+         */
+        ShardCoordinator(std::vector<ShardNode> nodes, std::chrono::milliseconds timeout);
+
+        /**
+         * @brief Interpreta una lista "host:puerto,host:puerto"
+         * @throws std::invalid_argument si alguna entrada no es válida
+         */
+        static std::vector<ShardNode> ParseNodes(const std::string& list);
+
+        /**
+         * @brief Busca en el índice local y en todos los workers
+         * @param local Índice del coordinador; también analiza la consulta
+         */
+        DistributedResults Search(const ShardedEngine& local, const std::string& query,
+                                  size_t max_results, const QueryOptions& options = {}) const;
+
+        size_t GetNodeCount() const
+        {
+            return nodes_.size();
+        }
+    };
+
+} // namespace DocuTrace::Infrastructure
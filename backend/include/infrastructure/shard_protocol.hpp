@@ -0,0 +1,75 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "infrastructure/bm25_engine.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    /**
+     * @brief Expansiones candidatas por posición del TERM expandible en preorden
+     * @note Forma de QueryExpansions que viaja entre nodos: los punteros a nodos solo valen
+     *       dentro del árbol que los creó (ver QueryNode::CollectExpandableTerms)
+     */
+    using ExpansionList = std::vector<std::unordered_map<std::string, TermExpansion>>;
+
+    /**
+     * @brief Petición del coordinador a un worker en cualquiera de las tres fases
+     * @note Cada worker vuelve a analizar la consulta: todos los nodos deben usar la misma
+     *       configuración del analizador y de SEARCH_MAX_EXPANSIONS / SEARCH_FUZZY_PENALTY
+     */
+    struct ShardRequest
+    {
+        std::string query;
+        QueryOptions options;
+        size_t max_results = 0;
+        // Fases 2 y 3: candidatos de todos los nodos, que cada worker aplica igual
+        std::optional<ExpansionList> expansions;
+        // Fase 3: estadísticas globales con las que puntuar
+        std::optional<CorpusStatistics> statistics;
+    };
+
+    /**
+     * @brief Top-k de un worker, sus facetas (si la petición las pidió) y cuánto puntuó antes
+     *        de la hora límite
+     */
+    struct ShardResults
+    {
+        std::vector<SearchResult> results;
+        FacetCounts facets;
+        SearchCoverage coverage;
+    };
+
+    /**
+     * @brief Serialización JSON de la búsqueda distribuida (endpoints /internal/shard/)
+     * @note Los Decode lanzan una excepción derivada de std::exception si el JSON no es válido
+     */
+    class ShardProtocol
+    {
+      public:
+        // Endpoints internos de los workers, uno por fase (arrays para usarlos en CROW_ROUTE)
+        static constexpr char EXPANSIONS_PATH[] = "/internal/shard/expansions";
+        static constexpr char STATISTICS_PATH[] = "/internal/shard/statistics";
+        static constexpr char SEARCH_PATH[] = "/internal/shard/search";
+
+        static ExpansionList IndexExpansions(const QueryNode& root,
+                                             const QueryExpansions& expansions);
+        static QueryExpansions BindExpansions(const QueryNode& root,
+                                              const ExpansionList& expansions);
+
+        static std::string EncodeRequest(const ShardRequest& request);
+        static ShardRequest DecodeRequest(const std::string& body);
+
+        static std::string EncodeExpansions(const ExpansionList& expansions);
+        static ExpansionList DecodeExpansions(const std::string& body);
+
+        static std::string EncodeStatistics(const CorpusStatistics& statistics);
+        static CorpusStatistics DecodeStatistics(const std::string& body);
+
+        static std::string EncodeResults(const ShardResults& shard_results);
+        static ShardResults DecodeResults(const std::string& body);
+    };
+
+} // namespace DocuTrace::Infrastructure
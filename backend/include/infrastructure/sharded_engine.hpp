@@ -0,0 +1,213 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "infrastructure/bm25_engine.hpp"
+#include "shared/thread_pool.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    /**
+     * @brief Índice repartido en N particiones BM25Engine por hash del ID de documento
+     * @note Cada partición tiene su propio índice, lock y compactación, así que las escrituras
+     *       en particiones distintas avanzan en paralelo. Las búsquedas se reparten en un pool
+     *       de hilos en tres fases (expansiones, estadísticas y puntuación) para que N, df y
+     *       la longitud media sean los de toda la colección y el ranking coincida con el de
+     *       un índice único. Con una sola partición delega directamente en ella
+     */
+    class ShardedEngine
+    {
+      private:
+        // Compartidas: una réplica reutiliza las particiones que no cambian entre versiones
+        std::vector<std::shared_ptr<BM25Engine>> shards_;
+        std::unique_ptr<Shared::ThreadPool> pool_;
+
+        BM25Engine& ShardFor(ExternalDocumentId document_id) const;
+
+        /**
+         * @brief Ejecuta function(partición) en todas las particiones a la vez y espera
+         * @return Resultado de cada partición, en orden
+         */
+        template <typename Function> auto Scatter(Function&& function) const
+        {
+            using Result = std::invoke_result_t<Function&, const BM25Engine&>;
+            if (!pool_)
+            {
+                return std::vector<Result>{function(std::as_const(*shards_.front()))};
+            }
+
+            std::vector<std::future<Result>> futures;
+            futures.reserve(shards_.size());
+            for (const auto& shard : shards_)
+            {
+                futures.push_back(pool_->Submit([&function, &shard]()
+                                                { return function(std::as_const(*shard)); }));
+            }
+
+            // Esperar a todas antes de propagar un error: las tareas referencian function
+            for (auto& future : futures)
+            {
+                future.wait();
+            }
+
+            std::vector<Result> results;
+            results.reserve(futures.size());
+            for (auto& future : futures)
+            {
+                results.push_back(future.get());
+            }
+            return results;
+        }
+
+      public:
+        /**
+         * @param shard_count Número de particiones (mínimo 1)
+         * @param analyzer Cadena de análisis compartida por todas las particiones
+         */
+        ShardedEngine(size_t shard_count, std::shared_ptr<const Shared::TextAnalyzer> analyzer);
+
+        /**
+         * @brief Agrupa particiones ya cargadas (p. ej. desde segmentos replicados)
+         * @param shards Particiones en orden (mínimo 1)
+         */
+        explicit ShardedEngine(std::vector<std::shared_ptr<BM25Engine>> shards);
+
+        ShardedEngine(const ShardedEngine&) = delete;
+        ShardedEngine& operator=(const ShardedEngine&) = delete;
+
+        size_t GetShardCount() const
+        {
+            return shards_.size();
+        }
+
+        const std::shared_ptr<BM25Engine>& GetShard(size_t shard) const
+        {
+            return shards_[shard];
+        }
+
+        void IndexDocument(ExternalDocumentId document_id, const std::string& content,
+                           const DocumentMetadata& metadata = {});
+
+        /**
+         * @brief Indexa documentos con IDs consecutivos; cada partición recibe los suyos y
+         *        todas indexan en paralelo
+         * @param num_threads Hilos y tamaño de lote de BM25Engine::IndexDocuments cuando hay
+         *        una sola partición; con varias, el paralelismo lo dan las particiones
+         * @return Número de documentos indexados
+         */
+        size_t IndexDocuments(const std::vector<std::string>& documents,
+                              ExternalDocumentId first_document_id, size_t num_threads,
+                              size_t batch_size);
+
+        bool DeleteDocument(ExternalDocumentId document_id);
+        bool UpdateDocument(ExternalDocumentId document_id, const std::string& content,
+                            const DocumentMetadata& metadata = {});
+
+        void SetCompactionRatio(double ratio);
+        void SetExpansionLimits(double fuzzy_penalty, size_t max_expansions);
+        void SetRankingParameters(const RankingParameters& ranking);
+        void SetScoreAccumulator(ScoreAccumulator accumulator);
+        void SetTwoPhaseSampling(size_t every);
+        void SetDocumentOrder(DocumentOrder order);
+
+        /**
+         * @brief Reparte el presupuesto de RAM a partes iguales entre las particiones
+         */
+        void SetMemoryBudget(size_t bytes, const std::filesystem::path& directory);
+
+        /**
+         * @brief Busca en todas las particiones y mezcla sus top-k (k-way merge)
+         * @param facets Si no es nullptr, suma las facetas de options.facets de todas
+         * @param coverage Si no es nullptr, suma lo que cada una puntuó antes de
+         *        options.deadline (todas comparten la misma hora límite)
+         */
+        std::vector<SearchResult> Search(const std::string& query, size_t max_results,
+                                         const QueryOptions& options = {},
+                                         FacetCounts* facets = nullptr,
+                                         SearchCoverage* coverage = nullptr) const;
+
+        /**
+         * @brief Resuelve un lote de consultas con las mismas tres fases que Search, pero una
+         *        sola ronda por partición para todo el lote
+         * @return Resultados de cada consulta, en orden; iguales a los de Search
+         * @note Cada partición puntúa el lote repartido entre sus propios hilos
+         */
+        std::vector<std::vector<SearchResult>> SearchBatch(
+            const std::vector<BatchQuery>& queries) const;
+
+        /**
+         * @brief Analiza la consulta con la cadena de análisis del índice
+         */
+        std::unique_ptr<QueryNode> ParseQuery(const std::string& query,
+                                              const QueryOptions& options = {}) const;
+
+        /**
+         * @brief Fases de Search por separado, para repartir una consulta entre nodos
+         * @note Un coordinador suma las expansiones y estadísticas de todos los nodos antes de
+         *       pedir a cada uno su top-k, igual que Search hace con las particiones
+         */
+        QueryExpansions CollectExpansions(const QueryNode& root) const;
+        void ApplyExpansions(QueryNode& root, const QueryExpansions& expansions) const;
+        CorpusStatistics CollectStatistics(const QueryNode& root) const;
+
+        /**
+         * @brief Postings que leería la consulta en todas las particiones, sin evaluarla
+         * @note Analiza la consulta y mira el diccionario de cada partición en este hilo:
+         *       cuesta microsegundos y sirve para decidir si admitirla (AdmissionControl)
+         */
+        uint64_t EstimateCost(const std::string& query, const QueryOptions& options = {}) const;
+        std::vector<SearchResult> Search(const QueryNode& root, const CorpusStatistics& statistics,
+                                         size_t max_results, const QueryOptions& options = {},
+                                         FacetCounts* facets = nullptr,
+                                         SearchCoverage* coverage = nullptr) const;
+
+        /**
+         * @brief Texto actual de cada documento, de la partición que lo tiene (nullopt si ya
+         *        no está en el índice)
+         */
+        std::vector<std::optional<std::string>> GetContents(
+            const std::vector<ExternalDocumentId>& document_ids) const;
+
+        /**
+         * @brief IDs externos de todos los documentos, partición a partición
+         */
+        std::vector<ExternalDocumentId> GetDocumentIds() const;
+
+        /**
+         * @brief Mezcla listas ya ordenadas por SearchResult::Ranks, o por
+         *        SearchResult::SortsBefore si hay sort (k-way merge)
+         * @return Las max_results primeras
+         */
+        static std::vector<SearchResult> MergeTopResults(
+            std::vector<std::vector<SearchResult>>& lists, size_t max_results,
+            const std::optional<SortOrder>& sort = std::nullopt);
+
+        /**
+         * @brief Suma las sugerencias de cada partición por palabra
+         * @note Cada partición aporta su top-k, así que una palabra que no esté entre las
+         *       mejores de ninguna puede faltar aunque globalmente lo estuviera
+         */
+        std::vector<Suggestion> Suggest(const std::string& prefix, size_t limit) const;
+
+        void Clear();
+        size_t GetDocumentCount() const;
+        size_t GetTombstoneCount() const;
+
+        /**
+         * @brief Suma de los términos de cada partición (los compartidos cuentan varias veces)
+         */
+        size_t GetTermCount() const;
+        size_t GetPostingCount() const;
+        size_t GetSuggestionWordCount() const;
+        MemoryStatistics GetMemoryStatistics() const;
+        TwoPhaseStatistics GetTwoPhaseStatistics() const;
+        ReorderStatistics GetReorderStatistics() const;
+        TermFilterStatistics GetTermFilterStatistics() const;
+    };
+
+} // namespace DocuTrace::Infrastructure
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "infrastructure/content_hash_table.hpp"
+#include "infrastructure/document_catalog.hpp"
+#include "infrastructure/index_replication.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    /**
+     * @brief Descripción de una copia de seguridad, guardada en su snapshot.json
+     */
+    struct SnapshotInfo
+    {
+        static constexpr const char* FILE_NAME = "snapshot.json";
+
+        std::string name;
+        int64_t created_at_ms = 0;
+        int64_t duration_ms = 0;
+        // Posición del catálogo fijada: documentos y último ID reservado
+        size_t documents = 0;
+        uint64_t last_id = 0;
+        size_t linked_files = 0;
+        // Archivos que hubo que copiar porque el destino no admite enlaces
+        size_t copied_files = 0;
+        // Particiones selladas de nuevo; el resto reutiliza el segmento de la copia anterior
+        size_t written_segments = 0;
+
+        /**
+         * @return nullopt si el archivo no existe o no es válido
+         */
+        static std::optional<SnapshotInfo> Read(const std::filesystem::path& file);
+
+        /**
+         * @throws std::runtime_error si no se puede escribir
+         */
+        void Write(const std::filesystem::path& file) const;
+    };
+
+    /**
+     * @brief Copias de seguridad en caliente del directorio de datos y del índice
+     * @note Cada copia es un directorio de enlaces duros: el catálogo con los archivos de
+     *       sus documentos (ver DocumentCatalog::Pin), la tabla de hashes de contenido que
+     *       deduplica las subidas y un segmento por partición con su
+     *       manifiesto, en el formato de la replicación. Los segmentos se sellan en un
+     *       directorio común y solo se reescriben las particiones que cambiaron desde la
+     *       copia anterior. No es thread-safe por sí mismo; SearchService serializa las
+     *       operaciones
+     */
+    class SnapshotStore
+    {
+      private:
+        std::filesystem::path directory_;
+        std::shared_ptr<DocumentCatalog> catalog_;
+        // Opcional: sin ella las copias solo guardan catálogo e índice
+        std::shared_ptr<ContentHashTable> content_hashes_;
+        std::unique_ptr<SegmentPublisher> segments_;
+
+        std::filesystem::path SegmentsDirectory() const
+        {
+            return directory_ / ".segments";
+        }
+
+      public:
+        /**
+         * @param directory Directorio de las copias (se crea si no existe)
+         */
+        SnapshotStore(std::filesystem::path directory, std::shared_ptr<DocumentCatalog> catalog,
+                      std::shared_ptr<ContentHashTable> content_hashes = nullptr);
+
+        // No copyable
+        SnapshotStore(const SnapshotStore&) = delete;
+        SnapshotStore& operator=(const SnapshotStore&) = delete;
+
+        /**
+         * @brief Letras, dígitos, '-', '_' y '.', hasta 64 caracteres y sin '.' inicial
+         */
+        static bool IsValidName(const std::string& name);
+
+        /**
+         * @brief Fija el catálogo y después sella el índice, enlazándolo todo en una copia
+         * @param name Nombre válido, o vacío para usar la fecha y hora UTC
+         * @throws std::invalid_argument si el nombre no es válido o ya existe
+         * @throws std::runtime_error si falla la escritura (no queda una copia a medias)
+         * @note Las subidas, cambios y bajas de documentos esperan desde que se fija el
+         *       catálogo hasta que se sella el índice (DocumentCatalog::LockMutations), para
+         *       que los dos reflejen el mismo instante; las búsquedas siguen
+         */
+        SnapshotInfo Create(const std::string& name, const ShardedEngine& engine);
+
+        /**
+         * @return Copias de la más antigua a la más reciente
+         */
+        std::vector<SnapshotInfo> List() const;
+        std::optional<SnapshotInfo> Find(const std::string& name) const;
+
+        /**
+         * @return true si existía
+         */
+        bool Remove(const std::string& name);
+
+        /**
+         * @brief Abre el índice de una copia sin volver a analizar el texto
+         * @throws std::runtime_error si un segmento falta o no coincide con el manifiesto
+         * @note No modifica la copia: el índice devuelto es independiente de ella
+         */
+        std::shared_ptr<ShardedEngine> Open(
+            const std::string& name, std::shared_ptr<const Shared::TextAnalyzer> analyzer) const;
+
+        /**
+         * @brief Devuelve el catálogo, los archivos de los documentos y la tabla de hashes al
+         *        estado de la copia
+         * @return Entradas restauradas
+         * @throws std::runtime_error si la copia está incompleta
+         * @note En una copia sin tabla de hashes se calcula de nuevo desde los documentos
+         */
+        std::vector<CatalogEntry> RestoreCatalog(const std::string& name);
+    };
+
+} // namespace DocuTrace::Infrastructure
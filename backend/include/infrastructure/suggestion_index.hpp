@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace DocuTrace::Infrastructure
+{
+    /**
+     * @brief Palabra sugerida con el número de documentos que la contienen
+     */
+    struct Suggestion
+    {
+        std::string word;
+        uint32_t document_frequency = 0;
+    };
+
+    /**
+     * @brief Trie de palabras con las MAX_SUGGESTIONS más frecuentes precalculadas en cada nodo
+     * @note Sugerir es bajar por el prefijo y copiar la lista del nodo: O(|prefijo| + k), sin
+     *       recorrer el subárbol. Las altas de documentos actualizan las listas del camino de
+     *       cada palabra en O(|palabra| * k); las bajas solo recalculan los nodos donde la
+     *       palabra estaba entre las mejores, a partir de las listas de sus hijos.
+     *       Tiene su propio lock, independiente del de BM25Engine
+     */
+    class SuggestionIndex
+    {
+      public:
+        static constexpr size_t MAX_SUGGESTIONS = 10;
+
+      private:
+        static constexpr uint32_t NO_WORD = UINT32_MAX;
+
+        struct Node
+        {
+            // Hijos ordenados por carácter
+            std::vector<std::pair<char, uint32_t>> children;
+            uint32_t word = NO_WORD;
+            // Mejores palabras del subárbol: mayor frecuencia primero
+            std::vector<uint32_t> top;
+        };
+
+        std::vector<Node> nodes_;
+        std::vector<std::string> words_;
+        // Documentos vivos que contienen cada palabra (0 = ya no se sugiere)
+        std::vector<uint32_t> frequencies_;
+        std::unordered_map<std::string, uint32_t> word_ids_;
+        size_t live_words_ = 0;
+        mutable std::shared_mutex mutex_;
+
+        /**
+         * @brief true si la palabra a va antes que b (más frecuente o, a igualdad, alfabética)
+         */
+        bool Ranks(uint32_t a, uint32_t b) const;
+
+        uint32_t FindChild(uint32_t node, char c) const;
+        void PromoteLocked(uint32_t node, uint32_t word);
+        void RebuildTopLocked(uint32_t node);
+        void AddWordLocked(const std::string& word, uint32_t count = 1);
+        void RemoveWordLocked(const std::string& word);
+
+      public:
+        SuggestionIndex();
+
+        /**
+         * @brief Suma un documento a la frecuencia de cada palabra
+         * @param words Palabras distintas del documento, en minúsculas y sin acentos
+         */
+        void AddDocument(const std::vector<std::string>& words);
+
+        /**
+         * @brief Igual que AddDocument para un lote, con una sola adquisición del lock
+         */
+        void AddDocuments(const std::vector<std::vector<std::string>>& documents);
+
+        /**
+         * @brief Resta un documento eliminado o reemplazado
+         * @param words Las mismas palabras que se pasaron al añadirlo
+         */
+        void RemoveDocument(const std::vector<std::string>& words);
+
+        /**
+         * @brief Palabras más frecuentes que empiezan por prefix
+         * @param limit Máximo de sugerencias (como mucho MAX_SUGGESTIONS)
+         */
+        std::vector<Suggestion> Suggest(const std::string& prefix, size_t limit) const;
+
+        /**
+         * @brief Palabras presentes en algún documento vivo con su frecuencia
+         */
+        std::vector<Suggestion> GetWords() const;
+
+        /**
+         * @brief Sustituye el contenido por palabras ya contadas (p. ej. de un segmento)
+         */
+        void Restore(const std::vector<Suggestion>& words);
+
+        /**
+         * @brief Número de palabras distintas presentes en algún documento vivo
+         */
+        size_t GetWordCount() const;
+
+        void Clear();
+    };
+
+} // namespace DocuTrace::Infrastructure
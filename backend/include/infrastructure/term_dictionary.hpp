@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace DocuTrace::Infrastructure
+{
+    /**
+     * @brief Término encontrado por una búsqueda aproximada
+     */
+    struct TermMatch
+    {
+        std::string term;
+        // Distancia de edición respecto al patrón (0 = exacto o por prefijo)
+        int distance = 0;
+    };
+
+    /**
+     * @brief Diccionario de términos sobre un trie comprimido (radix trie)
+     * @note Las cadenas de un solo hijo se fusionan en una etiqueta por arista, así que el
+     *       número de nodos es como máximo 2x el de términos. Permite expansión por prefijo y
+     *       búsqueda difusa recorriendo el trie con un autómata de Levenshtein (simulado fila a
+     *       fila) que poda ramas en cuanto superan la distancia máxima.
+     *       No es thread-safe por sí mismo; lo sincroniza quien lo contiene
+     */
+    class TermDictionary
+    {
+      private:
+        struct Node
+        {
+            // Etiqueta de la arista que llega a este nodo
+            std::string label;
+            // Hijos ordenados por el primer byte de su etiqueta
+            std::vector<uint32_t> children;
+            bool terminal = false;
+        };
+
+        std::vector<Node> nodes_;
+        std::vector<uint32_t> free_nodes_;
+        size_t term_count_ = 0;
+
+        uint32_t AllocateNode();
+        void ReleaseNode(uint32_t node);
+
+        /**
+         * @brief Absorbe el único hijo de node (node no terminal tras un borrado)
+         */
+        void MergeWithChild(uint32_t node);
+
+        /**
+         * @brief Posición en children de la arista que empieza por c (o donde insertarla)
+         */
+        size_t FindChild(uint32_t node, char c) const;
+
+        /**
+         * @brief Baja por el trie hasta el nodo cuyo subárbol contiene los términos con
+         *        prefijo text
+         * @param path Recibe la cadena completa hasta ese nodo (puede ser más larga que text)
+         * @return Nodo alcanzado o UINT32_MAX si text no es prefijo de ningún término
+         */
+        uint32_t Descend(const std::string& text, std::string& path) const;
+
+        void CollectTerms(uint32_t node, std::string& path, std::vector<std::string>& out,
+                          size_t limit) const;
+
+        void FuzzyVisit(uint32_t node, const std::string& pattern, int max_distance,
+                        std::string& path, std::vector<int>& rows,
+                        std::vector<TermMatch>& out) const;
+
+      public:
+        TermDictionary();
+
+        /**
+         * @return true si el término no existía
+         */
+        bool Insert(const std::string& term);
+
+        /**
+         * @return true si el término existía y se eliminó
+         */
+        bool Erase(const std::string& term);
+
+        bool Contains(const std::string& term) const;
+
+        /**
+         * @brief Términos que empiezan por prefix, en orden lexicográfico
+         * @param limit Máximo de términos devueltos
+         */
+        std::vector<std::string> PrefixSearch(const std::string& prefix, size_t limit) const;
+
+        /**
+         * @brief Términos que son prefijo de text (p. ej. raíces de una palabra completa)
+         * @param min_length Longitud mínima de los términos devueltos
+         */
+        std::vector<std::string> PrefixesOf(const std::string& text, size_t min_length) const;
+
+        /**
+         * @brief Términos a distancia de edición <= max_distance del patrón
+         * @note Distancia de Damerau-Levenshtein restringida: inserción, borrado,
+         *       sustitución y transposición de letras adyacentes ("einstien" → "einstein")
+         */
+        std::vector<TermMatch> FuzzySearch(const std::string& pattern, int max_distance) const;
+
+        size_t Size() const
+        {
+            return term_count_;
+        }
+
+        size_t GetNodeCount() const
+        {
+            return nodes_.size() - free_nodes_.size();
+        }
+
+        void Clear();
+    };
+
+} // namespace DocuTrace::Infrastructure
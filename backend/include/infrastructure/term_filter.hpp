@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "shared/binary_io.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    /**
+     * @brief Filtro binary fuse de 8 bits sobre los términos de un índice sellado
+     * @note Responde "seguro que no está" o "puede estar" con ~9 bits por término y un 0,4 %
+     *       de falsos positivos (1/256), sin falsos negativos. Cada consulta son tres lecturas
+     *       de un byte en lugar de bajar por el diccionario. Es estático: los términos que se
+     *       añaden después de construirlo los lleva aparte quien lo usa (InvertedIndex)
+     */
+    class TermFilter
+    {
+      private:
+        static constexpr uint32_t MAX_SEGMENT_LENGTH = 1u << 18;
+        static constexpr int MAX_ATTEMPTS = 100;
+
+        uint64_t seed_ = 0;
+        uint64_t key_count_ = 0;
+        uint32_t segment_length_ = 0;
+        uint32_t segment_count_length_ = 0;
+        std::vector<uint8_t> fingerprints_;
+
+        /**
+         * @brief Tamaño de los segmentos y del array para key_count claves
+         */
+        void Allocate(uint64_t key_count);
+
+        /**
+         * @brief Posición de la clave mezclada en cada uno de los tres segmentos consecutivos
+         */
+        uint32_t Position(int index, uint64_t mixed) const;
+
+      public:
+        /**
+         * @brief Hash de un término tal como lo guarda el filtro
+         */
+        static uint64_t Hash(std::string_view term);
+
+        /**
+         * @brief Construye el filtro con los hashes de todos los términos
+         * @param hashes Hashes de Hash (los repetidos se descartan)
+         * @return false si no se pudo construir (el filtro queda vacío)
+         */
+        bool Build(std::vector<uint64_t> hashes);
+
+        /**
+         * @return false si el término seguro que no estaba al construir el filtro (uno vacío
+         *         no descarta ninguno)
+         */
+        bool MayContain(uint64_t hash) const;
+
+        uint64_t GetKeyCount() const
+        {
+            return key_count_;
+        }
+
+        size_t GetSizeBytes() const
+        {
+            return fingerprints_.size();
+        }
+
+        void Write(Shared::BinaryWriter& writer) const;
+
+        /**
+         * @throws std::runtime_error si las dimensiones no cuadran con el número de claves
+         */
+        static TermFilter Read(Shared::BinaryReader& reader);
+    };
+
+    /**
+     * @brief Consultas al diccionario que pasaron por el filtro de términos
+     */
+    struct TermFilterHits
+    {
+        // Descartadas por el filtro sin tocar el diccionario
+        std::atomic<uint64_t> skipped{0};
+        // Buscadas en el diccionario (el filtro dijo "puede estar")
+        std::atomic<uint64_t> passed{0};
+        // De las anteriores, las que no estaban
+        std::atomic<uint64_t> false_positives{0};
+
+        TermFilterHits() = default;
+        TermFilterHits(TermFilterHits&& other) noexcept
+            : skipped(other.skipped.load()), passed(other.passed.load()),
+              false_positives(other.false_positives.load())
+        {
+        }
+        TermFilterHits& operator=(TermFilterHits&& other) noexcept
+        {
+            skipped = other.skipped.load();
+            passed = other.passed.load();
+            false_positives = other.false_positives.load();
+            return *this;
+        }
+    };
+
+    /**
+     * @brief Filtros de términos de un motor (o de todas sus particiones)
+     */
+    struct TermFilterStatistics
+    {
+        // Términos cubiertos por el filtro y los añadidos desde que se selló
+        uint64_t terms = 0;
+        uint64_t unsealed_terms = 0;
+        uint64_t bytes = 0;
+        uint64_t skipped = 0;
+        uint64_t passed = 0;
+        uint64_t false_positives = 0;
+
+        uint64_t GetLookups() const
+        {
+            return skipped + passed;
+        }
+
+        /**
+         * @return Fracción de búsquedas resueltas sin tocar el diccionario
+         */
+        double GetSkipRate() const;
+
+        /**
+         * @return Fracción de búsquedas cuyo término estaba en el índice
+         */
+        double GetHitRate() const;
+
+        /**
+         * @return Fracción de los términos ausentes que el filtro dejó pasar
+         */
+        double GetFalsePositiveRate() const;
+
+        double GetBitsPerTerm() const;
+        void Merge(const TermFilterStatistics& other);
+    };
+
+} // namespace DocuTrace::Infrastructure
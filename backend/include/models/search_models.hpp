@@ -1,6 +1,10 @@
 #pragma once
 
 #include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <ctime>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -10,14 +14,74 @@ namespace DocuTrace::Models
     {
         std::string content;
         double score;
-        int document_id;
+        uint64_t document_id;
+        // Worker que lo devolvió en modo coordinador (vacío = índice local)
+        std::string node;
+        std::string filename;
+        std::time_t timestamp = 0;
 
-        SearchResult(const std::string& content, double score, int doc_id)
+        SearchResult(const std::string& content, double score, uint64_t doc_id)
             : content(content), score(score), document_id(doc_id)
         {
         }
     };
 
+    /**
+     * @brief Documentos que casan con un valor de una faceta
+     */
+    struct FacetBucket
+    {
+        std::string value;
+        uint64_t count = 0;
+    };
+
+    /**
+     * @brief Recuentos de un campo sobre todos los documentos que casan
+     * @note month va en orden cronológico; extension y directory de más a menos documentos
+     */
+    struct Facet
+    {
+        std::string field;
+        std::vector<FacetBucket> buckets;
+    };
+
+    /**
+     * @brief Resultados de una búsqueda
+     * @note En modo coordinador los workers que fallan o no responden a tiempo se omiten y
+     *       la respuesta se marca como parcial
+     */
+    struct SearchResponse
+    {
+        std::vector<SearchResult> results;
+        // Workers consultados (0 fuera del modo coordinador) y cuántos fallaron
+        size_t nodes_total = 0;
+        size_t nodes_failed = 0;
+        // Token de la página siguiente de un cursor (vacío = no hay más o no se paginó)
+        std::string next_cursor;
+        // Solo si se pidieron (en un cursor, con la primera página)
+        std::vector<Facet> facets;
+        // Se agotó timeout_ms: results son los mejores puntuados hasta entonces
+        bool timed_out = false;
+        // Fracción estimada de la puntuación que se llegó a calcular (1 = completa)
+        double quality = 1.0;
+
+        bool IsPartial() const
+        {
+            return nodes_failed > 0 || timed_out;
+        }
+    };
+
+    /**
+     * @brief Puntuación e ID del último resultado ya recibido
+     * @note Los resultados siguientes puntúan menos o, con la misma puntuación, tienen un ID
+     *       mayor
+     */
+    struct SearchAfter
+    {
+        double score = 0.0;
+        uint64_t document_id = 0;
+    };
+
     /**
      * @brief DTO para request de búsqueda
      * @note Data Transfer Object para comunicación HTTP
@@ -26,20 +90,134 @@ namespace DocuTrace::Models
     {
         std::string query;
         size_t limit = 10;
+        // La última palabra se trata como prefijo (búsqueda mientras se escribe)
+        bool autocomplete = false;
+        // Ediciones toleradas en palabras que no existen en el índice (0-2)
+        int fuzzy = 0;
+        // Abre un cursor: la clasificación se calcula una vez y las páginas siguientes se
+        // piden con next_cursor
+        bool paginate = false;
+        // Continúa tras un resultado sin cursor (p. ej. cuando el cursor ya caducó)
+        std::optional<SearchAfter> search_after;
+        // Modelo de puntuación y parámetros de esta consulta (vacío = los del servidor)
+        std::string ranking;
+        std::optional<double> k1;
+        std::optional<double> b;
+        // Búsqueda en dos fases (vacío = TWO_PHASE); candidates y proximity la activan
+        std::optional<bool> two_phase;
+        std::optional<size_t> candidates;
+        std::optional<double> proximity;
+        // Campos de los que contar los documentos que casan: extension, month o directory
+        std::vector<std::string> facets;
+        // Orden por campo en vez de por puntuación: timestamp o filename ('-' = descendente)
+        std::string sort;
+        // Tiempo máximo de puntuación: al agotarse se devuelven resultados parciales
+        std::optional<uint32_t> timeout_ms;
+
+        static constexpr size_t MAX_CANDIDATES = 10000;
+        static constexpr uint32_t MAX_TIMEOUT_MS = 60000;
+
+        static bool IsRankingModel(const std::string& name)
+        {
+            return name == "bm25" || name == "bm25plus" || name == "bm25l" || name == "bm25f";
+        }
+
+        static bool IsFacetField(const std::string& name)
+        {
+            return name == "extension" || name == "month" || name == "directory";
+        }
+
+        static bool IsSortField(const std::string& name)
+        {
+            return name == "timestamp" || name == "-timestamp" || name == "filename" ||
+                   name == "-filename";
+        }
+
+        bool IsValid() const
+        {
+            // Un cursor o search_after continúan por puntuación: no se combinan con sort, ni
+            // con timeout_ms (cada página podría cortarse en un punto distinto)
+            return !query.empty() && limit > 0 && limit <= 100 && fuzzy >= 0 && fuzzy <= 2 &&
+                   (ranking.empty() || IsRankingModel(ranking)) && (!k1 || *k1 >= 0.0) &&
+                   (!b || (*b >= 0.0 && *b <= 1.0)) &&
+                   (!candidates || (*candidates > 0 && *candidates <= MAX_CANDIDATES)) &&
+                   (!proximity || *proximity >= 0.0) &&
+                   std::all_of(facets.begin(), facets.end(), IsFacetField) &&
+                   (sort.empty() || (IsSortField(sort) && !paginate && !search_after)) &&
+                   (!timeout_ms || (*timeout_ms > 0 && *timeout_ms <= MAX_TIMEOUT_MS &&
+                                    !paginate && !search_after));
+        }
+    };
+
+    /**
+     * @brief DTO para pedir la página siguiente de un cursor
+     */
+    struct SearchPageRequest
+    {
+        std::string cursor;
+        size_t limit = 10;
 
         bool IsValid() const
         {
-            return !query.empty() && limit > 0 && limit <= 100;
+            return !cursor.empty() && limit > 0 && limit <= 100;
         }
     };
 
+    /**
+     * @brief DTO para request de búsqueda por lotes
+     */
+    struct SearchBatchRequest
+    {
+        static constexpr size_t MAX_QUERIES = 1000;
+
+        std::vector<SearchRequest> queries;
+
+        bool IsValid() const
+        {
+            return !queries.empty() && queries.size() <= MAX_QUERIES &&
+                   std::all_of(queries.begin(), queries.end(),
+                               [](const SearchRequest& query) { return query.IsValid(); });
+        }
+    };
+
+    /**
+     * @brief DTO para request de autocompletado
+     */
+    struct SuggestRequest
+    {
+        std::string prefix;
+        size_t limit = 5;
+
+        bool IsValid() const
+        {
+            return !prefix.empty() && limit > 0 && limit <= 10;
+        }
+    };
+
+    /**
+     * @brief Palabra propuesta para completar el texto escrito
+     */
+    struct Suggestion
+    {
+        // Texto escrito con la última palabra completada
+        std::string text;
+        std::string word;
+        uint32_t document_frequency = 0;
+    };
+
     /**
      * @brief DTO para request de indexación de documento único
      */
     struct IndexDocumentRequest
     {
-        size_t document_id;
+        uint64_t document_id;
         std::string content;
+        // Metadatos para los filtros filename:, ext:, dir:, after: y before:, las facetas
+        // y el orden por campo
+        std::string filename;
+        std::time_t timestamp = 0;
+        // Carpeta de origen (solo los archivos del rastreador de carpetas)
+        std::string directory;
 
         bool IsValid() const
         {
@@ -53,6 +231,8 @@ namespace DocuTrace::Models
     struct IndexDocumentsRequest
     {
         std::vector<std::string> documents;
+        // ID externo del primer documento; los siguientes son consecutivos
+        uint64_t first_document_id = 0;
 
         bool IsValid() const
         {
@@ -68,8 +248,106 @@ namespace DocuTrace::Models
     struct SystemStats
     {
         size_t total_documents = 0;
+        size_t pending_deletions = 0;
+        size_t total_terms = 0;
+        size_t total_postings = 0;
+        size_t suggestion_words = 0;
         std::string engine_type = "BM25";
+        // Modelo de puntuación por defecto (RANKING_MODEL)
+        std::string ranking_model = "bm25";
         std::string version = "2.0.0";
+        // REPLICATION_MODE y generación servida; el retraso solo es distinto de 0 en réplicas
+        std::string replication_mode = "none";
+        uint64_t replication_generation = 0;
+        uint64_t replication_latest_generation = 0;
+        int64_t replication_lag_ms = 0;
+        // INDEX_MEMORY_MB: postings y textos en RAM y en archivos mapeados, y lecturas de cada
+        // nivel
+        size_t memory_budget_bytes = 0;
+        size_t memory_resident_bytes = 0;
+        uint64_t memory_cold_bytes = 0;
+        // Columnas de metadatos (DocValues), siempre en RAM
+        size_t memory_metadata_bytes = 0;
+        uint64_t posting_hits_resident = 0;
+        uint64_t posting_hits_cold = 0;
+        uint64_t document_hits_resident = 0;
+        uint64_t document_hits_cold = 0;
+        // Cursores de paginación abiertos
+        size_t open_cursors = 0;
+        // Búsquedas en dos fases: medias por consulta y recall de las muestreadas
+        uint64_t two_phase_queries = 0;
+        double two_phase_candidates = 0.0;
+        double two_phase_deferred_terms = 0.0;
+        double two_phase_first_phase_ms = 0.0;
+        double two_phase_second_phase_ms = 0.0;
+        uint64_t two_phase_sampled_queries = 0;
+        double two_phase_recall = 1.0;
+        // DOCUMENT_ORDER y efecto de la última reordenación de cada partición (bits por
+        // posting con un código de huecos ideal)
+        std::string document_order = "arrival";
+        uint64_t reorder_runs = 0;
+        uint64_t reorder_documents = 0;
+        double reorder_bits_per_posting_before = 0.0;
+        double reorder_bits_per_posting_after = 0.0;
+        uint64_t reorder_duration_ms = 0;
+        // Filtros de términos de las particiones: búsquedas resueltas sin tocar el
+        // diccionario, las que encontraron el término y ausentes que el filtro dejó pasar
+        uint64_t term_filter_terms = 0;
+        uint64_t term_filter_unsealed_terms = 0;
+        double term_filter_bits_per_term = 0.0;
+        uint64_t term_filter_lookups = 0;
+        double term_filter_skip_rate = 0.0;
+        double term_filter_hit_rate = 0.0;
+        double term_filter_false_positive_rate = 0.0;
+    };
+
+    /**
+     * @brief DTO para crear una copia de seguridad
+     */
+    struct SnapshotRequest
+    {
+        // Vacío: fecha y hora UTC (AAAAMMDD-HHMMSS)
+        std::string name;
+
+        bool IsValid() const
+        {
+            return name.empty() ||
+                   (name.size() <= 64 && name.front() != '.' &&
+                    std::all_of(name.begin(), name.end(),
+                                [](unsigned char c)
+                                { return std::isalnum(c) || c == '-' || c == '_' || c == '.'; }));
+        }
+    };
+
+    /**
+     * @brief DTO de una copia de seguridad del directorio de datos y del índice
+     */
+    struct SnapshotInfo
+    {
+        std::string name;
+        int64_t created_at_ms = 0;
+        int64_t duration_ms = 0;
+        // Documentos del catálogo y último ID reservado en el instante de la copia
+        size_t documents = 0;
+        uint64_t last_id = 0;
+        size_t linked_files = 0;
+        size_t copied_files = 0;
+        size_t written_segments = 0;
+    };
+
+    /**
+     * @brief DTO con el resultado de volver al estado de una copia
+     */
+    struct SnapshotRestoreResult
+    {
+        SnapshotInfo snapshot;
+        // Documentos del índice restaurado
+        size_t documents = 0;
+        // Del catálogo de la copia que el índice sellado aún no tenía
+        size_t reindexed_documents = 0;
+        // Subidos después de la copia: ya no existen
+        std::vector<uint64_t> removed_documents;
+        int64_t duration_ms = 0;
     };
 
     /**
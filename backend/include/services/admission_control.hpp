@@ -0,0 +1,231 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+namespace DocuTrace::Services
+{
+    /**
+     * @brief Clase de una petición, de más a menos prioritaria
+     */
+    enum class RequestPriority
+    {
+        // /api/search: alguien espera la respuesta
+        INTERACTIVE,
+        // /api/search/batch
+        BATCH,
+        // Subidas y reemplazos de documentos
+        INGEST
+    };
+
+    /**
+     * @brief Límites del control de admisión (ADMISSION_*)
+     */
+    struct AdmissionOptions
+    {
+        bool enabled = true;
+        // Peticiones en ejecución a la vez (0 = hilos del hardware)
+        size_t max_concurrent = 0;
+        // Postings que pueden leer a la vez las consultas en ejecución (0 = sin límite)
+        uint64_t cost_budget = 50'000'000;
+        // Peticiones que pueden esperar turno, entre todas las clases
+        size_t queue_size = 64;
+        // Espera máxima en la cola antes de rechazar con 503
+        std::chrono::milliseconds queue_timeout{500};
+    };
+
+    /**
+     * @brief Motivo por el que una petición no se ejecuta
+     */
+    enum class AdmissionStatus
+    {
+        ADMITTED,
+        // La consulta sola supera la mitad del presupuesto y no cabe ahora (429)
+        TOO_EXPENSIVE,
+        // Cola llena (503)
+        QUEUE_FULL,
+        // Esperó queue_timeout sin turno (503)
+        TIMED_OUT
+    };
+
+    /**
+     * @brief Contadores de una clase de petición
+     */
+    struct AdmissionClassStats
+    {
+        uint64_t admitted = 0;
+        // Admitidas tras esperar en la cola
+        uint64_t queued = 0;
+        uint64_t rejected_cost = 0;
+        uint64_t rejected_queue_full = 0;
+        uint64_t timed_out = 0;
+        size_t running = 0;
+        size_t waiting = 0;
+        // Espera en la cola (0 para las que entraron sin esperar) de las admitidas y de las
+        // que agotaron el tiempo
+        double avg_queue_ms = 0.0;
+        double max_queue_ms = 0.0;
+    };
+
+    struct AdmissionStats
+    {
+        bool enabled = false;
+        size_t max_concurrent = 0;
+        uint64_t cost_budget = 0;
+        uint64_t cost_in_flight = 0;
+        // Media móvil de la duración de las peticiones admitidas
+        double avg_service_ms = 0.0;
+        std::array<AdmissionClassStats, 3> classes;
+    };
+
+    class AdmissionControl;
+
+    /**
+     * @brief Turno de una petición: mientras existe ocupa su hueco y su coste
+     * @note Movible; al destruirse libera el turno y despierta a la siguiente de la cola
+     */
+    class Admission
+    {
+      private:
+        friend class AdmissionControl;
+
+        // nullptr si no se admitió o el control está desactivado
+        AdmissionControl* control_ = nullptr;
+        RequestPriority priority_ = RequestPriority::INTERACTIVE;
+        uint64_t charge_ = 0;
+        std::chrono::steady_clock::time_point start_;
+        AdmissionStatus status_ = AdmissionStatus::ADMITTED;
+        std::chrono::seconds retry_after_{0};
+
+      public:
+        Admission() = default;
+        Admission(Admission&& other) noexcept;
+        Admission& operator=(Admission&& other) noexcept;
+        Admission(const Admission&) = delete;
+        Admission& operator=(const Admission&) = delete;
+        ~Admission();
+
+        bool IsAdmitted() const
+        {
+            return status_ == AdmissionStatus::ADMITTED;
+        }
+
+        AdmissionStatus GetStatus() const
+        {
+            return status_;
+        }
+
+        /**
+         * @brief Segundos tras los que conviene reintentar (cabecera Retry-After)
+         */
+        std::chrono::seconds GetRetryAfter() const
+        {
+            return retry_after_;
+        }
+    };
+
+    /**
+     * @brief Limita las peticiones en ejecución por número y por coste estimado
+     * @note Cada petición ocupa un hueco de max_concurrent y cuenta su coste (postings que
+     *       leerá, ver ShardedEngine::EstimateCost) contra cost_budget; como mucho la mitad
+     *       del presupuesto, para que una consulta cara nunca deje sin sitio a las baratas.
+     *       Las clases menos prioritarias solo entran si queda holgura: BATCH con menos de
+     *       la mitad de los huecos y del presupuesto ocupados, INGEST con menos de la cuarta
+     *       parte. Lo que no cabe espera en una cola común, de la que sale siempre la primera
+     *       de la clase más prioritaria, y una petición nueva no adelanta a las que ya
+     *       esperan con su prioridad o más aunque quepa; una consulta que ya ocupa media cuota
+     *       no espera: se rechaza si no cabe al llegar. Con el servidor ocioso cualquier
+     *       petición se admite
+     */
+    class AdmissionControl
+    {
+      private:
+        friend class Admission;
+
+        struct Waiter
+        {
+            RequestPriority priority;
+            uint64_t charge;
+            bool admitted = false;
+        };
+
+        AdmissionOptions options_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable wakeup_;
+        // Cola de cada clase en orden de llegada
+        std::array<std::deque<Waiter*>, 3> waiting_;
+        std::array<size_t, 3> running_{};
+        size_t total_running_ = 0;
+        size_t total_waiting_ = 0;
+        uint64_t cost_in_flight_ = 0;
+        double avg_service_ms_ = 0.0;
+        std::array<AdmissionClassStats, 3> stats_{};
+        std::array<double, 3> total_queue_ms_{};
+
+        size_t SlotLimit(RequestPriority priority) const;
+        uint64_t CostLimit(RequestPriority priority) const;
+
+        /**
+         * @brief true si la petición cabe en la holgura de su clase
+         */
+        bool Fits(RequestPriority priority, uint64_t charge) const;
+
+        /**
+         * @brief true si alguna petición de esta prioridad o más ya espera turno
+         */
+        bool HasWaitersAhead(RequestPriority priority) const;
+
+        /**
+         * @brief Admite por orden de prioridad y de llegada a los que esperan y ya caben
+         * @return true si admitió a alguno
+         * @note Se detiene en el primero que no cabe: nadie que llegó después lo adelanta
+         */
+        bool AdmitWaiters();
+
+        void Start(RequestPriority priority, uint64_t charge);
+        void RecordQueueTime(RequestPriority priority, double queue_ms);
+        std::chrono::seconds RetryAfter() const;
+
+        /**
+         * @brief Devuelve el hueco y el coste de un turno (lo llama ~Admission)
+         */
+        void Release(const Admission& admission);
+
+      public:
+        explicit AdmissionControl(AdmissionOptions options);
+
+        // No copyable: los turnos guardan this
+        AdmissionControl(const AdmissionControl&) = delete;
+        AdmissionControl& operator=(const AdmissionControl&) = delete;
+
+        /**
+         * @brief Lee ADMISSION_CONTROL, ADMISSION_MAX_CONCURRENT, ADMISSION_COST_BUDGET,
+         *        ADMISSION_QUEUE_SIZE y ADMISSION_QUEUE_TIMEOUT_MS
+         */
+        static AdmissionOptions ReadOptions();
+
+        /**
+         * @brief Espera turno, como mucho queue_timeout
+         * @param cost Postings estimados (0 si no es una consulta)
+         * @return Turno admitido, o el motivo del rechazo y cuándo reintentar
+         * @note Bloquea el hilo que llama mientras espera
+         */
+        Admission Admit(RequestPriority priority, uint64_t cost);
+
+        const AdmissionOptions& GetOptions() const
+        {
+            return options_;
+        }
+
+        AdmissionStats GetStats() const;
+
+        static const char* PriorityName(RequestPriority priority);
+    };
+
+} // namespace DocuTrace::Services
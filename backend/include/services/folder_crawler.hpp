@@ -0,0 +1,168 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+#include "infrastructure/document_catalog.hpp"
+#include "services/search_service.hpp"
+#include "shared/directory_watcher.hpp"
+#include "shared/thread_pool.hpp"
+
+namespace DocuTrace::Services
+{
+    /**
+     * @brief Carpetas que se mantienen indexadas y cómo se vigilan (CRAWL_*)
+     */
+    struct CrawlerOptions
+    {
+        std::vector<std::filesystem::path> roots;
+        // Extensiones indexadas, en minúsculas y con el punto
+        std::vector<std::string> extensions{".txt"};
+        // Hilos del recorrido y de la lectura de archivos (0 = hilos del hardware)
+        size_t threads = 0;
+        // Silencio que se espera tras un cambio antes de aplicar la ráfaga
+        std::chrono::milliseconds debounce{500};
+        // Recorrido completo periódico (0 = solo al arrancar y si se pierden eventos)
+        std::chrono::seconds rescan_interval{0};
+    };
+
+    /**
+     * @brief Contadores acumulados del rastreador
+     */
+    struct CrawlerStats
+    {
+        uint64_t files = 0;
+        uint64_t added = 0;
+        uint64_t updated = 0;
+        uint64_t removed = 0;
+        // Archivos revisados cuyo tamaño y fecha no cambiaron
+        uint64_t unchanged = 0;
+        uint64_t rescans = 0;
+        size_t watches = 0;
+    };
+
+    /**
+     * @brief Mantiene sincronizados con el índice los archivos de unas carpetas locales
+     * @note Al arrancar recorre las carpetas en paralelo e indexa sus archivos; después
+     *       vigila los cambios (inotify), los agrupa hasta que pasa debounce sin ninguno y
+     *       solo revisa las rutas afectadas. Un archivo se vuelve a leer si cambian su tamaño
+     *       o su fecha de modificación. Los documentos no pasan por el catálogo: el índice
+     *       vive en memoria y se reconstruye desde las carpetas en cada arranque; los IDs se
+     *       reservan en el catálogo para no chocar con los de /api/upload. La tabla de
+     *       archivos se guarda en el directorio de datos (crawler_files.json), así cada
+     *       archivo conserva su ID entre arranques y solo se reservan IDs para los nuevos
+     */
+    class FolderCrawler
+    {
+      private:
+        struct WatchedFile
+        {
+            uint64_t document_id;
+            uintmax_t size;
+            std::filesystem::file_time_type::rep modified;
+        };
+
+        // Archivo encontrado al recorrer
+        struct FileState
+        {
+            std::string path;
+            uintmax_t size;
+            std::filesystem::file_time_type::rep modified;
+        };
+
+        std::shared_ptr<SearchService> search_service_;
+        std::shared_ptr<Infrastructure::DocumentCatalog> catalog_;
+        CrawlerOptions options_;
+        Shared::ThreadPool pool_;
+        Shared::DirectoryWatcher watcher_;
+        // Archivos indexados por ruta, en orden para recorrer los de un directorio. Solo los
+        // usa el hilo del rastreador
+        std::map<std::string, WatchedFile> files_;
+        std::filesystem::path table_file_;
+        bool watch_limit_reached_ = false;
+
+        std::atomic<uint64_t> file_count_{0};
+        std::atomic<uint64_t> added_{0};
+        std::atomic<uint64_t> updated_{0};
+        std::atomic<uint64_t> removed_{0};
+        std::atomic<uint64_t> unchanged_{0};
+        std::atomic<uint64_t> rescans_{0};
+        std::atomic<size_t> watches_{0};
+        std::atomic<bool> reindex_requested_{false};
+
+        // Último miembro: se detiene antes de destruir lo que usa
+        std::jthread thread_;
+
+        bool IsIndexable(const std::filesystem::path& path) const;
+
+        /**
+         * @brief Recupera files_ del arranque anterior, solo con las rutas bajo roots
+         * @note El índice empieza vacío: todos cuentan como cambiados y se vuelven a leer con
+         *       su ID de antes
+         */
+        void LoadTable();
+
+        /**
+         * @brief Guarda files_ (JSON compacto, reemplazo atómico)
+         */
+        void SaveTable() const;
+
+        /**
+         * @brief Archivos indexables bajo directories, un nivel del árbol a la vez con los
+         *        directorios de cada nivel repartidos entre los hilos
+         * @note Cada directorio se vigila antes de listarlo, para no perder los archivos que
+         *       se creen mientras tanto
+         */
+        std::vector<FileState> Walk(std::vector<std::filesystem::path> directories,
+                                    std::stop_token stop);
+
+        /**
+         * @brief Compara las rutas con lo indexado y aplica altas, cambios y bajas
+         * @param scopes Archivos o directorios (enteros) que revisar
+         */
+        void Synchronize(std::vector<std::filesystem::path> scopes, std::stop_token stop);
+
+        /**
+         * @brief Bucle del hilo: recorrido inicial y después eventos agrupados
+         */
+        void Run(std::stop_token stop);
+
+      public:
+        /**
+         * @brief Empieza a sincronizar en segundo plano
+         * @param catalog Solo para reservar IDs
+         */
+        FolderCrawler(std::shared_ptr<SearchService> search_service,
+                      std::shared_ptr<Infrastructure::DocumentCatalog> catalog,
+                      CrawlerOptions options);
+
+        // No copyable ni movible: el hilo guarda this
+        FolderCrawler(const FolderCrawler&) = delete;
+        FolderCrawler& operator=(const FolderCrawler&) = delete;
+
+        /**
+         * @brief Lee CRAWL_DIRS, CRAWL_EXTENSIONS, CRAWL_THREADS, CRAWL_DEBOUNCE_MS y
+         *        CRAWL_RESCAN_SECONDS
+         * @return Opciones sin roots si CRAWL_DIRS está vacío (rastreador desactivado)
+         */
+        static CrawlerOptions ReadOptions();
+
+        CrawlerStats GetStats() const;
+
+        /**
+         * @brief Vuelve a leer todos los archivos en el siguiente ciclo del hilo, aunque su
+         *        tamaño y fecha no hayan cambiado
+         * @note Tras restaurar una copia de seguridad, cuyo índice no conserva los documentos
+         *       de las carpetas
+         */
+        void RequestReindex();
+    };
+
+} // namespace DocuTrace::Services
@@ -1,48 +1,272 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdlib>
+#include <filesystem>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
 #include <vector>
-#include "infrastructure/bm25_engine.hpp"
+#include "infrastructure/content_hash_table.hpp"
+#include "infrastructure/cursor_cache.hpp"
+#include "infrastructure/document_catalog.hpp"
+#include "infrastructure/index_replication.hpp"
+#include "infrastructure/shard_coordinator.hpp"
+#include "infrastructure/shard_protocol.hpp"
+#include "infrastructure/sharded_engine.hpp"
+#include "infrastructure/snapshot_store.hpp"
 #include "models/search_models.hpp"
 
 namespace DocuTrace::Services
 {
+    /**
+     * @brief Papel del nodo en la búsqueda distribuida (NODE_ROLE)
+     * @note WORKER atiende las fases en /internal/shard/; COORDINATOR reparte /api/search
+     *       entre los workers de SHARD_NODES
+     */
+    enum class NodeRole
+    {
+        STANDALONE,
+        WORKER,
+        COORDINATOR
+    };
+
+    /**
+     * @brief Papel del nodo en la replicación del índice (REPLICATION_MODE)
+     * @note PUBLISHER indexa y publica segmentos en REPLICATION_DIR; REPLICA solo los carga
+     *       y sirve búsquedas
+     */
+    enum class ReplicationMode
+    {
+        NONE,
+        PUBLISHER,
+        REPLICA
+    };
+
     class SearchService
     {
       private:
-        std::unique_ptr<Infrastructure::BM25Engine> engine_;
+        // Particiones del índice (INDEX_SHARDS); con una sola equivale a un BM25Engine.
+        // Una réplica lo sustituye entero al cargar una generación nueva
+        std::atomic<std::shared_ptr<Infrastructure::ShardedEngine>> engine_;
+        std::shared_ptr<const Shared::TextAnalyzer> analyzer_;
+        std::shared_ptr<Infrastructure::DocumentCatalog> catalog_;
+        NodeRole role_ = NodeRole::STANDALONE;
+        // Solo en modo coordinador
+        std::unique_ptr<Infrastructure::ShardCoordinator> coordinator_;
+        // Cursores de paginación (CURSOR_TTL_SECONDS, CURSOR_CACHE_SIZE)
+        std::unique_ptr<Infrastructure::CursorCache> cursors_;
+
+        // Ajustes del motor, también para los índices que carga una réplica
+        double compaction_ratio_ = 0.2;
+        double fuzzy_penalty_ = 0.5;
+        size_t max_expansions_ = 50;
+        // RANKING_MODEL y sus parámetros; una búsqueda puede cambiarlos (ranking=, k1=, b=)
+        Infrastructure::RankingParameters ranking_;
+        Infrastructure::ScoreAccumulator score_accumulator_ =
+            Infrastructure::ScoreAccumulator::DOUBLE;
+        // TWO_PHASE y sus parámetros (una búsqueda puede cambiarlos con two_phase=, candidates=
+        // y proximity=); una de cada two_phase_sampling_ se repite exacta para medir su recall
+        Infrastructure::TwoPhaseOptions two_phase_;
+        bool two_phase_default_ = false;
+        size_t two_phase_sampling_ = 100;
+        // DOCUMENT_ORDER: orden de los IDs internos que deja la compactación
+        Infrastructure::DocumentOrder document_order_ = Infrastructure::DocumentOrder::ARRIVAL;
+        // INDEX_MEMORY_MB en bytes (0 = sin límite) y directorio del nivel frío
+        size_t memory_budget_ = 0;
+        std::filesystem::path cold_directory_;
+
+        ReplicationMode replication_mode_ = ReplicationMode::NONE;
+        std::unique_ptr<Infrastructure::SegmentPublisher> publisher_;
+        std::unique_ptr<Infrastructure::SegmentReplica> replica_;
+        std::chrono::milliseconds replication_interval_{1000};
+        std::mutex replication_mutex_;
+        std::condition_variable_any replication_wakeup_;
+
+        // Copias de seguridad en caliente (SNAPSHOT_DIR); nullptr en una réplica
+        std::unique_ptr<Infrastructure::SnapshotStore> snapshots_;
+        std::shared_ptr<Infrastructure::ContentHashTable> content_hashes_;
+        // Una copia o restauración a la vez
+        std::mutex snapshot_mutex_;
+
+        // Último miembro: se detiene antes de destruir el índice que publica
+        std::jthread replication_thread_;
+
+        std::shared_ptr<Infrastructure::ShardedEngine> Engine() const
+        {
+            return engine_.load();
+        }
 
         /**
-         * @brief Carga documentos existentes desde el índice al inicializar
+         * @brief Carga documentos existentes desde el catálogo al inicializar
          */
         void LoadExistingDocuments();
 
+        /**
+         * @brief Lee COMPACTION_TOMBSTONE_RATIO, SEARCH_FUZZY_PENALTY, SEARCH_MAX_EXPANSIONS,
+         *        INDEX_MEMORY_MB, INDEX_COLD_DIR, RANKING_MODEL, BM25_K1, BM25_B, BM25_DELTA,
+         *        BM25F_FILENAME_WEIGHT, SCORE_ACCUMULATOR y TWO_PHASE*
+         */
+        void ReadEngineSettings();
+        void ApplyEngineSettings(Infrastructure::ShardedEngine& engine) const;
+
+        /**
+         * @brief Lee NODE_ROLE, SHARD_NODES y SHARD_TIMEOUT_MS
+         */
+        void ConfigureNodeRole();
+
+        /**
+         * @brief Lee REPLICATION_MODE, REPLICATION_DIR y REPLICATION_INTERVAL_MS
+         */
+        void ConfigureReplication();
+
+        /**
+         * @brief Lee SNAPSHOT_DIR
+         */
+        void ConfigureSnapshots();
+
+        /**
+         * @brief Publica o carga una generación (según el modo) sin propagar errores
+         */
+        void Replicate();
+
+        /**
+         * @brief Bucle del hilo de replicación: Replicate cada REPLICATION_INTERVAL_MS
+         */
+        void RunReplication(std::stop_token stop);
+
+        /**
+         * @brief Clasifica hasta CursorCache::MAX_RANKING resultados, guarda el cursor y
+         *        devuelve su primera página
+         * @param engine Índice fijado para todas las páginas del cursor
+         */
+        Models::SearchResponse OpenCursor(
+            std::shared_ptr<const Infrastructure::ShardedEngine> engine, const std::string& query,
+            const Infrastructure::QueryOptions& options, size_t limit) const;
+
+        /**
+         * @brief Página [offset, offset + limit) de un cursor
+         * @note En local el texto se lee del índice fijado; los documentos eliminados desde
+         *       que se abrió el cursor se omiten
+         */
+        Models::SearchResponse ReadPage(const Infrastructure::CursorPosition& position,
+                                        size_t limit) const;
+
+        /**
+         * @brief Analiza la consulta de un coordinador y aplica sus expansiones
+         */
+        std::unique_ptr<Infrastructure::QueryNode> PrepareShardQuery(
+            const Infrastructure::ShardedEngine& engine,
+            const Infrastructure::ShardRequest& request) const;
+
       public:
-        SearchService();
+        /**
+         * @param content_hashes Tabla de deduplicación que guardan y restauran las copias de
+         *        seguridad (opcional)
+         */
+        explicit SearchService(
+            std::shared_ptr<Infrastructure::DocumentCatalog> catalog,
+            std::shared_ptr<Infrastructure::ContentHashTable> content_hashes = nullptr);
         ~SearchService() = default;
 
-        // No copyable pero movible
+        // No copyable ni movible: el hilo de replicación guarda this
         SearchService(const SearchService&) = delete;
         SearchService& operator=(const SearchService&) = delete;
-        SearchService(SearchService&&) = default;
-        SearchService& operator=(SearchService&&) = default;
+        SearchService(SearchService&&) = delete;
+        SearchService& operator=(SearchService&&) = delete;
 
         /**
-         * @brief Realiza una búsqueda en el índice
+         * @brief Realiza una búsqueda en el índice (y en los workers si es coordinador)
          * @param request Parámetros de búsqueda validados
-         * @return Vector de resultados ordenados por relevancia
+         * @return Resultados ordenados por relevancia
+         */
+        Models::SearchResponse Search(const Models::SearchRequest& request) const;
+
+        /**
+         * @brief Realiza varias búsquedas de una vez
+         * @param request Consultas validadas
+         * @return Una respuesta por consulta, en el mismo orden
+         * @note En local el lote comparte análisis, estadísticas y lecturas de postings; en
+         *       modo coordinador cada consulta se reparte entre los workers por separado
+         */
+        std::vector<Models::SearchResponse> SearchBatch(
+            const Models::SearchBatchRequest& request) const;
+
+        /**
+         * @brief Postings que leería la búsqueda en el índice local, sin ejecutarla
+         * @note Solo mira el diccionario (ver ShardedEngine::EstimateCost). Un coordinador
+         *       no tiene los postings de los workers: sus consultas cuestan casi 0 y las
+         *       limita el número de peticiones en curso
+         */
+        uint64_t EstimateCost(const Models::SearchRequest& request) const;
+        uint64_t EstimateCost(const Models::SearchBatchRequest& request) const;
+
+        /**
+         * @brief Página siguiente de un cursor abierto con SearchRequest::paginate
+         * @param request Token de next_cursor y tamaño de página validados
+         * @return nullopt si el cursor no existe o caducó (se puede seguir con search_after)
+         * @note Cuesta lo mismo a cualquier profundidad: las primeras
+         *       CursorCache::MAX_RANKING posiciones se leen de la clasificación guardada y
+         *       después se abre otro cursor tras el último resultado
+         */
+        std::optional<Models::SearchResponse> SearchPage(
+            const Models::SearchPageRequest& request) const;
+
+        /**
+         * @brief Fases de una búsqueda distribuida en un worker
+         * @param body Petición JSON del coordinador (ver ShardProtocol)
+         * @return Respuesta JSON: expansiones candidatas, estadísticas o top-k
+         * @throws std::exception si la petición no es válida
+         */
+        std::string ShardExpansions(const std::string& body) const;
+        std::string ShardStatistics(const std::string& body) const;
+        std::string ShardSearch(const std::string& body) const;
+
+        NodeRole GetNodeRole() const
+        {
+            return role_;
+        }
+
+        /**
+         * @brief Una réplica no admite escrituras: su índice solo cambia al replicar
+         */
+        bool IsReadOnly() const
+        {
+            return replication_mode_ == ReplicationMode::REPLICA;
+        }
+
+        /**
+         * @brief Completa la última palabra escrita con las más frecuentes del índice
+         * @param request Prefijo y número de sugerencias validados
+         * @return Sugerencias ordenadas por número de documentos
          */
-        std::vector<Models::SearchResult> Search(const Models::SearchRequest& request) const;
+        std::vector<Models::Suggestion> Suggest(const Models::SuggestRequest& request) const;
 
         /**
          * @brief Indexa un documento único
          * @param request Documento a indexar validado
-         * @return true si se indexó correctamente
+         * @return true si se indexó correctamente (false siempre en una réplica)
          */
         bool IndexDocument(const Models::IndexDocumentRequest& request);
 
+        /**
+         * @brief Elimina un documento del índice
+         * @param document_id ID del documento
+         * @return true si el documento existía
+         */
+        bool DeleteDocument(uint64_t document_id);
+
+        /**
+         * @brief Reemplaza el contenido de un documento ya indexado
+         * @param request Documento con el nuevo contenido
+         * @return true si el documento existía y se reindexó
+         */
+        bool UpdateDocument(const Models::IndexDocumentRequest& request);
+
         /**
          * @brief Indexa múltiples documentos
          * @param request Lista de documentos a indexar validados
@@ -50,6 +274,38 @@ namespace DocuTrace::Services
          */
         size_t IndexDocuments(const Models::IndexDocumentsRequest& request);
 
+        /**
+         * @brief Copia de seguridad en caliente del catálogo, los documentos y el índice
+         * @param name Nombre de la copia (vacío: fecha y hora UTC)
+         * @throws std::invalid_argument si el nombre ya existe o no es válido
+         * @throws std::runtime_error si no hay copias (réplica) o falla la escritura
+         * @note Enlaza los archivos sin copiar datos; las búsquedas siguen y las subidas,
+         *       cambios y bajas solo esperan mientras se fija el catálogo y se sella el índice
+         */
+        Models::SnapshotInfo CreateSnapshot(const std::string& name);
+
+        /**
+         * @return Copias de la más antigua a la más reciente
+         */
+        std::vector<Models::SnapshotInfo> ListSnapshots() const;
+
+        /**
+         * @return true si la copia existía
+         */
+        bool DeleteSnapshot(const std::string& name);
+
+        /**
+         * @brief Vuelve al estado de una copia: abre su índice sin volver a analizar el
+         *        texto, restaura el catálogo y los documentos y sustituye el índice servido
+         * @return nullopt si la copia no existe
+         * @throws std::runtime_error si la copia está dañada (el índice servido no cambia)
+         * @note El índice restaurado solo contiene los documentos del catálogo: los de las
+         *       carpetas rastreadas se vuelven a leer (FolderCrawler::RequestReindex). Las
+         *       subidas, cambios y bajas esperan desde que se restaura el catálogo hasta que
+         *       se sirve el índice nuevo (DocumentCatalog::LockMutations)
+         */
+        std::optional<Models::SnapshotRestoreResult> RestoreSnapshot(const std::string& name);
+
         /**
          * @brief Obtiene estadísticas del sistema de búsqueda
          * @return Estadísticas actuales del índice
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "shared/hash_utils.hpp"
+
+namespace DocuTrace::Shared
+{
+    /**
+     * @brief Escritura binaria en el orden de bytes de la máquina con XXH64 de lo escrito
+     * @note El checksum y el tamaño se obtienen sin releer el archivo
+     */
+    class BinaryWriter
+    {
+      private:
+        std::ostream& out_;
+        ContentHasher hasher_;
+        uint64_t size_ = 0;
+
+      public:
+        explicit BinaryWriter(std::ostream& out);
+
+        void WriteBytes(const void* data, size_t length);
+        void WriteString(std::string_view value);
+
+        template <typename T> void Write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            WriteBytes(&value, sizeof(T));
+        }
+
+        /**
+         * @brief Escribe el número de elementos seguido de su contenido
+         */
+        template <typename T> void WriteVector(const std::vector<T>& values)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            Write<uint64_t>(values.size());
+            WriteBytes(values.data(), values.size() * sizeof(T));
+        }
+
+        uint64_t GetSize() const
+        {
+            return size_;
+        }
+
+        uint64_t GetChecksum() const
+        {
+            return hasher_.Digest();
+        }
+    };
+
+    /**
+     * @brief Lectura de lo escrito con BinaryWriter
+     * @note Lanza std::runtime_error si el flujo termina antes de tiempo
+     */
+    class BinaryReader
+    {
+      private:
+        std::istream& in_;
+        ContentHasher hasher_;
+        uint64_t size_ = 0;
+        // Bytes que quedan en el flujo (máximo si no admite seekg)
+        uint64_t remaining_ = UINT64_MAX;
+
+      public:
+        explicit BinaryReader(std::istream& in);
+
+        void ReadBytes(void* data, size_t length);
+        std::string ReadString();
+
+        template <typename T> T Read()
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            T value;
+            ReadBytes(&value, sizeof(T));
+            return value;
+        }
+
+        template <typename T> std::vector<T> ReadVector()
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            std::vector<T> values(CheckedCount(Read<uint64_t>(), sizeof(T)));
+            ReadBytes(values.data(), values.size() * sizeof(T));
+            return values;
+        }
+
+        /**
+         * @brief Valida un número de elementos leído antes de reservar memoria
+         * @throws std::runtime_error si no cabe en lo que queda del flujo
+         */
+        size_t CheckedCount(uint64_t count, size_t element_size);
+
+        uint64_t GetSize() const
+        {
+            return size_;
+        }
+
+        uint64_t GetChecksum() const
+        {
+            return hasher_.Digest();
+        }
+    };
+
+} // namespace DocuTrace::Shared
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <zlib.h>
+
+namespace DocuTrace::Shared
+{
+    /**
+     * @brief Codificación de contenido HTTP (Content-Encoding)
+     * @note DEFLATE es el formato zlib, que es lo que HTTP llama "deflate"
+     */
+    enum class ContentEncoding
+    {
+        IDENTITY,
+        GZIP,
+        DEFLATE
+    };
+
+    /**
+     * @brief Compresión zlib incremental: los datos entran por bloques y la salida crece a
+     *        la vez, sin guardar la entrada completa
+     */
+    class StreamCompressor
+    {
+      private:
+        z_stream stream_{};
+
+        void Deflate(std::string_view input, int flush, std::string& output);
+
+      public:
+        /**
+         * @param encoding GZIP o DEFLATE
+         * @param level Nivel de zlib (1 = más rápido, 9 = más compacto)
+         * @throws std::runtime_error si zlib no se puede inicializar
+         */
+        StreamCompressor(ContentEncoding encoding, int level);
+        ~StreamCompressor();
+
+        StreamCompressor(const StreamCompressor&) = delete;
+        StreamCompressor& operator=(const StreamCompressor&) = delete;
+
+        /**
+         * @brief Comprime un bloque y añade a output lo que zlib tenga listo
+         */
+        void Write(std::string_view input, std::string& output);
+
+        /**
+         * @brief Vacía lo pendiente y escribe el final del flujo
+         */
+        void Finish(std::string& output);
+    };
+
+} // namespace DocuTrace::Shared
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace DocuTrace::Shared
+{
+    enum class WatchEventKind
+    {
+        // Creado, modificado o movido dentro del directorio vigilado
+        CHANGED,
+        // Eliminado o movido fuera
+        REMOVED,
+        // La cola del kernel se desbordó: se perdieron eventos y hay que volver a recorrer
+        OVERFLOW
+    };
+
+    struct WatchEvent
+    {
+        WatchEventKind kind;
+        std::filesystem::path path;
+        bool directory = false;
+    };
+
+    /**
+     * @brief Cambios en un conjunto de directorios (inotify en Linux)
+     * @note Cada directorio se vigila por separado, sin sus subdirectorios: quien recorre el
+     *       árbol añade los nuevos al verlos. En otros sistemas no vigila nada (IsOpen es
+     *       false) y Poll solo espera. No es thread-safe
+     */
+    class DirectoryWatcher
+    {
+      private:
+        int descriptor_ = -1;
+        // Descriptor de vigilancia → directorio
+        std::unordered_map<int, std::filesystem::path> directories_;
+
+        /**
+         * @brief Deja de vigilar un directorio y todos los que cuelgan de él
+         */
+        void Unwatch(const std::filesystem::path& directory);
+
+      public:
+        DirectoryWatcher();
+        ~DirectoryWatcher();
+        DirectoryWatcher(const DirectoryWatcher&) = delete;
+        DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+        bool IsOpen() const
+        {
+            return descriptor_ >= 0;
+        }
+
+        /**
+         * @brief Empieza a vigilar un directorio (no sus subdirectorios)
+         * @return false si no se pudo, p. ej. por el límite fs.inotify.max_user_watches
+         */
+        bool Watch(const std::filesystem::path& directory);
+
+        /**
+         * @brief Espera hasta timeout a que haya eventos
+         * @return Eventos leídos (vacío si venció el plazo)
+         * @note Un directorio movido deja de vigilarse con todo su subárbol; si el destino
+         *       está dentro de otro vigilado llega como CHANGED y hay que volver a añadirlo
+         */
+        std::vector<WatchEvent> Poll(std::chrono::milliseconds timeout);
+
+        size_t GetWatchCount() const
+        {
+            return directories_.size();
+        }
+    };
+
+} // namespace DocuTrace::Shared
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace DocuTrace::Shared
+{
+    class FileUtils
+    {
+      public:
+        /**
+         * @brief Obtiene (y crea si no existe) el directorio de datos del sistema operativo
+         * @return Linux: ~/.local/share/DocuTrace, macOS: ~/Library/Application Support/DocuTrace,
+         *         Windows: %APPDATA%\DocuTrace; ./data como respaldo. DATA_DIR tiene prioridad
+         */
+        static std::filesystem::path GetAppDataDir();
+
+        /**
+         * @brief Lee el contenido de texto de un archivo regular
+         * @param filepath Ruta del archivo
+         * @return Contenido del archivo o cadena vacía si no se pudo leer
+         */
+        static std::string ExtractText(const std::string& filepath);
+
+        /**
+         * @brief Escribe un archivo de forma atómica (temporal + renombrado)
+         * @param filepath Ruta destino
+         * @param data Contenido a escribir
+         * @return true si el archivo quedó escrito por completo
+         */
+        static bool WriteFileAtomic(const std::filesystem::path& filepath, std::string_view data);
+
+        /**
+         * @brief Enlaza (hard link) source en target sin copiar datos, o lo copia si el sistema
+         *        de archivos no admite el enlace (otro volumen, FAT); target se reemplaza de
+         *        forma atómica
+         * @param copied Si no es nullptr, indica si hubo que copiar los datos
+         * @return false si no se pudo ni enlazar ni copiar
+         * @note Solo es seguro con archivos que no se modifican en el sitio: los que se
+         *       escriben con WriteFileAtomic o con un nombre nuevo cada vez
+         */
+        static bool LinkOrCopyFile(const std::filesystem::path& source,
+                                   const std::filesystem::path& target, bool* copied = nullptr);
+    };
+
+} // namespace DocuTrace::Shared
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace DocuTrace::Shared
+{
+    /**
+     * @brief Hash de contenido incremental (XXH64) para procesar datos por bloques
+     * @note Permite calcular el hash mientras se recibe/escribe un archivo sin copiarlo
+     */
+    class ContentHasher
+    {
+      private:
+        static constexpr size_t STRIPE_SIZE = 32;
+
+        std::array<uint64_t, 4> accumulators_{};
+        std::array<unsigned char, STRIPE_SIZE> buffer_{};
+        size_t buffer_size_ = 0;
+        uint64_t total_length_ = 0;
+        uint64_t seed_ = 0;
+
+      public:
+        explicit ContentHasher(uint64_t seed = 0);
+
+        /**
+         * @brief Añade un bloque de datos al hash
+         * @param data Puntero al bloque
+         * @param length Tamaño del bloque en bytes
+         */
+        void Update(const void* data, size_t length);
+        void Update(std::string_view data);
+
+        /**
+         * @brief Obtiene el hash de todo lo procesado hasta ahora
+         * @return Valor XXH64 de 64 bits (no modifica el estado)
+         */
+        uint64_t Digest() const;
+
+        void Reset(uint64_t seed = 0);
+    };
+
+    class HashUtils
+    {
+      public:
+        /**
+         * @brief Calcula XXH64 de una cadena completa
+         * @example Hash64("") → 0xEF46DB3751D8E999
+         */
+        static uint64_t Hash64(std::string_view data, uint64_t seed = 0);
+
+        /**
+         * @brief Calcula la firma SimHash de 64 bits de una lista de tokens
+         * @param tokens Tokens normalizados del documento
+         * @return Firma donde documentos casi idénticos difieren en pocos bits
+         */
+        static uint64_t SimHash(const std::vector<std::string>& tokens);
+
+        /**
+         * @brief Número de bits distintos entre dos firmas
+         */
+        static int HammingDistance(uint64_t a, uint64_t b);
+
+        /**
+         * @brief Representación hexadecimal de 16 dígitos
+         * @example ToHex(255) → "00000000000000ff"
+         */
+        static std::string ToHex(uint64_t value);
+
+        /**
+         * @brief Convierte una cadena hexadecimal a entero
+         * @return 0 si la cadena no es válida
+         */
+        static uint64_t FromHex(const std::string& hex);
+    };
+
+} // namespace DocuTrace::Shared
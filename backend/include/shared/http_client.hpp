@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace DocuTrace::Shared
+{
+    /**
+     * @brief Respuesta HTTP: código de estado y cuerpo
+     */
+    struct HttpResponse
+    {
+        int status = 0;
+        std::string body;
+    };
+
+    /**
+     * @brief Cliente HTTP/1.1 mínimo y bloqueante para la comunicación entre nodos
+     * @note Una conexión por petición (Connection: close), sin TLS ni redirecciones: pensado
+     *       para la red interna entre coordinador y workers
+     */
+    class HttpClient
+    {
+      public:
+        /**
+         * @brief Envía un POST con cuerpo JSON y espera la respuesta completa
+         * @param timeout Plazo total para conectar, enviar y recibir
+         * @return Respuesta del servidor (cualquier código de estado)
+         * @throws std::runtime_error si no conecta, se agota el plazo o la respuesta no es HTTP
+         */
+        static HttpResponse Post(const std::string& host, uint16_t port, const std::string& path,
+                                 const std::string& body, std::chrono::milliseconds timeout);
+    };
+
+} // namespace DocuTrace::Shared
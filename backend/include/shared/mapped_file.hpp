@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+namespace DocuTrace::Shared
+{
+    /**
+     * @brief Uso previsto de un rango mapeado (se traduce a madvise)
+     */
+    enum class MappedAccess
+    {
+        RANDOM,
+        WILL_NEED
+    };
+
+    /**
+     * @brief Archivo temporal de solo anexado, mapeado en memoria para leerlo sin copias
+     * @note Se borra del directorio nada más crearlo, así que desaparece con el proceso.
+     *       Las páginas leídas son caché del sistema: el kernel las descarta bajo presión de
+     *       memoria en lugar de matar el proceso. Append puede mover el mapeo, así que los
+     *       punteros de Data solo valen hasta la siguiente escritura
+     */
+    class MappedFile
+    {
+      private:
+        int descriptor_ = -1;
+        char* mapping_ = nullptr;
+        size_t mapped_size_ = 0;
+        uint64_t size_ = 0;
+
+        explicit MappedFile(int descriptor);
+
+        /**
+         * @brief Amplía el mapeo para cubrir al menos minimum_size bytes
+         * @throws std::runtime_error si mmap falla (el mapeo anterior se conserva)
+         */
+        void Remap(uint64_t minimum_size);
+
+      public:
+        /**
+         * @param directory Directorio donde crear el archivo (se crea si no existe)
+         * @throws std::runtime_error si no se puede crear
+         */
+        static std::unique_ptr<MappedFile> CreateTemporary(const std::filesystem::path& directory);
+
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /**
+         * @brief Añade datos al final del archivo
+         * @return Posición en la que quedaron
+         * @throws std::runtime_error si falla la escritura (p. ej. disco lleno)
+         */
+        uint64_t Append(const void* data, size_t length);
+
+        const char* Data(uint64_t offset) const
+        {
+            return mapping_ + offset;
+        }
+
+        /**
+         * @brief Sugerencia al kernel sobre cómo se va a leer un rango (errores ignorados)
+         */
+        void Advise(uint64_t offset, size_t length, MappedAccess access) const;
+
+        uint64_t GetSize() const
+        {
+            return size_;
+        }
+    };
+
+    /**
+     * @brief Lecturas servidas desde RAM y desde un archivo mapeado
+     * @note Se incrementan con el lock compartido del motor, de ahí los atómicos
+     */
+    struct TierHits
+    {
+        std::atomic<uint64_t> resident{0};
+        std::atomic<uint64_t> cold{0};
+
+        TierHits() = default;
+        TierHits(TierHits&& other) noexcept
+            : resident(other.resident.load()), cold(other.cold.load())
+        {
+        }
+        TierHits& operator=(TierHits&& other) noexcept
+        {
+            resident = other.resident.load();
+            cold = other.cold.load();
+            return *this;
+        }
+
+        void Record(bool is_cold)
+        {
+            (is_cold ? cold : resident).fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+
+} // namespace DocuTrace::Shared
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace DocuTrace::Shared
+{
+    /**
+     * @brief Nivel de instrucciones vectoriales usado por los kernels
+     */
+    enum class SimdLevel
+    {
+        SCALAR,
+        SSE,
+        AVX2
+    };
+
+    /**
+     * @brief Kernels sobre listas ordenadas de enteros (postings) con despacho en tiempo de
+     *        ejecución
+     * @note Cada kernel tiene una versión escalar de referencia y, en x86-64, variantes
+     *       SSE/AVX2 compiladas con atributos de target, sin necesitar -mavx2 en todo el
+     *       proyecto. Todas las listas deben estar ordenadas y sin repetidos
+     */
+    class SimdKernels
+    {
+      public:
+        // Diferencia de tamaños a partir de la cual conviene galopar en vez de mezclar
+        static constexpr size_t GALLOP_RATIO = 16;
+
+        /**
+         * @brief Mejor nivel soportado por la CPU actual
+         */
+        static SimdLevel DetectLevel();
+
+        static SimdLevel GetLevel();
+
+        /**
+         * @brief Fuerza un nivel (se limita al soportado por la CPU)
+         * @return Nivel efectivamente activo
+         */
+        static SimdLevel SetLevel(SimdLevel level);
+
+        static const char* LevelName(SimdLevel level);
+
+        /**
+         * @brief Interpreta "auto", "scalar", "sse" o "avx2"
+         * @return false si el valor no es reconocido
+         */
+        static bool ParseLevel(const std::string& value, SimdLevel& level);
+
+        // ========================================================================
+        // Búsqueda
+        // ========================================================================
+
+        /**
+         * @brief Primera posición con valor >= target (como std::lower_bound)
+         * @note Búsqueda binaria hasta una ventana pequeña que se resuelve con comparación
+         *       vectorial
+         */
+        static size_t LowerBound(const uint32_t* values, size_t size, uint32_t target);
+
+        /**
+         * @brief Primera posición >= begin con valor >= target, con saltos exponenciales
+         * @note Adecuada para avanzar un cursor sobre una lista mucho más larga
+         */
+        static size_t GallopLowerBound(const uint32_t* values, size_t size, size_t begin,
+                                       uint32_t target);
+
+        // ========================================================================
+        // Intersección y diferencia
+        // ========================================================================
+
+        /**
+         * @brief Intersección de dos listas ordenadas
+         * @param out Destino con capacidad para min(size_a, size_b) valores
+         * @return Número de valores escritos
+         * @note Galopa si los tamaños son muy desiguales; si no, usa el nivel SIMD activo
+         */
+        static size_t Intersect(const uint32_t* a, size_t size_a, const uint32_t* b,
+                                size_t size_b, uint32_t* out);
+
+        static size_t IntersectScalar(const uint32_t* a, size_t size_a, const uint32_t* b,
+                                      size_t size_b, uint32_t* out);
+        static size_t IntersectGalloping(const uint32_t* a, size_t size_a, const uint32_t* b,
+                                         size_t size_b, uint32_t* out);
+        static size_t IntersectSse(const uint32_t* a, size_t size_a, const uint32_t* b,
+                                   size_t size_b, uint32_t* out);
+        static size_t IntersectAvx2(const uint32_t* a, size_t size_a, const uint32_t* b,
+                                    size_t size_b, uint32_t* out);
+
+        /**
+         * @brief Valores de a que no están en b
+         * @param out Destino con capacidad para size_a valores
+         * @return Número de valores escritos
+         */
+        static size_t Difference(const uint32_t* a, size_t size_a, const uint32_t* b,
+                                 size_t size_b, uint32_t* out);
+
+        // ========================================================================
+        // Compresión por bloques empaquetados
+        // ========================================================================
+
+        // Valores por bloque
+        static constexpr size_t PACKED_BLOCK_SIZE = 16;
+
+        /**
+         * @brief Tamaño máximo codificado de count enteros
+         */
+        static size_t PackedMaxBytes(size_t count);
+
+        /**
+         * @brief Codifica enteros por bloques de PACKED_BLOCK_SIZE: un byte con los bits del
+         *        mayor valor del bloque y los valores con esos bits, sin huecos entre ellos
+         * @return Bytes escritos en out (capacidad PackedMaxBytes(count))
+         * @note Cuanto menores los valores (p. ej. huecos entre IDs próximos), menos bits
+         */
+        static size_t EncodePacked(const uint32_t* values, size_t count, uint8_t* out);
+
+        /**
+         * @brief Decodifica count enteros con el nivel SIMD activo
+         * @param size Bytes disponibles en input
+         * @return Bytes consumidos o 0 si la entrada está truncada o un bloque no es válido
+         */
+        static size_t DecodePacked(const uint8_t* input, size_t size, size_t count,
+                                   uint32_t* out);
+
+        static size_t DecodePackedScalar(const uint8_t* input, size_t size, size_t count,
+                                         uint32_t* out);
+        static size_t DecodePackedAvx2(const uint8_t* input, size_t size, size_t count,
+                                       uint32_t* out);
+
+        // ========================================================================
+        // Puntuación
+        // ========================================================================
+
+        /**
+         * @brief Aportación saturada de cada posting en float: a * f / (f + c + d * dl)
+         * @param lengths Longitud por ID de documento; debe cubrir todos los de documents
+         * @note Con a = idf * (k1 + 1), c = k1 * (1 - b) y d = k1 * b / avdl es BM25. La
+         *       versión AVX2 calcula 8 postings a la vez leyendo las longitudes con gather y
+         *       da exactamente el mismo resultado que la escalar
+         */
+        static void SaturatedScores(const uint32_t* documents, const uint32_t* frequencies,
+                                    size_t count, const uint32_t* lengths, float a, float c,
+                                    float d, float* out);
+
+        static void SaturatedScoresScalar(const uint32_t* documents, const uint32_t* frequencies,
+                                          size_t count, const uint32_t* lengths, float a, float c,
+                                          float d, float* out);
+        static void SaturatedScoresAvx2(const uint32_t* documents, const uint32_t* frequencies,
+                                        size_t count, const uint32_t* lengths, float a, float c,
+                                        float d, float* out);
+    };
+
+} // namespace DocuTrace::Shared
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace DocuTrace::Shared
+{
+    /**
+     * @brief Formato de serialización de una respuesta
+     */
+    enum class WireFormat
+    {
+        JSON,
+        MSGPACK,
+        CBOR
+    };
+
+    /**
+     * @brief Serializa objetos, listas y escalares directamente en un búfer por bloques
+     * @note Sin árbol intermedio: cada valor se codifica al escribirse y, cuando el búfer
+     *       supera chunk_size, se entrega al sink y se reutiliza. MessagePack y CBOR necesitan
+     *       el número de elementos de cada contenedor al abrirlo; JSON lo ignora
+     * @example writer.BeginObject(1); writer.Key("ok"); writer.Bool(true); writer.EndObject();
+     */
+    class StructuredWriter
+    {
+      public:
+        using Sink = std::function<void(std::string_view chunk)>;
+        static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+      private:
+        WireFormat format_;
+        Sink sink_;
+        size_t chunk_size_;
+        std::string buffer_;
+        // JSON: por cada contenedor abierto, si aún no tiene elementos (para las comas)
+        std::vector<bool> first_in_container_;
+        bool after_key_ = false;
+
+        /**
+         * @brief Separador JSON antes de un valor o clave
+         */
+        void BeforeValue();
+
+        /**
+         * @brief Cabecera binaria: tipo y longitud o valor con el menor tamaño posible
+         */
+        void WriteMsgpackLength(uint8_t fix_base, size_t fix_limit, uint8_t code8, uint8_t code16,
+                                uint8_t code32, size_t length);
+        void WriteCborHead(uint8_t major, uint64_t value);
+        void WriteBigEndian(uint64_t value, size_t bytes);
+        void WriteJsonString(std::string_view text);
+        void Append(const char* data, size_t length);
+
+        void FlushIfFull()
+        {
+            if (buffer_.size() >= chunk_size_)
+            {
+                Flush();
+            }
+        }
+
+      public:
+        /**
+         * @param sink Recibe cada bloque serializado, en orden
+         * @param chunk_size Tamaño aproximado de cada bloque
+         */
+        StructuredWriter(WireFormat format, Sink sink, size_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+        StructuredWriter(const StructuredWriter&) = delete;
+        StructuredWriter& operator=(const StructuredWriter&) = delete;
+
+        /**
+         * @param fields Número de pares clave-valor que se van a escribir
+         */
+        void BeginObject(size_t fields);
+        void EndObject();
+
+        /**
+         * @param count Número de elementos que se van a escribir
+         */
+        void BeginArray(size_t count);
+        void EndArray();
+
+        void Key(std::string_view key);
+        void String(std::string_view value);
+        void UInt(uint64_t value);
+        void Int(int64_t value);
+        void Double(double value);
+        void Bool(bool value);
+
+        /**
+         * @brief Termina un valor de primer nivel de una secuencia
+         * @note En JSON añade un salto de línea (JSON por líneas); MessagePack y CBOR se
+         *       concatenan sin separador
+         */
+        void EndRecord();
+
+        /**
+         * @brief Entrega al sink lo que quede en el búfer
+         */
+        void Flush();
+
+        WireFormat GetFormat() const
+        {
+            return format_;
+        }
+    };
+
+} // namespace DocuTrace::Shared
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace DocuTrace::Shared
+{
+    /**
+     * @brief Stemmer del español basado en el algoritmo Snowball
+     * @note Opera sobre texto ya normalizado (minúsculas y sin acentos), por lo que los
+     *       sufijos acentuados de Snowball se comparan en su forma sin tilde
+     */
+    class SpanishStemmer
+    {
+      public:
+        /**
+         * @brief Reduce una palabra a su raíz
+         * @param word Palabra en minúsculas sin acentos
+         * @return Raíz de la palabra (la palabra sin cambios si contiene dígitos)
+         * @example Stem("computadoras") → "comput", Stem("computacion") → "comput"
+         */
+        static std::string Stem(const std::string& word);
+    };
+
+    /**
+     * @brief Configuración de la cadena de análisis
+     */
+    struct AnalyzerOptions
+    {
+        bool stemming = true;
+        bool stopwords = true;
+        // Archivo con una stopword por línea ('#' para comentarios); vacío = lista por defecto
+        std::string stopwords_file;
+    };
+
+    /**
+     * @brief Cadena de análisis de texto: tokenizado → minúsculas/sin acentos → stopwords →
+     *        stemming
+     * @note La misma instancia debe usarse al indexar y al consultar para que los términos
+     *       coincidan. Es inmutable y por tanto segura entre hilos
+     */
+    class TextAnalyzer
+    {
+      private:
+        AnalyzerOptions options_;
+        std::unordered_set<std::string> stopwords_;
+
+      public:
+        explicit TextAnalyzer(AnalyzerOptions options = {});
+
+        /**
+         * @brief Convierte un texto en los términos que se indexan o buscan
+         * @example Analyze("Las computadoras de la universidad") → {"comput", "univers"}
+         */
+        std::vector<std::string> Analyze(const std::string& text) const;
+
+        /**
+         * @brief Aplica stopwords y stemming a un token ya tokenizado
+         * @return Término resultante o cadena vacía si el token es una stopword
+         */
+        std::string AnalyzeToken(const std::string& token) const;
+
+        bool IsStopword(const std::string& token) const;
+
+        size_t GetStopwordCount() const
+        {
+            return stopwords_.size();
+        }
+
+        const AnalyzerOptions& GetOptions() const
+        {
+            return options_;
+        }
+
+        /**
+         * @brief Divide en palabras en minúsculas y sin acentos
+         * @note Cualquier carácter ASCII no alfanumérico y los símbolos UTF-8 de 3-4 bytes
+         *       separan palabras; las letras no ASCII restantes se descartan como en
+         *       TextUtils::cleanString
+         * @example Tokenize("José,María\nPérez") → {"jose", "maria", "perez"}
+         */
+        static std::vector<std::string> Tokenize(const std::string& text);
+
+        /**
+         * @brief Lista de stopwords del español usada por defecto (sin acentos)
+         */
+        static const std::vector<std::string>& DefaultSpanishStopwords();
+    };
+
+} // namespace DocuTrace::Shared
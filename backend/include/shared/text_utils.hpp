@@ -61,7 +61,7 @@ namespace DocuTrace::Shared
         /**
          * @brief Remueve acentos comunes del español de un texto
          * @param text Texto con acentos
-         * @return Texto sin acentos (á→a, é→e, í→i, ó→o, ú→u, ñ→n)
+         * @return Texto sin acentos (á→a, é→e, í→i, ó→o, ú→u, ü→u, ñ→n)
          * @example removeSpanishAccents("José María") → "Jose Maria"
          */
         static std::string removeSpanishAccents(const std::string& text);
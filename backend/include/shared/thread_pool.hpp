@@ -0,0 +1,71 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace DocuTrace::Shared
+{
+    /**
+     * @brief Pool de hilos de tamaño fijo con cola FIFO de tareas
+     * @note Las tareas no deben esperar a otras tareas del mismo pool: con todos los hilos
+     *       ocupados esperando, nadie ejecutaría las pendientes
+     */
+    class ThreadPool
+    {
+      private:
+        std::vector<std::thread> workers_;
+        std::queue<std::function<void()>> tasks_;
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        bool stopping_ = false;
+
+        void WorkerLoop();
+
+      public:
+        /**
+         * @param thread_count Número de hilos (0 = hilos del hardware)
+         */
+        explicit ThreadPool(size_t thread_count = 0);
+
+        /**
+         * @brief Termina las tareas ya encoladas y detiene los hilos
+         */
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /**
+         * @brief Encola una tarea
+         * @return Future con el resultado (o la excepción) de la tarea
+         */
+        template <typename Function>
+        auto Submit(Function&& function) -> std::future<std::invoke_result_t<Function>>
+        {
+            using Result = std::invoke_result_t<Function>;
+            // std::function exige tareas copiables: el packaged_task va en un shared_ptr
+            auto task =
+                std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+            std::future<Result> result = task->get_future();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                tasks_.emplace([task]() { (*task)(); });
+            }
+            condition_.notify_one();
+            return result;
+        }
+
+        size_t GetThreadCount() const
+        {
+            return workers_.size();
+        }
+    };
+
+} // namespace DocuTrace::Shared
@@ -0,0 +1,24 @@
+#include "controllers/admission_response.hpp"
+#include <string>
+
+namespace DocuTrace::Controllers
+{
+    crow::response RejectedResponse(const Services::Admission& admission)
+    {
+        const bool too_expensive =
+            admission.GetStatus() == Services::AdmissionStatus::TOO_EXPENSIVE;
+        const std::string message =
+            too_expensive
+                ? "Consulta demasiado costosa para la carga actual, reinténtala más tarde"
+                : "Servidor saturado, reinténtalo más tarde";
+        const std::string retry_after = std::to_string(admission.GetRetryAfter().count());
+
+        crow::response response(too_expensive ? 429 : 503,
+                                "{\"error\": \"" + message + "\", \"retry_after\": " +
+                                    retry_after + "}");
+        response.set_header("Content-Type", "application/json");
+        response.set_header("Retry-After", retry_after);
+        return response;
+    }
+
+} // namespace DocuTrace::Controllers
@@ -0,0 +1,177 @@
+#include "controllers/document_controller.hpp"
+#include "controllers/admission_response.hpp"
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+#include "crow/json.h"
+#include "crow/multipart.h"
+#include "models/search_models.hpp"
+#include "shared/file_utils.hpp"
+#include "shared/hash_utils.hpp"
+#include "shared/text_utils.hpp"
+
+namespace DocuTrace::Controllers
+{
+    namespace
+    {
+        std::vector<crow::json::wvalue> AliasesToJson(
+            const std::vector<Infrastructure::DocumentAlias>& aliases)
+        {
+            std::vector<crow::json::wvalue> items;
+            for (const auto& alias : aliases)
+            {
+                crow::json::wvalue item;
+                item["filename"] = alias.filename;
+                item["timestamp"] = alias.timestamp;
+                items.push_back(std::move(item));
+            }
+            return items;
+        }
+    } // namespace
+
+    DocumentController::DocumentController(
+        std::shared_ptr<Services::SearchService> search_service,
+        std::shared_ptr<Infrastructure::DocumentCatalog> catalog,
+        std::shared_ptr<Infrastructure::ContentHashTable> content_hashes,
+        std::shared_ptr<Services::AdmissionControl> admission)
+        : search_service_(std::move(search_service)), catalog_(std::move(catalog)),
+          content_hashes_(std::move(content_hashes)), admission_(std::move(admission))
+    {
+    }
+
+    crow::response DocumentController::HandleDelete(uint64_t document_id)
+    {
+        // Compartido con las subidas: ninguna puede añadir un alias a este documento entre
+        // su baja en el índice y la de su hash
+        auto mutation_lock = catalog_->LockMutations();
+
+        auto entry = catalog_->Find(document_id);
+        if (!entry)
+        {
+            return crow::response(404, "{\"error\": \"Documento no encontrado\"}");
+        }
+
+        // El borrado en el motor no toca las listas: marca el documento y descuenta su df
+        search_service_->DeleteDocument(document_id);
+        catalog_->Remove(document_id);
+        auto dropped_aliases = content_hashes_->RemoveDocument(document_id);
+
+        std::error_code ec;
+        std::filesystem::remove(entry->path, ec);
+        if (ec)
+        {
+            std::cerr << "[-] No se pudo eliminar " << entry->path << ": " << ec.message()
+                      << std::endl;
+        }
+
+        crow::json::wvalue response;
+        response["message"] = "Documento '" + entry->filename + "' eliminado.";
+        response["doc_id"] = document_id;
+        // Las copias subidas como alias no tenían archivo propio: desaparecen con el original
+        response["dropped_aliases"] = AliasesToJson(dropped_aliases);
+        response["success"] = true;
+        return crow::response(200, response);
+    }
+
+    crow::response DocumentController::HandleUpdate(const crow::request& req,
+                                                    uint64_t document_id)
+    {
+        // Acepta multipart con la parte "file" o el contenido en el cuerpo
+        std::string body = req.body;
+        if (req.get_header_value("Content-Type").starts_with("multipart/form-data"))
+        {
+            crow::multipart::message msg(req);
+            auto file_part = msg.get_part_by_name("file");
+            if (file_part.headers.empty())
+            {
+                return crow::response(400, "{\"error\": \"No se encontró la parte del "
+                                           "archivo en el formulario.\"}");
+            }
+            body = file_part.body;
+        }
+
+        if (body.empty())
+        {
+            return crow::response(400, "{\"error\": \"El contenido del documento está vacío\"}");
+        }
+
+        auto admission = admission_->Admit(Services::RequestPriority::INGEST, 0);
+        if (!admission.IsAdmitted())
+        {
+            return RejectedResponse(admission);
+        }
+        auto mutation_lock = catalog_->LockMutations();
+
+        auto entry = catalog_->Find(document_id);
+        if (!entry)
+        {
+            return crow::response(404, "{\"error\": \"Documento no encontrado\"}");
+        }
+
+        // El contenido nuevo se escribe aparte y solo reemplaza al archivo si el reindexado
+        // funciona; si falla, el documento conserva su contenido en disco y en el índice
+        std::filesystem::path staged_path = entry->path;
+        staged_path += ".update";
+        if (!Shared::FileUtils::WriteFileAtomic(staged_path, body))
+        {
+            return crow::response(
+                500, "{\"error\": \"No se pudo guardar el archivo en el servidor.\"}");
+        }
+
+        std::string content = Shared::FileUtils::ExtractText(staged_path.string());
+        Models::IndexDocumentRequest index_req{document_id, content, entry->filename,
+                                               std::time(nullptr)};
+        std::error_code ec;
+        if (!search_service_->UpdateDocument(index_req))
+        {
+            std::filesystem::remove(staged_path, ec);
+            return crow::response(500, "{\"error\": \"No se pudo reindexar el documento\"}");
+        }
+
+        std::filesystem::rename(staged_path, entry->path, ec);
+        if (ec)
+        {
+            std::cerr << "[-] Error al reemplazar " << entry->path << ": " << ec.message()
+                      << std::endl;
+            std::filesystem::remove(staged_path, ec);
+            // El índice ya tiene el texto nuevo: vuelve al del archivo, que no cambió
+            search_service_->UpdateDocument(
+                {document_id, Shared::FileUtils::ExtractText(entry->path), entry->filename,
+                 entry->timestamp});
+            return crow::response(
+                500, "{\"error\": \"No se pudo guardar el archivo en el servidor.\"}");
+        }
+        catalog_->Touch(document_id);
+
+        // Registrar el nuevo hash; si otro documento ya tiene ese contenido, este solo pierde
+        // el anterior
+        const uint64_t content_hash = Shared::HashUtils::Hash64(body);
+        uint64_t simhash =
+            content_hashes_->GetNearDuplicateOptions().enabled
+                ? Shared::HashUtils::SimHash(Shared::TextUtils::normalizeForSearch(content))
+                : 0;
+        auto dropped_aliases = content_hashes_->Register(content_hash, document_id, simhash);
+
+        crow::json::wvalue response;
+        response["message"] = "Documento '" + entry->filename + "' actualizado y reindexado.";
+        response["doc_id"] = document_id;
+        response["content_hash"] = Shared::HashUtils::ToHex(content_hash);
+        // Los alias eran copias del contenido anterior
+        response["dropped_aliases"] = AliasesToJson(dropped_aliases);
+        response["success"] = true;
+        return crow::response(200, response);
+    }
+
+    void DocumentController::RegisterRoutes(crow::App<crow::CORSHandler>& app)
+    {
+        CROW_ROUTE(app, "/api/documents/<uint>")
+            .methods("DELETE"_method)([this](const crow::request&, uint64_t document_id)
+                                      { return HandleDelete(document_id); });
+
+        CROW_ROUTE(app, "/api/documents/<uint>")
+            .methods("PUT"_method)([this](const crow::request& req, uint64_t document_id)
+                                   { return HandleUpdate(req, document_id); });
+    }
+
+} // namespace DocuTrace::Controllers
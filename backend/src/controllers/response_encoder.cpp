@@ -0,0 +1,182 @@
+#include "controllers/response_encoder.hpp"
+#include <algorithm>
+#include <cctype>
+#include <vector>
+
+namespace DocuTrace::Controllers
+{
+    namespace
+    {
+        struct MediaRange
+        {
+            std::string name;
+            double quality = 1.0;
+        };
+
+        std::string_view trim(std::string_view text)
+        {
+            while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front())))
+            {
+                text.remove_prefix(1);
+            }
+            while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back())))
+            {
+                text.remove_suffix(1);
+            }
+            return text;
+        }
+
+        // "a;q=0.5, b" → {{"a", 0.5}, {"b", 1}}, nombres en minúsculas
+        std::vector<MediaRange> parse_header_list(std::string_view header)
+        {
+            std::vector<MediaRange> ranges;
+            while (!header.empty())
+            {
+                const size_t comma = header.find(',');
+                std::string_view item = header.substr(0, comma);
+                header = comma == std::string_view::npos ? std::string_view{}
+                                                         : header.substr(comma + 1);
+
+                MediaRange range;
+                const size_t semicolon = item.find(';');
+                for (char c : trim(item.substr(0, semicolon)))
+                {
+                    range.name += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+                }
+                if (semicolon != std::string_view::npos)
+                {
+                    std::string_view parameters = trim(item.substr(semicolon + 1));
+                    if (parameters.starts_with("q="))
+                    {
+                        try
+                        {
+                            range.quality = std::stod(std::string(parameters.substr(2)));
+                        }
+                        catch (const std::exception&)
+                        {
+                            range.quality = 0.0;
+                        }
+                    }
+                }
+                if (!range.name.empty() && range.quality > 0.0)
+                {
+                    ranges.push_back(std::move(range));
+                }
+            }
+            // A igual calidad se respeta el orden del cliente
+            std::stable_sort(ranges.begin(), ranges.end(),
+                             [](const MediaRange& a, const MediaRange& b)
+                             { return a.quality > b.quality; });
+            return ranges;
+        }
+
+        const char* content_type(Shared::WireFormat format, bool sequence)
+        {
+            switch (format)
+            {
+            case Shared::WireFormat::MSGPACK:
+                return "application/msgpack";
+            case Shared::WireFormat::CBOR:
+                return sequence ? "application/cbor-seq" : "application/cbor";
+            case Shared::WireFormat::JSON:
+                break;
+            }
+            return sequence ? "application/x-ndjson" : "application/json";
+        }
+    } // namespace
+
+    Shared::WireFormat ResponseEncoder::NegotiateFormat(std::string_view accept)
+    {
+        for (const auto& range : parse_header_list(accept))
+        {
+            if (range.name == "application/msgpack" || range.name == "application/x-msgpack")
+            {
+                return Shared::WireFormat::MSGPACK;
+            }
+            if (range.name == "application/cbor" || range.name == "application/cbor-seq")
+            {
+                return Shared::WireFormat::CBOR;
+            }
+            if (range.name == "application/json" || range.name == "application/x-ndjson" ||
+                range.name == "*/*")
+            {
+                return Shared::WireFormat::JSON;
+            }
+        }
+        return Shared::WireFormat::JSON;
+    }
+
+    Shared::ContentEncoding ResponseEncoder::NegotiateEncoding(std::string_view accept_encoding)
+    {
+        for (const auto& range : parse_header_list(accept_encoding))
+        {
+            if (range.name == "gzip" || range.name == "*")
+            {
+                return Shared::ContentEncoding::GZIP;
+            }
+            if (range.name == "deflate")
+            {
+                return Shared::ContentEncoding::DEFLATE;
+            }
+        }
+        return Shared::ContentEncoding::IDENTITY;
+    }
+
+    ResponseEncoder::ResponseEncoder(const crow::request& req, int compression_level,
+                                     bool sequence)
+        : sequence_(sequence), compression_level_(compression_level),
+          writer_(NegotiateFormat(req.get_header_value("Accept")),
+                  [this](std::string_view chunk) { Consume(chunk); })
+    {
+        if (compression_level_ > 0)
+        {
+            encoding_ = NegotiateEncoding(req.get_header_value("Accept-Encoding"));
+        }
+    }
+
+    void ResponseEncoder::Consume(std::string_view chunk)
+    {
+        if (encoding_ == Shared::ContentEncoding::IDENTITY)
+        {
+            body_.append(chunk);
+            return;
+        }
+        if (!compressor_)
+        {
+            pending_.append(chunk);
+            if (pending_.size() < MIN_COMPRESSED_BYTES)
+            {
+                return;
+            }
+            compressor_ = std::make_unique<Shared::StreamCompressor>(encoding_, compression_level_);
+            chunk = pending_;
+        }
+        compressor_->Write(chunk, body_);
+        pending_.clear();
+    }
+
+    crow::response ResponseEncoder::Finish(int code)
+    {
+        writer_.Flush();
+
+        crow::response response(code);
+        if (compressor_)
+        {
+            compressor_->Finish(body_);
+            response.set_header("Content-Encoding", encoding_ == Shared::ContentEncoding::GZIP
+                                                        ? "gzip"
+                                                        : "deflate");
+        }
+        else
+        {
+            body_.append(pending_);
+        }
+
+        response.set_header("Content-Type", content_type(writer_.GetFormat(), sequence_));
+        // El cuerpo depende de estas cabeceras: las cachés intermedias deben distinguirlas
+        response.set_header("Vary", "Accept, Accept-Encoding");
+        response.body = std::move(body_);
+        return response;
+    }
+
+} // namespace DocuTrace::Controllers
@@ -1,11 +1,131 @@
 #include "controllers/search_controller.hpp"
+#include <algorithm>
+#include <chrono>
+#include "controllers/admission_response.hpp"
+#include "controllers/response_encoder.hpp"
 #include "models/search_models.hpp"
 #include "services/search_service.hpp"
+#include "shared/text_utils.hpp"
 
 namespace DocuTrace::Controllers
 {
-    SearchController::SearchController(std::shared_ptr<Services::SearchService> service)
-        : search_service_(std::move(service))
+    namespace
+    {
+        /**
+         * @brief Abre el objeto común de /api/search y de cada registro de /api/search/batch
+         * @param extra_fields Campos que el llamador escribe después, antes de EndObject
+         */
+        void begin_search_response(Shared::StructuredWriter& writer,
+                                   const Models::SearchResponse& search_response,
+                                   size_t extra_fields)
+        {
+            const bool distributed = search_response.nodes_total > 0;
+            const bool paginated = !search_response.next_cursor.empty();
+            const bool faceted = !search_response.facets.empty();
+            writer.BeginObject(3 + (distributed ? 1 : 0) + (paginated ? 1 : 0) +
+                               (faceted ? 1 : 0) + (search_response.timed_out ? 1 : 0) +
+                               extra_fields);
+            writer.Key("total_results");
+            writer.UInt(search_response.results.size());
+
+            writer.Key("results");
+            writer.BeginArray(search_response.results.size());
+            for (const auto& r : search_response.results)
+            {
+                // Los documentos indexados en bloque no tienen nombre ni fecha
+                const bool has_metadata = !r.filename.empty() || r.timestamp != 0;
+                writer.BeginObject(3 + (r.node.empty() ? 0 : 1) + (has_metadata ? 2 : 0));
+                writer.Key("document_id");
+                writer.UInt(r.document_id);
+                writer.Key("content_preview");
+                writer.String(r.content);
+                writer.Key("score");
+                writer.Double(r.score);
+                if (!r.node.empty())
+                {
+                    writer.Key("node");
+                    writer.String(r.node);
+                }
+                if (has_metadata)
+                {
+                    writer.Key("filename");
+                    writer.String(r.filename);
+                    writer.Key("timestamp");
+                    writer.Int(r.timestamp);
+                }
+                writer.EndObject();
+            }
+            writer.EndArray();
+
+            // {"extension": [{"value": "pdf", "count": 12}, ...], "month": [...]}
+            if (faceted)
+            {
+                writer.Key("facets");
+                writer.BeginObject(search_response.facets.size());
+                for (const auto& facet : search_response.facets)
+                {
+                    writer.Key(facet.field);
+                    writer.BeginArray(facet.buckets.size());
+                    for (const auto& bucket : facet.buckets)
+                    {
+                        writer.BeginObject(2);
+                        writer.Key("value");
+                        writer.String(bucket.value);
+                        writer.Key("count");
+                        writer.UInt(bucket.count);
+                        writer.EndObject();
+                    }
+                    writer.EndArray();
+                }
+                writer.EndObject();
+            }
+
+            // Workers que no respondieron a tiempo o timeout_ms agotado: resultados parciales
+            writer.Key("partial");
+            writer.Bool(search_response.IsPartial());
+            if (search_response.timed_out)
+            {
+                writer.Key("quality");
+                writer.Double(search_response.quality);
+            }
+            if (distributed)
+            {
+                writer.Key("nodes");
+                writer.BeginObject(2);
+                writer.Key("total");
+                writer.UInt(search_response.nodes_total);
+                writer.Key("failed");
+                writer.UInt(search_response.nodes_failed);
+                writer.EndObject();
+            }
+            if (paginated)
+            {
+                writer.Key("next_cursor");
+                writer.String(search_response.next_cursor);
+            }
+        }
+
+        crow::response encode_search_response(const crow::request& req,
+                                              const Models::SearchResponse& search_response,
+                                              int compression_level)
+        {
+            // Sin árbol JSON intermedio: el contenido se escribe tal cual en el cuerpo
+            ResponseEncoder encoder(req, compression_level);
+            Shared::StructuredWriter& writer = encoder.Writer();
+            begin_search_response(writer, search_response, 1);
+            writer.Key("success");
+            writer.Bool(true);
+            writer.EndObject();
+            return encoder.Finish();
+        }
+    } // namespace
+
+    SearchController::SearchController(std::shared_ptr<Services::SearchService> service,
+                                       int compression_level,
+                                       std::shared_ptr<Services::AdmissionControl> admission,
+                                       std::shared_ptr<const Services::FolderCrawler> crawler)
+        : search_service_(std::move(service)), compression_level_(compression_level),
+          admission_(std::move(admission)), crawler_(std::move(crawler))
     {
     }
 
@@ -15,6 +135,42 @@ namespace DocuTrace::Controllers
             .methods("GET"_method)(
                 [this](const crow::request& req)
                 {
+                    size_t limit = 10;
+                    auto limit_str = req.url_params.get("limit");
+                    if (limit_str)
+                    {
+                        try
+                        {
+                            limit = std::stoul(limit_str);
+                        }
+                        catch (const std::exception&)
+                        {
+                            return crow::response(400,
+                                                  "{\"error\": \"Parámetro 'limit' inválido\"}");
+                        }
+                    }
+
+                    // Página siguiente de un cursor: la consulta ya va en él
+                    auto cursor = req.url_params.get("cursor");
+                    if (cursor)
+                    {
+                        Models::SearchPageRequest page_req{cursor, limit};
+                        if (!page_req.IsValid())
+                        {
+                            return crow::response(
+                                400, "{\"error\": \"Parámetros de paginación inválidos\"}");
+                        }
+
+                        auto page = search_service_->SearchPage(page_req);
+                        if (!page)
+                        {
+                            return crow::response(410, "{\"error\": \"Cursor desconocido o "
+                                                       "caducado; continúa con after_score y "
+                                                       "after_id\"}");
+                        }
+                        return encode_search_response(req, *page, compression_level_);
+                    }
+
                     auto query = req.url_params.get("query");
                     if (!query)
                     {
@@ -22,7 +178,282 @@ namespace DocuTrace::Controllers
                                               "{\"error\": \"El parámetro 'query' es requerido\"}");
                     }
 
-                    size_t limit = 10;
+                    Models::SearchRequest search_req{query, limit};
+
+                    auto autocomplete_str = req.url_params.get("autocomplete");
+                    search_req.autocomplete =
+                        autocomplete_str && std::string(autocomplete_str) == "true";
+
+                    auto fuzzy_str = req.url_params.get("fuzzy");
+                    if (fuzzy_str)
+                    {
+                        try
+                        {
+                            search_req.fuzzy = std::stoi(fuzzy_str);
+                        }
+                        catch (const std::exception&)
+                        {
+                            return crow::response(400,
+                                                  "{\"error\": \"Parámetro 'fuzzy' inválido\"}");
+                        }
+                    }
+
+                    // Modelo de puntuación de esta consulta (bm25, bm25plus, bm25l, bm25f)
+                    auto ranking_str = req.url_params.get("ranking");
+                    if (ranking_str)
+                    {
+                        search_req.ranking = ranking_str;
+                    }
+                    auto k1_str = req.url_params.get("k1");
+                    auto b_str = req.url_params.get("b");
+                    try
+                    {
+                        if (k1_str)
+                        {
+                            search_req.k1 = std::stod(k1_str);
+                        }
+                        if (b_str)
+                        {
+                            search_req.b = std::stod(b_str);
+                        }
+                    }
+                    catch (const std::exception&)
+                    {
+                        return crow::response(
+                            400, "{\"error\": \"Parámetros 'k1' y 'b' inválidos\"}");
+                    }
+
+                    // Búsqueda en dos fases: candidates o proximity la activan sin two_phase=
+                    auto two_phase_str = req.url_params.get("two_phase");
+                    if (two_phase_str)
+                    {
+                        search_req.two_phase = std::string(two_phase_str) == "true";
+                    }
+                    auto candidates_str = req.url_params.get("candidates");
+                    auto proximity_str = req.url_params.get("proximity");
+                    try
+                    {
+                        if (candidates_str)
+                        {
+                            search_req.candidates = std::stoul(candidates_str);
+                        }
+                        if (proximity_str)
+                        {
+                            search_req.proximity = std::stod(proximity_str);
+                        }
+                    }
+                    catch (const std::exception&)
+                    {
+                        return crow::response(
+                            400,
+                            "{\"error\": \"Parámetros 'candidates' y 'proximity' inválidos\"}");
+                    }
+
+                    // Facetas (extension,month,directory) y orden por campo (sort=-timestamp)
+                    auto facets_str = req.url_params.get("facets");
+                    if (facets_str)
+                    {
+                        search_req.facets = Shared::TextUtils::splitString(facets_str, ',');
+                    }
+                    auto sort_str = req.url_params.get("sort");
+                    if (sort_str)
+                    {
+                        search_req.sort = sort_str;
+                    }
+
+                    auto paginate_str = req.url_params.get("paginate");
+                    search_req.paginate = paginate_str && std::string(paginate_str) == "true";
+
+                    // Clave search-after: score y document_id del último resultado recibido
+                    auto after_score_str = req.url_params.get("after_score");
+                    auto after_id_str = req.url_params.get("after_id");
+                    if (after_score_str || after_id_str)
+                    {
+                        try
+                        {
+                            search_req.search_after = Models::SearchAfter{
+                                std::stod(after_score_str ? after_score_str : ""),
+                                std::stoull(after_id_str ? after_id_str : "")};
+                        }
+                        catch (const std::exception&)
+                        {
+                            return crow::response(400, "{\"error\": \"Parámetros 'after_score' "
+                                                       "y 'after_id' inválidos\"}");
+                        }
+                    }
+
+                    // Tiempo máximo de puntuación: al agotarse responde con partial y quality
+                    auto timeout_str = req.url_params.get("timeout_ms");
+                    if (timeout_str)
+                    {
+                        try
+                        {
+                            search_req.timeout_ms = static_cast<uint32_t>(
+                                std::min<unsigned long>(std::stoul(timeout_str),
+                                                        Models::SearchRequest::MAX_TIMEOUT_MS +
+                                                            1));
+                        }
+                        catch (const std::exception&)
+                        {
+                            return crow::response(
+                                400, "{\"error\": \"Parámetro 'timeout_ms' inválido\"}");
+                        }
+                    }
+
+                    if (!search_req.IsValid())
+                    {
+                        return crow::response(400,
+                                              "{\"error\": \"Parámetros de búsqueda inválidos\"}");
+                    }
+
+                    // Se estima el coste antes de ocupar un hilo de búsqueda con ella
+                    const auto arrival = std::chrono::steady_clock::now();
+                    auto admission = admission_->Admit(Services::RequestPriority::INTERACTIVE,
+                                                       search_service_->EstimateCost(search_req));
+                    if (!admission.IsAdmitted())
+                    {
+                        return RejectedResponse(admission);
+                    }
+                    // La espera en la cola cuenta contra timeout_ms; sin tiempo, se puntúa lo
+                    // mínimo (ver BM25Engine::ScoreDisjunctionAnytime)
+                    if (search_req.timeout_ms)
+                    {
+                        const auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                                std::chrono::steady_clock::now() - arrival)
+                                                .count();
+                        search_req.timeout_ms = static_cast<uint32_t>(
+                            std::max<int64_t>(1, int64_t{*search_req.timeout_ms} - waited));
+                    }
+                    return encode_search_response(req, search_service_->Search(search_req),
+                                                  compression_level_);
+                });
+
+        // Lote de consultas: {"queries": [{"query": "...", "limit": 10, "autocomplete":
+        // false, "fuzzy": 0, "ranking": "bm25"}, ...]}. Responde un registro por consulta, en
+        // orden (JSON por líneas, o MessagePack/CBOR concatenados)
+        CROW_ROUTE(app, "/api/search/batch")
+            .methods("POST"_method)(
+                [this](const crow::request& req)
+                {
+                    auto body = crow::json::load(req.body);
+                    if (!body || body.t() != crow::json::type::Object || !body.has("queries") ||
+                        body["queries"].t() != crow::json::type::List)
+                    {
+                        return crow::response(
+                            400, "{\"error\": \"El campo 'queries' (lista) es requerido\"}");
+                    }
+
+                    Models::SearchBatchRequest batch_req;
+                    try
+                    {
+                        for (const auto& item : body["queries"])
+                        {
+                            Models::SearchRequest search_req{std::string(item["query"].s())};
+                            if (item.has("limit"))
+                            {
+                                search_req.limit = static_cast<size_t>(item["limit"].u());
+                            }
+                            if (item.has("autocomplete"))
+                            {
+                                search_req.autocomplete = item["autocomplete"].b();
+                            }
+                            if (item.has("fuzzy"))
+                            {
+                                search_req.fuzzy = static_cast<int>(item["fuzzy"].i());
+                            }
+                            if (item.has("ranking"))
+                            {
+                                search_req.ranking = std::string(item["ranking"].s());
+                            }
+                            if (item.has("k1"))
+                            {
+                                search_req.k1 = item["k1"].d();
+                            }
+                            if (item.has("b"))
+                            {
+                                search_req.b = item["b"].d();
+                            }
+                            if (item.has("two_phase"))
+                            {
+                                search_req.two_phase = item["two_phase"].b();
+                            }
+                            if (item.has("candidates"))
+                            {
+                                search_req.candidates =
+                                    static_cast<size_t>(item["candidates"].u());
+                            }
+                            if (item.has("proximity"))
+                            {
+                                search_req.proximity = item["proximity"].d();
+                            }
+                            if (item.has("facets"))
+                            {
+                                for (const auto& facet : item["facets"])
+                                {
+                                    search_req.facets.push_back(std::string(facet.s()));
+                                }
+                            }
+                            if (item.has("sort"))
+                            {
+                                search_req.sort = std::string(item["sort"].s());
+                            }
+                            if (item.has("timeout_ms"))
+                            {
+                                search_req.timeout_ms = static_cast<uint32_t>(std::min<uint64_t>(
+                                    item["timeout_ms"].u(),
+                                    Models::SearchRequest::MAX_TIMEOUT_MS + 1));
+                            }
+                            batch_req.queries.push_back(std::move(search_req));
+                        }
+                    }
+                    catch (const std::exception&)
+                    {
+                        return crow::response(400,
+                                              "{\"error\": \"Consulta del lote inválida\"}");
+                    }
+
+                    if (!batch_req.IsValid())
+                    {
+                        return crow::response(
+                            400, "{\"error\": \"Parámetros de búsqueda inválidos (máximo " +
+                                     std::to_string(Models::SearchBatchRequest::MAX_QUERIES) +
+                                     " consultas)\"}");
+                    }
+
+                    auto admission = admission_->Admit(Services::RequestPriority::BATCH,
+                                                       search_service_->EstimateCost(batch_req));
+                    if (!admission.IsAdmitted())
+                    {
+                        return RejectedResponse(admission);
+                    }
+                    auto responses = search_service_->SearchBatch(batch_req);
+
+                    ResponseEncoder encoder(req, compression_level_, true);
+                    Shared::StructuredWriter& writer = encoder.Writer();
+                    for (size_t i = 0; i < responses.size(); ++i)
+                    {
+                        begin_search_response(writer, responses[i], 1);
+                        writer.Key("index");
+                        writer.UInt(i);
+                        writer.EndObject();
+                        writer.EndRecord();
+                    }
+                    return encoder.Finish();
+                });
+
+        // Autocompletado mientras se escribe: no toca documentos ni puntúa
+        CROW_ROUTE(app, "/api/suggest")
+            .methods("GET"_method)(
+                [this](const crow::request& req)
+                {
+                    auto prefix = req.url_params.get("prefix");
+                    if (!prefix)
+                    {
+                        return crow::response(
+                            400, "{\"error\": \"El parámetro 'prefix' es requerido\"}");
+                    }
+
+                    size_t limit = 5;
                     auto limit_str = req.url_params.get("limit");
                     if (limit_str)
                     {
@@ -37,30 +468,119 @@ namespace DocuTrace::Controllers
                         }
                     }
 
-                    Models::SearchRequest search_req{query, limit};
-                    if (!search_req.IsValid())
+                    Models::SuggestRequest suggest_req{prefix, limit};
+                    if (!suggest_req.IsValid())
                     {
-                        return crow::response(400,
-                                              "{\"error\": \"Parámetros de búsqueda inválidos\"}");
+                        return crow::response(
+                            400, "{\"error\": \"Parámetros de autocompletado inválidos\"}");
                     }
 
-                    auto results = search_service_->Search(search_req);
+                    std::vector<crow::json::wvalue> suggestions_json;
+                    for (const auto& suggestion : search_service_->Suggest(suggest_req))
+                    {
+                        crow::json::wvalue item;
+                        item["text"] = suggestion.text;
+                        item["word"] = suggestion.word;
+                        item["document_frequency"] = suggestion.document_frequency;
+                        suggestions_json.push_back(std::move(item));
+                    }
 
                     crow::json::wvalue response;
-                    response["total_results"] = results.size();
+                    response["suggestions"] = std::move(suggestions_json);
+                    response["success"] = true;
+                    return crow::response(200, response);
+                });
+
+        // Estado del índice y de la replicación (generación servida y retraso)
+        CROW_ROUTE(app, "/api/stats")
+            .methods("GET"_method)(
+                [this](const crow::request& req)
+                {
+                    Models::SystemStats stats = search_service_->GetStats();
 
-                    std::vector<crow::json::wvalue> results_json;
-                    for (const auto& r : results)
+                    crow::json::wvalue response;
+                    response["total_documents"] = stats.total_documents;
+                    response["pending_deletions"] = stats.pending_deletions;
+                    response["total_terms"] = stats.total_terms;
+                    response["total_postings"] = stats.total_postings;
+                    response["suggestion_words"] = stats.suggestion_words;
+                    response["engine_type"] = stats.engine_type;
+                    response["ranking_model"] = stats.ranking_model;
+                    response["version"] = stats.version;
+                    response["replication"]["mode"] = stats.replication_mode;
+                    response["replication"]["generation"] = stats.replication_generation;
+                    response["replication"]["latest_generation"] =
+                        stats.replication_latest_generation;
+                    response["replication"]["lag_ms"] = stats.replication_lag_ms;
+                    response["memory"]["budget_bytes"] = stats.memory_budget_bytes;
+                    response["memory"]["resident_bytes"] = stats.memory_resident_bytes;
+                    response["memory"]["cold_bytes"] = stats.memory_cold_bytes;
+                    response["memory"]["metadata_bytes"] = stats.memory_metadata_bytes;
+                    response["memory"]["hits"]["postings"]["resident"] =
+                        stats.posting_hits_resident;
+                    response["memory"]["hits"]["postings"]["cold"] = stats.posting_hits_cold;
+                    response["memory"]["hits"]["documents"]["resident"] =
+                        stats.document_hits_resident;
+                    response["memory"]["hits"]["documents"]["cold"] = stats.document_hits_cold;
+                    response["open_cursors"] = stats.open_cursors;
+                    response["two_phase"]["queries"] = stats.two_phase_queries;
+                    response["two_phase"]["avg_candidates"] = stats.two_phase_candidates;
+                    response["two_phase"]["avg_deferred_terms"] = stats.two_phase_deferred_terms;
+                    response["two_phase"]["first_phase_ms"] = stats.two_phase_first_phase_ms;
+                    response["two_phase"]["second_phase_ms"] = stats.two_phase_second_phase_ms;
+                    response["two_phase"]["sampled_queries"] = stats.two_phase_sampled_queries;
+                    response["two_phase"]["recall"] = stats.two_phase_recall;
+                    response["reordering"]["order"] = stats.document_order;
+                    response["reordering"]["runs"] = stats.reorder_runs;
+                    response["reordering"]["documents"] = stats.reorder_documents;
+                    response["reordering"]["bits_per_posting_before"] =
+                        stats.reorder_bits_per_posting_before;
+                    response["reordering"]["bits_per_posting_after"] =
+                        stats.reorder_bits_per_posting_after;
+                    response["reordering"]["duration_ms"] = stats.reorder_duration_ms;
+                    response["term_filter"]["terms"] = stats.term_filter_terms;
+                    response["term_filter"]["unsealed_terms"] = stats.term_filter_unsealed_terms;
+                    response["term_filter"]["bits_per_term"] = stats.term_filter_bits_per_term;
+                    response["term_filter"]["lookups"] = stats.term_filter_lookups;
+                    response["term_filter"]["skip_rate"] = stats.term_filter_skip_rate;
+                    response["term_filter"]["hit_rate"] = stats.term_filter_hit_rate;
+                    response["term_filter"]["false_positive_rate"] =
+                        stats.term_filter_false_positive_rate;
+                    // Peticiones en curso, en cola y rechazadas por clase
+                    Services::AdmissionStats admission = admission_->GetStats();
+                    response["admission"]["enabled"] = admission.enabled;
+                    response["admission"]["max_concurrent"] = admission.max_concurrent;
+                    response["admission"]["cost_budget"] = admission.cost_budget;
+                    response["admission"]["cost_in_flight"] = admission.cost_in_flight;
+                    response["admission"]["avg_service_ms"] = admission.avg_service_ms;
+                    for (size_t i = 0; i < admission.classes.size(); ++i)
+                    {
+                        const auto& stats = admission.classes[i];
+                        const char* name = Services::AdmissionControl::PriorityName(
+                            static_cast<Services::RequestPriority>(i));
+                        auto& item = response["admission"]["classes"][name];
+                        item["admitted"] = stats.admitted;
+                        item["queued"] = stats.queued;
+                        item["rejected_cost"] = stats.rejected_cost;
+                        item["rejected_queue_full"] = stats.rejected_queue_full;
+                        item["timed_out"] = stats.timed_out;
+                        item["running"] = stats.running;
+                        item["waiting"] = stats.waiting;
+                        item["avg_queue_ms"] = stats.avg_queue_ms;
+                        item["max_queue_ms"] = stats.max_queue_ms;
+                    }
+                    if (crawler_)
                     {
-                        crow::json::wvalue result_item;
-                        result_item["document_id"] = r.document_id;
-                        result_item["content_preview"] = r.content;
-                        result_item["score"] = r.score;
-                        results_json.push_back(std::move(result_item));
+                        Services::CrawlerStats crawler = crawler_->GetStats();
+                        response["crawler"]["files"] = crawler.files;
+                        response["crawler"]["watched_directories"] = crawler.watches;
+                        response["crawler"]["added"] = crawler.added;
+                        response["crawler"]["updated"] = crawler.updated;
+                        response["crawler"]["removed"] = crawler.removed;
+                        response["crawler"]["unchanged"] = crawler.unchanged;
+                        response["crawler"]["rescans"] = crawler.rescans;
                     }
-                    response["results"] = std::move(results_json);
                     response["success"] = true;
-
                     return crow::response(200, response);
                 });
 
@@ -74,8 +594,30 @@ namespace DocuTrace::Controllers
                     info["version"] = "2.0.0";
                     info["description"] = "Motor de búsqueda BM25 con API REST";
                     info["endpoints"]["health"] = "GET /health, GET /health";
-                    info["endpoints"]["search"] = "GET /api/search?query={terminos}";
+                    info["endpoints"]["search"] =
+                        "GET /api/search?query={terminos}&autocomplete=true&fuzzy={0-2}"
+                        "&timeout_ms={1-60000}";
+                    info["endpoints"]["search_page"] =
+                        "GET /api/search?query={terminos}&paginate=true, luego "
+                        "GET /api/search?cursor={next_cursor}&limit={1-100}; sin cursor: "
+                        "&after_score={score}&after_id={document_id}";
+                    info["endpoints"]["search_batch"] = "POST /api/search/batch";
+                    info["ranking"] = "&ranking={bm25|bm25plus|bm25l|bm25f}&k1={>=0}&b={0-1}";
+                    info["two_phase"] =
+                        "&two_phase={true|false}&candidates={1-10000}&proximity={>=0}";
+                    info["facets"] = "&facets={extension,month,directory}"
+                                     "&sort={timestamp|-timestamp|filename|-filename}";
+                    info["query_syntax"] = "+obligatorio -excluido AND OR NOT (grupos) "
+                                           "filename:texto ext:pdf dir:/ruta after:AAAA-MM-DD "
+                                           "before:AAAA-MM-DD prefijo* errata~ errata~2";
+                    info["endpoints"]["suggest"] = "GET /api/suggest?prefix={texto}&limit={1-10}";
+                    info["endpoints"]["stats"] = "GET /api/stats";
                     info["endpoints"]["upload"] = "POST /api/upload/{filename}";
+                    info["endpoints"]["delete"] = "DELETE /api/documents/{id}";
+                    info["endpoints"]["update"] = "PUT /api/documents/{id}";
+                    info["endpoints"]["snapshots"] =
+                        "GET|POST /api/snapshots, POST /api/snapshots/{name}/restore, "
+                        "DELETE /api/snapshots/{name}";
 
                     return crow::response(200, info);
                 });
@@ -0,0 +1,59 @@
+#include "controllers/shard_controller.hpp"
+#include <iostream>
+#include "infrastructure/shard_protocol.hpp"
+
+namespace DocuTrace::Controllers
+{
+    using Infrastructure::ShardProtocol;
+
+    ShardController::ShardController(std::shared_ptr<Services::SearchService> service)
+        : search_service_(std::move(service))
+    {
+    }
+
+    crow::response ShardController::HandlePhase(const crow::request& req, const Phase& phase)
+    {
+        try
+        {
+            crow::response response(200, phase(req.body));
+            response.set_header("Content-Type", "application/json");
+            return response;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "[-] Petición de coordinador inválida: " << e.what() << std::endl;
+            return crow::response(400, "{\"error\": \"Petición de fase inválida\"}");
+        }
+    }
+
+    void ShardController::RegisterRoutes(crow::App<crow::CORSHandler>& app)
+    {
+        // Fase 1: términos del diccionario local para palabra* y palabra~
+        CROW_ROUTE(app, ShardProtocol::EXPANSIONS_PATH)
+            .methods("POST"_method)(
+                [this](const crow::request& req)
+                {
+                    return HandlePhase(req, [this](const std::string& body)
+                                       { return search_service_->ShardExpansions(body); });
+                });
+
+        // Fase 2: N, longitud total y df locales
+        CROW_ROUTE(app, ShardProtocol::STATISTICS_PATH)
+            .methods("POST"_method)(
+                [this](const crow::request& req)
+                {
+                    return HandlePhase(req, [this](const std::string& body)
+                                       { return search_service_->ShardStatistics(body); });
+                });
+
+        // Fase 3: top-k local puntuado con las estadísticas globales
+        CROW_ROUTE(app, ShardProtocol::SEARCH_PATH)
+            .methods("POST"_method)(
+                [this](const crow::request& req)
+                {
+                    return HandlePhase(req, [this](const std::string& body)
+                                       { return search_service_->ShardSearch(body); });
+                });
+    }
+
+} // namespace DocuTrace::Controllers
@@ -0,0 +1,154 @@
+#include "controllers/snapshot_controller.hpp"
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace DocuTrace::Controllers
+{
+    SnapshotController::SnapshotController(
+        std::shared_ptr<Services::SearchService> search_service,
+        std::shared_ptr<Services::FolderCrawler> crawler)
+        : search_service_(std::move(search_service)), crawler_(std::move(crawler))
+    {
+    }
+
+    crow::json::wvalue SnapshotController::ToJson(const Models::SnapshotInfo& snapshot)
+    {
+        crow::json::wvalue item;
+        item["name"] = snapshot.name;
+        item["created_at_ms"] = snapshot.created_at_ms;
+        item["duration_ms"] = snapshot.duration_ms;
+        item["documents"] = snapshot.documents;
+        item["last_id"] = snapshot.last_id;
+        item["linked_files"] = snapshot.linked_files;
+        item["copied_files"] = snapshot.copied_files;
+        item["written_segments"] = snapshot.written_segments;
+        return item;
+    }
+
+    crow::response SnapshotController::HandleCreate(const crow::request& req)
+    {
+        // Nombre opcional en ?name= o en {"name": "..."}
+        Models::SnapshotRequest snapshot_req;
+        if (auto name = req.url_params.get("name"))
+        {
+            snapshot_req.name = name;
+        }
+        else if (!req.body.empty())
+        {
+            auto body = crow::json::load(req.body);
+            if (!body || body.t() != crow::json::type::Object)
+            {
+                return crow::response(400, "{\"error\": \"Cuerpo JSON inválido\"}");
+            }
+            if (body.has("name"))
+            {
+                snapshot_req.name = std::string(body["name"].s());
+            }
+        }
+        if (!snapshot_req.IsValid())
+        {
+            return crow::response(400, "{\"error\": \"Nombre de copia inválido: letras, dígitos, "
+                                       "'-', '_' y '.', hasta 64 caracteres\"}");
+        }
+
+        try
+        {
+            crow::json::wvalue response;
+            response["snapshot"] = ToJson(search_service_->CreateSnapshot(snapshot_req.name));
+            response["success"] = true;
+            return crow::response(201, response);
+        }
+        catch (const std::invalid_argument&)
+        {
+            return crow::response(409, "{\"error\": \"Ya existe una copia con ese nombre\"}");
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "[-] Error al crear la copia: " << e.what() << std::endl;
+            return crow::response(500, "{\"error\": \"No se pudo crear la copia\"}");
+        }
+    }
+
+    crow::response SnapshotController::HandleRestore(const std::string& name)
+    {
+        std::optional<Models::SnapshotRestoreResult> result;
+        try
+        {
+            result = search_service_->RestoreSnapshot(name);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "[-] Error al restaurar la copia '" << name << "': " << e.what()
+                      << std::endl;
+            return crow::response(500, "{\"error\": \"La copia está dañada o incompleta\"}");
+        }
+        if (!result)
+        {
+            return crow::response(404, "{\"error\": \"Copia no encontrada\"}");
+        }
+
+        // La tabla de hashes ya volvió con el catálogo: los documentos subidos después de
+        // la copia no dejan hashes
+        std::vector<crow::json::wvalue> removed_json;
+        for (uint64_t document_id : result->removed_documents)
+        {
+            removed_json.push_back(crow::json::wvalue(document_id));
+        }
+        if (crawler_)
+        {
+            crawler_->RequestReindex();
+        }
+
+        crow::json::wvalue response;
+        response["snapshot"] = ToJson(result->snapshot);
+        response["documents"] = result->documents;
+        response["reindexed_documents"] = result->reindexed_documents;
+        response["removed_documents"] = std::move(removed_json);
+        response["duration_ms"] = result->duration_ms;
+        response["success"] = true;
+        return crow::response(200, response);
+    }
+
+    void SnapshotController::RegisterRoutes(crow::App<crow::CORSHandler>& app)
+    {
+        CROW_ROUTE(app, "/api/snapshots")
+            .methods("GET"_method)(
+                [this](const crow::request&)
+                {
+                    std::vector<crow::json::wvalue> snapshots_json;
+                    for (const auto& snapshot : search_service_->ListSnapshots())
+                    {
+                        snapshots_json.push_back(ToJson(snapshot));
+                    }
+
+                    crow::json::wvalue response;
+                    response["snapshots"] = std::move(snapshots_json);
+                    response["success"] = true;
+                    return crow::response(200, response);
+                });
+
+        CROW_ROUTE(app, "/api/snapshots")
+            .methods("POST"_method)([this](const crow::request& req) { return HandleCreate(req); });
+
+        CROW_ROUTE(app, "/api/snapshots/<string>/restore")
+            .methods("POST"_method)([this](const crow::request&, const std::string& name)
+                                    { return HandleRestore(name); });
+
+        CROW_ROUTE(app, "/api/snapshots/<string>")
+            .methods("DELETE"_method)(
+                [this](const crow::request&, const std::string& name)
+                {
+                    if (!search_service_->DeleteSnapshot(name))
+                    {
+                        return crow::response(404, "{\"error\": \"Copia no encontrada\"}");
+                    }
+                    crow::json::wvalue response;
+                    response["message"] = "Copia '" + name + "' eliminada.";
+                    response["success"] = true;
+                    return crow::response(200, response);
+                });
+    }
+
+} // namespace DocuTrace::Controllers
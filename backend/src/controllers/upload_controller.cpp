@@ -1,136 +1,23 @@
 #include "controllers/upload_controller.hpp"
-#include <cstdlib>
+#include "controllers/admission_response.hpp"
+#include <algorithm>
+#include <cstring>
 #include <ctime>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
-#include <nlohmann/json.hpp>
-#include <sstream>
 #include <string>
 #include "crow/json.h"
 #include "crow/multipart.h"
 #include "models/search_models.hpp"
+#include "shared/file_utils.hpp"
+#include "shared/hash_utils.hpp"
+#include "shared/text_utils.hpp"
 
 namespace
 {
-    // Obtener la ruta de datos de aplicación específica del sistema operativo
-    std::filesystem::path get_app_data_dir()
-    {
-        std::filesystem::path data_dir;
-
-#ifdef _WIN32
-        const char* appdata = std::getenv("APPDATA");
-        if (appdata)
-        {
-            data_dir = std::filesystem::path(appdata) / "DocuTrace";
-        }
-        else
-        {
-            const char* userprofile = std::getenv("USERPROFILE");
-            if (userprofile)
-            {
-                data_dir = std::filesystem::path(userprofile) / "AppData" / "Roaming" / "DocuTrace";
-            }
-            else
-            {
-                data_dir = std::filesystem::current_path() / "data";
-            }
-        }
-#elif __APPLE__
-        const char* home = std::getenv("HOME");
-        if (home)
-        {
-            data_dir =
-                std::filesystem::path(home) / "Library" / "Application Support" / "DocuTrace";
-        }
-        else
-        {
-            data_dir = std::filesystem::current_path() / "data";
-        }
-#else
-        const char* home = std::getenv("HOME");
-        if (home)
-        {
-            data_dir = std::filesystem::path(home) / ".local" / "share" / "DocuTrace";
-        }
-        else
-        {
-            data_dir = std::filesystem::current_path() / "data";
-        }
-#endif
-
-        // Crear el directorio si no existe
-        std::error_code ec;
-        std::filesystem::create_directories(data_dir, ec);
-
-        if (ec)
-        {
-            std::cerr << "[-] Error al crear directorio de datos: " << ec.message() << std::endl;
-            data_dir = std::filesystem::current_path() / "data";
-            std::filesystem::create_directories(data_dir);
-        }
-
-        std::cout << "[+] Directorio de datos: " << data_dir << std::endl;
-        return data_dir;
-    }
-
-    // --- Rutas absolutas basadas en el directorio de datos del sistema ---
-    const std::filesystem::path DATA_ROOT = get_app_data_dir();
-    const std::filesystem::path DOCS_PATH = DATA_ROOT / "docs";
-    const std::filesystem::path LAST_ID_FILE = DATA_ROOT / "last_id.txt";
-    const std::filesystem::path DOC_INDEX_FILE = DATA_ROOT / "document_index.json";
-
-    int get_next_id()
-    {
-        // Asegurar que el directorio existe
-        std::error_code ec;
-        std::filesystem::create_directories(DATA_ROOT, ec);
-        if (ec)
-        {
-            std::cerr << "[-] Error al crear directorio de datos: " << ec.message() << std::endl;
-            return 1;
-        }
-
-        int last_id = 0;
-
-        // Leer último ID si el archivo existe
-        if (std::filesystem::exists(LAST_ID_FILE))
-        {
-            std::ifstream in(LAST_ID_FILE);
-            if (in.is_open())
-            {
-                in >> last_id;
-                if (in.fail())
-                {
-                    std::cerr << "[-] Error al leer last_id.txt, reiniciando desde 0" << std::endl;
-                    last_id = 0;
-                }
-            }
-            else
-            {
-                std::cerr << "[-] No se pudo abrir last_id.txt para lectura" << std::endl;
-            }
-        }
-
-        int next_id = last_id + 1;
-
-        // Guardar nuevo ID
-        std::ofstream out(LAST_ID_FILE);
-        if (out.is_open())
-        {
-            out << next_id;
-            if (out.fail())
-            {
-                std::cerr << "[-] Error al escribir last_id.txt" << std::endl;
-            }
-        }
-        else
-        {
-            std::cerr << "[-] No se pudo abrir last_id.txt para escritura" << std::endl;
-        }
-
-        return next_id;
-    }
+    // Tamaño de bloque con el que se recorre el cuerpo subido
+    constexpr size_t UPLOAD_CHUNK_SIZE = 64 * 1024;
 
     // Extrae la extensión de un nombre de archivo
     std::string get_file_extension(const std::string& filename)
@@ -138,128 +25,29 @@ namespace
         return std::filesystem::path(filename).extension().string();
     }
 
-    // Actualiza el índice de documentos con la información del nuevo archivo.
-    void update_document_index(int doc_id, const std::string& original_name,
-                               const std::string& new_path)
-    {
-        nlohmann::json index;
-
-        // Leer índice existente si existe
-        if (std::filesystem::exists(DOC_INDEX_FILE))
-        {
-            std::ifstream in(DOC_INDEX_FILE);
-            if (in.is_open())
-            {
-                try
-                {
-                    in >> index;
-                    if (!index.is_array())
-                    {
-                        std::cerr
-                            << "[-] document_index.json no contiene un array válido, reiniciando"
-                            << std::endl;
-                        index = nlohmann::json::array();
-                    }
-                }
-                catch (const nlohmann::json::parse_error& e)
-                {
-                    std::cerr << "[-] Error al parsear document_index.json: " << e.what()
-                              << std::endl;
-                    std::cerr << "[-] Reiniciando índice desde cero" << std::endl;
-                    index = nlohmann::json::array();
-                }
-            }
-            else
-            {
-                std::cerr << "[-] No se pudo abrir document_index.json para lectura" << std::endl;
-                index = nlohmann::json::array();
-            }
-        }
-        else
-        {
-            // Archivo no existe, crear índice nuevo
-            index = nlohmann::json::array();
-            std::cout << "[+] Creando nuevo índice de documentos" << std::endl;
-        }
-
-        // Crear nueva entrada
-        nlohmann::json new_entry;
-        new_entry["id"] = doc_id;
-        new_entry["filename"] = original_name;
-        new_entry["path"] = new_path;
-        new_entry["timestamp"] = std::time(nullptr);
-
-        index.push_back(new_entry);
+} // namespace
 
-        // Guardar índice actualizado
-        std::ofstream out(DOC_INDEX_FILE);
-        if (out.is_open())
-        {
-            out << index.dump(4);
-            if (out.fail())
-            {
-                std::cerr << "[-] Error al escribir document_index.json" << std::endl;
-            }
-        }
-        else
-        {
-            std::cerr << "[-] No se pudo abrir document_index.json para escritura" << std::endl;
-        }
+namespace DocuTrace::Controllers
+{
+    UploadController::UploadController(
+        std::shared_ptr<Services::SearchService> search_service,
+        std::shared_ptr<Infrastructure::DocumentCatalog> catalog,
+        std::shared_ptr<Infrastructure::ContentHashTable> content_hashes,
+        std::shared_ptr<Services::AdmissionControl> admission)
+        : search_service_(std::move(search_service)), catalog_(std::move(catalog)),
+          content_hashes_(std::move(content_hashes)), admission_(std::move(admission))
+    {
+        BackfillContentHashes();
     }
 
-    // Extrae texto de un archivo (solo TXT por ahora)
-    std::string extract_text(const std::string& filepath)
+    void UploadController::BackfillContentHashes()
     {
-        // Verificar que el archivo existe
-        std::error_code ec;
-        if (!std::filesystem::exists(filepath, ec))
-        {
-            std::cerr << "[-] Archivo no existe: " << filepath << std::endl;
-            return "";
-        }
-
-        if (ec)
-        {
-            std::cerr << "[-] Error al verificar archivo: " << ec.message() << std::endl;
-            return "";
-        }
-
-        // Verificar que es un archivo regular
-        if (!std::filesystem::is_regular_file(filepath, ec))
-        {
-            std::cerr << "[-] No es un archivo regular: " << filepath << std::endl;
-            return "";
-        }
-
-        // Leer contenido del archivo
-        std::ifstream file(filepath, std::ios::in);
-        if (!file.is_open())
-        {
-            std::cerr << "[-] No se pudo abrir archivo para lectura: " << filepath << std::endl;
-            return "";
-        }
-
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-
-        if (file.bad())
+        const size_t backfilled = content_hashes_->Backfill(catalog_->GetEntries());
+        if (backfilled > 0)
         {
-            std::cerr << "[-] Error al leer archivo: " << filepath << std::endl;
-            return "";
+            std::cout << "[+] Hashes de contenido calculados para " << backfilled
+                      << " documentos existentes" << std::endl;
         }
-
-        std::string content = buffer.str();
-
-        return content;
-    }
-
-} // namespace
-
-namespace DocuTrace::Controllers
-{
-    UploadController::UploadController(std::shared_ptr<Services::SearchService> search_service)
-        : search_service_(std::move(search_service))
-    {
     }
 
     void UploadController::RegisterRoutes(crow::App<crow::CORSHandler>& app)
@@ -324,9 +112,41 @@ namespace DocuTrace::Controllers
                             400, "{\"error\": \"Por ahora, solo se permiten archivos .txt\"}");
                     }
 
+                    // Hash del contenido recorriendo el cuerpo por bloques
+                    Shared::ContentHasher hasher;
+                    const std::string& body = file_part.body;
+                    for (size_t offset = 0; offset < body.size(); offset += UPLOAD_CHUNK_SIZE)
+                    {
+                        hasher.Update(body.data() + offset,
+                                      std::min(UPLOAD_CHUNK_SIZE, body.size() - offset));
+                    }
+                    const uint64_t content_hash = hasher.Digest();
+
+                    auto admission = admission_->Admit(Services::RequestPriority::INGEST, 0);
+                    if (!admission.IsAdmitted())
+                    {
+                        return RejectedResponse(admission);
+                    }
+                    // Con el mismo lock que DELETE y PUT: el original no puede desaparecer
+                    // entre registrar el alias y responder
+                    auto mutation_lock = catalog_->LockMutations();
+
+                    // Contenido idéntico ya indexado: registrar alias sin reindexar
+                    if (auto original_id = content_hashes_->AddAlias(content_hash,
+                                                                     original_filename))
+                    {
+                        crow::json::wvalue response;
+                        response["message"] = "El contenido de '" + original_filename +
+                                              "' ya estaba indexado; registrado como alias.";
+                        response["doc_id"] = *original_id;
+                        response["duplicate"] = true;
+                        response["content_hash"] = Shared::HashUtils::ToHex(content_hash);
+                        return crow::response(200, response);
+                    }
+
                     // --- Lógica de persistencia e indexación ---
-                    int new_id = get_next_id();
-                    std::filesystem::path target_dir = DOCS_PATH / "txt";
+                    uint64_t new_id = catalog_->NextId();
+                    std::filesystem::path target_dir = catalog_->GetDocsPath() / "txt";
                     std::filesystem::create_directories(target_dir);
 
                     const std::string new_internal_filename = std::to_string(new_id) + extension;
@@ -343,22 +163,40 @@ namespace DocuTrace::Controllers
                     out_file.close();
 
                     // Actualizar índice
-                    update_document_index(new_id, original_filename, file_path_str);
+                    const std::time_t uploaded_at = std::time(nullptr);
+                    catalog_->Add({new_id, original_filename, file_path_str, uploaded_at});
 
                     // Extraer texto e indexar
-                    std::string content = extract_text(file_path_str);
+                    std::string content = Shared::FileUtils::ExtractText(file_path_str);
+                    std::optional<Infrastructure::NearDuplicateMatch> near_duplicate;
+                    uint64_t simhash = 0;
                     if (!content.empty())
                     {
-                        Models::IndexDocumentRequest index_req{static_cast<size_t>(new_id),
-                                                               content};
+                        if (content_hashes_->GetNearDuplicateOptions().enabled)
+                        {
+                            simhash = Shared::HashUtils::SimHash(
+                                Shared::TextUtils::normalizeForSearch(content));
+                            near_duplicate = content_hashes_->FindNearDuplicate(simhash);
+                        }
+
+                        Models::IndexDocumentRequest index_req{new_id, content, original_filename,
+                                                               uploaded_at};
                         search_service_->IndexDocument(index_req);
                     }
+                    content_hashes_->Register(content_hash, new_id, simhash);
 
                     crow::json::wvalue response;
                     response["message"] =
                         "Archivo '" + original_filename + "' subido e indexado exitosamente.";
                     response["doc_id"] = new_id;
                     response["path"] = file_path_str;
+                    response["duplicate"] = false;
+                    response["content_hash"] = Shared::HashUtils::ToHex(content_hash);
+                    if (near_duplicate)
+                    {
+                        response["near_duplicate_of"] = near_duplicate->document_id;
+                        response["near_duplicate_distance"] = near_duplicate->distance;
+                    }
                     return crow::response(201, response);
                 });
     }
@@ -1,9 +1,23 @@
 #include "infrastructure/bm25_engine.hpp"
 #include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <cmath>
+#include <functional>
 #include <future>
+#include <iostream>
+#include <limits>
+#include <mutex>
 #include <numeric>
+#include <stdexcept>
+#include <string_view>
 #include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include "infrastructure/query_evaluator.hpp"
+#include "infrastructure/query_parser.hpp"
+#include "shared/simd_kernels.hpp"
 #include "shared/text_utils.hpp"
 
 namespace DocuTrace::Infrastructure
@@ -12,292 +26,2897 @@ namespace DocuTrace::Infrastructure
     // IMPLEMENTACIÓN DE InvertedIndex
     // ============================================================================
 
-    void InvertedIndex::AddTerm(const std::string& term, int document_id)
+    namespace
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        document_frequency_[term].insert(document_id);
-        term_frequency_[term][document_id]++;
+        // Inserta o incrementa (documento, frecuencia) manteniendo el orden por ID
+        // @return true si se creó una entrada nueva
+        bool add_posting(PostingList& list, InternalDocumentId document_id, uint32_t frequency)
+        {
+            // Caso habitual: los IDs internos se asignan de forma creciente
+            if (list.documents.empty() || list.documents.back() < document_id)
+            {
+                list.documents.push_back(document_id);
+                list.frequencies.push_back(frequency);
+                return true;
+            }
+
+            size_t position = Shared::SimdKernels::LowerBound(list.documents.data(),
+                                                              list.documents.size(), document_id);
+            if (position < list.documents.size() && list.documents[position] == document_id)
+            {
+                list.frequencies[position] += frequency;
+                return false;
+            }
+
+            list.documents.insert(list.documents.begin() + position, document_id);
+            list.frequencies.insert(list.frequencies.begin() + position, frequency);
+            return true;
+        }
+
+        // Tras un remapeo que reordena (DocumentOrder::BISECTION) la lista deja de estar
+        // ordenada por ID; con el de orden de llegada ya lo está y no cuesta más que comprobarlo
+        void sort_postings(std::span<InternalDocumentId> documents, std::span<uint32_t> frequencies)
+        {
+            if (std::is_sorted(documents.begin(), documents.end()))
+            {
+                return;
+            }
+            std::vector<std::pair<InternalDocumentId, uint32_t>> pairs(documents.size());
+            for (size_t i = 0; i < documents.size(); ++i)
+            {
+                pairs[i] = {documents[i], frequencies[i]};
+            }
+            std::sort(pairs.begin(), pairs.end());
+            for (size_t i = 0; i < pairs.size(); ++i)
+            {
+                documents[i] = pairs[i].first;
+                frequencies[i] = pairs[i].second;
+            }
+        }
+    } // namespace
+
+    void InvertedIndex::AddTerm(const std::string& term, InternalDocumentId document_id)
+    {
+        auto [it, inserted] = postings_.try_emplace(term);
+        if (inserted)
+        {
+            dictionary_.Insert(term);
+            NoteNewTerm(term);
+        }
+        Promote(it->second);
+        it->second.accesses++;
+        posting_count_ += add_posting(it->second, document_id, 1);
+    }
+
+    void InvertedIndex::AddTerms(const std::vector<std::string>& terms,
+                                 InternalDocumentId document_id)
+    {
+        // Agrupar primero para añadir una sola entrada por término
+        std::unordered_map<std::string_view, uint32_t> counts;
+        counts.reserve(terms.size());
+        for (const auto& term : terms)
+        {
+            counts[term]++;
+        }
+
+        for (const auto& [term, frequency] : counts)
+        {
+            auto [it, inserted] = postings_.try_emplace(std::string(term));
+            if (inserted)
+            {
+                dictionary_.Insert(it->first);
+                NoteNewTerm(it->first);
+            }
+            // Las listas que se escriben cuentan como usadas para no expulsarlas enseguida
+            Promote(it->second);
+            it->second.accesses++;
+            posting_count_ += add_posting(it->second, document_id, frequency);
+        }
+    }
+
+    const PostingList* InvertedIndex::Find(const std::string& term) const
+    {
+        if (!term_filter_)
+        {
+            auto it = postings_.find(term);
+            return (it != postings_.end()) ? &it->second : nullptr;
+        }
+
+        const uint64_t hash = TermFilter::Hash(term);
+        if (!term_filter_->MayContain(hash) && !unsealed_terms_.contains(hash))
+        {
+            filter_hits_.skipped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        filter_hits_.passed.fetch_add(1, std::memory_order_relaxed);
+        auto it = postings_.find(term);
+        if (it == postings_.end())
+        {
+            filter_hits_.false_positives.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return &it->second;
+    }
+
+    void InvertedIndex::NoteNewTerm(const std::string& term)
+    {
+        // Sin filtro no hace falta: todas las búsquedas van al diccionario
+        if (term_filter_)
+        {
+            unsealed_terms_.insert(TermFilter::Hash(term));
+        }
+    }
+
+    bool InvertedIndex::SealTermFilter()
+    {
+        std::vector<uint64_t> hashes;
+        hashes.reserve(postings_.size());
+        for (const auto& [term, list] : postings_)
+        {
+            hashes.push_back(TermFilter::Hash(term));
+        }
+
+        TermFilter filter;
+        if (!filter.Build(std::move(hashes)))
+        {
+            term_filter_.reset();
+            unsealed_terms_.clear();
+            return false;
+        }
+        SetTermFilter(std::move(filter));
+        return true;
+    }
+
+    void InvertedIndex::SetTermFilter(TermFilter filter)
+    {
+        term_filter_ = std::move(filter);
+        unsealed_terms_.clear();
+    }
+
+    PostingView InvertedIndex::View(const PostingList& list) const
+    {
+        if (!list.IsCold())
+        {
+            return {list.documents, list.frequencies};
+        }
+
+        const uint64_t frequencies_offset =
+            list.cold_offset + uint64_t(list.cold_count) * sizeof(InternalDocumentId);
+        return {{reinterpret_cast<const InternalDocumentId*>(cold_->Data(list.cold_offset)),
+                 list.cold_count},
+                {reinterpret_cast<const uint32_t*>(cold_->Data(frequencies_offset)),
+                 list.cold_count}};
+    }
+
+    void InvertedIndex::Promote(PostingList& list)
+    {
+        if (!list.IsCold())
+        {
+            return;
+        }
+
+        PostingView view = View(list);
+        list.documents.assign(view.documents.begin(), view.documents.end());
+        list.frequencies.assign(view.frequencies.begin(), view.frequencies.end());
+        cold_posting_count_ -= list.cold_count;
+        cold_garbage_bytes_ += uint64_t(list.cold_count) * BYTES_PER_POSTING;
+        list.cold_offset = 0;
+        list.cold_count = 0;
+    }
+
+    int InvertedIndex::GetDocumentFrequency(const std::string& term,
+                                            InternalDocumentId document_id) const
+    {
+        auto list = GetPostings(term);
+        if (!list)
+        {
+            return 0;
+        }
+
+        size_t position =
+            Shared::SimdKernels::LowerBound(list->documents.data(), list->Size(), document_id);
+        if (position == list->Size() || list->documents[position] != document_id)
+        {
+            return 0;
+        }
+        return static_cast<int>(list->frequencies[position]);
+    }
+
+    int InvertedIndex::GetIndexFrequency(const std::string& term) const
+    {
+        const PostingList* list = Find(term);
+        return list ? static_cast<int>(list->Size() - list->deleted_count) : 0;
+    }
+
+    void InvertedIndex::MarkDeleted(const std::vector<std::string>& terms,
+                                    InternalDocumentId document_id)
+    {
+        std::unordered_set<std::string_view> seen;
+        seen.reserve(terms.size());
+        for (const auto& term : terms)
+        {
+            if (!seen.insert(term).second)
+            {
+                continue;
+            }
+            auto it = postings_.find(term);
+            if (it == postings_.end())
+            {
+                continue;
+            }
+
+            // Con otra configuración del analizador el término puede no ser de este documento
+            PostingView view = View(it->second);
+            size_t position =
+                Shared::SimdKernels::LowerBound(view.documents.data(), view.Size(), document_id);
+            if (position < view.Size() && view.documents[position] == document_id)
+            {
+                it->second.deleted_count++;
+            }
+        }
+    }
+
+    std::optional<PostingView> InvertedIndex::GetPostings(const std::string& term) const
+    {
+        const PostingList* list = Find(term);
+        if (!list)
+        {
+            return std::nullopt;
+        }
+
+        // Varios lectores a la vez con el lock compartido
+        std::atomic_ref<uint32_t>(list->accesses).fetch_add(1, std::memory_order_relaxed);
+        hits_.Record(list->IsCold());
+        if (list->IsCold())
+        {
+            // Se va a recorrer entera: lectura anticipada en lugar de un fallo por página
+            cold_->Advise(list->cold_offset, list->Size() * BYTES_PER_POSTING,
+                          Shared::MappedAccess::WILL_NEED);
+        }
+        return View(*list);
+    }
+
+    void InvertedIndex::AddPostingList(const std::string& term, PostingList list)
+    {
+        auto [it, inserted] = postings_.try_emplace(term, std::move(list));
+        if (inserted)
+        {
+            dictionary_.Insert(term);
+            NoteNewTerm(term);
+            posting_count_ += it->second.Size();
+        }
+    }
+
+    std::optional<uint64_t> InvertedIndex::StoreCold(
+        std::unique_ptr<Shared::MappedFile>& file, std::span<const InternalDocumentId> documents,
+        std::span<const uint32_t> frequencies)
+    {
+        try
+        {
+            if (!file)
+            {
+                file = Shared::MappedFile::CreateTemporary(cold_directory_);
+            }
+            const uint64_t offset = file->Append(documents.data(), documents.size_bytes());
+            file->Append(frequencies.data(), frequencies.size_bytes());
+            return offset;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "[-] No se pudo reescribir el archivo frío de postings: " << e.what()
+                      << std::endl;
+            return std::nullopt;
+        }
+    }
+
+    void InvertedIndex::RewriteColdLists()
+    {
+        std::unique_ptr<Shared::MappedFile> rewritten;
+        std::vector<std::pair<PostingList*, uint64_t>> offsets;
+        for (auto& [term, list] : postings_)
+        {
+            if (!list.IsCold())
+            {
+                continue;
+            }
+
+            PostingView view = View(list);
+            auto offset = StoreCold(rewritten, view.documents, view.frequencies);
+            if (!offset)
+            {
+                // Se conserva el archivo actual, basura incluida
+                return;
+            }
+            offsets.emplace_back(&list, *offset);
+        }
+
+        for (auto& [list, offset] : offsets)
+        {
+            list->cold_offset = offset;
+        }
+        cold_ = std::move(rewritten);
+        cold_garbage_bytes_ = 0;
+    }
+
+    size_t InvertedIndex::SpillColdLists(size_t bytes, size_t min_postings,
+                                         const std::filesystem::path& directory)
+    {
+        cold_directory_ = directory;
+        if (cold_ && cold_garbage_bytes_ > cold_->GetSize() / 2)
+        {
+            // Sin listas frías vivas el archivo reescrito queda vacío (nulo)
+            RewriteColdLists();
+        }
+        if (!cold_)
+        {
+            cold_ = Shared::MappedFile::CreateTemporary(directory);
+        }
+
+        std::vector<PostingList*> candidates;
+        for (auto& [term, list] : postings_)
+        {
+            if (!list.IsCold() && list.Size() >= min_postings)
+            {
+                candidates.push_back(&list);
+            }
+        }
+        // Primero las menos usadas; a igualdad, las más largas
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const PostingList* a, const PostingList* b)
+                  {
+                      if (a->accesses != b->accesses)
+                      {
+                          return a->accesses < b->accesses;
+                      }
+                      return a->Size() > b->Size();
+                  });
+
+        size_t freed = 0;
+        for (PostingList* list : candidates)
+        {
+            if (freed >= bytes)
+            {
+                break;
+            }
+
+            const size_t count = list->documents.size();
+            const uint64_t offset =
+                cold_->Append(list->documents.data(), count * sizeof(InternalDocumentId));
+            cold_->Append(list->frequencies.data(), count * sizeof(uint32_t));
+            list->cold_offset = offset;
+            list->cold_count = static_cast<uint32_t>(count);
+            std::vector<InternalDocumentId>().swap(list->documents);
+            std::vector<uint32_t>().swap(list->frequencies);
+            cold_posting_count_ += count;
+            freed += count * BYTES_PER_POSTING;
+        }
+
+        // Envejecer los contadores para que cuente el uso reciente
+        for (auto& [term, list] : postings_)
+        {
+            list.accesses /= 2;
+        }
+        return freed;
+    }
+
+    size_t InvertedIndex::Compact(const std::vector<InternalDocumentId>& remap)
+    {
+        size_t removed = 0;
+        std::unique_ptr<Shared::MappedFile> compacted_cold;
+        bool cold_failed = false;
+        std::vector<InternalDocumentId> cold_documents;
+        std::vector<uint32_t> cold_frequencies;
+
+        for (auto it = postings_.begin(); it != postings_.end();)
+        {
+            PostingList& list = it->second;
+
+            if (list.IsCold())
+            {
+                // Se compacta aparte y se escribe en el archivo nuevo
+                PostingView view = View(list);
+                cold_documents.clear();
+                cold_frequencies.clear();
+                for (size_t i = 0; i < view.Size(); ++i)
+                {
+                    InternalDocumentId new_id = remap[view.documents[i]];
+                    if (new_id != DocumentIdMap::INVALID_ID)
+                    {
+                        cold_documents.push_back(new_id);
+                        cold_frequencies.push_back(view.frequencies[i]);
+                    }
+                }
+
+                sort_postings(cold_documents, cold_frequencies);
+                const size_t dropped = view.Size() - cold_documents.size();
+                removed += dropped;
+                posting_count_ -= dropped;
+                cold_posting_count_ -= list.cold_count;
+                list.cold_offset = 0;
+                list.cold_count = 0;
+                list.deleted_count = 0;
+
+                if (cold_documents.empty())
+                {
+                    dictionary_.Erase(it->first);
+                    it = postings_.erase(it);
+                    continue;
+                }
+                std::optional<uint64_t> offset;
+                if (!cold_failed)
+                {
+                    offset = StoreCold(compacted_cold, cold_documents, cold_frequencies);
+                }
+                if (offset)
+                {
+                    list.cold_offset = *offset;
+                    list.cold_count = static_cast<uint32_t>(cold_documents.size());
+                    cold_posting_count_ += list.cold_count;
+                }
+                else
+                {
+                    // Sin archivo nuevo la lista vuelve a RAM: el anterior se cierra al terminar
+                    cold_failed = true;
+                    list.documents = cold_documents;
+                    list.frequencies = cold_frequencies;
+                }
+                ++it;
+                continue;
+            }
+
+            size_t write = 0;
+            for (size_t read = 0; read < list.documents.size(); ++read)
+            {
+                InternalDocumentId new_id = remap[list.documents[read]];
+                if (new_id == DocumentIdMap::INVALID_ID)
+                {
+                    continue;
+                }
+                list.documents[write] = new_id;
+                list.frequencies[write] = list.frequencies[read];
+                write++;
+            }
+
+            removed += list.documents.size() - write;
+            posting_count_ -= list.documents.size() - write;
+            list.deleted_count = 0;
+            list.documents.resize(write);
+            list.frequencies.resize(write);
+            sort_postings(list.documents, list.frequencies);
+
+            if (list.documents.empty())
+            {
+                dictionary_.Erase(it->first);
+                it = postings_.erase(it);
+            }
+            else
+            {
+                list.documents.shrink_to_fit();
+                list.frequencies.shrink_to_fit();
+                ++it;
+            }
+        }
+
+        cold_ = std::move(compacted_cold);
+        cold_garbage_bytes_ = 0;
+        // Los términos que se quedaron sin documentos no deben seguir pasando el filtro
+        SealTermFilter();
+        return removed;
+    }
+
+    void InvertedIndex::Clear()
+    {
+        postings_.clear();
+        dictionary_.Clear();
+        posting_count_ = 0;
+        term_filter_.reset();
+        unsealed_terms_.clear();
+        cold_.reset();
+        cold_posting_count_ = 0;
+        cold_garbage_bytes_ = 0;
+    }
+
+    // ============================================================================
+    // IMPLEMENTACIÓN DE CorpusStatistics, QueryExpansions, MemoryStatistics y
+    // TwoPhaseStatistics
+    // ============================================================================
+
+    double CorpusStatistics::GetAverageLength() const
+    {
+        if (document_count == 0)
+        {
+            return 0.0;
+        }
+        return static_cast<double>(total_length) / static_cast<double>(document_count);
+    }
+
+    double CorpusStatistics::GetAverageFilenameLength() const
+    {
+        if (document_count == 0)
+        {
+            return 0.0;
+        }
+        return static_cast<double>(filename_total_length) / static_cast<double>(document_count);
+    }
+
+    size_t CorpusStatistics::GetDocumentFrequency(const std::string& term) const
+    {
+        auto it = document_frequencies.find(term);
+        return it != document_frequencies.end() ? it->second : 0;
+    }
+
+    void CorpusStatistics::Merge(const CorpusStatistics& other)
+    {
+        document_count += other.document_count;
+        total_length += other.total_length;
+        filename_total_length += other.filename_total_length;
+        for (const auto& [term, frequency] : other.document_frequencies)
+        {
+            document_frequencies[term] += frequency;
+        }
+    }
+
+    void MemoryStatistics::Merge(const MemoryStatistics& other)
+    {
+        budget_bytes += other.budget_bytes;
+        resident_bytes += other.resident_bytes;
+        cold_bytes += other.cold_bytes;
+        metadata_bytes += other.metadata_bytes;
+        posting_hits_resident += other.posting_hits_resident;
+        posting_hits_cold += other.posting_hits_cold;
+        document_hits_resident += other.document_hits_resident;
+        document_hits_cold += other.document_hits_cold;
+    }
+
+    double TwoPhaseStatistics::GetRecall() const
+    {
+        if (sampled_expected == 0)
+        {
+            return 1.0;
+        }
+        return static_cast<double>(sampled_matched) / static_cast<double>(sampled_expected);
+    }
+
+    void TwoPhaseStatistics::Merge(const TwoPhaseStatistics& other)
+    {
+        queries += other.queries;
+        candidates += other.candidates;
+        deferred_terms += other.deferred_terms;
+        first_phase_us += other.first_phase_us;
+        second_phase_us += other.second_phase_us;
+        sampled_queries += other.sampled_queries;
+        sampled_expected += other.sampled_expected;
+        sampled_matched += other.sampled_matched;
+    }
+
+    double SearchCoverage::GetQuality() const
+    {
+        if (total_weight <= 0.0)
+        {
+            return 1.0;
+        }
+        return std::min(1.0, scored_weight / total_weight);
+    }
+
+    void SearchCoverage::Merge(const SearchCoverage& other)
+    {
+        partial = partial || other.partial;
+        scored_weight += other.scored_weight;
+        total_weight += other.total_weight;
+    }
+
+    void QueryExpansions::Add(const QueryNode* node, const std::string& term, int distance,
+                              size_t document_frequency)
+    {
+        auto [it, inserted] = terms[node].try_emplace(term, TermExpansion{distance, 0});
+        if (!inserted)
+        {
+            it->second.distance = std::min(it->second.distance, distance);
+        }
+        it->second.document_frequency += document_frequency;
+    }
+
+    void QueryExpansions::Merge(const QueryExpansions& other)
+    {
+        for (const auto& [node, candidates] : other.terms)
+        {
+            for (const auto& [term, expansion] : candidates)
+            {
+                Add(node, term, expansion.distance, expansion.document_frequency);
+            }
+        }
+    }
+
+    // ============================================================================
+    // IMPLEMENTACIÓN DE DocumentLengthTable
+    // ============================================================================
+
+    void DocumentLengthTable::AddDocument(InternalDocumentId document_id, int length)
+    {
+        if (lengths_.size() <= document_id)
+        {
+            lengths_.resize(document_id + 1, 0);
+        }
+        lengths_[document_id] = static_cast<uint32_t>(length);
+        total_length_ += length;
+        document_count_++;
+    }
+
+    void DocumentLengthTable::RemoveDocument(InternalDocumentId document_id)
+    {
+        if (document_id < lengths_.size())
+        {
+            total_length_ -= lengths_[document_id];
+            lengths_[document_id] = 0;
+            document_count_--;
+        }
+    }
+
+    double DocumentLengthTable::GetAverageLength() const
+    {
+        if (document_count_ == 0)
+        {
+            return 0.0;
+        }
+
+        return static_cast<double>(total_length_) / static_cast<double>(document_count_);
+    }
+
+    void DocumentLengthTable::Compact(const std::vector<InternalDocumentId>& remap,
+                                      size_t live_count)
+    {
+        std::vector<uint32_t> compacted(live_count, 0);
+        for (size_t old_id = 0; old_id < lengths_.size() && old_id < remap.size(); ++old_id)
+        {
+            if (remap[old_id] != DocumentIdMap::INVALID_ID)
+            {
+                compacted[remap[old_id]] = lengths_[old_id];
+            }
+        }
+        lengths_ = std::move(compacted);
+    }
+
+    void DocumentLengthTable::Clear()
+    {
+        lengths_.clear();
+        document_count_ = 0;
+        total_length_ = 0;
+    }
+
+    // ============================================================================
+    // IMPLEMENTACIÓN DE BM25Engine
+    // ============================================================================
+
+    BM25Engine::BM25Engine(std::shared_ptr<const Shared::TextAnalyzer> analyzer)
+        : analyzer_(analyzer ? std::move(analyzer) : std::make_shared<Shared::TextAnalyzer>())
+    {
+    }
+
+    BM25Engine::~BM25Engine()
+    {
+        std::lock_guard<std::mutex> lock(compaction_mutex_);
+        if (compaction_future_.valid())
+        {
+            compaction_future_.wait();
+        }
+    }
+
+    std::vector<std::string> BM25Engine::TokenizeAndNormalize(const std::string& text) const
+    {
+        return analyzer_->Analyze(text);
+    }
+
+    std::vector<std::string> BM25Engine::AnalyzeWords(const std::vector<std::string>& words) const
+    {
+        std::vector<std::string> terms;
+        terms.reserve(words.size());
+        for (const auto& word : words)
+        {
+            std::string term = analyzer_->AnalyzeToken(word);
+            if (!term.empty())
+            {
+                terms.push_back(std::move(term));
+            }
+        }
+        return terms;
+    }
+
+    std::vector<std::string> BM25Engine::SuggestionWords(std::vector<std::string> words) const
+    {
+        std::erase_if(words,
+                      [this](const std::string& word)
+                      {
+                          return word.size() < MIN_SUGGESTION_LENGTH ||
+                                 word.size() > MAX_SUGGESTION_LENGTH ||
+                                 Shared::TextUtils::isNumber(word) || analyzer_->IsStopword(word);
+                      });
+        std::sort(words.begin(), words.end());
+        words.erase(std::unique(words.begin(), words.end()), words.end());
+        return words;
+    }
+
+    size_t BM25Engine::GetOptimalThreadCount(size_t document_count) const
+    {
+        // Si hay pocos documentos, usar menos hilos
+        const size_t hardware_threads = std::thread::hardware_concurrency();
+        const size_t min_docs_per_thread = 100;
+
+        size_t optimal_threads =
+            std::min(hardware_threads, std::max(size_t(1), document_count / min_docs_per_thread));
+
+        return optimal_threads;
+    }
+
+    BM25Engine::RemovedDocument BM25Engine::TombstoneLocked(InternalDocumentId internal_id)
+    {
+        tombstones_[internal_id] = true;
+        tombstone_count_++;
+        // Liberar el contenido ya; las entradas del índice se purgan al compactar
+        RemovedDocument removed{internal_id, layout_generation_, documents_.Release(internal_id)};
+        filename_field_.RemoveDocument(internal_id);
+        document_lengths_.RemoveDocument(internal_id);
+        return removed;
+    }
+
+    void BM25Engine::ForgetRemoved(const std::vector<RemovedDocument>& removed)
+    {
+        if (removed.empty())
+        {
+            return;
+        }
+
+        std::vector<std::vector<std::string>> terms;
+        terms.reserve(removed.size());
+        for (const auto& document : removed)
+        {
+            std::vector<std::string> words = Shared::TextAnalyzer::Tokenize(document.content);
+            terms.push_back(AnalyzeWords(words));
+            suggestions_.RemoveDocument(SuggestionWords(std::move(words)));
+        }
+
+        // El df baja ya para que el idf no dependa de cuándo se compacte
+        std::unique_lock<std::shared_mutex> lock(documents_mutex_);
+        for (size_t i = 0; i < removed.size(); ++i)
+        {
+            if (removed[i].layout_generation == layout_generation_)
+            {
+                index_.MarkDeleted(terms[i], removed[i].internal_id);
+            }
+        }
+    }
+
+    std::optional<BM25Engine::RemovedDocument> BM25Engine::IndexTokensLocked(
+        ExternalDocumentId document_id, const std::string& content,
+        const std::vector<std::string>& tokens, const DocumentMetadata& metadata)
+    {
+        // Reindexar un ID existente equivale a eliminar la versión anterior
+        std::optional<RemovedDocument> replaced;
+        if (auto previous = document_ids_.Find(document_id))
+        {
+            replaced = TombstoneLocked(*previous);
+        }
+
+        InternalDocumentId internal_id = document_ids_.Assign(document_id);
+        documents_.Add(content);
+        doc_values_.Add(metadata);
+        filename_field_.AddDocument(internal_id, TokenizeAndNormalize(metadata.filename));
+        tombstones_.push_back(false);
+        unordered_count_++;
+
+        document_lengths_.AddDocument(internal_id, static_cast<int>(tokens.size()));
+        index_.AddTerms(tokens, internal_id);
+        return replaced;
+    }
+
+    void BM25Engine::IndexDocument(ExternalDocumentId document_id, const std::string& content,
+                                   const DocumentMetadata& metadata)
+    {
+        std::vector<std::string> words = Shared::TextAnalyzer::Tokenize(content);
+        std::vector<std::string> tokens = AnalyzeWords(words);
+        std::optional<RemovedDocument> previous;
+        {
+            std::unique_lock<std::shared_mutex> lock(documents_mutex_);
+            previous = IndexTokensLocked(document_id, content, tokens, metadata);
+            EnforceMemoryBudgetLocked();
+        }
+
+        if (previous)
+        {
+            ForgetRemoved({std::move(*previous)});
+        }
+        suggestions_.AddDocument(SuggestionWords(std::move(words)));
+        version_++;
+
+        ScheduleCompactionIfNeeded();
+    }
+
+    bool BM25Engine::DeleteDocument(ExternalDocumentId document_id)
+    {
+        RemovedDocument previous;
+        {
+            std::unique_lock<std::shared_mutex> lock(documents_mutex_);
+            auto internal_id = document_ids_.Find(document_id);
+            if (!internal_id)
+            {
+                return false;
+            }
+
+            previous = TombstoneLocked(*internal_id);
+            document_ids_.Release(document_id);
+        }
+
+        ForgetRemoved({std::move(previous)});
+        version_++;
+
+        ScheduleCompactionIfNeeded();
+        return true;
+    }
+
+    bool BM25Engine::UpdateDocument(ExternalDocumentId document_id, const std::string& content,
+                                    const DocumentMetadata& metadata)
+    {
+        std::vector<std::string> words = Shared::TextAnalyzer::Tokenize(content);
+        std::vector<std::string> tokens = AnalyzeWords(words);
+        std::optional<RemovedDocument> previous;
+        {
+            std::unique_lock<std::shared_mutex> lock(documents_mutex_);
+            if (!document_ids_.Find(document_id))
+            {
+                return false;
+            }
+
+            // Se asigna un ID interno nuevo y el anterior queda como tombstone
+            previous = IndexTokensLocked(document_id, content, tokens, metadata);
+            EnforceMemoryBudgetLocked();
+        }
+
+        ForgetRemoved({std::move(*previous)});
+        suggestions_.AddDocument(SuggestionWords(std::move(words)));
+        version_++;
+
+        ScheduleCompactionIfNeeded();
+        return true;
+    }
+
+    std::optional<BM25Engine::ReorderPlan> BM25Engine::PlanReorder() const
+    {
+        ReorderPlan plan;
+        std::vector<InternalDocumentId> live;
+        std::vector<std::vector<InternalDocumentId>> lists;
+        {
+            std::shared_lock<std::shared_mutex> lock(documents_mutex_);
+            if (document_order_ != DocumentOrder::BISECTION || unordered_count_ == 0)
+            {
+                return std::nullopt;
+            }
+            plan.document_count = documents_.Size();
+            plan.layout_generation = layout_generation_;
+
+            // Documentos vivos numerados de forma densa en orden de llegada
+            std::vector<InternalDocumentId> dense(plan.document_count,
+                                                  DocumentIdMap::INVALID_ID);
+            for (size_t id = 0; id < plan.document_count; ++id)
+            {
+                if (!tombstones_[id])
+                {
+                    dense[id] = static_cast<InternalDocumentId>(live.size());
+                    live.push_back(static_cast<InternalDocumentId>(id));
+                }
+            }
+
+            const size_t min_frequency = ReorderOptions{}.min_document_frequency;
+            index_.ForEachPostingList(
+                [&](const std::string&, const PostingView& list)
+                {
+                    std::vector<InternalDocumentId> documents;
+                    for (InternalDocumentId id : list.documents)
+                    {
+                        if (dense[id] != DocumentIdMap::INVALID_ID)
+                        {
+                            documents.push_back(dense[id]);
+                        }
+                    }
+                    plan.postings += documents.size();
+                    plan.gap_bits_before += DocumentReordering::GapBits(documents);
+                    if (documents.size() >= min_frequency)
+                    {
+                        lists.push_back(std::move(documents));
+                    }
+                });
+        }
+
+        // La bisección trabaja sobre la copia: búsquedas y escrituras siguen mientras tanto
+        const std::vector<InternalDocumentId> order =
+            DocumentReordering::Bisect(live.size(), lists);
+        plan.order.reserve(order.size());
+        for (InternalDocumentId position : order)
+        {
+            plan.order.push_back(live[position]);
+        }
+        return plan;
+    }
+
+    size_t BM25Engine::CompactLocked(const ReorderPlan* plan)
+    {
+        if (tombstone_count_ == 0 && !plan)
+        {
+            if (index_.GetUnsealedTermCount() > 0)
+            {
+                index_.SealTermFilter();
+            }
+            return 0;
+        }
+
+        // Nuevo ID denso para cada documento vivo: primero los del plan en su orden y luego
+        // el resto en el de llegada (los del plan que faltan ya estaban eliminados)
+        std::vector<InternalDocumentId> remap(documents_.Size(), DocumentIdMap::INVALID_ID);
+        InternalDocumentId next_id = 0;
+        size_t first_unplanned = 0;
+        if (plan)
+        {
+            for (InternalDocumentId old_id : plan->order)
+            {
+                if (!tombstones_[old_id])
+                {
+                    remap[old_id] = next_id++;
+                }
+            }
+            first_unplanned = plan->document_count;
+        }
+        const InternalDocumentId planned = next_id;
+        for (size_t old_id = first_unplanned; old_id < documents_.Size(); ++old_id)
+        {
+            if (!tombstones_[old_id])
+            {
+                remap[old_id] = next_id++;
+            }
+        }
+
+        size_t removed = index_.Compact(remap);
+        document_lengths_.Compact(remap, next_id);
+        document_ids_.Compact(remap, next_id);
+        documents_.Compact(remap, next_id);
+        doc_values_.Compact(remap, next_id);
+        filename_field_.Compact(remap, next_id);
+        tombstones_.assign(next_id, false);
+        tombstone_count_ = 0;
+        unordered_count_ = plan ? next_id - planned : std::min<size_t>(unordered_count_, next_id);
+        layout_generation_++;
+        return removed;
+    }
+
+    size_t BM25Engine::Compact()
+    {
+        const auto start = std::chrono::steady_clock::now();
+        std::optional<ReorderPlan> plan = PlanReorder();
+
+        std::unique_lock<std::shared_mutex> lock(documents_mutex_);
+        // Si otra compactación renumeró los IDs mientras tanto, el plan ya no vale
+        if (!plan || plan->layout_generation != layout_generation_)
+        {
+            return CompactLocked();
+        }
+
+        const size_t removed = CompactLocked(&*plan);
+
+        // Los documentos del plan ocupan los primeros IDs; los posteriores no cuentan
+        const auto planned = static_cast<InternalDocumentId>(
+            documents_.Size() - std::min(unordered_count_, documents_.Size()));
+        ReorderStatistics run;
+        run.runs = reorder_statistics_.runs + 1;
+        run.documents = planned;
+        run.postings = plan->postings;
+        run.gap_bits_before = plan->gap_bits_before;
+        index_.ForEachPostingList(
+            [&](const std::string&, const PostingView& list)
+            {
+                const auto end =
+                    std::lower_bound(list.documents.begin(), list.documents.end(), planned);
+                run.gap_bits_after += DocumentReordering::GapBits(
+                    std::span<const InternalDocumentId>(list.documents.begin(), end));
+            });
+        run.duration_ms = reorder_statistics_.duration_ms +
+                          static_cast<uint64_t>(
+                              std::chrono::duration_cast<std::chrono::milliseconds>(
+                                  std::chrono::steady_clock::now() - start)
+                                  .count());
+        reorder_statistics_ = run;
+        return removed;
+    }
+
+    void BM25Engine::SetCompactionRatio(double ratio)
+    {
+        std::unique_lock<std::shared_mutex> lock(documents_mutex_);
+        compaction_ratio_ = ratio;
+    }
+
+    void BM25Engine::SetDocumentOrder(DocumentOrder order)
+    {
+        std::unique_lock<std::shared_mutex> lock(documents_mutex_);
+        document_order_ = order;
+    }
+
+    void BM25Engine::SetExpansionLimits(double fuzzy_penalty, size_t max_expansions)
+    {
+        std::unique_lock<std::shared_mutex> lock(documents_mutex_);
+        fuzzy_penalty_ = fuzzy_penalty;
+        max_expansions_ = max_expansions;
+    }
+
+    void BM25Engine::SetRankingParameters(const RankingParameters& ranking)
+    {
+        std::unique_lock<std::shared_mutex> lock(documents_mutex_);
+        ranking_ = ranking;
+    }
+
+    void BM25Engine::SetTwoPhaseSampling(size_t every)
+    {
+        std::unique_lock<std::shared_mutex> lock(documents_mutex_);
+        two_phase_sampling_ = every;
+    }
+
+    void BM25Engine::SetScoreAccumulator(ScoreAccumulator accumulator)
+    {
+        std::unique_lock<std::shared_mutex> lock(documents_mutex_);
+        score_accumulator_ = accumulator;
+    }
+
+    bool BM25Engine::ParseScoreAccumulator(const std::string& value,
+                                           ScoreAccumulator& accumulator)
+    {
+        if (value.empty() || value == "double")
+        {
+            accumulator = ScoreAccumulator::DOUBLE;
+        }
+        else if (value == "float32")
+        {
+            accumulator = ScoreAccumulator::FLOAT32;
+        }
+        else if (value == "uint16")
+        {
+            accumulator = ScoreAccumulator::UINT16;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    const char* BM25Engine::ScoreAccumulatorName(ScoreAccumulator accumulator)
+    {
+        switch (accumulator)
+        {
+        case ScoreAccumulator::FLOAT32:
+            return "float32";
+        case ScoreAccumulator::UINT16:
+            return "uint16";
+        case ScoreAccumulator::DOUBLE:
+            break;
+        }
+        return "double";
+    }
+
+    void BM25Engine::SetMemoryBudget(size_t bytes, const std::filesystem::path& directory)
+    {
+        std::unique_lock<std::shared_mutex> lock(documents_mutex_);
+        memory_budget_ = bytes;
+        cold_directory_ = directory;
+        spill_threshold_ = bytes;
+        EnforceMemoryBudgetLocked();
+    }
+
+    void BM25Engine::EnforceMemoryBudgetLocked()
+    {
+        if (memory_budget_ == 0 || cold_storage_failed_)
+        {
+            return;
+        }
+
+        size_t resident = index_.GetResidentBytes() + documents_.GetResidentBytes();
+        if (resident <= spill_threshold_)
+        {
+            return;
+        }
+
+        // Se baja hasta el 90% para no expulsar de nuevo en cada escritura
+        const size_t target = memory_budget_ - memory_budget_ / 10;
+        try
+        {
+            // Los textos solo se leen para los resultados que se devuelven: salen primero
+            resident -= documents_.SpillOldest(resident - target, cold_directory_);
+            if (resident > target)
+            {
+                resident -= index_.SpillColdLists(resident - target, MIN_COLD_POSTINGS,
+                                                  cold_directory_);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "[-] Nivel frío desactivado (" << e.what()
+                      << "); el índice sigue entero en RAM" << std::endl;
+            cold_storage_failed_ = true;
+            return;
+        }
+
+        // Lo que queda son listas cortas o muy usadas: no se reintenta hasta que crezca
+        spill_threshold_ = std::max(memory_budget_, resident + memory_budget_ / 10);
+    }
+
+    MemoryStatistics BM25Engine::GetMemoryStatistics() const
+    {
+        std::shared_lock<std::shared_mutex> lock(documents_mutex_);
+        MemoryStatistics statistics;
+        statistics.budget_bytes = memory_budget_;
+        statistics.resident_bytes = index_.GetResidentBytes() + documents_.GetResidentBytes();
+        statistics.cold_bytes = index_.GetColdBytes() + documents_.GetColdBytes();
+        statistics.metadata_bytes = doc_values_.GetMemoryUsage();
+        statistics.posting_hits_resident = index_.GetHits().resident.load();
+        statistics.posting_hits_cold = index_.GetHits().cold.load();
+        statistics.document_hits_resident = documents_.GetHits().resident.load();
+        statistics.document_hits_cold = documents_.GetHits().cold.load();
+        return statistics;
+    }
+
+    TwoPhaseStatistics BM25Engine::GetTwoPhaseStatistics() const
+    {
+        TwoPhaseStatistics statistics;
+        statistics.queries = two_phase_queries_.load();
+        statistics.candidates = two_phase_candidates_.load();
+        statistics.deferred_terms = two_phase_deferred_terms_.load();
+        statistics.first_phase_us = two_phase_first_us_.load();
+        statistics.second_phase_us = two_phase_second_us_.load();
+        statistics.sampled_queries = two_phase_sampled_.load();
+        statistics.sampled_expected = two_phase_expected_.load();
+        statistics.sampled_matched = two_phase_matched_.load();
+        return statistics;
+    }
+
+    ReorderStatistics BM25Engine::GetReorderStatistics() const
+    {
+        std::shared_lock<std::shared_mutex> lock(documents_mutex_);
+        return reorder_statistics_;
+    }
+
+    TermFilterStatistics BM25Engine::GetTermFilterStatistics() const
+    {
+        std::shared_lock<std::shared_mutex> lock(documents_mutex_);
+        TermFilterStatistics statistics;
+        if (const auto& filter = index_.GetTermFilter())
+        {
+            statistics.terms = filter->GetKeyCount();
+            statistics.bytes = filter->GetSizeBytes();
+        }
+        statistics.unsealed_terms = index_.GetUnsealedTermCount();
+        statistics.skipped = index_.GetFilterHits().skipped.load();
+        statistics.passed = index_.GetFilterHits().passed.load();
+        statistics.false_positives = index_.GetFilterHits().false_positives.load();
+        return statistics;
+    }
+
+    void BM25Engine::ScheduleCompactionIfNeeded()
+    {
+        {
+            std::shared_lock<std::shared_mutex> lock(documents_mutex_);
+            size_t total = documents_.Size();
+            if (total == 0)
+            {
+                return;
+            }
+            const bool purge = static_cast<double>(tombstone_count_) / total >= compaction_ratio_;
+            const bool reorder = document_order_ == DocumentOrder::BISECTION &&
+                                 unordered_count_ >= MIN_REORDER_DOCUMENTS &&
+                                 static_cast<double>(unordered_count_) / total >= compaction_ratio_;
+            const size_t unsealed = index_.GetUnsealedTermCount();
+            const bool seal = unsealed >= MIN_UNSEALED_TERMS &&
+                              static_cast<double>(unsealed) / index_.GetTermCount() >=
+                                  compaction_ratio_;
+            if (!purge && !reorder && !seal)
+            {
+                return;
+            }
+        }
+
+        // Solo una compactación a la vez; el mutex cubre la comprobación y la asignación
+        std::lock_guard<std::mutex> lock(compaction_mutex_);
+        if (compaction_future_.valid() &&
+            compaction_future_.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            return;
+        }
+
+        compaction_future_ = std::async(std::launch::async, [this]() { Compact(); });
+    }
+
+    void BM25Engine::IndexDocumentBatch(const std::vector<std::string>& batch,
+                                        ExternalDocumentId first_document_id)
+    {
+        // Tokenizar sin lock; solo la inserción en el índice es exclusiva
+        std::vector<std::vector<std::string>> tokenized;
+        std::vector<std::vector<std::string>> suggestion_words;
+        tokenized.reserve(batch.size());
+        suggestion_words.reserve(batch.size());
+        for (const auto& content : batch)
+        {
+            std::vector<std::string> words = Shared::TextAnalyzer::Tokenize(content);
+            tokenized.push_back(AnalyzeWords(words));
+            suggestion_words.push_back(SuggestionWords(std::move(words)));
+        }
+
+        std::vector<RemovedDocument> replaced;
+        {
+            std::unique_lock<std::shared_mutex> lock(documents_mutex_);
+            for (size_t i = 0; i < batch.size(); ++i)
+            {
+                if (auto previous =
+                        IndexTokensLocked(first_document_id + i, batch[i], tokenized[i], {}))
+                {
+                    replaced.push_back(std::move(*previous));
+                }
+            }
+            EnforceMemoryBudgetLocked();
+        }
+
+        ForgetRemoved(replaced);
+        suggestions_.AddDocuments(suggestion_words);
+        version_++;
+    }
+
+    size_t BM25Engine::IndexDocuments(const std::vector<std::string>& documents,
+                                      ExternalDocumentId first_document_id, size_t num_threads,
+                                      size_t batch_size)
+    {
+        if (documents.empty())
+        {
+            return 0;
+        }
+
+        // Determinar número óptimo de hilos si no se especificó
+        if (num_threads == 0)
+        {
+            num_threads = GetOptimalThreadCount(documents.size());
+        }
+
+        // Reservar espacio para los documentos
+        {
+            std::unique_lock<std::shared_mutex> lock(documents_mutex_);
+            documents_.Reserve(documents_.Size() + documents.size());
+            doc_values_.Reserve(doc_values_.Size() + documents.size());
+        }
+
+        // Dividir documentos en batches
+        std::vector<std::future<void>> futures;
+
+        size_t current_pos = 0;
+        while (current_pos < documents.size())
+        {
+            size_t remaining = documents.size() - current_pos;
+            size_t current_batch_size = std::min(batch_size, remaining);
+
+            std::vector<std::string> batch(documents.begin() + current_pos,
+                                           documents.begin() + current_pos + current_batch_size);
+
+            futures.push_back(std::async(std::launch::async, &BM25Engine::IndexDocumentBatch, this,
+                                         std::move(batch), first_document_id + current_pos));
+
+            current_pos += current_batch_size;
+
+            // Limitar el número de hilos activos
+            if (futures.size() >= num_threads)
+            {
+                futures.front().wait();
+                futures.erase(futures.begin());
+            }
+        }
+
+        // Esperar que terminen todos los hilos
+        for (auto& future : futures)
+        {
+            future.wait();
+        }
+
+        ScheduleCompactionIfNeeded();
+        return documents.size();
+    }
+
+    TermContext BM25Engine::MakeTermContext(const std::string& term,
+                                            const CorpusStatistics& statistics) const
+    {
+        TermContext context;
+        context.document_count = static_cast<double>(statistics.document_count);
+        // n solo cuenta documentos vivos, como N
+        context.document_frequency = static_cast<double>(statistics.GetDocumentFrequency(term));
+        context.average_length = statistics.GetAverageLength();
+        context.average_filename_length = statistics.GetAverageFilenameLength();
+        context.term_hash = FilenameField::HashTerm(term);
+        context.filename_field = &filename_field_;
+        return context;
+    }
+
+    template <typename Policy>
+    std::vector<BM25Engine::ScoredDocument> BM25Engine::ScoreDisjunction(
+        const RankingParameters& ranking, const std::vector<WeightedTerm>& query_tokens,
+        const CorpusStatistics& statistics) const
+    {
+        // Acumuladores indexados por ID interno denso
+        std::vector<double> scores(documents_.Size(), 0.0);
+
+        for (const auto& [token, weight] : query_tokens)
+        {
+            auto postings = index_.GetPostings(token);
+            if (!postings)
+            {
+                continue;
+            }
+
+            const Policy policy(ranking, MakeTermContext(token, statistics));
+            AccumulatePostings(policy, weight, postings->documents, postings->frequencies,
+                               document_lengths_, tombstones_, scores);
+        }
+
+        std::vector<ScoredDocument> hits;
+        for (size_t i = 0; i < scores.size(); ++i)
+        {
+            if (scores[i] != 0.0)
+            {
+                hits.push_back({static_cast<InternalDocumentId>(i), scores[i]});
+            }
+        }
+
+        return hits;
+    }
+
+    template <typename Policy>
+    std::vector<double> BM25Engine::ScoreCandidates(
+        const RankingParameters& ranking, const std::vector<WeightedTerm>& terms,
+        const std::vector<InternalDocumentId>& candidates, const CorpusStatistics& statistics) const
+    {
+        std::vector<double> scores(candidates.size(), 0.0);
+
+        for (const auto& [term, weight] : terms)
+        {
+            auto postings = index_.GetPostings(term);
+            if (!postings)
+            {
+                continue;
+            }
+
+            const Policy policy(ranking, MakeTermContext(term, statistics));
+            const uint32_t* documents = postings->documents.data();
+            const size_t size = postings->Size();
+
+            // Galopar en las postings desde la última posición: los candidatos suelen
+            // ser muchos menos que las postings de términos frecuentes
+            size_t position = 0;
+            for (size_t c = 0; c < candidates.size() && position < size; ++c)
+            {
+                position =
+                    Shared::SimdKernels::GallopLowerBound(documents, size, position, candidates[c]);
+                if (position == size || documents[position] != candidates[c])
+                {
+                    continue;
+                }
+
+                double f = static_cast<double>(postings->frequencies[position]);
+                double dl = static_cast<double>(document_lengths_.GetLength(candidates[c]));
+                scores[c] += weight * policy(candidates[c], f, dl);
+            }
+        }
+
+        return scores;
+    }
+
+    namespace
+    {
+        // Trabajo entre dos consultas del reloj con hora límite: unos pocos cientos de
+        // microsegundos, para pasarse poco sin que leer el reloj cueste
+        constexpr size_t ANYTIME_POSTINGS_PER_CHECK = 64 * 1024;
+        constexpr size_t ANYTIME_CANDIDATES_PER_CHECK = 4 * 1024;
+    } // namespace
+
+    template <typename Policy>
+    std::vector<BM25Engine::ImpactTerm<Policy>> BM25Engine::ImpactOrderedTerms(
+        const RankingParameters& ranking, const std::vector<WeightedTerm>& terms,
+        const CorpusStatistics& statistics, SearchCoverage& coverage) const
+    {
+        std::vector<ImpactTerm<Policy>> ordered;
+        for (const auto& [term, weight] : terms)
+        {
+            auto postings = index_.GetPostings(term);
+            if (!postings)
+            {
+                continue;
+            }
+            const Policy policy(ranking, MakeTermContext(term, statistics));
+            const double impact = std::abs(weight * policy.UpperBound());
+            ordered.push_back({weight, policy, *postings, impact});
+            coverage.total_weight += impact * static_cast<double>(postings->Size());
+        }
+
+        // stable_sort: a igual aportación se suma en el orden de la consulta
+        std::stable_sort(ordered.begin(), ordered.end(),
+                         [](const ImpactTerm<Policy>& a, const ImpactTerm<Policy>& b)
+                         { return a.impact > b.impact; });
+        return ordered;
+    }
+
+    template <typename Policy>
+    std::vector<double> BM25Engine::ScoreCandidatesAnytime(
+        const RankingParameters& ranking, const std::vector<WeightedTerm>& terms,
+        const std::vector<InternalDocumentId>& candidates, const CorpusStatistics& statistics,
+        std::chrono::steady_clock::time_point deadline, SearchCoverage& coverage) const
+    {
+        std::vector<double> scores(candidates.size(), 0.0);
+        if (candidates.empty())
+        {
+            return scores;
+        }
+        const auto ordered = ImpactOrderedTerms<Policy>(ranking, terms, statistics, coverage);
+
+        for (size_t t = 0; t < ordered.size() && !coverage.partial; ++t)
+        {
+            const auto& [weight, policy, postings, impact] = ordered[t];
+            const uint32_t* documents = postings.documents.data();
+            const size_t size = postings.Size();
+            // El peso del término se reparte por igual entre los candidatos
+            const double weight_per_candidate =
+                impact * static_cast<double>(size) / static_cast<double>(candidates.size());
+
+            size_t position = 0;
+            size_t c = 0;
+            while (c < candidates.size() && position < size)
+            {
+                if (c > 0 && c % ANYTIME_CANDIDATES_PER_CHECK == 0 &&
+                    std::chrono::steady_clock::now() >= deadline)
+                {
+                    coverage.partial = true;
+                    break;
+                }
+                position =
+                    Shared::SimdKernels::GallopLowerBound(documents, size, position, candidates[c]);
+                if (position < size && documents[position] == candidates[c])
+                {
+                    double f = static_cast<double>(postings.frequencies[position]);
+                    double dl = static_cast<double>(document_lengths_.GetLength(candidates[c]));
+                    scores[c] += weight * policy(candidates[c], f, dl);
+                }
+                ++c;
+            }
+            // Si se acabaron las postings, el resto de candidatos ya no tiene el término
+            const size_t scored = position < size ? c : candidates.size();
+            coverage.scored_weight += weight_per_candidate * static_cast<double>(scored);
+
+            if (std::chrono::steady_clock::now() >= deadline && t + 1 < ordered.size())
+            {
+                coverage.partial = true;
+            }
+        }
+
+        return scores;
+    }
+
+    template <typename Policy>
+    std::vector<BM25Engine::ScoredDocument> BM25Engine::ScoreDisjunctionAnytime(
+        const RankingParameters& ranking, const std::vector<WeightedTerm>& terms,
+        const CorpusStatistics& statistics, std::chrono::steady_clock::time_point deadline,
+        SearchCoverage& coverage) const
+    {
+        std::vector<double> scores(documents_.Size(), 0.0);
+        const auto ordered = ImpactOrderedTerms<Policy>(ranking, terms, statistics, coverage);
+
+        size_t since_check = 0;
+        for (size_t t = 0; t < ordered.size() && !coverage.partial; ++t)
+        {
+            const auto& [weight, policy, postings, impact] = ordered[t];
+            for (size_t begin = 0; begin < postings.Size();
+                 begin += ANYTIME_POSTINGS_PER_CHECK)
+            {
+                if (since_check >= ANYTIME_POSTINGS_PER_CHECK)
+                {
+                    since_check = 0;
+                    if (std::chrono::steady_clock::now() >= deadline)
+                    {
+                        coverage.partial = true;
+                        break;
+                    }
+                }
+                const size_t count = std::min(ANYTIME_POSTINGS_PER_CHECK, postings.Size() - begin);
+                AccumulatePostings(policy, weight, postings.documents.subspan(begin, count),
+                                   postings.frequencies.subspan(begin, count), document_lengths_,
+                                   tombstones_, scores);
+                coverage.scored_weight += impact * static_cast<double>(count);
+                since_check += count;
+            }
+        }
+
+        std::vector<ScoredDocument> hits;
+        for (size_t i = 0; i < scores.size(); ++i)
+        {
+            if (scores[i] != 0.0)
+            {
+                hits.push_back({static_cast<InternalDocumentId>(i), scores[i]});
+            }
+        }
+
+        return hits;
+    }
+
+    template <typename Policy>
+    std::vector<BM25Engine::ScoredDocument> BM25Engine::ScoreTwoPhase(
+        const RankingParameters& ranking, const std::vector<WeightedTerm>& terms,
+        const CorpusStatistics& statistics, const TwoPhaseOptions& options,
+        size_t max_results) const
+    {
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point start = Clock::now();
+
+        struct TermPostings
+        {
+            const WeightedTerm* term;
+            PostingView postings;
+        };
+
+        // Primera fase: términos de menos a más postings (de más a menos idf)
+        std::vector<TermPostings> lists;
+        for (const auto& term : terms)
+        {
+            if (auto postings = index_.GetPostings(term.term))
+            {
+                lists.push_back({&term, *postings});
+            }
+        }
+        std::stable_sort(lists.begin(), lists.end(),
+                         [](const TermPostings& a, const TermPostings& b)
+                         { return a.postings.Size() < b.postings.Size(); });
+
+        // Listas que caben en el presupuesto (al menos la más corta)
+        size_t scanned = 0;
+        size_t scored_lists = 0;
+        for (; scored_lists < lists.size(); ++scored_lists)
+        {
+            const size_t size = lists[scored_lists].postings.Size();
+            if (scored_lists > 0 && scanned + size > options.posting_budget)
+            {
+                break;
+            }
+            scanned += size;
+        }
+        const size_t deferred = lists.size() - scored_lists;
+
+        // Pocas postings frente a la colección: pares (ID, aportación) ordenados y sumados;
+        // si no, los acumuladores densos de ScoreDisjunction
+        std::vector<ScoredDocument> partial;
+        if (scanned * SPARSE_FIRST_PHASE_RATIO < documents_.Size())
+        {
+            partial.reserve(scanned);
+            for (size_t t = 0; t < scored_lists; ++t)
+            {
+                const PostingView& postings = lists[t].postings;
+                const Policy policy(ranking, MakeTermContext(lists[t].term->term, statistics));
+                const double weight = lists[t].term->weight;
+                for (size_t i = 0; i < postings.Size(); ++i)
+                {
+                    const InternalDocumentId document_id = postings.documents[i];
+                    if (tombstones_[document_id])
+                    {
+                        continue;
+                    }
+                    const double f = static_cast<double>(postings.frequencies[i]);
+                    const double dl =
+                        static_cast<double>(document_lengths_.GetLength(document_id));
+                    partial.push_back({document_id, weight * policy(document_id, f, dl)});
+                }
+            }
+
+            std::sort(partial.begin(), partial.end(),
+                      [](const ScoredDocument& a, const ScoredDocument& b)
+                      { return a.document_id < b.document_id; });
+            size_t unique = 0;
+            for (size_t i = 0; i < partial.size(); ++i)
+            {
+                if (unique > 0 && partial[unique - 1].document_id == partial[i].document_id)
+                {
+                    partial[unique - 1].score += partial[i].score;
+                }
+                else
+                {
+                    partial[unique++] = partial[i];
+                }
+            }
+            partial.resize(unique);
+        }
+        else
+        {
+            std::vector<double> scores(documents_.Size(), 0.0);
+            for (size_t t = 0; t < scored_lists; ++t)
+            {
+                const Policy policy(ranking, MakeTermContext(lists[t].term->term, statistics));
+                AccumulatePostings(policy, lists[t].term->weight, lists[t].postings.documents,
+                                   lists[t].postings.frequencies, document_lengths_, tombstones_,
+                                   scores);
+            }
+            for (size_t i = 0; i < scores.size(); ++i)
+            {
+                if (scores[i] != 0.0)
+                {
+                    partial.push_back({static_cast<InternalDocumentId>(i), scores[i]});
+                }
+            }
+        }
+
+        const size_t keep = std::max(options.candidates, max_results);
+        if (partial.size() > keep)
+        {
+            std::nth_element(partial.begin(), partial.begin() + (keep - 1), partial.end(),
+                             [](const ScoredDocument& a, const ScoredDocument& b)
+                             { return a.score > b.score; });
+            // Los empates con el último candidato también pasan
+            const double threshold = partial[keep - 1].score;
+            std::erase_if(partial, [threshold](const ScoredDocument& candidate)
+                          { return candidate.score < threshold; });
+            std::sort(partial.begin(), partial.end(),
+                      [](const ScoredDocument& a, const ScoredDocument& b)
+                      { return a.document_id < b.document_id; });
+        }
+        const Clock::time_point first_phase = Clock::now();
+
+        // Segunda fase: puntuación exacta con todos los términos, solo de los candidatos
+        std::vector<InternalDocumentId> ids;
+        ids.reserve(partial.size());
+        for (const auto& candidate : partial)
+        {
+            ids.push_back(candidate.document_id);
+        }
+        std::vector<double> exact = ScoreCandidates<Policy>(ranking, terms, ids, statistics);
+
+        std::vector<ScoredDocument> hits;
+        hits.reserve(ids.size());
+        for (size_t c = 0; c < ids.size(); ++c)
+        {
+            double score = exact[c];
+            if (options.proximity_weight > 0.0 && score != 0.0)
+            {
+                score += options.proximity_weight * ProximityScore(documents_.Get(ids[c]), terms);
+            }
+            if (score != 0.0)
+            {
+                hits.push_back({ids[c], score});
+            }
+        }
+        const Clock::time_point second_phase = Clock::now();
+
+        const uint64_t query_number = ++two_phase_queries_;
+        two_phase_candidates_ += ids.size();
+        two_phase_deferred_terms_ += deferred;
+        two_phase_first_us_ += static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(first_phase - start).count());
+        two_phase_second_us_ += static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(second_phase - first_phase)
+                .count());
+
+        // Calidad: la misma consulta sin cascada (con cercanía no hay referencia exacta)
+        if (two_phase_sampling_ > 0 && options.proximity_weight == 0.0 &&
+            query_number % two_phase_sampling_ == 0)
+        {
+            QueryOptions ids_only;
+            ids_only.omit_content = true;
+            std::vector<ScoredDocument> reference = ScoreDisjunction<Policy>(ranking, terms,
+                                                                             statistics);
+            std::vector<ScoredDocument> cascade = hits;
+            std::vector<SearchResult> expected = TopResultsLocked(reference, max_results, ids_only);
+            std::vector<SearchResult> returned = TopResultsLocked(cascade, max_results, ids_only);
+
+            std::unordered_set<ExternalDocumentId> found;
+            for (const auto& result : returned)
+            {
+                found.insert(result.document_id);
+            }
+            size_t matched = 0;
+            for (const auto& result : expected)
+            {
+                matched += found.contains(result.document_id) ? 1 : 0;
+            }
+            two_phase_sampled_++;
+            two_phase_expected_ += expected.size();
+            two_phase_matched_ += matched;
+        }
+        return hits;
+    }
+
+    double BM25Engine::ProximityScore(std::string_view content,
+                                      const std::vector<WeightedTerm>& terms) const
+    {
+        std::unordered_map<std::string_view, size_t> slots;
+        for (const auto& term : terms)
+        {
+            slots.try_emplace(term.term, slots.size());
+        }
+        if (slots.size() < 2)
+        {
+            return 0.0;
+        }
+
+        // Posición y término de cada coincidencia, en orden de aparición
+        const std::vector<std::string> words = TokenizeAndNormalize(std::string(content));
+        std::vector<std::pair<size_t, size_t>> matches;
+        for (size_t position = 0; position < words.size(); ++position)
+        {
+            auto it = slots.find(words[position]);
+            if (it != slots.end())
+            {
+                matches.emplace_back(position, it->second);
+            }
+        }
+
+        std::vector<size_t> seen(slots.size(), 0);
+        size_t present = 0;
+        for (const auto& match : matches)
+        {
+            present += seen[match.second]++ == 0 ? 1 : 0;
+        }
+        if (present < 2)
+        {
+            return 0.0;
+        }
+
+        // Ventana deslizante más corta con los present términos distintos
+        std::fill(seen.begin(), seen.end(), 0);
+        size_t covered = 0;
+        size_t shortest = words.size();
+        size_t left = 0;
+        for (size_t right = 0; right < matches.size(); ++right)
+        {
+            covered += seen[matches[right].second]++ == 0 ? 1 : 0;
+            while (covered == present)
+            {
+                shortest = std::min(shortest, matches[right].first - matches[left].first + 1);
+                covered -= --seen[matches[left].second] == 0 ? 1 : 0;
+                ++left;
+            }
+        }
+
+        const double m = static_cast<double>(present);
+        return (m - 1) / (static_cast<double>(shortest) - m + 1);
+    }
+
+    template <typename Policy>
+    void BM25Engine::ComputeImpacts(const Policy& policy, const PostingView& postings,
+                                    size_t begin, size_t count, float* out) const
+    {
+        if constexpr (std::is_same_v<Policy, Bm25Policy>)
+        {
+            // La misma expresión con idf, k1, b y avdl ya combinados en tres constantes
+            Shared::SimdKernels::SaturatedScores(
+                postings.documents.data() + begin, postings.frequencies.data() + begin, count,
+                document_lengths_.Data(), static_cast<float>(policy.idf * (policy.k1 + 1)),
+                static_cast<float>(policy.k1 * (1 - policy.b)),
+                static_cast<float>(policy.k1 * policy.b / policy.avdl), out);
+        }
+        else
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                const InternalDocumentId document_id = postings.documents[begin + i];
+                const double f = static_cast<double>(postings.frequencies[begin + i]);
+                const double dl = static_cast<double>(document_lengths_.GetLength(document_id));
+                out[i] = static_cast<float>(policy(document_id, f, dl));
+            }
+        }
+    }
+
+    template <typename Policy, typename Accumulator>
+    std::optional<std::vector<BM25Engine::ScoredDocument>> BM25Engine::ScoreDisjunctionApproximate(
+        const RankingParameters& ranking, const std::vector<WeightedTerm>& terms,
+        const CorpusStatistics& statistics, size_t max_results) const
+    {
+        constexpr bool quantized = std::is_integral_v<Accumulator>;
+
+        struct TermScorer
+        {
+            PostingView postings;
+            Policy policy;
+            double weight;
+        };
+
+        std::vector<TermScorer> scorers;
+        double upper_bound = 0.0;
+        for (const auto& [term, weight] : terms)
+        {
+            auto postings = index_.GetPostings(term);
+            if (!postings)
+            {
+                continue;
+            }
+
+            const Policy policy(ranking, MakeTermContext(term, statistics));
+            // Un entero sin signo no representa los términos con idf negativo (n > N/2)
+            if (quantized && (policy.UpperBound() <= 0.0 || weight <= 0.0))
+            {
+                return std::nullopt;
+            }
+            upper_bound += weight * policy.UpperBound();
+            scorers.push_back({*postings, policy, weight});
+        }
+
+        // Escala para que la suma de las aportaciones redondeadas de todos los términos no
+        // desborde el acumulador
+        float scale = 1.0f;
+        if constexpr (quantized)
+        {
+            const double limit = static_cast<double>(std::numeric_limits<Accumulator>::max()) -
+                                 static_cast<double>(scorers.size());
+            scale = upper_bound > 0.0 ? static_cast<float>(limit / upper_bound) : 0.0f;
+        }
+
+        std::vector<Accumulator> scores(documents_.Size(), Accumulator{0});
+        float impacts[IMPACT_BLOCK_SIZE];
+        for (const auto& scorer : scorers)
+        {
+            const float weight = static_cast<float>(scorer.weight) * scale;
+            const size_t size = scorer.postings.Size();
+            for (size_t begin = 0; begin < size; begin += IMPACT_BLOCK_SIZE)
+            {
+                const size_t count = std::min(IMPACT_BLOCK_SIZE, size - begin);
+                ComputeImpacts(scorer.policy, scorer.postings, begin, count, impacts);
+
+                // AVX2 no tiene scatter: la suma en los acumuladores es escalar
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const InternalDocumentId document_id = scorer.postings.documents[begin + i];
+                    if (tombstones_[document_id])
+                    {
+                        continue;
+                    }
+                    if constexpr (quantized)
+                    {
+                        scores[document_id] = static_cast<Accumulator>(
+                            scores[document_id] +
+                            static_cast<Accumulator>(impacts[i] * weight + 0.5f));
+                    }
+                    else
+                    {
+                        scores[document_id] += weight * impacts[i];
+                    }
+                }
+            }
+        }
+
+        std::vector<ScoredDocument> candidates;
+        for (size_t i = 0; i < scores.size(); ++i)
+        {
+            if (scores[i] != Accumulator{0})
+            {
+                candidates.push_back(
+                    {static_cast<InternalDocumentId>(i), static_cast<double>(scores[i])});
+            }
+        }
+
+        const size_t keep = std::max(max_results * RESCORE_FACTOR, MIN_RESCORE_CANDIDATES);
+        if (candidates.size() > keep)
+        {
+            std::nth_element(candidates.begin(), candidates.begin() + (keep - 1), candidates.end(),
+                             [](const ScoredDocument& a, const ScoredDocument& b)
+                             { return a.score > b.score; });
+
+            // Se corta por puntuación y no por posición: los empates (que el top-k exacto
+            // desempata por ID externo) y lo que queda dentro del error de redondeo entran
+            const double threshold = candidates[keep - 1].score;
+            const double margin = quantized ? static_cast<double>(scorers.size())
+                                            : std::abs(threshold) * FLOAT_SCORE_MARGIN;
+            std::erase_if(candidates, [threshold, margin](const ScoredDocument& candidate)
+                          { return candidate.score < threshold - margin; });
+            std::sort(candidates.begin(), candidates.end(),
+                      [](const ScoredDocument& a, const ScoredDocument& b)
+                      { return a.document_id < b.document_id; });
+        }
+
+        // Puntuación exacta, sumada en el mismo orden que ScoreDisjunction
+        std::vector<InternalDocumentId> ids;
+        ids.reserve(candidates.size());
+        for (const auto& candidate : candidates)
+        {
+            ids.push_back(candidate.document_id);
+        }
+        std::vector<double> exact = ScoreCandidates<Policy>(ranking, terms, ids, statistics);
+
+        std::vector<ScoredDocument> hits;
+        hits.reserve(ids.size());
+        for (size_t c = 0; c < ids.size(); ++c)
+        {
+            if (exact[c] != 0.0)
+            {
+                hits.push_back({ids[c], exact[c]});
+            }
+        }
+        return hits;
+    }
+
+    std::vector<SearchResult> BM25Engine::TopResultsLocked(std::vector<ScoredDocument>& hits,
+                                                           size_t max_results,
+                                                           const QueryOptions& options) const
+    {
+        // Mismo orden que SearchResult::Ranks para que las particiones se puedan mezclar
+        auto ranks = [this](const ScoredDocument& a, const ScoredDocument& b)
+        {
+            if (a.score != b.score)
+            {
+                return a.score > b.score;
+            }
+            return document_ids_.GetExternal(a.document_id) <
+                   document_ids_.GetExternal(b.document_id);
+        };
+
+        // Mismo orden que SearchResult::SortsBefore, leyendo solo la columna del campo
+        const SortOrder sort = options.sort.value_or(SortOrder{});
+        auto sorts_before = [this, &sort, &ranks](const ScoredDocument& a, const ScoredDocument& b)
+        {
+            int order;
+            if (sort.field == SortField::TIMESTAMP)
+            {
+                const std::time_t first = doc_values_.GetTimestamp(a.document_id);
+                const std::time_t second = doc_values_.GetTimestamp(b.document_id);
+                order = first < second ? -1 : first > second;
+            }
+            else
+            {
+                order = doc_values_.GetFilename(a.document_id)
+                            .compare(doc_values_.GetFilename(b.document_id));
+            }
+            if (order != 0)
+            {
+                return sort.descending ? order > 0 : order < 0;
+            }
+            return ranks(a, b);
+        };
+
+        if (options.search_after && !options.sort)
+        {
+            // Se descarta lo ya entregado antes de ordenar: una página profunda ordena lo
+            // mismo que la primera
+            const SearchAfter& after = *options.search_after;
+            std::erase_if(hits,
+                          [this, &after](const ScoredDocument& hit)
+                          {
+                              if (hit.score != after.score)
+                              {
+                                  return hit.score > after.score;
+                              }
+                              return document_ids_.GetExternal(hit.document_id) <=
+                                     after.document_id;
+                          });
+        }
+
+        const size_t keep = std::min(hits.size(), max_results);
+        if (options.sort)
+        {
+            std::partial_sort(hits.begin(), hits.begin() + keep, hits.end(), sorts_before);
+        }
+        else
+        {
+            std::partial_sort(hits.begin(), hits.begin() + keep, hits.end(), ranks);
+        }
+
+        // El contenido solo se copia para los resultados que se devuelven
+        std::vector<SearchResult> results;
+        results.reserve(keep);
+        for (size_t i = 0; i < keep; ++i)
+        {
+            const InternalDocumentId document_id = hits[i].document_id;
+            auto& result = results.emplace_back(
+                options.omit_content ? std::string() : std::string(documents_.Get(document_id)),
+                hits[i].score, document_ids_.GetExternal(document_id));
+            result.filename = doc_values_.GetFilename(document_id);
+            result.timestamp = doc_values_.GetTimestamp(document_id);
+        }
+        return results;
     }
 
-    void InvertedIndex::AddTerms(const std::vector<std::string>& terms, int document_id)
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        for (const auto& term : terms)
+    void BM25Engine::CollectExpansionsLocked(const QueryNode& node,
+                                             QueryExpansions& expansions) const
+    {
+        if (node.type == QueryNode::Type::GROUP)
+        {
+            for (const auto& clause : node.clauses)
+            {
+                CollectExpansionsLocked(*clause.node, expansions);
+            }
+            return;
+        }
+        if (node.type != QueryNode::Type::TERM || node.match == QueryMatch::EXACT)
+        {
+            return;
+        }
+
+        const TermDictionary& dictionary = index_.GetDictionary();
+
+        // Distancia mínima de cada término encontrado (0 = exacto o por prefijo)
+        std::unordered_map<std::string, int> found;
+        auto add = [&found](const std::string& term, int distance)
+        {
+            auto [it, inserted] = found.try_emplace(term, distance);
+            if (!inserted)
+            {
+                it->second = std::min(it->second, distance);
+            }
+        };
+
+        for (const auto& token : node.tokens)
+        {
+            if (index_.GetIndexFrequency(token) > 0)
+            {
+                add(token, 0);
+            }
+        }
+
+        if (node.match == QueryMatch::PREFIX)
+        {
+            for (const auto& term : dictionary.PrefixSearch(node.pattern, EXPANSION_SCAN_LIMIT))
+            {
+                add(term, 0);
+            }
+            // Raíces más cortas que lo ya escrito ("computadore*" → "comput")
+            size_t min_length = std::max<size_t>(4, (node.pattern.size() + 1) / 2);
+            for (const auto& term : dictionary.PrefixesOf(node.pattern, min_length))
+            {
+                add(term, 0);
+            }
+        }
+        else if (!node.fuzzy_fallback || found.empty())
+        {
+            // Contra la palabra escrita y contra su raíz: el diccionario guarda raíces
+            for (const auto& match : dictionary.FuzzySearch(node.pattern, node.max_edits))
+            {
+                add(match.term, match.distance);
+            }
+            for (const auto& token : node.tokens)
+            {
+                if (token == node.pattern)
+                {
+                    continue;
+                }
+                for (const auto& match : dictionary.FuzzySearch(token, node.max_edits))
+                {
+                    add(match.term, match.distance);
+                }
+            }
+        }
+
+        for (const auto& [term, distance] : found)
         {
-            document_frequency_[term].insert(document_id);
-            term_frequency_[term][document_id]++;
+            expansions.Add(&node, term, distance,
+                           static_cast<size_t>(index_.GetIndexFrequency(term)));
         }
     }
 
-    int InvertedIndex::GetDocumentFrequency(const std::string& term, int document_id) const
+    uint64_t BM25Engine::EstimateCostLocked(const QueryNode& node) const
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto term_it = term_frequency_.find(term);
-        if (term_it == term_frequency_.end())
+        if (node.type == QueryNode::Type::GROUP)
         {
-            return 0;
+            uint64_t cost = 0;
+            for (const auto& clause : node.clauses)
+            {
+                cost += EstimateCostLocked(*clause.node);
+            }
+            return cost;
+        }
+        if (node.type == QueryNode::Type::FILTER)
+        {
+            return document_ids_.Size();
+        }
+
+        uint64_t cost = 0;
+        for (const auto& token : node.tokens)
+        {
+            cost += static_cast<uint64_t>(index_.GetIndexFrequency(token));
         }
 
-        auto doc_it = term_it->second.find(document_id);
-        return (doc_it != term_it->second.end()) ? doc_it->second : 0;
+        if (node.match == QueryMatch::PREFIX)
+        {
+            // Las expansiones que se quedaría ApplyExpansionsLocked: las más frecuentes
+            std::vector<uint64_t> frequencies;
+            for (const auto& term :
+                 index_.GetDictionary().PrefixSearch(node.pattern, EXPANSION_SCAN_LIMIT))
+            {
+                frequencies.push_back(static_cast<uint64_t>(index_.GetIndexFrequency(term)));
+            }
+            const size_t kept = std::min(frequencies.size(), max_expansions_);
+            std::partial_sort(frequencies.begin(), frequencies.begin() + kept, frequencies.end(),
+                              std::greater<>());
+            cost += std::accumulate(frequencies.begin(), frequencies.begin() + kept, uint64_t{0});
+        }
+        else if (node.match == QueryMatch::FUZZY && (!node.fuzzy_fallback || cost == 0))
+        {
+            const size_t terms = index_.GetTermCount();
+            cost += terms == 0 ? 0 : max_expansions_ * (index_.GetPostingCount() / terms);
+        }
+        return cost;
     }
 
-    int InvertedIndex::GetIndexFrequency(const std::string& term) const
+    void BM25Engine::ApplyExpansionsLocked(QueryNode& node,
+                                           const QueryExpansions& expansions) const
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = document_frequency_.find(term);
-        return (it != document_frequency_.end()) ? static_cast<int>(it->second.size()) : 0;
+        if (node.type == QueryNode::Type::GROUP)
+        {
+            for (auto& clause : node.clauses)
+            {
+                ApplyExpansionsLocked(*clause.node, expansions);
+            }
+            return;
+        }
+        if (node.type != QueryNode::Type::TERM || node.match == QueryMatch::EXACT)
+        {
+            return;
+        }
+
+        std::vector<std::pair<std::string, TermExpansion>> candidates;
+        if (auto it = expansions.terms.find(&node); it != expansions.terms.end())
+        {
+            candidates.assign(it->second.begin(), it->second.end());
+        }
+
+        if (node.match == QueryMatch::FUZZY && node.fuzzy_fallback &&
+            std::any_of(candidates.begin(), candidates.end(),
+                        [&node](const auto& candidate)
+                        {
+                            return candidate.second.distance == 0 &&
+                                   std::find(node.tokens.begin(), node.tokens.end(),
+                                             candidate.first) != node.tokens.end();
+                        }))
+        {
+            // La palabra existe: la tolerancia implícita no añade variantes
+            return;
+        }
+
+        const size_t keep = std::min(candidates.size(), max_expansions_);
+        std::partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end(),
+                          [](const auto& a, const auto& b)
+                          {
+                              if (a.second.distance != b.second.distance)
+                              {
+                                  return a.second.distance < b.second.distance;
+                              }
+                              if (a.second.document_frequency != b.second.document_frequency)
+                              {
+                                  return a.second.document_frequency >
+                                         b.second.document_frequency;
+                              }
+                              return a.first < b.first;
+                          });
+        candidates.resize(keep);
+
+        node.tokens.clear();
+        node.weights.clear();
+        for (auto& [term, expansion] : candidates)
+        {
+            node.tokens.push_back(std::move(term));
+            node.weights.push_back(std::pow(fuzzy_penalty_, expansion.distance));
+        }
     }
 
-    std::set<int> InvertedIndex::GetDocuments(const std::string& term) const
+    void BM25Engine::CollectStatisticsLocked(const std::vector<WeightedTerm>& terms,
+                                             CorpusStatistics& statistics) const
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = document_frequency_.find(term);
-        return (it != document_frequency_.end()) ? it->second : std::set<int>{};
+        statistics.document_count += document_ids_.Size();
+        statistics.total_length += document_lengths_.GetTotalLength();
+        statistics.filename_total_length += filename_field_.GetTotalLength();
+
+        std::unordered_set<std::string_view> seen;
+        for (const auto& [term, weight] : terms)
+        {
+            if (seen.insert(term).second)
+            {
+                statistics.document_frequencies[term] +=
+                    static_cast<size_t>(index_.GetIndexFrequency(term));
+            }
+        }
     }
 
-    void InvertedIndex::Clear()
+    std::vector<SearchResult> BM25Engine::SearchLocked(const QueryNode& root,
+                                                       const CorpusStatistics& statistics,
+                                                       size_t max_results,
+                                                       const QueryOptions& options,
+                                                       FacetCounts* facets,
+                                                       SearchCoverage* coverage) const
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        document_frequency_.clear();
-        term_frequency_.clear();
-    }
+        if (document_ids_.Size() == 0)
+        {
+            return {};
+        }
 
-    // ============================================================================
-    // IMPLEMENTACIÓN DE DocumentLengthTable
-    // ============================================================================
+        std::vector<WeightedTerm> terms;
+        root.CollectScoringTerms(terms);
 
-    void DocumentLengthTable::AddDocument(int document_id, int length)
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        lengths_[document_id] = length;
-        cache_valid_ = false;
+        // search_after necesita todos los resultados con su puntuación exacta, y las facetas
+        // y el orden por campo todos los documentos que casan, no solo los mejores
+        const bool count_facets = facets && !options.facets.empty();
+        const bool exhaustive = options.search_after || options.sort || count_facets;
+
+        // El modelo se elige una vez: los bucles de puntuación quedan especializados
+        const RankingParameters& ranking = options.ranking ? *options.ranking : ranking_;
+        SearchCoverage local_coverage;
+        SearchCoverage& anytime = coverage ? *coverage : local_coverage;
+        std::vector<ScoredDocument> hits;
+        if (root.IsPlainDisjunction())
+        {
+            // Consulta clásica: sin restricciones, se puntúan todas las postings
+            hits = VisitRankingModel(
+                ranking.model,
+                [&]<typename Policy>()
+                {
+                    if (options.deadline)
+                    {
+                        return ScoreDisjunctionAnytime<Policy>(ranking, terms, statistics,
+                                                               *options.deadline, anytime);
+                    }
+                    if (options.two_phase && !exhaustive)
+                    {
+                        return ScoreTwoPhase<Policy>(ranking, terms, statistics,
+                                                     *options.two_phase, max_results);
+                    }
+                    std::optional<std::vector<ScoredDocument>> approximate;
+                    if (score_accumulator_ == ScoreAccumulator::FLOAT32 && !exhaustive)
+                    {
+                        approximate = ScoreDisjunctionApproximate<Policy, float>(
+                            ranking, terms, statistics, max_results);
+                    }
+                    else if (score_accumulator_ == ScoreAccumulator::UINT16 && !exhaustive)
+                    {
+                        approximate = ScoreDisjunctionApproximate<Policy, uint16_t>(
+                            ranking, terms, statistics, max_results);
+                    }
+                    return approximate ? std::move(*approximate)
+                                       : ScoreDisjunction<Policy>(ranking, terms, statistics);
+                });
+
+            if (count_facets)
+            {
+                std::vector<InternalDocumentId> matches;
+                matches.reserve(hits.size());
+                for (const auto& hit : hits)
+                {
+                    matches.push_back(hit.document_id);
+                }
+                doc_values_.CountFacets(matches, options.facets, *facets);
+            }
+        }
+        else
+        {
+            QueryEvaluator evaluator(index_, tombstones_, doc_values_);
+            std::vector<InternalDocumentId> candidates = evaluator.Evaluate(root);
+            if (count_facets)
+            {
+                doc_values_.CountFacets(candidates, options.facets, *facets);
+            }
+            std::vector<double> scores =
+                VisitRankingModel(ranking.model,
+                                  [&]<typename Policy>()
+                                  {
+                                      if (options.deadline)
+                                      {
+                                          return ScoreCandidatesAnytime<Policy>(
+                                              ranking, terms, candidates, statistics,
+                                              *options.deadline, anytime);
+                                      }
+                                      return ScoreCandidates<Policy>(ranking, terms, candidates,
+                                                                     statistics);
+                                  });
+
+            // Los candidatos sin términos puntuables (p. ej. solo filtros) se devuelven con 0
+            hits.reserve(candidates.size());
+            for (size_t c = 0; c < candidates.size(); ++c)
+            {
+                hits.push_back({candidates[c], scores[c]});
+            }
+        }
+
+        return TopResultsLocked(hits, max_results, options);
     }
 
-    int DocumentLengthTable::GetLength(int document_id) const
+    void BM25Engine::SearchBatchRangeLocked(const std::vector<std::unique_ptr<QueryNode>>& roots,
+                                            const std::vector<BatchQuery>& queries,
+                                            const CorpusStatistics& statistics, size_t begin,
+                                            size_t end,
+                                            std::vector<std::vector<SearchResult>>& results) const
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = lengths_.find(document_id);
-        return (it != lengths_.end()) ? it->second : 0;
+        // Aportaciones de los términos ya vistos en este bloque (con el modelo del motor)
+        std::unordered_map<std::string, TermContribution> contributions;
+        // Acumuladores compartidos por las consultas del bloque: tras cada una solo se
+        // recorren y limpian los documentos que tocó
+        std::vector<double> scores(documents_.Size(), 0.0);
+        std::vector<InternalDocumentId> touched;
+        std::vector<WeightedTerm> terms;
+
+        for (size_t q = begin; q < end; ++q)
+        {
+            const QueryNode& root = *roots[q];
+            if (root.clauses.empty())
+            {
+                continue;
+            }
+            if (!root.IsPlainDisjunction() || queries[q].options.ranking ||
+                queries[q].options.two_phase)
+            {
+                results[q] = SearchLocked(root, statistics, queries[q].max_results,
+                                          queries[q].options, nullptr);
+                continue;
+            }
+
+            terms.clear();
+            root.CollectScoringTerms(terms);
+
+            for (const auto& [term, weight] : terms)
+            {
+                auto [it, inserted] = contributions.try_emplace(term);
+                TermContribution& contribution = it->second;
+                if (inserted)
+                {
+                    contribution.postings = index_.GetPostings(term);
+                    if (contribution.postings)
+                    {
+                        const PostingView& postings = *contribution.postings;
+                        const TermContext context = MakeTermContext(term, statistics);
+                        contribution.scores.resize(postings.Size());
+                        VisitRankingModel(
+                            ranking_.model,
+                            [&]<typename Policy>()
+                            {
+                                const Policy policy(ranking_, context);
+                                for (size_t i = 0; i < postings.Size(); ++i)
+                                {
+                                    InternalDocumentId doc_id = postings.documents[i];
+                                    if (tombstones_[doc_id])
+                                    {
+                                        continue;
+                                    }
+                                    double f = static_cast<double>(postings.frequencies[i]);
+                                    double dl = static_cast<double>(
+                                        document_lengths_.GetLength(doc_id));
+                                    contribution.scores[i] = policy(doc_id, f, dl);
+                                }
+                            });
+                    }
+                }
+                if (!contribution.postings)
+                {
+                    continue;
+                }
+
+                // Las aportaciones son positivas salvo en documentos eliminados (0, que no
+                // cambia la puntuación): un documento se toca la primera vez que deja el 0
+                const auto& documents = contribution.postings->documents;
+                for (size_t i = 0; i < documents.size(); ++i)
+                {
+                    const double score = weight * contribution.scores[i];
+                    if (scores[documents[i]] == 0.0 && score != 0.0)
+                    {
+                        touched.push_back(documents[i]);
+                    }
+                    scores[documents[i]] += score;
+                }
+            }
+
+            // TopResultsLocked ordena por un orden total: el de los candidatos no importa
+            std::vector<ScoredDocument> hits;
+            hits.reserve(touched.size());
+            for (InternalDocumentId document_id : touched)
+            {
+                hits.push_back({document_id, scores[document_id]});
+                scores[document_id] = 0.0;
+            }
+            touched.clear();
+            results[q] = TopResultsLocked(hits, queries[q].max_results, queries[q].options);
+        }
     }
 
-    double DocumentLengthTable::GetAverageLength() const
+    std::vector<std::vector<SearchResult>> BM25Engine::SearchBatchLocked(
+        const std::vector<std::unique_ptr<QueryNode>>& roots,
+        const std::vector<BatchQuery>& queries, const CorpusStatistics& statistics,
+        size_t num_threads) const
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (cache_valid_)
+        std::vector<std::vector<SearchResult>> results(queries.size());
+        if (document_ids_.Size() == 0 || queries.empty())
         {
-            return average_length_cache_;
+            return results;
         }
 
-        if (lengths_.empty())
+        if (num_threads == 0)
         {
-            return 0.0;
+            num_threads = std::min<size_t>(
+                std::thread::hardware_concurrency(),
+                std::max<size_t>(1, queries.size() / MIN_BATCH_QUERIES_PER_THREAD));
+        }
+        num_threads = std::clamp<size_t>(num_threads, 1, queries.size());
+        if (num_threads == 1)
+        {
+            SearchBatchRangeLocked(roots, queries, statistics, 0, queries.size(), results);
+            return results;
+        }
+
+        // Bloques contiguos: cada hilo escribe solo en sus posiciones de results
+        const size_t block_size = (queries.size() + num_threads - 1) / num_threads;
+        std::vector<std::future<void>> futures;
+        for (size_t begin = 0; begin < queries.size(); begin += block_size)
+        {
+            const size_t end = std::min(queries.size(), begin + block_size);
+            futures.push_back(std::async(std::launch::async,
+                                         [this, &roots, &queries, &statistics, &results, begin,
+                                          end]()
+                                         {
+                                             SearchBatchRangeLocked(roots, queries, statistics,
+                                                                    begin, end, results);
+                                         }));
         }
 
-        double sum =
-            std::accumulate(lengths_.begin(), lengths_.end(), 0.0,
-                            [](double acc, const auto& pair) { return acc + pair.second; });
+        // Esperar a todos antes de propagar un error: las tareas usan el lock del llamador
+        for (auto& future : futures)
+        {
+            future.wait();
+        }
+        for (auto& future : futures)
+        {
+            future.get();
+        }
+        return results;
+    }
 
-        average_length_cache_ = sum / static_cast<double>(lengths_.size());
-        cache_valid_ = true;
-        return average_length_cache_;
+    std::unique_ptr<QueryNode> BM25Engine::ParseQuery(const std::string& query,
+                                                      const QueryOptions& options) const
+    {
+        QueryParser parser([this](const std::string& text) { return TokenizeAndNormalize(text); },
+                           [](const std::string& text)
+                           { return Shared::TextAnalyzer::Tokenize(text); });
+        return parser.Parse(query, options);
     }
 
-    void DocumentLengthTable::Clear()
+    void BM25Engine::CollectExpansions(const QueryNode& root, QueryExpansions& expansions) const
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        lengths_.clear();
-        cache_valid_ = false;
-        average_length_cache_ = -1.0;
+        std::shared_lock<std::shared_mutex> lock(documents_mutex_);
+        CollectExpansionsLocked(root, expansions);
     }
 
-    // ============================================================================
-    // IMPLEMENTACIÓN DE BM25Engine
-    // ============================================================================
+    void BM25Engine::ApplyExpansions(QueryNode& root, const QueryExpansions& expansions) const
+    {
+        std::shared_lock<std::shared_mutex> lock(documents_mutex_);
+        ApplyExpansionsLocked(root, expansions);
+    }
 
-    double BM25Engine::CalculateBM25Score(double n, double f, double N, double dl,
-                                          double avdl) const
+    void BM25Engine::CollectStatistics(const QueryNode& root, CorpusStatistics& statistics) const
     {
-        double idf = std::log((N - n + 0.5) / (n + 0.5));
-        double tf_component = (f * (K1 + 1)) / (f + K1 * (1 - B + B * dl / avdl));
-        return idf * tf_component;
+        std::vector<WeightedTerm> terms;
+        root.CollectScoringTerms(terms);
+
+        std::shared_lock<std::shared_mutex> lock(documents_mutex_);
+        CollectStatisticsLocked(terms, statistics);
     }
 
-    std::vector<std::string> BM25Engine::TokenizeAndNormalize(const std::string& text) const
+    uint64_t BM25Engine::EstimateCost(const QueryNode& root) const
     {
-        return Shared::TextUtils::normalizeForSearch(text);
+        std::shared_lock<std::shared_mutex> lock(documents_mutex_);
+        return EstimateCostLocked(root);
     }
 
-    size_t BM25Engine::GetOptimalThreadCount(size_t document_count) const
+    void BM25Engine::CollectStatistics(const std::vector<std::unique_ptr<QueryNode>>& roots,
+                                       CorpusStatistics& statistics) const
     {
-        // Si hay pocos documentos, usar menos hilos
-        const size_t hardware_threads = std::thread::hardware_concurrency();
-        const size_t min_docs_per_thread = 100;
+        std::vector<WeightedTerm> terms;
+        for (const auto& root : roots)
+        {
+            root->CollectScoringTerms(terms);
+        }
 
-        size_t optimal_threads =
-            std::min(hardware_threads, std::max(size_t(1), document_count / min_docs_per_thread));
+        std::shared_lock<std::shared_mutex> lock(documents_mutex_);
+        CollectStatisticsLocked(terms, statistics);
+    }
 
-        return optimal_threads;
+    std::vector<SearchResult> BM25Engine::Search(const QueryNode& root,
+                                                 const CorpusStatistics& statistics,
+                                                 size_t max_results, const QueryOptions& options,
+                                                 FacetCounts* facets,
+                                                 SearchCoverage* coverage) const
+    {
+        std::shared_lock<std::shared_mutex> lock(documents_mutex_);
+        return SearchLocked(root, statistics, max_results, options, facets, coverage);
     }
 
-    void BM25Engine::IndexDocument(size_t document_id, const std::string& content)
+    std::vector<SearchResult> BM25Engine::Search(const std::string& query, size_t max_results,
+                                                 const QueryOptions& options,
+                                                 FacetCounts* facets,
+                                                 SearchCoverage* coverage) const
     {
-        std::vector<std::string> tokens = TokenizeAndNormalize(content);
+        std::unique_ptr<QueryNode> root = ParseQuery(query, options);
+        if (root->clauses.empty())
+        {
+            return {};
+        }
 
-        std::lock_guard<std::mutex> lock(documents_mutex_);
+        std::shared_lock<std::shared_mutex> lock(documents_mutex_);
 
-        // Usar document_id (size_t) para el vector, eliminando la advertencia.
-        if (documents_.size() <= document_id)
+        if (document_ids_.Size() == 0)
         {
-            documents_.resize(document_id + 1);
+            return {};
         }
-        documents_[document_id] = content;
 
-        // Usar un ID de tipo int para las clases auxiliares que lo requieren.
-        int doc_id_int = static_cast<int>(document_id);
-        document_lengths_.AddDocument(doc_id_int, static_cast<int>(tokens.size()));
-        index_.AddTerms(tokens, doc_id_int);
+        QueryExpansions expansions;
+        CollectExpansionsLocked(*root, expansions);
+        ApplyExpansionsLocked(*root, expansions);
+
+        std::vector<WeightedTerm> terms;
+        root->CollectScoringTerms(terms);
+        CorpusStatistics statistics;
+        CollectStatisticsLocked(terms, statistics);
+        return SearchLocked(*root, statistics, max_results, options, facets, coverage);
     }
 
-    void BM25Engine::IndexDocumentBatch(const std::vector<std::string>& batch, size_t start_id)
+    std::vector<std::optional<std::string>> BM25Engine::GetContents(
+        const std::vector<ExternalDocumentId>& document_ids) const
     {
-        for (size_t i = 0; i < batch.size(); ++i)
+        std::vector<std::optional<std::string>> contents(document_ids.size());
+        std::shared_lock<std::shared_mutex> lock(documents_mutex_);
+        for (size_t i = 0; i < document_ids.size(); ++i)
         {
-            const auto& content = batch[i];
-            std::vector<std::string> tokens = TokenizeAndNormalize(content);
+            if (auto internal_id = document_ids_.Find(document_ids[i]))
+            {
+                contents[i] = std::string(documents_.Get(*internal_id));
+            }
+        }
+        return contents;
+    }
 
-            size_t doc_id = start_id + i;
-            document_lengths_.AddDocument(static_cast<int>(doc_id),
-                                          static_cast<int>(tokens.size()));
-            index_.AddTerms(tokens, static_cast<int>(doc_id));
+    std::vector<ExternalDocumentId> BM25Engine::GetDocumentIds() const
+    {
+        std::shared_lock<std::shared_mutex> lock(documents_mutex_);
+        std::vector<ExternalDocumentId> ids;
+        ids.reserve(document_ids_.Size());
+        for (size_t id = 0; id < tombstones_.size(); ++id)
+        {
+            if (!tombstones_[id])
+            {
+                ids.push_back(document_ids_.GetExternal(static_cast<InternalDocumentId>(id)));
+            }
         }
+        return ids;
     }
 
-    size_t BM25Engine::IndexDocuments(const std::vector<std::string>& documents, size_t num_threads,
-                                      size_t batch_size)
+    std::vector<std::vector<SearchResult>> BM25Engine::SearchBatch(
+        const std::vector<BatchQuery>& queries, size_t num_threads) const
     {
-        if (documents.empty())
+        std::vector<std::unique_ptr<QueryNode>> roots;
+        roots.reserve(queries.size());
+        for (const auto& query : queries)
         {
-            return 0;
+            roots.push_back(ParseQuery(query.query, query.options));
         }
 
-        // Determinar número óptimo de hilos si no se especificó
-        if (num_threads == 0)
+        std::shared_lock<std::shared_mutex> lock(documents_mutex_);
+
+        // Un solo conjunto de estadísticas: N y avdl son comunes y el df de un término no
+        // depende de la consulta en la que aparece
+        std::vector<WeightedTerm> terms;
+        for (auto& root : roots)
         {
-            num_threads = GetOptimalThreadCount(documents.size());
+            if (root->clauses.empty())
+            {
+                continue;
+            }
+            QueryExpansions expansions;
+            CollectExpansionsLocked(*root, expansions);
+            ApplyExpansionsLocked(*root, expansions);
+            root->CollectScoringTerms(terms);
         }
 
-        // Reservar espacio para los documentos
+        CorpusStatistics statistics;
+        CollectStatisticsLocked(terms, statistics);
+        return SearchBatchLocked(roots, queries, statistics, num_threads);
+    }
+
+    std::vector<std::vector<SearchResult>> BM25Engine::SearchBatch(
+        const std::vector<std::unique_ptr<QueryNode>>& roots,
+        const std::vector<BatchQuery>& queries, const CorpusStatistics& statistics,
+        size_t num_threads) const
+    {
+        std::shared_lock<std::shared_mutex> lock(documents_mutex_);
+        return SearchBatchLocked(roots, queries, statistics, num_threads);
+    }
+
+    std::vector<Suggestion> BM25Engine::Suggest(const std::string& prefix, size_t limit) const
+    {
+        // Un prefijo acabado en separador ya no tiene palabra que completar
+        std::vector<std::string> words = Shared::TextAnalyzer::Tokenize(prefix);
+        const unsigned char last = prefix.empty() ? ' ' : static_cast<unsigned char>(prefix.back());
+        if (words.empty() || (last < 0x80 && !std::isalnum(last)))
         {
-            std::lock_guard<std::mutex> lock(documents_mutex_);
-            documents_.reserve(documents_.size() + documents.size());
+            return {};
         }
+        return suggestions_.Suggest(words.back(), limit);
+    }
 
-        // Dividir documentos en batches
-        std::vector<std::future<void>> futures;
-        std::vector<std::vector<std::string>> batches;
+    namespace
+    {
+        // Desde el formato 3 cada lista es su número de postings, los huecos entre IDs menos
+        // uno y las frecuencias menos uno, empaquetados por bloques (ver
+        // Shared::SimdKernels::EncodePacked). Cuanto más juntos los IDs
+        // (DocumentOrder::BISECTION), menos bits
+        void write_postings(Shared::BinaryWriter& writer, const PostingList& list,
+                            std::vector<uint32_t>& values, std::vector<uint8_t>& buffer)
+        {
+            const size_t count = list.documents.size();
+            writer.Write<uint64_t>(count);
+            values.resize(count);
+            buffer.resize(Shared::SimdKernels::PackedMaxBytes(count));
+            for (size_t i = 0; i < count; ++i)
+            {
+                values[i] = i == 0 ? list.documents[0]
+                                   : list.documents[i] - list.documents[i - 1] - 1;
+            }
+            buffer.resize(Shared::SimdKernels::EncodePacked(values.data(), count, buffer.data()));
+            writer.WriteVector(buffer);
 
-        size_t current_pos = 0;
-        while (current_pos < documents.size())
+            buffer.resize(Shared::SimdKernels::PackedMaxBytes(count));
+            for (size_t i = 0; i < count; ++i)
+            {
+                values[i] = list.frequencies[i] - 1;
+            }
+            buffer.resize(Shared::SimdKernels::EncodePacked(values.data(), count, buffer.data()));
+            writer.WriteVector(buffer);
+        }
+
+        // Los bloques deben ocupar la secuencia entera
+        bool decode_packed(const std::vector<uint8_t>& input, std::vector<uint32_t>& values)
         {
-            size_t remaining = documents.size() - current_pos;
-            size_t current_batch_size = std::min(batch_size, remaining);
+            return Shared::SimdKernels::DecodePacked(input.data(), input.size(), values.size(),
+                                                     values.data()) == input.size();
+        }
 
-            std::vector<std::string> batch(documents.begin() + current_pos,
-                                           documents.begin() + current_pos + current_batch_size);
+        PostingList read_postings(Shared::BinaryReader& reader)
+        {
+            // Cada bloque ocupa al menos un byte en cada secuencia
+            const uint64_t count = reader.Read<uint64_t>();
+            reader.CheckedCount(count / Shared::SimdKernels::PACKED_BLOCK_SIZE + 1, 2);
 
-            size_t start_id;
+            PostingList list;
+            std::vector<uint32_t> gaps(count);
+            list.frequencies.resize(count);
+            if (!decode_packed(reader.ReadVector<uint8_t>(), gaps) ||
+                !decode_packed(reader.ReadVector<uint8_t>(), list.frequencies))
             {
-                std::lock_guard<std::mutex> lock(documents_mutex_);
-                start_id = documents_.size();
-                documents_.insert(documents_.end(), batch.begin(), batch.end());
+                throw std::runtime_error("postings inconsistentes en el segmento");
             }
 
-            futures.push_back(std::async(std::launch::async, &BM25Engine::IndexDocumentBatch, this,
-                                         std::move(batch), start_id));
+            list.documents.resize(count);
+            uint64_t document = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                document = i == 0 ? gaps[0] : document + gaps[i] + 1;
+                if (document > std::numeric_limits<InternalDocumentId>::max())
+                {
+                    throw std::runtime_error("postings inconsistentes en el segmento");
+                }
+                list.documents[i] = static_cast<InternalDocumentId>(document);
+                list.frequencies[i]++;
+            }
+            return list;
+        }
+    } // namespace
 
-            current_pos += current_batch_size;
+    uint64_t BM25Engine::WriteSegment(Shared::BinaryWriter& writer) const
+    {
+        // Las sugerencias tienen lock propio: se leen antes para no anidar locks
+        const uint64_t version = version_.load();
+        std::vector<Suggestion> words = suggestions_.GetWords();
 
-            // Limitar el número de hilos activos
-            if (futures.size() >= num_threads)
+        std::shared_lock<std::shared_mutex> lock(documents_mutex_);
+        writer.Write(SEGMENT_MAGIC);
+        writer.Write(SEGMENT_FORMAT);
+
+        // Documentos vivos renumerados de forma densa, como tras una compactación
+        std::vector<InternalDocumentId> remap(documents_.Size(), DocumentIdMap::INVALID_ID);
+        InternalDocumentId next_id = 0;
+        for (size_t id = 0; id < documents_.Size(); ++id)
+        {
+            if (!tombstones_[id])
             {
-                futures.front().wait();
-                futures.erase(futures.begin());
+                remap[id] = next_id++;
             }
         }
 
-        // Esperar que terminen todos los hilos
-        for (auto& future : futures)
+        writer.Write<uint64_t>(next_id);
+        for (size_t id = 0; id < documents_.Size(); ++id)
         {
-            future.wait();
+            if (tombstones_[id])
+            {
+                continue;
+            }
+            const auto internal_id = static_cast<InternalDocumentId>(id);
+            writer.Write<uint64_t>(document_ids_.GetExternal(internal_id));
+            writer.Write<uint32_t>(document_lengths_.GetLength(internal_id));
+            writer.Write<int64_t>(doc_values_.GetTimestamp(internal_id));
+            writer.WriteString(doc_values_.GetFilename(internal_id));
+            writer.WriteString(doc_values_.GetDirectory(internal_id));
+            writer.WriteString(documents_.Peek(internal_id));
         }
 
-        return documents.size();
-    }
+        // Solo los términos con algún documento vivo
+        auto is_live = [this](InternalDocumentId id) { return !tombstones_[id]; };
+        uint64_t live_terms = 0;
+        index_.ForEachPostingList(
+            [&](const std::string&, const PostingView& list)
+            { live_terms += std::any_of(list.documents.begin(), list.documents.end(), is_live); });
 
-    std::vector<SearchResult> BM25Engine::Search(const std::string& query, size_t max_results) const
-    {
-        std::lock_guard<std::mutex> lock(documents_mutex_);
+        writer.Write<uint64_t>(live_terms);
+        PostingList live;
+        std::vector<uint32_t> values;
+        std::vector<uint8_t> buffer;
+        std::vector<uint64_t> hashes;
+        hashes.reserve(live_terms);
+        index_.ForEachPostingList(
+            [&](const std::string& term, const PostingView& list)
+            {
+                live.documents.clear();
+                live.frequencies.clear();
+                for (size_t i = 0; i < list.Size(); ++i)
+                {
+                    if (is_live(list.documents[i]))
+                    {
+                        live.documents.push_back(remap[list.documents[i]]);
+                        live.frequencies.push_back(list.frequencies[i]);
+                    }
+                }
+                if (live.documents.empty())
+                {
+                    return;
+                }
+                writer.WriteString(term);
+                write_postings(writer, live, values, buffer);
+                hashes.push_back(TermFilter::Hash(term));
+            });
 
-        if (documents_.empty())
+        // Desde el formato 4 el segmento sale sellado con el filtro de sus términos
+        TermFilter filter;
+        filter.Build(std::move(hashes));
+        filter.Write(writer);
+
+        writer.Write<uint64_t>(words.size());
+        for (const auto& [word, frequency] : words)
         {
-            return {};
+            writer.WriteString(word);
+            writer.Write<uint32_t>(frequency);
         }
+        return version;
+    }
 
-        std::vector<std::string> query_tokens = TokenizeAndNormalize(query);
-        if (query_tokens.empty())
+    void BM25Engine::ReadSegment(Shared::BinaryReader& reader)
+    {
+        if (reader.Read<uint64_t>() != SEGMENT_MAGIC)
         {
-            return {};
+            throw std::runtime_error("no es un segmento de índice compatible");
+        }
+        // El formato 1 no guardaba el directorio de cada documento, hasta el 2 las postings
+        // iban sin comprimir y hasta el 3 no había filtro de términos
+        const uint32_t format = reader.Read<uint32_t>();
+        if (format < MIN_SEGMENT_FORMAT || format > SEGMENT_FORMAT)
+        {
+            throw std::runtime_error("no es un segmento de índice compatible");
         }
 
-        std::vector<double> scores(documents_.size(), 0.0);
-        double N = static_cast<double>(documents_.size());
-        double avdl = document_lengths_.GetAverageLength();
+        // Se construye aparte y se sustituye al final: un segmento inválido no deja el
+        // motor a medias
+        DocumentIdMap document_ids;
+        DocumentLengthTable document_lengths;
+        DocumentStore documents;
+        DocValues doc_values;
+        // No forma parte del formato: se vuelve a analizar de los nombres de archivo
+        FilenameField filename_field;
 
-        for (const auto& token : query_tokens)
+        const size_t document_count = reader.CheckedCount(reader.Read<uint64_t>(), 1);
+        for (size_t id = 0; id < document_count; ++id)
         {
-            double n = static_cast<double>(index_.GetIndexFrequency(token));
-            if (n == 0)
+            ExternalDocumentId external_id = reader.Read<uint64_t>();
+            uint32_t length = reader.Read<uint32_t>();
+            DocumentMetadata metadata;
+            metadata.timestamp = static_cast<std::time_t>(reader.Read<int64_t>());
+            metadata.filename = reader.ReadString();
+            if (format >= 2)
             {
-                continue;
+                metadata.directory = reader.ReadString();
             }
 
-            auto docs_with_token = index_.GetDocuments(token);
+            document_ids.Assign(external_id);
+            document_lengths.AddDocument(static_cast<InternalDocumentId>(id),
+                                         static_cast<int>(length));
+            filename_field.AddDocument(static_cast<InternalDocumentId>(id),
+                                       TokenizeAndNormalize(metadata.filename));
+            doc_values.Add(metadata);
+            documents.Add(reader.ReadString());
+        }
 
-            for (int doc_id : docs_with_token)
+        InvertedIndex index;
+        const size_t term_count = reader.CheckedCount(reader.Read<uint64_t>(), 1);
+        std::vector<uint64_t> hashes;
+        hashes.reserve(term_count);
+        for (size_t i = 0; i < term_count; ++i)
+        {
+            std::string term = reader.ReadString();
+            hashes.push_back(TermFilter::Hash(term));
+            PostingList list;
+            if (format >= 3)
             {
-                double f = static_cast<double>(index_.GetDocumentFrequency(token, doc_id));
-                double dl = static_cast<double>(document_lengths_.GetLength(doc_id));
-                double score = CalculateBM25Score(n, f, N, dl, avdl);
-                scores[doc_id] += score;
+                list = read_postings(reader);
             }
+            else
+            {
+                list.documents = reader.ReadVector<InternalDocumentId>();
+                list.frequencies = reader.ReadVector<uint32_t>();
+            }
+            // IDs estrictamente crecientes y de documentos del segmento
+            if (list.documents.empty() || list.documents.size() != list.frequencies.size() ||
+                list.documents.back() >= document_count ||
+                std::adjacent_find(list.documents.begin(), list.documents.end(),
+                                   std::greater_equal<InternalDocumentId>()) !=
+                    list.documents.end())
+            {
+                throw std::runtime_error("postings inconsistentes en el segmento");
+            }
+            index.AddPostingList(term, std::move(list));
         }
 
-        // Crear resultados y ordenarlos
-        std::vector<SearchResult> results;
-        for (size_t i = 0; i < scores.size(); ++i)
+        if (format >= 4)
         {
-            if (scores[i] != 0.0)
+            // Comprobar los términos cuesta mucho menos que construirlo, y un filtro dañado
+            // no puede esconder ninguno
+            TermFilter filter = TermFilter::Read(reader);
+            if (!std::all_of(hashes.begin(), hashes.end(),
+                             [&filter](uint64_t hash) { return filter.MayContain(hash); }))
             {
-                if (i < documents_.size() && !documents_[i].empty())
-                {
-                    results.emplace_back(documents_[i], scores[i], static_cast<int>(i));
-                }
+                throw std::runtime_error("filtro de términos inconsistente en el segmento");
             }
+            index.SetTermFilter(std::move(filter));
+        }
+        else
+        {
+            index.SealTermFilter();
         }
 
-        std::sort(results.begin(), results.end(),
-                  [](const SearchResult& a, const SearchResult& b) { return a.score > b.score; });
+        std::vector<Suggestion> words(reader.CheckedCount(reader.Read<uint64_t>(), 1));
+        for (auto& [word, frequency] : words)
+        {
+            word = reader.ReadString();
+            frequency = reader.Read<uint32_t>();
+        }
 
-        return results;
+        {
+            std::unique_lock<std::shared_mutex> lock(documents_mutex_);
+            index_ = std::move(index);
+            document_lengths_ = std::move(document_lengths);
+            document_ids_ = std::move(document_ids);
+            documents_ = std::move(documents);
+            doc_values_ = std::move(doc_values);
+            filename_field_ = std::move(filename_field);
+            tombstones_.assign(documents_.Size(), false);
+            tombstone_count_ = 0;
+            // El segmento conserva el orden con que se escribió
+            unordered_count_ = 0;
+            layout_generation_++;
+            EnforceMemoryBudgetLocked();
+        }
+        suggestions_.Restore(words);
+        version_++;
     }
 
     void BM25Engine::Clear()
     {
-        std::lock_guard<std::mutex> lock(documents_mutex_);
+        std::unique_lock<std::shared_mutex> lock(documents_mutex_);
+        suggestions_.Clear();
         index_.Clear();
         document_lengths_.Clear();
-        documents_.clear();
+        document_ids_.Clear();
+        documents_.Clear();
+        doc_values_.Clear();
+        filename_field_.Clear();
+        tombstones_.clear();
+        tombstone_count_ = 0;
+        unordered_count_ = 0;
+        layout_generation_++;
+        version_++;
     }
 
-} // namespace DocuTrace::Infrastructure
\ No newline at end of file
+} // namespace DocuTrace::Infrastructure
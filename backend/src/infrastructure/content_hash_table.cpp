@@ -0,0 +1,525 @@
+#include "infrastructure/content_hash_table.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+#include "shared/file_utils.hpp"
+#include "shared/hash_utils.hpp"
+#include "shared/text_utils.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    ContentHashTable::ContentHashTable(std::filesystem::path file_path,
+                                       NearDuplicateOptions near_duplicate_options)
+        : file_path_(std::move(file_path)), near_duplicate_options_(near_duplicate_options)
+    {
+        log_path_ = file_path_;
+        log_path_.replace_extension(".log");
+        near_duplicate_options_.max_distance =
+            std::clamp(near_duplicate_options_.max_distance, 0, 63);
+        if (near_duplicate_options_.enabled)
+        {
+            simhash_bands_.resize(static_cast<size_t>(near_duplicate_options_.max_distance) + 1);
+        }
+        Load();
+    }
+
+    uint64_t ContentHashTable::BandValue(uint64_t simhash, size_t band) const
+    {
+        const size_t bands = simhash_bands_.size();
+        const size_t begin = band * 64 / bands;
+        const size_t width = (band + 1) * 64 / bands - begin;
+        return width == 64 ? simhash : (simhash >> begin) & ((uint64_t{1} << width) - 1);
+    }
+
+    void ContentHashTable::IndexSimHashLocked(const ContentHashEntry& entry)
+    {
+        if (entry.simhash == 0)
+        {
+            return;
+        }
+        for (size_t band = 0; band < simhash_bands_.size(); ++band)
+        {
+            simhash_bands_[band][BandValue(entry.simhash, band)].push_back(entry.content_hash);
+        }
+    }
+
+    void ContentHashTable::UnindexSimHashLocked(const ContentHashEntry& entry)
+    {
+        if (entry.simhash == 0)
+        {
+            return;
+        }
+        for (size_t band = 0; band < simhash_bands_.size(); ++band)
+        {
+            auto bucket = simhash_bands_[band].find(BandValue(entry.simhash, band));
+            if (bucket == simhash_bands_[band].end())
+            {
+                continue;
+            }
+            std::erase(bucket->second, entry.content_hash);
+            if (bucket->second.empty())
+            {
+                simhash_bands_[band].erase(bucket);
+            }
+        }
+    }
+
+    void ContentHashTable::Load()
+    {
+        if (!std::filesystem::exists(file_path_))
+        {
+            LoadLog();
+            return;
+        }
+
+        std::ifstream in(file_path_);
+        if (!in.is_open())
+        {
+            std::cerr << "[-] No se pudo abrir " << file_path_ << " para lectura" << std::endl;
+            return;
+        }
+
+        try
+        {
+            nlohmann::json table;
+            in >> table;
+            if (!table.is_array())
+            {
+                return;
+            }
+
+            for (const auto& item : table)
+            {
+                if (!item.contains("hash") || !item.contains("id"))
+                {
+                    continue;
+                }
+
+                ContentHashEntry entry;
+                entry.content_hash = Shared::HashUtils::FromHex(item["hash"].get<std::string>());
+                entry.document_id = item["id"].get<uint64_t>();
+                if (item.contains("simhash"))
+                {
+                    entry.simhash = Shared::HashUtils::FromHex(item["simhash"].get<std::string>());
+                }
+                if (item.contains("aliases") && item["aliases"].is_array())
+                {
+                    for (const auto& alias : item["aliases"])
+                    {
+                        entry.aliases.push_back({alias.value("filename", std::string{}),
+                                                 alias.value("timestamp", std::time_t{0})});
+                    }
+                }
+
+                hash_by_document_[entry.document_id] = entry.content_hash;
+                entries_[entry.content_hash] = std::move(entry);
+            }
+        }
+        catch (const nlohmann::json::exception& e)
+        {
+            std::cerr << "[-] Error al parsear tabla de hashes: " << e.what() << std::endl;
+            entries_.clear();
+            hash_by_document_.clear();
+        }
+
+        for (const auto& [hash, entry] : entries_)
+        {
+            IndexSimHashLocked(entry);
+        }
+        LoadLog();
+    }
+
+    void ContentHashTable::LoadLog()
+    {
+        log_records_ = 0;
+        std::ifstream in(log_path_);
+        if (!in.is_open())
+        {
+            return;
+        }
+
+        // Repite los cambios en orden; una línea a medias (caída al escribirla) se ignora
+        std::string line;
+        while (std::getline(in, line))
+        {
+            if (line.empty())
+            {
+                continue;
+            }
+            log_records_++;
+
+            try
+            {
+                nlohmann::json record = nlohmann::json::parse(line);
+                const std::string op = record.value("op", std::string{});
+                if (op == "register")
+                {
+                    std::vector<DocumentAlias> dropped;
+                    RegisterLocked(
+                        Shared::HashUtils::FromHex(record["hash"].get<std::string>()),
+                        record["id"].get<uint64_t>(),
+                        Shared::HashUtils::FromHex(record.value("simhash", std::string{"0"})),
+                        dropped);
+                }
+                else if (op == "alias")
+                {
+                    auto it = entries_.find(
+                        Shared::HashUtils::FromHex(record["hash"].get<std::string>()));
+                    if (it != entries_.end())
+                    {
+                        it->second.aliases.push_back(
+                            {record.value("filename", std::string{}),
+                             record.value("timestamp", std::time_t{0})});
+                    }
+                }
+                else if (op == "remove")
+                {
+                    RemoveDocumentLocked(record["id"].get<uint64_t>());
+                }
+            }
+            catch (const nlohmann::json::exception& e)
+            {
+                std::cerr << "[-] Línea no válida en " << log_path_ << ": " << e.what()
+                          << std::endl;
+            }
+        }
+    }
+
+    void ContentHashTable::Save() const
+    {
+        if (!SaveTo(file_path_))
+        {
+            return;
+        }
+
+        // Sin registro ya se lee la tabla nueva; si no se puede borrar, se vacía
+        std::error_code ec;
+        if (!std::filesystem::remove(log_path_, ec) && ec)
+        {
+            std::ofstream truncate(log_path_, std::ios::trunc);
+        }
+        log_records_ = 0;
+    }
+
+    void ContentHashTable::Append(const std::string& record) const
+    {
+        if (log_records_ >= std::max(MIN_LOG_RECORDS, entries_.size()))
+        {
+            Save();
+            return;
+        }
+
+        std::ofstream out(log_path_, std::ios::binary | std::ios::app);
+        out << record << '\n';
+        out.flush();
+        if (!out)
+        {
+            std::cerr << "[-] No se pudo escribir en " << log_path_ << std::endl;
+            Save();
+            return;
+        }
+        log_records_++;
+    }
+
+    bool ContentHashTable::SaveTo(const std::filesystem::path& file) const
+    {
+        nlohmann::json table = nlohmann::json::array();
+        for (const auto& [hash, entry] : entries_)
+        {
+            nlohmann::json item;
+            item["hash"] = Shared::HashUtils::ToHex(entry.content_hash);
+            item["id"] = entry.document_id;
+            if (entry.simhash != 0)
+            {
+                item["simhash"] = Shared::HashUtils::ToHex(entry.simhash);
+            }
+
+            nlohmann::json aliases = nlohmann::json::array();
+            for (const auto& alias : entry.aliases)
+            {
+                aliases.push_back({{"filename", alias.filename}, {"timestamp", alias.timestamp}});
+            }
+            item["aliases"] = std::move(aliases);
+            table.push_back(std::move(item));
+        }
+
+        return Shared::FileUtils::WriteFileAtomic(file, table.dump());
+    }
+
+    std::optional<uint64_t> ContentHashTable::Find(uint64_t content_hash) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(content_hash);
+        if (it == entries_.end())
+        {
+            return std::nullopt;
+        }
+        return it->second.document_id;
+    }
+
+    std::optional<NearDuplicateMatch> ContentHashTable::FindNearDuplicate(uint64_t simhash) const
+    {
+        if (!near_duplicate_options_.enabled || simhash == 0)
+        {
+            return std::nullopt;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::optional<NearDuplicateMatch> best;
+        for (size_t band = 0; band < simhash_bands_.size(); ++band)
+        {
+            auto bucket = simhash_bands_[band].find(BandValue(simhash, band));
+            if (bucket == simhash_bands_[band].end())
+            {
+                continue;
+            }
+
+            // Un candidato que comparte varias bandas se compara varias veces: sale igual
+            for (uint64_t content_hash : bucket->second)
+            {
+                const auto& entry = entries_.at(content_hash);
+                int distance = Shared::HashUtils::HammingDistance(simhash, entry.simhash);
+                if (distance <= near_duplicate_options_.max_distance &&
+                    (!best || distance < best->distance ||
+                     (distance == best->distance && entry.document_id < best->document_id)))
+                {
+                    best = NearDuplicateMatch{entry.document_id, distance};
+                }
+            }
+        }
+        return best;
+    }
+
+    std::vector<DocumentAlias> ContentHashTable::Register(uint64_t content_hash,
+                                                          uint64_t document_id, uint64_t simhash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<DocumentAlias> dropped;
+        RegisterLocked(content_hash, document_id, simhash, dropped);
+
+        nlohmann::json record = {{"op", "register"},
+                                 {"hash", Shared::HashUtils::ToHex(content_hash)},
+                                 {"id", document_id}};
+        if (simhash != 0)
+        {
+            record["simhash"] = Shared::HashUtils::ToHex(simhash);
+        }
+        Append(record.dump());
+        return dropped;
+    }
+
+    bool ContentHashTable::RegisterLocked(uint64_t content_hash, uint64_t document_id,
+                                          uint64_t simhash, std::vector<DocumentAlias>& dropped)
+    {
+        auto previous = hash_by_document_.find(document_id);
+        if (previous != hash_by_document_.end() && previous->second != content_hash)
+        {
+            auto old_entry = entries_.find(previous->second);
+            if (old_entry != entries_.end())
+            {
+                UnindexSimHashLocked(old_entry->second);
+                dropped = std::move(old_entry->second.aliases);
+                entries_.erase(old_entry);
+            }
+            hash_by_document_.erase(previous);
+        }
+
+        // El contenido ya es de otro documento: reemplazar su entrada le quitaría los alias
+        // y un DELETE posterior de este documento borraría la del otro
+        auto current = entries_.find(content_hash);
+        if (current != entries_.end() && current->second.document_id != document_id)
+        {
+            return false;
+        }
+
+        // Mismo contenido del mismo documento (un PUT sin cambios): las copias registradas
+        // siguen siendo copias suyas
+        if (current != entries_.end())
+        {
+            UnindexSimHashLocked(current->second);
+            current->second.simhash = simhash;
+        }
+        else
+        {
+            current = entries_.emplace(content_hash,
+                                       ContentHashEntry{content_hash, document_id, simhash, {}})
+                          .first;
+        }
+        IndexSimHashLocked(current->second);
+        hash_by_document_[document_id] = content_hash;
+        return true;
+    }
+
+    std::optional<uint64_t> ContentHashTable::AddAlias(uint64_t content_hash,
+                                                       const std::string& filename)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(content_hash);
+        if (it == entries_.end())
+        {
+            return std::nullopt;
+        }
+
+        const std::time_t timestamp = std::time(nullptr);
+        it->second.aliases.push_back({filename, timestamp});
+        Append(nlohmann::json{{"op", "alias"},
+                              {"hash", Shared::HashUtils::ToHex(content_hash)},
+                              {"filename", filename},
+                              {"timestamp", timestamp}}
+                   .dump());
+        return it->second.document_id;
+    }
+
+    std::vector<DocumentAlias> ContentHashTable::RemoveDocument(uint64_t document_id)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!hash_by_document_.contains(document_id))
+        {
+            return {};
+        }
+
+        auto dropped = RemoveDocumentLocked(document_id);
+        Append(nlohmann::json{{"op", "remove"}, {"id", document_id}}.dump());
+        return dropped;
+    }
+
+    std::vector<DocumentAlias> ContentHashTable::RemoveDocumentLocked(uint64_t document_id)
+    {
+        auto it = hash_by_document_.find(document_id);
+        if (it == hash_by_document_.end())
+        {
+            return {};
+        }
+
+        std::vector<DocumentAlias> dropped;
+        auto entry = entries_.find(it->second);
+        if (entry != entries_.end())
+        {
+            UnindexSimHashLocked(entry->second);
+            dropped = std::move(entry->second.aliases);
+            entries_.erase(entry);
+        }
+        hash_by_document_.erase(it);
+        return dropped;
+    }
+
+    bool ContentHashTable::ContainsDocument(uint64_t document_id) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return hash_by_document_.contains(document_id);
+    }
+
+    size_t ContentHashTable::Size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+
+    size_t ContentHashTable::Backfill(const std::vector<CatalogEntry>& entries)
+    {
+        // Leer y calcular los hashes sin lock; la tabla se escribe una sola vez al final
+        struct Pending
+        {
+            uint64_t document_id;
+            uint64_t content_hash;
+            uint64_t simhash;
+        };
+        std::vector<Pending> pending;
+        for (const auto& entry : entries)
+        {
+            if (ContainsDocument(entry.id))
+            {
+                continue;
+            }
+
+            std::string content = Shared::FileUtils::ExtractText(entry.path);
+            if (content.empty())
+            {
+                continue;
+            }
+
+            uint64_t simhash =
+                near_duplicate_options_.enabled
+                    ? Shared::HashUtils::SimHash(Shared::TextUtils::normalizeForSearch(content))
+                    : 0;
+            pending.push_back({entry.id, Shared::HashUtils::Hash64(content), simhash});
+        }
+
+        if (pending.empty())
+        {
+            return 0;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t backfilled = 0;
+        for (const auto& document : pending)
+        {
+            // Dos documentos del catálogo con el mismo contenido: el primero queda como dueño
+            std::vector<DocumentAlias> dropped;
+            if (RegisterLocked(document.content_hash, document.document_id, document.simhash,
+                               dropped))
+            {
+                backfilled++;
+            }
+        }
+        Save();
+        return backfilled;
+    }
+
+    bool ContentHashTable::Pin(const std::filesystem::path& file) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Con cambios en el registro la tabla en disco está incompleta: se reescribe antes de
+        // enlazarla, bajo el mismo lock que los cambios
+        if (log_records_ > 0)
+        {
+            Save();
+        }
+        if (!std::filesystem::exists(file_path_) || log_records_ > 0)
+        {
+            if (!SaveTo(file))
+            {
+                throw std::runtime_error("no se pudo escribir " + file.string());
+            }
+            return true;
+        }
+
+        bool copied = false;
+        if (!Shared::FileUtils::LinkOrCopyFile(file_path_, file, &copied))
+        {
+            throw std::runtime_error("no se pudo enlazar " + file_path_.string());
+        }
+        return copied;
+    }
+
+    void ContentHashTable::Restore(const std::filesystem::path& file)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (std::filesystem::exists(file))
+        {
+            if (!Shared::FileUtils::LinkOrCopyFile(file, file_path_))
+            {
+                throw std::runtime_error("no se pudo restaurar " + file_path_.string());
+            }
+        }
+        else
+        {
+            std::error_code ec;
+            std::filesystem::remove(file_path_, ec);
+        }
+        // El registro describe cambios sobre la tabla sustituida
+        std::error_code ec;
+        std::filesystem::remove(log_path_, ec);
+
+        entries_.clear();
+        hash_by_document_.clear();
+        for (auto& band : simhash_bands_)
+        {
+            band.clear();
+        }
+        Load();
+    }
+
+} // namespace DocuTrace::Infrastructure
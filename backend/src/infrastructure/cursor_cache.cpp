@@ -0,0 +1,99 @@
+#include "infrastructure/cursor_cache.hpp"
+#include <algorithm>
+#include <charconv>
+
+namespace DocuTrace::Infrastructure
+{
+    CursorCache::CursorCache(std::chrono::seconds ttl, size_t capacity)
+        : ttl_(ttl), capacity_(std::max<size_t>(capacity, 1)), random_(std::random_device{}())
+    {
+    }
+
+    void CursorCache::EvictLocked(Clock::time_point now)
+    {
+        std::erase_if(entries_, [this, now](const auto& item)
+                      { return now - item.second.last_access > ttl_; });
+
+        while (entries_.size() >= capacity_)
+        {
+            auto oldest = std::min_element(entries_.begin(), entries_.end(),
+                                           [](const auto& a, const auto& b)
+                                           { return a.second.last_access < b.second.last_access; });
+            entries_.erase(oldest);
+        }
+    }
+
+    uint64_t CursorCache::Insert(std::shared_ptr<const CursorSnapshot> snapshot)
+    {
+        const Clock::time_point now = Clock::now();
+        std::lock_guard<std::mutex> lock(mutex_);
+        EvictLocked(now);
+
+        // Aleatorio: un token no permite adivinar los cursores de otros clientes
+        uint64_t id = random_();
+        while (entries_.contains(id))
+        {
+            id = random_();
+        }
+        entries_.emplace(id, Entry{std::move(snapshot), now});
+        return id;
+    }
+
+    std::optional<CursorPosition> CursorCache::Find(const std::string& token)
+    {
+        const size_t separator = token.find('-');
+        if (separator == std::string::npos)
+        {
+            return std::nullopt;
+        }
+
+        uint64_t id = 0;
+        size_t offset = 0;
+        const char* begin = token.data();
+        const char* end = token.data() + token.size();
+        auto [id_end, id_error] = std::from_chars(begin, begin + separator, id, 16);
+        auto [offset_end, offset_error] = std::from_chars(begin + separator + 1, end, offset);
+        if (id_error != std::errc() || id_end != begin + separator ||
+            offset_error != std::errc() || offset_end != end)
+        {
+            return std::nullopt;
+        }
+
+        const Clock::time_point now = Clock::now();
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(id);
+        if (it == entries_.end())
+        {
+            return std::nullopt;
+        }
+        if (now - it->second.last_access > ttl_)
+        {
+            entries_.erase(it);
+            return std::nullopt;
+        }
+
+        it->second.last_access = now;
+        return CursorPosition{it->second.snapshot, id, offset};
+    }
+
+    std::string CursorCache::MakeToken(uint64_t id, size_t offset)
+    {
+        char buffer[48];
+        auto [id_end, id_error] = std::to_chars(buffer, buffer + 16, id, 16);
+        // Ancho fijo para que todos los tokens de un cursor empiecen igual
+        const size_t digits = static_cast<size_t>(id_end - buffer);
+        std::string token(16 - digits, '0');
+        token.append(buffer, id_end);
+        token += '-';
+        auto [offset_end, offset_error] = std::to_chars(buffer, buffer + sizeof(buffer), offset);
+        token.append(buffer, offset_end);
+        return token;
+    }
+
+    size_t CursorCache::Size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+
+} // namespace DocuTrace::Infrastructure
@@ -0,0 +1,347 @@
+#include "infrastructure/doc_values.hpp"
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+
+namespace DocuTrace::Infrastructure
+{
+    namespace
+    {
+        constexpr int64_t SECONDS_PER_DAY = 24 * 60 * 60;
+
+        // Nombre y rango [begin, end) en segundos del mes UTC de un instante
+        struct CalendarMonth
+        {
+            std::string name;
+            int64_t begin;
+            int64_t end;
+        };
+
+        CalendarMonth month_of(int64_t timestamp)
+        {
+            using namespace std::chrono;
+            const sys_days day{days{timestamp >= 0 ? timestamp / SECONDS_PER_DAY
+                                                   : (timestamp + 1) / SECONDS_PER_DAY - 1}};
+            const year_month_day date{day};
+            const year_month first = date.year() / date.month();
+            const year_month next = first + months{1};
+
+            char name[16];
+            std::snprintf(name, sizeof(name), "%04d-%02u", static_cast<int>(date.year()),
+                          static_cast<unsigned>(date.month()));
+            auto seconds_of = [](const year_month& month)
+            {
+                return duration_cast<seconds>(sys_days{month / 1}.time_since_epoch()).count();
+            };
+            return {name, seconds_of(first), seconds_of(next)};
+        }
+
+        bool contains_case_insensitive(std::string_view haystack, const std::string& needle)
+        {
+            auto it = std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end(),
+                                  [](char a, char b)
+                                  {
+                                      return std::tolower(static_cast<unsigned char>(a)) ==
+                                             std::tolower(static_cast<unsigned char>(b));
+                                  });
+            return it != haystack.end();
+        }
+
+        // El propio directorio o uno que cuelga de él
+        bool is_within(const std::string& directory, const std::string& ancestor)
+        {
+            if (directory.size() < ancestor.size() ||
+                directory.compare(0, ancestor.size(), ancestor) != 0)
+            {
+                return false;
+            }
+            return directory.size() == ancestor.size() || ancestor.back() == '/' ||
+                   directory[ancestor.size()] == '/';
+        }
+    } // namespace
+
+    void FacetCounts::Merge(const FacetCounts& other)
+    {
+        for (const auto& [field, values] : other.fields)
+        {
+            auto& counts = fields[field];
+            for (const auto& [value, count] : values)
+            {
+                counts[value] += count;
+            }
+        }
+    }
+
+    uint32_t DocValues::Dictionary::Encode(const std::string& value)
+    {
+        auto [it, inserted] = codes_.try_emplace(value, static_cast<uint32_t>(values_.size()));
+        if (inserted)
+        {
+            values_.push_back(value);
+        }
+        return it->second;
+    }
+
+    std::optional<uint32_t> DocValues::Dictionary::Find(const std::string& value) const
+    {
+        auto it = codes_.find(value);
+        if (it == codes_.end())
+        {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    size_t DocValues::Dictionary::GetMemoryUsage() const
+    {
+        size_t bytes = values_.capacity() * sizeof(std::string) +
+                       codes_.bucket_count() * sizeof(void*) +
+                       codes_.size() * (sizeof(std::string) + sizeof(uint32_t) + sizeof(void*));
+        for (const auto& value : values_)
+        {
+            // Cada valor está dos veces: en values_ y como clave de codes_
+            bytes += 2 * value.size();
+        }
+        return bytes;
+    }
+
+    std::string DocValues::ExtensionOf(std::string_view filename)
+    {
+        const size_t dot = filename.rfind('.');
+        // Sin punto, o solo al principio (".bashrc"): sin extensión
+        if (dot == std::string_view::npos || dot == 0 || dot + 1 == filename.size())
+        {
+            return {};
+        }
+        std::string extension(filename.substr(dot + 1));
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension;
+    }
+
+    bool DocValues::ParseFacetField(const std::string& value, FacetField& field)
+    {
+        if (value == "extension")
+        {
+            field = FacetField::EXTENSION;
+            return true;
+        }
+        if (value == "month")
+        {
+            field = FacetField::MONTH;
+            return true;
+        }
+        if (value == "directory")
+        {
+            field = FacetField::DIRECTORY;
+            return true;
+        }
+        return false;
+    }
+
+    const char* DocValues::FacetFieldName(FacetField field)
+    {
+        switch (field)
+        {
+        case FacetField::EXTENSION:
+            return "extension";
+        case FacetField::MONTH:
+            return "month";
+        case FacetField::DIRECTORY:
+            return "directory";
+        }
+        return "extension";
+    }
+
+    bool DocValues::ParseSortOrder(const std::string& value, SortOrder& sort)
+    {
+        const bool descending = !value.empty() && value.front() == '-';
+        const std::string field = descending ? value.substr(1) : value;
+        if (field == "timestamp")
+        {
+            sort = {SortField::TIMESTAMP, descending};
+            return true;
+        }
+        if (field == "filename")
+        {
+            sort = {SortField::FILENAME, descending};
+            return true;
+        }
+        return false;
+    }
+
+    std::string DocValues::SortOrderName(const SortOrder& sort)
+    {
+        return std::string(sort.descending ? "-" : "") +
+               (sort.field == SortField::TIMESTAMP ? "timestamp" : "filename");
+    }
+
+    void DocValues::Reserve(size_t count)
+    {
+        timestamps_.reserve(count);
+        extensions_.reserve(count);
+        directories_.reserve(count);
+        filename_offsets_.reserve(count + 1);
+    }
+
+    void DocValues::Add(const DocumentMetadata& metadata)
+    {
+        timestamps_.push_back(static_cast<int64_t>(metadata.timestamp));
+        extensions_.push_back(extension_dictionary_.Encode(ExtensionOf(metadata.filename)));
+        directories_.push_back(directory_dictionary_.Encode(metadata.directory));
+        filenames_ += metadata.filename;
+        filename_offsets_.push_back(filenames_.size());
+    }
+
+    DocumentBitset DocValues::Filter(const QueryNode& filter) const
+    {
+        DocumentBitset matches;
+        const size_t size = Size();
+        const std::string& value = filter.filter_value;
+        switch (filter.field)
+        {
+        case QueryField::FILENAME:
+            matches.Assign(size,
+                           [this, &value](InternalDocumentId id)
+                           { return contains_case_insensitive(GetFilename(id), value); });
+            break;
+        case QueryField::AFTER:
+        {
+            const int64_t after = static_cast<int64_t>(filter.filter_timestamp);
+            matches.Assign(size, [this, after](InternalDocumentId id)
+                           { return timestamps_[id] >= after; });
+            break;
+        }
+        case QueryField::BEFORE:
+        {
+            const int64_t before = static_cast<int64_t>(filter.filter_timestamp);
+            matches.Assign(size, [this, before](InternalDocumentId id)
+                           { return timestamps_[id] < before; });
+            break;
+        }
+        case QueryField::EXTENSION:
+        {
+            // Una extensión que nadie tiene no casa con ningún documento
+            if (auto code = extension_dictionary_.Find(value))
+            {
+                matches.Assign(size, [this, code = *code](InternalDocumentId id)
+                               { return extensions_[id] == code; });
+            }
+            else
+            {
+                matches.Assign(size, [](InternalDocumentId) { return false; });
+            }
+            break;
+        }
+        case QueryField::DIRECTORY:
+        {
+            const auto& values = directory_dictionary_.GetValues();
+            std::vector<uint8_t> accepted(values.size(), 0);
+            for (size_t code = 1; code < values.size(); ++code)
+            {
+                accepted[code] = is_within(values[code], value) ? 1 : 0;
+            }
+            matches.Assign(size, [this, &accepted](InternalDocumentId id)
+                           { return accepted[directories_[id]] != 0; });
+            break;
+        }
+        }
+        return matches;
+    }
+
+    void DocValues::CountFacets(std::span<const InternalDocumentId> documents,
+                                const std::vector<FacetField>& fields, FacetCounts& counts) const
+    {
+        auto count_codes = [&documents](const std::vector<uint32_t>& column,
+                                        const Dictionary& dictionary,
+                                        std::map<std::string, uint64_t>& values)
+        {
+            std::vector<uint64_t> per_code(dictionary.GetValues().size(), 0);
+            for (InternalDocumentId id : documents)
+            {
+                per_code[column[id]]++;
+            }
+            // El código 0 (sin valor) no es una faceta
+            for (size_t code = 1; code < per_code.size(); ++code)
+            {
+                if (per_code[code] > 0)
+                {
+                    values[dictionary.Decode(static_cast<uint32_t>(code))] += per_code[code];
+                }
+            }
+        };
+
+        for (FacetField field : fields)
+        {
+            auto& values = counts.fields[field];
+            switch (field)
+            {
+            case FacetField::EXTENSION:
+                count_codes(extensions_, extension_dictionary_, values);
+                break;
+            case FacetField::DIRECTORY:
+                count_codes(directories_, directory_dictionary_, values);
+                break;
+            case FacetField::MONTH:
+            {
+                // Los documentos de un mismo mes suelen tener IDs seguidos: el último mes
+                // visto ahorra casi todas las conversiones de calendario
+                std::map<int64_t, std::pair<CalendarMonth, uint64_t>> months;
+                std::pair<CalendarMonth, uint64_t>* last = nullptr;
+                for (InternalDocumentId id : documents)
+                {
+                    const int64_t timestamp = timestamps_[id];
+                    if (timestamp == 0)
+                    {
+                        continue;
+                    }
+                    if (!last || timestamp < last->first.begin || timestamp >= last->first.end)
+                    {
+                        CalendarMonth month = month_of(timestamp);
+                        const int64_t begin = month.begin;
+                        last = &months.try_emplace(begin, std::move(month), 0).first->second;
+                    }
+                    last->second++;
+                }
+                for (const auto& [begin, month] : months)
+                {
+                    values[month.first.name] += month.second;
+                }
+                break;
+            }
+            }
+        }
+    }
+
+    void DocValues::Compact(const std::vector<InternalDocumentId>& remap, size_t live_count)
+    {
+        DocValues compacted;
+        compacted.Reserve(live_count);
+        for (InternalDocumentId id : DocumentIdMap::SurvivorsInOrder(remap, live_count))
+        {
+            compacted.timestamps_.push_back(timestamps_[id]);
+            compacted.extensions_.push_back(compacted.extension_dictionary_.Encode(
+                extension_dictionary_.Decode(extensions_[id])));
+            compacted.directories_.push_back(
+                compacted.directory_dictionary_.Encode(GetDirectory(id)));
+            compacted.filenames_ += GetFilename(id);
+            compacted.filename_offsets_.push_back(compacted.filenames_.size());
+        }
+        *this = std::move(compacted);
+    }
+
+    void DocValues::Clear()
+    {
+        *this = DocValues();
+    }
+
+    size_t DocValues::GetMemoryUsage() const
+    {
+        return timestamps_.capacity() * sizeof(int64_t) +
+               extensions_.capacity() * sizeof(uint32_t) +
+               directories_.capacity() * sizeof(uint32_t) + filenames_.capacity() +
+               filename_offsets_.capacity() * sizeof(uint64_t) +
+               extension_dictionary_.GetMemoryUsage() + directory_dictionary_.GetMemoryUsage();
+    }
+
+} // namespace DocuTrace::Infrastructure
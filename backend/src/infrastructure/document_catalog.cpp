@@ -0,0 +1,352 @@
+#include "infrastructure/document_catalog.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+#include <unordered_set>
+#include "shared/file_utils.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    namespace
+    {
+        constexpr const char* INDEX_FILE_NAME = "document_index.json";
+        constexpr const char* LAST_ID_FILE_NAME = "last_id.txt";
+
+        // Entradas de document_index.json; se ignoran las que no tienen id o ruta
+        std::vector<CatalogEntry> parse_entries(const nlohmann::json& index)
+        {
+            std::vector<CatalogEntry> entries;
+            for (const auto& doc : index)
+            {
+                if (!doc.contains("id") || !doc.contains("path"))
+                {
+                    continue;
+                }
+
+                entries.push_back({doc["id"].get<uint64_t>(), doc.value("filename", std::string{}),
+                                   doc["path"].get<std::string>(),
+                                   doc.value("timestamp", std::time_t{0})});
+            }
+            return entries;
+        }
+    } // namespace
+
+    DocumentCatalog::DocumentCatalog(std::filesystem::path data_root)
+        : data_root_(std::move(data_root)), index_file_(data_root_ / INDEX_FILE_NAME),
+          last_id_file_(data_root_ / LAST_ID_FILE_NAME)
+    {
+        Load();
+    }
+
+    void DocumentCatalog::Load()
+    {
+        if (!std::filesystem::exists(index_file_))
+        {
+            std::cout << "[+] Creando nuevo índice de documentos" << std::endl;
+            return;
+        }
+
+        std::ifstream in(index_file_);
+        if (!in.is_open())
+        {
+            std::cerr << "[-] No se pudo abrir document_index.json para lectura" << std::endl;
+            return;
+        }
+
+        try
+        {
+            nlohmann::json index;
+            in >> index;
+            if (!index.is_array())
+            {
+                std::cerr << "[-] document_index.json no contiene un array válido, reiniciando"
+                          << std::endl;
+                return;
+            }
+
+            entries_ = parse_entries(index);
+        }
+        catch (const nlohmann::json::exception& e)
+        {
+            std::cerr << "[-] Error al parsear document_index.json: " << e.what() << std::endl;
+            std::cerr << "[-] Reiniciando índice desde cero" << std::endl;
+            entries_.clear();
+        }
+    }
+
+    void DocumentCatalog::Save() const
+    {
+        if (!SaveTo(index_file_))
+        {
+            std::cerr << "[-] Error al escribir document_index.json" << std::endl;
+        }
+    }
+
+    bool DocumentCatalog::SaveTo(const std::filesystem::path& file) const
+    {
+        nlohmann::json index = nlohmann::json::array();
+        for (const auto& entry : entries_)
+        {
+            nlohmann::json item;
+            item["id"] = entry.id;
+            item["filename"] = entry.filename;
+            item["path"] = entry.path;
+            item["timestamp"] = entry.timestamp;
+            index.push_back(std::move(item));
+        }
+
+        return Shared::FileUtils::WriteFileAtomic(file, index.dump(4));
+    }
+
+    uint64_t DocumentCatalog::ReadLastIdLocked() const
+    {
+        uint64_t last_id = 0;
+        if (!std::filesystem::exists(last_id_file_))
+        {
+            return last_id;
+        }
+
+        std::ifstream in(last_id_file_);
+        if (in.is_open())
+        {
+            in >> last_id;
+            if (in.fail())
+            {
+                std::cerr << "[-] Error al leer last_id.txt, reiniciando desde 0" << std::endl;
+                last_id = 0;
+            }
+        }
+        else
+        {
+            std::cerr << "[-] No se pudo abrir last_id.txt para lectura" << std::endl;
+        }
+        return last_id;
+    }
+
+    uint64_t DocumentCatalog::NextId()
+    {
+        return ReserveIds(1);
+    }
+
+    uint64_t DocumentCatalog::ReserveIds(uint64_t count)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Asegurar que el directorio existe
+        std::error_code ec;
+        std::filesystem::create_directories(data_root_, ec);
+        if (ec)
+        {
+            std::cerr << "[-] Error al crear directorio de datos: " << ec.message() << std::endl;
+            return 1;
+        }
+
+        // Leer último ID si el archivo existe
+        const uint64_t last_id = ReadLastIdLocked();
+        uint64_t next_id = last_id + 1;
+
+        // Guardar el último ID reservado
+        if (!Shared::FileUtils::WriteFileAtomic(last_id_file_, std::to_string(last_id + count)))
+        {
+            std::cerr << "[-] Error al escribir last_id.txt" << std::endl;
+        }
+
+        return next_id;
+    }
+
+    void DocumentCatalog::Add(const CatalogEntry& entry)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.push_back(entry);
+        Save();
+    }
+
+    std::optional<CatalogEntry> DocumentCatalog::Find(uint64_t id) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find_if(entries_.begin(), entries_.end(),
+                               [id](const CatalogEntry& entry) { return entry.id == id; });
+        if (it == entries_.end())
+        {
+            return std::nullopt;
+        }
+        return *it;
+    }
+
+    bool DocumentCatalog::Remove(uint64_t id)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t removed =
+            std::erase_if(entries_, [id](const CatalogEntry& entry) { return entry.id == id; });
+        if (removed == 0)
+        {
+            return false;
+        }
+
+        Save();
+        return true;
+    }
+
+    std::unique_lock<std::mutex> DocumentCatalog::LockMutations()
+    {
+        return std::unique_lock<std::mutex>(mutation_mutex_);
+    }
+
+    bool DocumentCatalog::Touch(uint64_t id)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find_if(entries_.begin(), entries_.end(),
+                               [id](const CatalogEntry& entry) { return entry.id == id; });
+        if (it == entries_.end())
+        {
+            return false;
+        }
+
+        it->timestamp = std::time(nullptr);
+        Save();
+        return true;
+    }
+
+    std::vector<CatalogEntry> DocumentCatalog::GetEntries() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_;
+    }
+
+    std::filesystem::path DocumentCatalog::SnapshotPath(const std::filesystem::path& directory,
+                                                        const CatalogEntry& entry) const
+    {
+        const auto relative = std::filesystem::path(entry.path).lexically_relative(data_root_);
+        if (relative.empty() || *relative.begin() == "..")
+        {
+            return {};
+        }
+        return directory / relative;
+    }
+
+    CatalogSnapshot DocumentCatalog::Pin(const std::filesystem::path& directory) const
+    {
+        std::filesystem::create_directories(directory);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        CatalogSnapshot snapshot;
+        snapshot.entries = entries_;
+        snapshot.last_id = ReadLastIdLocked();
+
+        auto link = [&snapshot](const std::filesystem::path& source,
+                                const std::filesystem::path& target)
+        {
+            std::filesystem::create_directories(target.parent_path());
+            bool copied = false;
+            if (!Shared::FileUtils::LinkOrCopyFile(source, target, &copied))
+            {
+                throw std::runtime_error("no se pudo enlazar " + source.string());
+            }
+            snapshot.linked_files += copied ? 0 : 1;
+            snapshot.copied_files += copied ? 1 : 0;
+        };
+
+        for (const auto& entry : snapshot.entries)
+        {
+            const auto target = SnapshotPath(directory, entry);
+            if (target.empty())
+            {
+                std::cerr << "[!] " << entry.path
+                          << " está fuera del directorio de datos, no entra en la copia"
+                          << std::endl;
+                continue;
+            }
+            link(entry.path, target);
+        }
+
+        // El archivo en disco es el de entries_: cada cambio lo reescribe bajo el mismo lock
+        if (std::filesystem::exists(index_file_))
+        {
+            link(index_file_, directory / INDEX_FILE_NAME);
+        }
+        else if (!SaveTo(directory / INDEX_FILE_NAME))
+        {
+            throw std::runtime_error("no se pudo escribir el catálogo de la copia");
+        }
+        if (!Shared::FileUtils::WriteFileAtomic(directory / LAST_ID_FILE_NAME,
+                                                std::to_string(snapshot.last_id)))
+        {
+            throw std::runtime_error("no se pudo escribir last_id.txt de la copia");
+        }
+        return snapshot;
+    }
+
+    std::vector<CatalogEntry> DocumentCatalog::Restore(const std::filesystem::path& directory)
+    {
+        std::ifstream in(directory / INDEX_FILE_NAME);
+        if (!in.is_open())
+        {
+            throw std::runtime_error("la copia no tiene document_index.json");
+        }
+        std::vector<CatalogEntry> restored;
+        uint64_t snapshot_last_id = 0;
+        try
+        {
+            nlohmann::json index;
+            in >> index;
+            restored = parse_entries(index);
+            std::ifstream last_id_in(directory / LAST_ID_FILE_NAME);
+            last_id_in >> snapshot_last_id;
+        }
+        catch (const nlohmann::json::exception& e)
+        {
+            throw std::runtime_error(std::string("catálogo de la copia inválido: ") + e.what());
+        }
+
+        // Se comprueba todo antes de tocar el directorio de datos
+        for (const auto& entry : restored)
+        {
+            const auto source = SnapshotPath(directory, entry);
+            if (!source.empty() && !std::filesystem::exists(source))
+            {
+                throw std::runtime_error("a la copia le falta " + source.string());
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::unordered_set<uint64_t> restored_ids;
+        for (const auto& entry : restored)
+        {
+            restored_ids.insert(entry.id);
+            const auto source = SnapshotPath(directory, entry);
+            if (source.empty())
+            {
+                continue;
+            }
+            std::filesystem::create_directories(std::filesystem::path(entry.path).parent_path());
+            if (!Shared::FileUtils::LinkOrCopyFile(source, entry.path))
+            {
+                throw std::runtime_error("no se pudo restaurar " + entry.path);
+            }
+        }
+
+        // Documentos subidos después de la copia
+        std::error_code ec;
+        for (const auto& entry : entries_)
+        {
+            if (!restored_ids.contains(entry.id) && !SnapshotPath(data_root_, entry).empty())
+            {
+                std::filesystem::remove(entry.path, ec);
+            }
+        }
+
+        if (!Shared::FileUtils::LinkOrCopyFile(directory / INDEX_FILE_NAME, index_file_))
+        {
+            throw std::runtime_error("no se pudo restaurar document_index.json");
+        }
+        if (snapshot_last_id > ReadLastIdLocked())
+        {
+            Shared::FileUtils::WriteFileAtomic(last_id_file_, std::to_string(snapshot_last_id));
+        }
+        entries_ = restored;
+        return restored;
+    }
+
+} // namespace DocuTrace::Infrastructure
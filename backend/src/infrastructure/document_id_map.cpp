@@ -0,0 +1,67 @@
+#include "infrastructure/document_id_map.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    std::optional<InternalDocumentId> DocumentIdMap::Find(ExternalDocumentId external_id) const
+    {
+        auto it = internal_ids_.find(external_id);
+        if (it == internal_ids_.end())
+        {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    InternalDocumentId DocumentIdMap::Assign(ExternalDocumentId external_id)
+    {
+        auto internal_id = static_cast<InternalDocumentId>(external_ids_.size());
+        external_ids_.push_back(external_id);
+        internal_ids_[external_id] = internal_id;
+        return internal_id;
+    }
+
+    void DocumentIdMap::Release(ExternalDocumentId external_id)
+    {
+        internal_ids_.erase(external_id);
+    }
+
+    void DocumentIdMap::Compact(const std::vector<InternalDocumentId>& remap, size_t live_count)
+    {
+        std::vector<ExternalDocumentId> compacted(live_count);
+        for (size_t old_id = 0; old_id < external_ids_.size(); ++old_id)
+        {
+            InternalDocumentId new_id = remap[old_id];
+            if (new_id != INVALID_ID)
+            {
+                compacted[new_id] = external_ids_[old_id];
+            }
+        }
+        external_ids_ = std::move(compacted);
+
+        for (auto& [external_id, internal_id] : internal_ids_)
+        {
+            internal_id = remap[internal_id];
+        }
+    }
+
+    std::vector<InternalDocumentId> DocumentIdMap::SurvivorsInOrder(
+        const std::vector<InternalDocumentId>& remap, size_t live_count)
+    {
+        std::vector<InternalDocumentId> survivors(live_count);
+        for (size_t old_id = 0; old_id < remap.size(); ++old_id)
+        {
+            if (remap[old_id] != INVALID_ID)
+            {
+                survivors[remap[old_id]] = static_cast<InternalDocumentId>(old_id);
+            }
+        }
+        return survivors;
+    }
+
+    void DocumentIdMap::Clear()
+    {
+        internal_ids_.clear();
+        external_ids_.clear();
+    }
+
+} // namespace DocuTrace::Infrastructure
@@ -0,0 +1,333 @@
+#include "infrastructure/document_reordering.hpp"
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <utility>
+
+namespace DocuTrace::Infrastructure
+{
+    namespace
+    {
+        // Términos de cada documento que se ordena (solo los que aparecen en varios)
+        struct ForwardIndex
+        {
+            std::vector<uint64_t> offsets;
+            std::vector<uint32_t> terms;
+            size_t term_count = 0;
+
+            // log2 de 0 a documentos + 1
+            std::vector<double> log2;
+
+            std::span<const uint32_t> Terms(uint32_t document) const
+            {
+                return {terms.data() + offsets[document], terms.data() + offsets[document + 1]};
+            }
+        };
+
+        // log2(k) para k <= documentos + 1: el coste se evalúa millones de veces por pasada
+        std::vector<double> log2_table(size_t size)
+        {
+            std::vector<double> table(size + 2, 0.0);
+            for (size_t k = 1; k < table.size(); ++k)
+            {
+                table[k] = std::log2(static_cast<double>(k));
+            }
+            return table;
+        }
+
+        // Lo que necesita una tarea de la bisección; los vectores por término vuelven a cero
+        // al terminar cada partición para reutilizarlos en la siguiente
+        struct Workspace
+        {
+            std::vector<uint32_t> left_degree;
+            std::vector<uint32_t> right_degree;
+            std::vector<double> left_to_right;
+            std::vector<double> right_to_left;
+            std::vector<uint32_t> partition_terms;
+            std::vector<std::pair<double, uint32_t>> left_gains;
+            std::vector<std::pair<double, uint32_t>> right_gains;
+
+            explicit Workspace(size_t term_count)
+                : left_degree(term_count, 0), right_degree(term_count, 0),
+                  left_to_right(term_count, 0.0), right_to_left(term_count, 0.0)
+            {
+            }
+        };
+
+        class Bisection
+        {
+          private:
+            const ForwardIndex& forward_;
+            const ReorderOptions& options_;
+
+            // Coste de los huecos de un término con degree documentos en una mitad de size:
+            // degree · log2(size / (degree + 1))
+            double GapCost(uint32_t degree, size_t size) const
+            {
+                return degree == 0
+                           ? 0.0
+                           : degree * (forward_.log2[size] - forward_.log2[degree + 1]);
+            }
+
+            double SumGains(uint32_t document, const std::vector<double>& term_gains) const
+            {
+                double gain = 0.0;
+                for (uint32_t term : forward_.Terms(document))
+                {
+                    gain += term_gains[term];
+                }
+                return gain;
+            }
+
+            void Move(uint32_t document, std::vector<uint32_t>& from,
+                      std::vector<uint32_t>& to) const
+            {
+                for (uint32_t term : forward_.Terms(document))
+                {
+                    from[term]--;
+                    to[term]++;
+                }
+            }
+
+            /**
+             * @brief Intercambia documentos entre las dos mitades mientras baje el coste
+             */
+            void Refine(std::span<uint32_t> documents, Workspace& work) const
+            {
+                const size_t half = documents.size() / 2;
+                work.partition_terms.clear();
+                for (size_t i = 0; i < documents.size(); ++i)
+                {
+                    auto& degree = i < half ? work.left_degree : work.right_degree;
+                    for (uint32_t term : forward_.Terms(documents[i]))
+                    {
+                        if (work.left_degree[term] == 0 && work.right_degree[term] == 0)
+                        {
+                            work.partition_terms.push_back(term);
+                        }
+                        degree[term]++;
+                    }
+                }
+
+                const size_t left_size = half;
+                const size_t right_size = documents.size() - half;
+                // Más ganancia primero; a igualdad, por documento (resultado determinista)
+                auto by_gain = [](const std::pair<double, uint32_t>& a,
+                                  const std::pair<double, uint32_t>& b)
+                { return a.first > b.first || (a.first == b.first && a.second < b.second); };
+
+                for (size_t iteration = 0; iteration < options_.iterations; ++iteration)
+                {
+                    // Ganancia de mover a la otra mitad un documento con cada término
+                    for (uint32_t term : work.partition_terms)
+                    {
+                        const uint32_t left = work.left_degree[term];
+                        const uint32_t right = work.right_degree[term];
+                        const double before =
+                            GapCost(left, left_size) + GapCost(right, right_size);
+                        work.left_to_right[term] =
+                            left == 0 ? 0.0
+                                      : before - GapCost(left - 1, left_size) -
+                                            GapCost(right + 1, right_size);
+                        work.right_to_left[term] =
+                            right == 0 ? 0.0
+                                       : before - GapCost(left + 1, left_size) -
+                                             GapCost(right - 1, right_size);
+                    }
+
+                    work.left_gains.clear();
+                    work.right_gains.clear();
+                    for (size_t i = 0; i < half; ++i)
+                    {
+                        work.left_gains.emplace_back(SumGains(documents[i], work.left_to_right),
+                                                     documents[i]);
+                    }
+                    for (size_t i = half; i < documents.size(); ++i)
+                    {
+                        work.right_gains.emplace_back(SumGains(documents[i], work.right_to_left),
+                                                      documents[i]);
+                    }
+                    std::sort(work.left_gains.begin(), work.left_gains.end(), by_gain);
+                    std::sort(work.right_gains.begin(), work.right_gains.end(), by_gain);
+
+                    size_t swaps = 0;
+                    while (swaps < work.left_gains.size() &&
+                           work.left_gains[swaps].first + work.right_gains[swaps].first > 0.0)
+                    {
+                        Move(work.left_gains[swaps].second, work.left_degree, work.right_degree);
+                        Move(work.right_gains[swaps].second, work.right_degree, work.left_degree);
+                        ++swaps;
+                    }
+                    if (swaps == 0)
+                    {
+                        break;
+                    }
+
+                    // Los swaps primeros de cada lado cambian de mitad
+                    for (size_t i = 0; i < half; ++i)
+                    {
+                        documents[i] = i < swaps ? work.right_gains[i].second
+                                                 : work.left_gains[i].second;
+                    }
+                    for (size_t i = 0; i < work.right_gains.size(); ++i)
+                    {
+                        documents[half + i] = i < swaps ? work.left_gains[i].second
+                                                        : work.right_gains[i].second;
+                    }
+                }
+
+                for (uint32_t term : work.partition_terms)
+                {
+                    work.left_degree[term] = 0;
+                    work.right_degree[term] = 0;
+                }
+            }
+
+          public:
+            Bisection(const ForwardIndex& forward, const ReorderOptions& options)
+                : forward_(forward), options_(options)
+            {
+            }
+
+            void Run(std::span<uint32_t> documents, size_t depth, Workspace& work) const
+            {
+                if (documents.size() <= std::max<size_t>(options_.min_partition, 1))
+                {
+                    return;
+                }
+
+                Refine(documents, work);
+                const size_t half = documents.size() / 2;
+                const std::span<uint32_t> left = documents.first(half);
+                const std::span<uint32_t> right = documents.subspan(half);
+                if (depth < options_.parallel_depth)
+                {
+                    // Las mitades no comparten documentos: la izquierda va a otro hilo
+                    auto future = std::async(std::launch::async,
+                                             [this, left, depth]()
+                                             {
+                                                 Workspace own(forward_.term_count);
+                                                 Run(left, depth + 1, own);
+                                             });
+                    Run(right, depth + 1, work);
+                    future.get();
+                    return;
+                }
+                Run(left, depth + 1, work);
+                Run(right, depth + 1, work);
+            }
+        };
+    } // namespace
+
+    // ============================================================================
+    // IMPLEMENTACIÓN DE ReorderStatistics
+    // ============================================================================
+
+    double ReorderStatistics::GetBitsPerPostingBefore() const
+    {
+        return postings == 0 ? 0.0 : gap_bits_before / static_cast<double>(postings);
+    }
+
+    double ReorderStatistics::GetBitsPerPostingAfter() const
+    {
+        return postings == 0 ? 0.0 : gap_bits_after / static_cast<double>(postings);
+    }
+
+    void ReorderStatistics::Merge(const ReorderStatistics& other)
+    {
+        runs += other.runs;
+        documents += other.documents;
+        postings += other.postings;
+        gap_bits_before += other.gap_bits_before;
+        gap_bits_after += other.gap_bits_after;
+        duration_ms += other.duration_ms;
+    }
+
+    // ============================================================================
+    // IMPLEMENTACIÓN DE DocumentReordering
+    // ============================================================================
+
+    std::vector<InternalDocumentId> DocumentReordering::Bisect(
+        size_t document_count, const std::vector<std::vector<InternalDocumentId>>& lists,
+        const ReorderOptions& options)
+    {
+        // Índice directo en dos pasadas: tamaños y luego términos
+        ForwardIndex forward;
+        forward.offsets.assign(document_count + 1, 0);
+        for (const auto& list : lists)
+        {
+            if (list.size() < options.min_document_frequency)
+            {
+                continue;
+            }
+            for (InternalDocumentId id : list)
+            {
+                forward.offsets[id + 1]++;
+            }
+        }
+        for (size_t d = 0; d < document_count; ++d)
+        {
+            forward.offsets[d + 1] += forward.offsets[d];
+        }
+
+        forward.terms.resize(forward.offsets.back());
+        forward.log2 = log2_table(document_count);
+        std::vector<uint64_t> cursor(forward.offsets.begin(), forward.offsets.end() - 1);
+        for (const auto& list : lists)
+        {
+            if (list.size() < options.min_document_frequency)
+            {
+                continue;
+            }
+            const auto term = static_cast<uint32_t>(forward.term_count++);
+            for (InternalDocumentId id : list)
+            {
+                forward.terms[cursor[id]++] = term;
+            }
+        }
+
+        std::vector<InternalDocumentId> order(document_count);
+        for (size_t d = 0; d < document_count; ++d)
+        {
+            order[d] = static_cast<InternalDocumentId>(d);
+        }
+        Workspace work(forward.term_count);
+        Bisection(forward, options).Run(order, 0, work);
+        return order;
+    }
+
+    double DocumentReordering::GapBits(std::span<const InternalDocumentId> list)
+    {
+        double bits = 0.0;
+        int64_t previous = -1;
+        for (InternalDocumentId id : list)
+        {
+            bits += std::log2(static_cast<double>(static_cast<int64_t>(id) - previous));
+            previous = id;
+        }
+        return bits;
+    }
+
+    bool DocumentReordering::ParseOrder(const std::string& value, DocumentOrder& order)
+    {
+        if (value.empty() || value == "arrival")
+        {
+            order = DocumentOrder::ARRIVAL;
+        }
+        else if (value == "bisection")
+        {
+            order = DocumentOrder::BISECTION;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    const char* DocumentReordering::OrderName(DocumentOrder order)
+    {
+        return order == DocumentOrder::BISECTION ? "bisection" : "arrival";
+    }
+
+} // namespace DocuTrace::Infrastructure
@@ -0,0 +1,132 @@
+#include "infrastructure/document_store.hpp"
+#include <iostream>
+#include <stdexcept>
+
+namespace DocuTrace::Infrastructure
+{
+    void DocumentStore::Add(std::string text)
+    {
+        resident_bytes_ += text.size();
+        entries_.push_back({std::move(text)});
+    }
+
+    std::string_view DocumentStore::Get(InternalDocumentId document_id) const
+    {
+        hits_.Record(entries_[document_id].cold_size > 0);
+        return Peek(document_id);
+    }
+
+    std::string_view DocumentStore::Peek(InternalDocumentId document_id) const
+    {
+        const Entry& entry = entries_[document_id];
+        if (entry.cold_size == 0)
+        {
+            return entry.text;
+        }
+        return {cold_->Data(entry.cold_offset), entry.cold_size};
+    }
+
+    std::string DocumentStore::Release(InternalDocumentId document_id)
+    {
+        Entry& entry = entries_[document_id];
+        if (entry.cold_size > 0)
+        {
+            // Lo que ocupaba en el archivo se recupera al compactar
+            std::string text(Peek(document_id));
+            cold_bytes_ -= entry.cold_size;
+            entry.cold_offset = 0;
+            entry.cold_size = 0;
+            return text;
+        }
+
+        resident_bytes_ -= entry.text.size();
+        std::string text = std::move(entry.text);
+        std::string().swap(entry.text);
+        return text;
+    }
+
+    void DocumentStore::Compact(const std::vector<InternalDocumentId>& remap, size_t live_count)
+    {
+        std::vector<Entry> compacted;
+        compacted.reserve(live_count);
+        std::unique_ptr<Shared::MappedFile> compacted_cold;
+        bool cold_failed = false;
+        resident_bytes_ = 0;
+        cold_bytes_ = 0;
+
+        for (InternalDocumentId old_id : DocumentIdMap::SurvivorsInOrder(remap, live_count))
+        {
+            Entry& entry = entries_[old_id];
+            if (entry.cold_size > 0 && !cold_failed)
+            {
+                try
+                {
+                    if (!compacted_cold)
+                    {
+                        compacted_cold = Shared::MappedFile::CreateTemporary(cold_directory_);
+                    }
+                    entry.cold_offset =
+                        compacted_cold->Append(cold_->Data(entry.cold_offset), entry.cold_size);
+                }
+                catch (const std::exception& e)
+                {
+                    std::cerr << "[-] No se pudo reescribir el archivo frío de textos: "
+                              << e.what() << std::endl;
+                    cold_failed = true;
+                }
+            }
+            if (entry.cold_size > 0 && cold_failed)
+            {
+                // Sin archivo nuevo el texto vuelve a RAM: el anterior se cierra al terminar
+                entry.text.assign(cold_->Data(entry.cold_offset), entry.cold_size);
+                entry.cold_offset = 0;
+                entry.cold_size = 0;
+            }
+
+            resident_bytes_ += entry.text.size();
+            cold_bytes_ += entry.cold_size;
+            compacted.push_back(std::move(entry));
+        }
+
+        entries_ = std::move(compacted);
+        cold_ = std::move(compacted_cold);
+        spill_cursor_ = 0;
+    }
+
+    size_t DocumentStore::SpillOldest(size_t bytes, const std::filesystem::path& directory)
+    {
+        if (!cold_)
+        {
+            cold_directory_ = directory;
+            cold_ = Shared::MappedFile::CreateTemporary(directory);
+        }
+
+        size_t freed = 0;
+        for (; spill_cursor_ < entries_.size() && freed < bytes; ++spill_cursor_)
+        {
+            Entry& entry = entries_[spill_cursor_];
+            if (entry.cold_size > 0 || entry.text.empty())
+            {
+                continue;
+            }
+
+            entry.cold_offset = cold_->Append(entry.text.data(), entry.text.size());
+            entry.cold_size = static_cast<uint32_t>(entry.text.size());
+            freed += entry.text.size();
+            resident_bytes_ -= entry.text.size();
+            cold_bytes_ += entry.cold_size;
+            std::string().swap(entry.text);
+        }
+        return freed;
+    }
+
+    void DocumentStore::Clear()
+    {
+        entries_.clear();
+        cold_.reset();
+        resident_bytes_ = 0;
+        cold_bytes_ = 0;
+        spill_cursor_ = 0;
+    }
+
+} // namespace DocuTrace::Infrastructure
@@ -0,0 +1,295 @@
+#include "infrastructure/index_replication.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <stdexcept>
+#include "shared/binary_io.hpp"
+#include "shared/hash_utils.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    namespace
+    {
+        constexpr const char* SEGMENT_EXTENSION = ".seg";
+        constexpr const char* TEMPORARY_EXTENSION = ".tmp";
+
+        int64_t now_ms()
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                .count();
+        }
+    } // namespace
+
+    // ============================================================================
+    // IMPLEMENTACIÓN DE ReplicationManifest
+    // ============================================================================
+
+    std::optional<ReplicationManifest> ReplicationManifest::Read(
+        const std::filesystem::path& file)
+    {
+        std::ifstream in(file);
+        if (!in.is_open())
+        {
+            return std::nullopt;
+        }
+
+        try
+        {
+            nlohmann::json value;
+            in >> value;
+
+            ReplicationManifest manifest;
+            manifest.writer = value.at("writer").get<std::string>();
+            manifest.generation = value.at("generation").get<uint64_t>();
+            manifest.published_at_ms = value.at("published_at_ms").get<int64_t>();
+            for (const auto& segment : value.at("segments"))
+            {
+                manifest.segments.push_back(
+                    {segment.at("file").get<std::string>(), segment.at("version").get<uint64_t>(),
+                     segment.at("size").get<uint64_t>(),
+                     Shared::HashUtils::FromHex(segment.at("checksum").get<std::string>())});
+            }
+            return manifest;
+        }
+        catch (const nlohmann::json::exception& e)
+        {
+            std::cerr << "[-] Manifiesto de replicación inválido: " << e.what() << std::endl;
+            return std::nullopt;
+        }
+    }
+
+    void ReplicationManifest::Write(const std::filesystem::path& file) const
+    {
+        nlohmann::json segments_json = nlohmann::json::array();
+        for (const auto& segment : segments)
+        {
+            // Checksum en hexadecimal: 64 bits no caben sin pérdida en un número JSON
+            segments_json.push_back({{"file", segment.file},
+                                     {"version", segment.version},
+                                     {"size", segment.size},
+                                     {"checksum", Shared::HashUtils::ToHex(segment.checksum)}});
+        }
+
+        nlohmann::json value = {{"writer", writer},
+                                {"generation", generation},
+                                {"published_at_ms", published_at_ms},
+                                {"segments", std::move(segments_json)}};
+
+        std::filesystem::path temporary = file;
+        temporary += TEMPORARY_EXTENSION;
+        {
+            std::ofstream out(temporary, std::ios::trunc);
+            out << value.dump(2);
+            if (!out)
+            {
+                throw std::runtime_error("no se pudo escribir " + temporary.string());
+            }
+        }
+        std::filesystem::rename(temporary, file);
+    }
+
+    // ============================================================================
+    // IMPLEMENTACIÓN DE SegmentPublisher
+    // ============================================================================
+
+    SegmentPublisher::SegmentPublisher(std::filesystem::path directory)
+        : directory_(std::move(directory))
+    {
+        std::filesystem::create_directories(directory_);
+
+        // Distinto en cada arranque: los nombres de segmento nunca se reutilizan
+        std::random_device random;
+        writer_id_ = Shared::HashUtils::ToHex((uint64_t(random()) << 32) ^ uint64_t(random()) ^
+                                             static_cast<uint64_t>(now_ms()));
+    }
+
+    bool SegmentPublisher::Publish(const ShardedEngine& engine)
+    {
+        ReplicationManifest manifest;
+        manifest.writer = writer_id_;
+        manifest.generation = current_ ? current_->generation + 1 : 1;
+
+        const bool same_layout = current_ && current_->segments.size() == engine.GetShardCount();
+        bool changed = !same_layout;
+        std::vector<std::weak_ptr<const BM25Engine>> sealed_shards;
+        for (size_t shard = 0; shard < engine.GetShardCount(); ++shard)
+        {
+            const BM25Engine& source = *engine.GetShard(shard);
+            sealed_shards.push_back(engine.GetShard(shard));
+            if (same_layout && sealed_shards_[shard].lock() == engine.GetShard(shard) &&
+                current_->segments[shard].version == source.GetVersion())
+            {
+                manifest.segments.push_back(current_->segments[shard]);
+                continue;
+            }
+            changed = true;
+
+            SegmentInfo segment;
+            segment.file = "shard-" + std::to_string(shard) + "-" + writer_id_ + "-" +
+                           std::to_string(manifest.generation) + SEGMENT_EXTENSION;
+            std::filesystem::path temporary = directory_ / (segment.file + TEMPORARY_EXTENSION);
+            {
+                std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+                Shared::BinaryWriter writer(out);
+                segment.version = source.WriteSegment(writer);
+                segment.size = writer.GetSize();
+                segment.checksum = writer.GetChecksum();
+                out.close();
+                if (!out)
+                {
+                    throw std::runtime_error("no se pudo escribir " + temporary.string());
+                }
+            }
+            std::filesystem::rename(temporary, directory_ / segment.file);
+            manifest.segments.push_back(std::move(segment));
+        }
+
+        if (!changed)
+        {
+            return false;
+        }
+
+        manifest.published_at_ms = now_ms();
+        manifest.Write(directory_ / ReplicationManifest::FILE_NAME);
+
+        std::vector<std::string> previous;
+        if (current_)
+        {
+            for (const auto& segment : current_->segments)
+            {
+                previous.push_back(segment.file);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(status_mutex_);
+            current_ = std::move(manifest);
+        }
+        previous_files_ = std::move(previous);
+        sealed_shards_ = std::move(sealed_shards);
+        RemoveUnusedSegments();
+        return true;
+    }
+
+    void SegmentPublisher::RemoveUnusedSegments() const
+    {
+        auto in_use = [this](const std::string& file)
+        {
+            return std::any_of(current_->segments.begin(), current_->segments.end(),
+                               [&file](const SegmentInfo& segment)
+                               { return segment.file == file; }) ||
+                   std::find(previous_files_.begin(), previous_files_.end(), file) !=
+                       previous_files_.end();
+        };
+
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(directory_, error))
+        {
+            const std::string name = entry.path().filename().string();
+            // Solo segmentos de este escritor: los de otra instancia no se tocan
+            if (name.find(writer_id_) == std::string::npos || in_use(name))
+            {
+                continue;
+            }
+            std::filesystem::remove(entry.path(), error);
+        }
+    }
+
+    ReplicationStatus SegmentPublisher::GetStatus() const
+    {
+        std::lock_guard<std::mutex> lock(status_mutex_);
+        ReplicationStatus status;
+        status.generation = current_ ? current_->generation : 0;
+        status.latest_generation = status.generation;
+        return status;
+    }
+
+    // ============================================================================
+    // IMPLEMENTACIÓN DE SegmentReplica
+    // ============================================================================
+
+    SegmentReplica::SegmentReplica(std::filesystem::path directory,
+                                   std::shared_ptr<const Shared::TextAnalyzer> analyzer)
+        : directory_(std::move(directory)), analyzer_(std::move(analyzer))
+    {
+    }
+
+    std::shared_ptr<BM25Engine> SegmentReplica::LoadSegment(const SegmentInfo& segment) const
+    {
+        std::ifstream in(directory_ / segment.file, std::ios::binary);
+        if (!in.is_open())
+        {
+            throw std::runtime_error("falta el segmento " + segment.file);
+        }
+
+        auto shard = std::make_shared<BM25Engine>(analyzer_);
+        Shared::BinaryReader reader(in);
+        shard->ReadSegment(reader);
+        if (reader.GetSize() != segment.size || reader.GetChecksum() != segment.checksum)
+        {
+            throw std::runtime_error("el segmento " + segment.file +
+                                     " no coincide con el manifiesto");
+        }
+        return shard;
+    }
+
+    std::shared_ptr<ShardedEngine> SegmentReplica::Refresh()
+    {
+        auto manifest = ReplicationManifest::Read(directory_ / ReplicationManifest::FILE_NAME);
+        if (!manifest)
+        {
+            return nullptr;
+        }
+
+        std::optional<ReplicationManifest> loaded;
+        {
+            std::lock_guard<std::mutex> lock(status_mutex_);
+            latest_ = manifest;
+            loaded = loaded_;
+        }
+        if (loaded && loaded->IsSameGeneration(*manifest))
+        {
+            return nullptr;
+        }
+
+        // Solo se leen los segmentos nuevos; el resto se comparte con el índice actual
+        std::vector<std::shared_ptr<BM25Engine>> shards;
+        for (size_t shard = 0; shard < manifest->segments.size(); ++shard)
+        {
+            const SegmentInfo& segment = manifest->segments[shard];
+            if (loaded && shard < loaded->segments.size() &&
+                loaded->segments[shard].file == segment.file)
+            {
+                shards.push_back(shards_[shard]);
+            }
+            else
+            {
+                shards.push_back(LoadSegment(segment));
+            }
+        }
+
+        shards_ = shards;
+        {
+            std::lock_guard<std::mutex> lock(status_mutex_);
+            loaded_ = std::move(manifest);
+        }
+        return std::make_shared<ShardedEngine>(std::move(shards));
+    }
+
+    ReplicationStatus SegmentReplica::GetStatus() const
+    {
+        std::lock_guard<std::mutex> lock(status_mutex_);
+        ReplicationStatus status;
+        status.generation = loaded_ ? loaded_->generation : 0;
+        status.latest_generation = latest_ ? latest_->generation : 0;
+        if (latest_ && (!loaded_ || !loaded_->IsSameGeneration(*latest_)))
+        {
+            status.lag_ms = std::max<int64_t>(0, now_ms() - latest_->published_at_ms);
+        }
+        return status;
+    }
+
+} // namespace DocuTrace::Infrastructure
@@ -0,0 +1,254 @@
+#include "infrastructure/query_evaluator.hpp"
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include "shared/simd_kernels.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    QueryEvaluator::QueryEvaluator(const InvertedIndex& index, const std::vector<bool>& tombstones,
+                                   const DocValues& doc_values)
+        : index_(index), tombstones_(tombstones), doc_values_(doc_values)
+    {
+    }
+
+    // ============================================================================
+    // Operaciones sobre conjuntos ordenados
+    // ============================================================================
+
+    DocumentSet QueryEvaluator::Intersect(const DocumentSet& a, const DocumentSet& b)
+    {
+        DocumentSet result(std::min(a.size(), b.size()));
+        result.resize(Shared::SimdKernels::Intersect(a.data(), a.size(), b.data(), b.size(),
+                                                     result.data()));
+        return result;
+    }
+
+    DocumentSet QueryEvaluator::Union(std::span<const InternalDocumentId> a,
+                                      std::span<const InternalDocumentId> b)
+    {
+        DocumentSet result;
+        result.reserve(a.size() + b.size());
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+        return result;
+    }
+
+    DocumentSet QueryEvaluator::Difference(const DocumentSet& a, const DocumentSet& b)
+    {
+        DocumentSet result(a.size());
+        result.resize(Shared::SimdKernels::Difference(a.data(), a.size(), b.data(), b.size(),
+                                                      result.data()));
+        return result;
+    }
+
+    // ============================================================================
+    // Planificación y evaluación
+    // ============================================================================
+
+    size_t QueryEvaluator::EstimateCost(const QueryNode& node) const
+    {
+        switch (node.type)
+        {
+        case QueryNode::Type::TERM:
+        {
+            size_t cost = 0;
+            for (const auto& token : node.tokens)
+            {
+                cost += static_cast<size_t>(index_.GetIndexFrequency(token));
+            }
+            return cost;
+        }
+        case QueryNode::Type::FILTER:
+            return tombstones_.size();
+        case QueryNode::Type::GROUP:
+        {
+            // Con cláusulas obligatorias el resultado no supera la más selectiva
+            size_t must_cost = SIZE_MAX;
+            size_t should_cost = 0;
+            bool has_should = false;
+            for (const auto& clause : node.clauses)
+            {
+                if (clause.occur == QueryOccur::MUST)
+                {
+                    must_cost = std::min(must_cost, EstimateCost(*clause.node));
+                }
+                else if (clause.occur == QueryOccur::SHOULD)
+                {
+                    should_cost += EstimateCost(*clause.node);
+                    has_should = true;
+                }
+            }
+            if (must_cost != SIZE_MAX)
+            {
+                return must_cost;
+            }
+            return has_should ? should_cost : tombstones_.size();
+        }
+        }
+        return tombstones_.size();
+    }
+
+    DocumentSet QueryEvaluator::EvaluateTerm(const QueryNode& node) const
+    {
+        DocumentSet result;
+        for (const auto& token : node.tokens)
+        {
+            auto postings = index_.GetPostings(token);
+            if (!postings)
+            {
+                continue;
+            }
+            result = result.empty()
+                         ? DocumentSet(postings->documents.begin(), postings->documents.end())
+                         : Union(result, postings->documents);
+        }
+        return result;
+    }
+
+    DocumentSet QueryEvaluator::EvaluateNode(const QueryNode& node) const
+    {
+        switch (node.type)
+        {
+        case QueryNode::Type::TERM:
+            return EvaluateTerm(node);
+        case QueryNode::Type::GROUP:
+            return EvaluateGroup(node);
+        case QueryNode::Type::FILTER:
+        {
+            const DocumentBitset matches = doc_values_.Filter(node);
+            DocumentSet result;
+            for (InternalDocumentId id = 0; id < doc_values_.Size(); ++id)
+            {
+                if (matches.Test(id))
+                {
+                    result.push_back(id);
+                }
+            }
+            return result;
+        }
+        }
+        return {};
+    }
+
+    DocumentSet QueryEvaluator::EvaluateGroup(const QueryNode& node) const
+    {
+        std::vector<const QueryNode*> musts;
+        std::vector<const QueryNode*> shoulds;
+        std::vector<const QueryNode*> must_nots;
+        std::vector<const QueryClause*> filters;
+
+        for (const auto& clause : node.clauses)
+        {
+            if (clause.node->type == QueryNode::Type::FILTER && clause.occur != QueryOccur::SHOULD)
+            {
+                filters.push_back(&clause);
+                continue;
+            }
+
+            switch (clause.occur)
+            {
+            case QueryOccur::MUST:
+                musts.push_back(clause.node.get());
+                break;
+            case QueryOccur::SHOULD:
+                shoulds.push_back(clause.node.get());
+                break;
+            case QueryOccur::MUST_NOT:
+                must_nots.push_back(clause.node.get());
+                break;
+            }
+        }
+
+        // Filtros de metadatos evaluados una sola vez como bitset: una pasada por la columna
+        // de cada uno y después AND / AND NOT palabra a palabra
+        const size_t capacity = doc_values_.Size();
+        std::optional<DocumentBitset> filter_bits;
+        for (const QueryClause* clause : filters)
+        {
+            DocumentBitset matches = doc_values_.Filter(*clause->node);
+            const bool exclude = clause->occur == QueryOccur::MUST_NOT;
+            if (filter_bits)
+            {
+                filter_bits->Combine(matches, exclude);
+            }
+            else if (!exclude)
+            {
+                filter_bits = std::move(matches);
+            }
+            else
+            {
+                filter_bits.emplace();
+                filter_bits->Assign(capacity, [](InternalDocumentId) { return true; });
+                filter_bits->Combine(matches, true);
+            }
+        }
+
+        auto apply_filter = [&filter_bits](DocumentSet& set)
+        {
+            if (filter_bits)
+            {
+                std::erase_if(set, [&](InternalDocumentId id) { return !filter_bits->Test(id); });
+            }
+        };
+
+        DocumentSet result;
+        if (!musts.empty())
+        {
+            // Intersecciones de la lista más corta a la más larga
+            std::vector<std::pair<size_t, const QueryNode*>> plan;
+            plan.reserve(musts.size());
+            for (const QueryNode* must : musts)
+            {
+                plan.emplace_back(EstimateCost(*must), must);
+            }
+            std::sort(plan.begin(), plan.end(),
+                      [](const auto& a, const auto& b) { return a.first < b.first; });
+
+            result = EvaluateNode(*plan.front().second);
+            apply_filter(result);
+            for (size_t i = 1; i < plan.size() && !result.empty(); ++i)
+            {
+                result = Intersect(result, EvaluateNode(*plan[i].second));
+            }
+        }
+        else if (!shoulds.empty())
+        {
+            for (const QueryNode* should : shoulds)
+            {
+                DocumentSet matches = EvaluateNode(*should);
+                result = result.empty() ? std::move(matches) : Union(result, matches);
+            }
+            apply_filter(result);
+        }
+        else
+        {
+            // Solo filtros o exclusiones: se parte de todos los documentos
+            for (InternalDocumentId id = 0; id < capacity; ++id)
+            {
+                if (!filter_bits || filter_bits->Test(id))
+                {
+                    result.push_back(id);
+                }
+            }
+        }
+
+        for (const QueryNode* must_not : must_nots)
+        {
+            if (result.empty())
+            {
+                break;
+            }
+            result = Difference(result, EvaluateNode(*must_not));
+        }
+
+        return result;
+    }
+
+    DocumentSet QueryEvaluator::Evaluate(const QueryNode& root) const
+    {
+        DocumentSet result = EvaluateNode(root);
+        std::erase_if(result, [this](InternalDocumentId id) { return tombstones_[id]; });
+        return result;
+    }
+
+} // namespace DocuTrace::Infrastructure
@@ -0,0 +1,506 @@
+#include "infrastructure/query_parser.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include "shared/text_utils.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    // ============================================================================
+    // IMPLEMENTACIÓN DE QueryNode
+    // ============================================================================
+
+    bool QueryNode::IsPlainDisjunction() const
+    {
+        if (type != Type::GROUP)
+        {
+            return false;
+        }
+
+        return std::all_of(clauses.begin(), clauses.end(),
+                           [](const QueryClause& clause)
+                           {
+                               return clause.occur == QueryOccur::SHOULD &&
+                                      clause.node->type == Type::TERM;
+                           });
+    }
+
+    void QueryNode::CollectScoringTerms(std::vector<WeightedTerm>& terms) const
+    {
+        switch (type)
+        {
+        case Type::TERM:
+            for (size_t i = 0; i < tokens.size(); ++i)
+            {
+                terms.push_back({tokens[i], i < weights.size() ? weights[i] : 1.0});
+            }
+            break;
+        case Type::GROUP:
+            for (const auto& clause : clauses)
+            {
+                if (clause.occur != QueryOccur::MUST_NOT)
+                {
+                    clause.node->CollectScoringTerms(terms);
+                }
+            }
+            break;
+        case Type::FILTER:
+            break;
+        }
+    }
+
+    bool QueryNode::HasExpandableTerms() const
+    {
+        if (type == Type::TERM)
+        {
+            return match != QueryMatch::EXACT;
+        }
+        return std::any_of(clauses.begin(), clauses.end(), [](const QueryClause& clause)
+                           { return clause.node->HasExpandableTerms(); });
+    }
+
+    void QueryNode::CollectExpandableTerms(std::vector<const QueryNode*>& terms) const
+    {
+        if (type == Type::TERM && match != QueryMatch::EXACT)
+        {
+            terms.push_back(this);
+        }
+        for (const auto& clause : clauses)
+        {
+            clause.node->CollectExpandableTerms(terms);
+        }
+    }
+
+    // ============================================================================
+    // IMPLEMENTACIÓN DE QueryParser
+    // ============================================================================
+
+    QueryParser::QueryParser(Normalizer normalize, Normalizer fold)
+        : normalize_(std::move(normalize)), fold_(std::move(fold))
+    {
+    }
+
+    std::vector<QueryParser::Token> QueryParser::Lex(const std::string& query)
+    {
+        std::vector<Token> tokens;
+        int depth = 0;
+        size_t i = 0;
+
+        while (i < query.size())
+        {
+            unsigned char c = static_cast<unsigned char>(query[i]);
+            if (std::isspace(c))
+            {
+                i++;
+                continue;
+            }
+
+            // Modificador +/- pegado a la siguiente palabra o paréntesis
+            char modifier = '\0';
+            if ((c == '+' || c == '-') && i + 1 < query.size() &&
+                !std::isspace(static_cast<unsigned char>(query[i + 1])))
+            {
+                modifier = static_cast<char>(c);
+                c = static_cast<unsigned char>(query[++i]);
+            }
+
+            if (c == '(')
+            {
+                tokens.push_back({Token::Kind::LPAREN, "(", modifier});
+                depth++;
+                i++;
+                continue;
+            }
+
+            if (c == ')')
+            {
+                // Los paréntesis de cierre sin pareja se ignoran
+                if (depth > 0)
+                {
+                    tokens.push_back({Token::Kind::RPAREN, ")", '\0'});
+                    depth--;
+                }
+                i++;
+                continue;
+            }
+
+            std::string word;
+            bool quoted = false;
+            bool phrase = false;
+            while (i < query.size())
+            {
+                char ch = query[i];
+                if (ch == '"')
+                {
+                    quoted = !quoted;
+                    phrase = true;
+                    i++;
+                    continue;
+                }
+                if (!quoted && (std::isspace(static_cast<unsigned char>(ch)) || ch == '(' ||
+                                ch == ')'))
+                {
+                    break;
+                }
+                word += ch;
+                i++;
+            }
+
+            if (modifier == '\0' && word == "AND")
+            {
+                tokens.push_back({Token::Kind::AND, word, '\0'});
+            }
+            else if (modifier == '\0' && word == "OR")
+            {
+                tokens.push_back({Token::Kind::OR, word, '\0'});
+            }
+            else if (modifier == '\0' && word == "NOT")
+            {
+                tokens.push_back({Token::Kind::NOT, word, '\0'});
+            }
+            else if (!word.empty())
+            {
+                tokens.push_back({Token::Kind::WORD, word, modifier, phrase});
+            }
+        }
+
+        return tokens;
+    }
+
+    bool QueryParser::AtEnd() const
+    {
+        return position_ >= tokens_.size();
+    }
+
+    bool QueryParser::Peek(Token::Kind kind) const
+    {
+        return !AtEnd() && tokens_[position_].kind == kind;
+    }
+
+    std::unique_ptr<QueryNode> QueryParser::Parse(const std::string& query,
+                                                  const QueryOptions& options)
+    {
+        tokens_ = Lex(query);
+        position_ = 0;
+        options_ = options;
+
+        // Autocompletado: la última palabra todavía se está escribiendo
+        if (options_.prefix_last && !tokens_.empty())
+        {
+            Token& last = tokens_.back();
+            if (last.kind == Token::Kind::WORD && !last.phrase && last.modifier != '-' &&
+                last.text.find_first_of(":*~") == std::string::npos)
+            {
+                last.text += '*';
+            }
+        }
+        return ParseOr();
+    }
+
+    std::unique_ptr<QueryNode> QueryParser::ParseOr()
+    {
+        auto group = std::make_unique<QueryNode>();
+        group->type = QueryNode::Type::GROUP;
+
+        // La yuxtaposición equivale a OR, como en la búsqueda clásica
+        while (!AtEnd() && !Peek(Token::Kind::RPAREN))
+        {
+            if (Peek(Token::Kind::OR) || Peek(Token::Kind::AND))
+            {
+                position_++;
+                continue;
+            }
+
+            QueryOccur occur = QueryOccur::SHOULD;
+            auto node = ParseAnd(occur);
+            if (node)
+            {
+                group->clauses.push_back({occur, std::move(node)});
+            }
+        }
+
+        return group;
+    }
+
+    std::unique_ptr<QueryNode> QueryParser::ParseAnd(QueryOccur& occur)
+    {
+        QueryOccur first_occur = QueryOccur::SHOULD;
+        auto first = ParseUnary(first_occur);
+        if (!Peek(Token::Kind::AND))
+        {
+            occur = first_occur;
+            return first;
+        }
+
+        // Todos los operandos de un AND pasan a ser obligatorios
+        auto to_must = [](QueryOccur value)
+        { return value == QueryOccur::SHOULD ? QueryOccur::MUST : value; };
+
+        auto group = std::make_unique<QueryNode>();
+        group->type = QueryNode::Type::GROUP;
+        if (first)
+        {
+            group->clauses.push_back({to_must(first_occur), std::move(first)});
+        }
+
+        while (Peek(Token::Kind::AND))
+        {
+            position_++;
+            QueryOccur next_occur = QueryOccur::SHOULD;
+            auto next = ParseUnary(next_occur);
+            if (next)
+            {
+                group->clauses.push_back({to_must(next_occur), std::move(next)});
+            }
+        }
+
+        occur = QueryOccur::SHOULD;
+        return group->clauses.empty() ? nullptr : std::move(group);
+    }
+
+    std::unique_ptr<QueryNode> QueryParser::ParseUnary(QueryOccur& occur)
+    {
+        if (AtEnd() || Peek(Token::Kind::RPAREN))
+        {
+            return nullptr;
+        }
+
+        const Token token = tokens_[position_++];
+        switch (token.kind)
+        {
+        case Token::Kind::NOT:
+        {
+            QueryOccur inner = QueryOccur::SHOULD;
+            auto node = ParseUnary(inner);
+            occur = QueryOccur::MUST_NOT;
+            return node;
+        }
+        case Token::Kind::LPAREN:
+        {
+            auto node = ParseOr();
+            if (Peek(Token::Kind::RPAREN))
+            {
+                position_++;
+            }
+            occur = token.modifier == '+'   ? QueryOccur::MUST
+                    : token.modifier == '-' ? QueryOccur::MUST_NOT
+                                            : QueryOccur::SHOULD;
+            return node->clauses.empty() ? nullptr : std::move(node);
+        }
+        case Token::Kind::WORD:
+        {
+            auto node = MakeWord(token.text, token.phrase);
+            if (!node)
+            {
+                return nullptr;
+            }
+
+            // Los filtros restringen por defecto; los términos solo suman puntuación
+            QueryOccur default_occur =
+                node->type == QueryNode::Type::FILTER ? QueryOccur::MUST : QueryOccur::SHOULD;
+            occur = token.modifier == '+'   ? QueryOccur::MUST
+                    : token.modifier == '-' ? QueryOccur::MUST_NOT
+                                            : default_occur;
+            return node;
+        }
+        default:
+            return nullptr;
+        }
+    }
+
+    std::unique_ptr<QueryNode> QueryParser::MakeWord(const std::string& text, bool phrase)
+    {
+        size_t colon = text.find(':');
+        if (colon != std::string::npos && colon > 0 && colon + 1 < text.size())
+        {
+            std::string field = text.substr(0, colon);
+            std::transform(field.begin(), field.end(), field.begin(), ::tolower);
+            std::string value = text.substr(colon + 1);
+
+            auto node = std::make_unique<QueryNode>();
+            node->type = QueryNode::Type::FILTER;
+            node->filter_value = value;
+
+            if (field == "filename")
+            {
+                node->field = QueryField::FILENAME;
+                std::transform(node->filter_value.begin(), node->filter_value.end(),
+                               node->filter_value.begin(), ::tolower);
+                return node;
+            }
+            if (field == "ext")
+            {
+                // Igual que DocValues la guarda: en minúsculas y sin el punto
+                node->field = QueryField::EXTENSION;
+                std::string& extension = node->filter_value;
+                extension.erase(0, extension.find_first_not_of('.'));
+                std::transform(extension.begin(), extension.end(), extension.begin(),
+                               ::tolower);
+                return extension.empty() ? nullptr : std::move(node);
+            }
+            if (field == "dir")
+            {
+                // Sin la barra final: dir:/datos/ equivale a dir:/datos
+                node->field = QueryField::DIRECTORY;
+                std::string& directory = node->filter_value;
+                while (directory.size() > 1 && directory.back() == '/')
+                {
+                    directory.pop_back();
+                }
+                return node;
+            }
+            if (field == "after" || field == "before")
+            {
+                node->field = field == "after" ? QueryField::AFTER : QueryField::BEFORE;
+                if (!ParseTimestamp(value, node->filter_timestamp))
+                {
+                    return nullptr;
+                }
+                return node;
+            }
+        }
+
+        if (!phrase && fold_)
+        {
+            if (auto node = MakeExpandable(text))
+            {
+                return node;
+            }
+        }
+
+        auto node = std::make_unique<QueryNode>();
+        node->type = QueryNode::Type::TERM;
+        node->tokens = normalize_(text);
+        if (node->tokens.empty())
+        {
+            return nullptr;
+        }
+
+        // Sin índice posicional, una frase exige todos sus términos (sin las stopwords)
+        if (phrase && node->tokens.size() > 1)
+        {
+            auto group = std::make_unique<QueryNode>();
+            group->type = QueryNode::Type::GROUP;
+            for (auto& token : node->tokens)
+            {
+                auto term = std::make_unique<QueryNode>();
+                term->type = QueryNode::Type::TERM;
+                term->tokens.push_back(std::move(token));
+                group->clauses.push_back({QueryOccur::MUST, std::move(term)});
+            }
+            return group;
+        }
+        return node;
+    }
+
+    std::unique_ptr<QueryNode> QueryParser::MakeExpandable(const std::string& text)
+    {
+        std::string word = text;
+        QueryMatch match = QueryMatch::EXACT;
+        int max_edits = 0;
+        bool fallback = false;
+
+        size_t tilde = word.rfind('~');
+        if (word.size() > 1 && word.back() == '*')
+        {
+            match = QueryMatch::PREFIX;
+            word.pop_back();
+        }
+        else if (tilde != std::string::npos && tilde > 0 &&
+                 (tilde + 1 == word.size() ||
+                  (tilde + 2 == word.size() && (word.back() == '1' || word.back() == '2'))))
+        {
+            match = QueryMatch::FUZZY;
+            max_edits = tilde + 1 == word.size() ? 1 : word.back() - '0';
+            word.resize(tilde);
+        }
+        else if (options_.fuzzy_edits > 0)
+        {
+            match = QueryMatch::FUZZY;
+            max_edits = std::min(options_.fuzzy_edits, MAX_EDITS);
+            fallback = true;
+        }
+
+        if (match == QueryMatch::EXACT)
+        {
+            return nullptr;
+        }
+
+        // Solo palabras simples: "jose-maria*" se busca como términos exactos
+        std::vector<std::string> folded = fold_(word);
+        if (folded.size() != 1)
+        {
+            return nullptr;
+        }
+
+        auto node = std::make_unique<QueryNode>();
+        node->type = QueryNode::Type::TERM;
+        node->tokens = normalize_(word);
+        node->pattern = std::move(folded.front());
+        node->match = match;
+        node->fuzzy_fallback = fallback;
+
+        if (match == QueryMatch::FUZZY)
+        {
+            // Como el modo AUTO de Lucene: palabras cortas admiten menos ediciones
+            const size_t length = node->pattern.size();
+            int allowed = length < 3 ? 0 : length < 6 ? 1 : MAX_EDITS;
+            node->max_edits = std::min(max_edits, allowed);
+            if (node->max_edits == 0)
+            {
+                node->match = QueryMatch::EXACT;
+            }
+            // Una stopword sigue siendo stopword aunque se pida tolerancia implícita
+            if (node->tokens.empty() && (fallback || node->match == QueryMatch::EXACT))
+            {
+                return nullptr;
+            }
+        }
+        return node;
+    }
+
+    bool QueryParser::ParseTimestamp(const std::string& value, std::time_t& timestamp)
+    {
+        if (Shared::TextUtils::isNumber(value))
+        {
+            try
+            {
+                timestamp = static_cast<std::time_t>(std::stoll(value));
+                return true;
+            }
+            catch (const std::exception&)
+            {
+                return false;
+            }
+        }
+
+        // AAAA-MM-DD interpretado como medianoche UTC
+        if (value.size() != 10 || value[4] != '-' || value[7] != '-')
+        {
+            return false;
+        }
+
+        try
+        {
+            std::chrono::year_month_day date{std::chrono::year{std::stoi(value.substr(0, 4))},
+                                             std::chrono::month{static_cast<unsigned>(
+                                                 std::stoi(value.substr(5, 2)))},
+                                             std::chrono::day{static_cast<unsigned>(
+                                                 std::stoi(value.substr(8, 2)))}};
+            if (!date.ok())
+            {
+                return false;
+            }
+
+            auto days = std::chrono::sys_days{date};
+            timestamp = static_cast<std::time_t>(
+                std::chrono::duration_cast<std::chrono::seconds>(days.time_since_epoch()).count());
+            return true;
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+    }
+
+} // namespace DocuTrace::Infrastructure
@@ -0,0 +1,112 @@
+#include "infrastructure/ranking_models.hpp"
+#include "shared/hash_utils.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    RankingParameters RankingParameters::ForModel(RankingModel model)
+    {
+        RankingParameters parameters;
+        parameters.model = model;
+        if (model == RankingModel::BM25L)
+        {
+            parameters.delta = 0.5;
+        }
+        return parameters;
+    }
+
+    std::optional<RankingModel> RankingParameters::ParseModel(std::string_view name)
+    {
+        if (name == "bm25")
+        {
+            return RankingModel::BM25;
+        }
+        if (name == "bm25plus")
+        {
+            return RankingModel::BM25_PLUS;
+        }
+        if (name == "bm25l")
+        {
+            return RankingModel::BM25L;
+        }
+        if (name == "bm25f")
+        {
+            return RankingModel::BM25F;
+        }
+        return std::nullopt;
+    }
+
+    const char* RankingParameters::ModelName(RankingModel model)
+    {
+        switch (model)
+        {
+        case RankingModel::BM25_PLUS:
+            return "bm25plus";
+        case RankingModel::BM25L:
+            return "bm25l";
+        case RankingModel::BM25F:
+            return "bm25f";
+        case RankingModel::BM25:
+            break;
+        }
+        return "bm25";
+    }
+
+    uint64_t FilenameField::HashTerm(std::string_view term)
+    {
+        return Shared::HashUtils::Hash64(term);
+    }
+
+    void FilenameField::AddDocument(InternalDocumentId document_id,
+                                    const std::vector<std::string>& terms)
+    {
+        // Los huecos (IDs que no pasaron por aquí) quedan como nombres vacíos
+        while (offsets_.size() <= document_id)
+        {
+            offsets_.push_back(offsets_.back());
+        }
+        for (const auto& term : terms)
+        {
+            terms_.push_back(HashTerm(term));
+        }
+        offsets_.push_back(static_cast<uint32_t>(terms_.size()));
+        total_length_ += static_cast<long long>(terms.size());
+    }
+
+    void FilenameField::RemoveDocument(InternalDocumentId document_id)
+    {
+        // Los términos se purgan al compactar
+        if (document_id + 1 < offsets_.size())
+        {
+            total_length_ -= GetLength(document_id);
+        }
+    }
+
+    void FilenameField::Compact(const std::vector<InternalDocumentId>& remap, size_t live_count)
+    {
+        std::vector<uint64_t> terms;
+        std::vector<uint32_t> offsets;
+        offsets.reserve(live_count + 1);
+        offsets.push_back(0);
+        for (InternalDocumentId old_id : DocumentIdMap::SurvivorsInOrder(remap, live_count))
+        {
+            // Los que nunca pasaron por AddDocument quedan con el nombre vacío
+            if (old_id + 1 < offsets_.size())
+            {
+                terms.insert(terms.end(), terms_.begin() + offsets_[old_id],
+                             terms_.begin() + offsets_[old_id + 1]);
+            }
+            offsets.push_back(static_cast<uint32_t>(terms.size()));
+        }
+        terms_ = std::move(terms);
+        offsets_ = std::move(offsets);
+        total_length_ = static_cast<long long>(terms_.size());
+    }
+
+    void FilenameField::Clear()
+    {
+        terms_.clear();
+        offsets_.assign(1, 0);
+        total_length_ = 0;
+    }
+
+} // namespace DocuTrace::Infrastructure
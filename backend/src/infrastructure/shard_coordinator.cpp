@@ -0,0 +1,230 @@
+#include "infrastructure/shard_coordinator.hpp"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include "infrastructure/shard_protocol.hpp"
+#include "shared/http_client.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    ShardCoordinator::ShardCoordinator(std::vector<ShardNode> nodes,
+                                       std::chrono::milliseconds timeout)
+        : nodes_(std::move(nodes)), timeout_(timeout)
+    {
+        if (!nodes_.empty())
+        {
+            // Las tareas solo esperan red: un hilo por nodo y por petición concurrente
+            pool_ = std::make_unique<Shared::ThreadPool>(
+                nodes_.size() * std::max(1u, std::thread::hardware_concurrency()));
+        }
+    }
+
+    std::vector<ShardNode> ShardCoordinator::ParseNodes(const std::string& list)
+    {
+        std::vector<ShardNode> nodes;
+        std::stringstream stream(list);
+        std::string entry;
+        while (std::getline(stream, entry, ','))
+        {
+            entry.erase(0, entry.find_first_not_of(" \t"));
+            entry.erase(entry.find_last_not_of(" \t") + 1);
+            if (entry.empty())
+            {
+                continue;
+            }
+
+            size_t colon = entry.rfind(':');
+            if (colon == std::string::npos || colon == 0)
+            {
+                throw std::invalid_argument("nodo sin host:puerto: " + entry);
+            }
+
+            unsigned long port = 0;
+            try
+            {
+                port = std::stoul(entry.substr(colon + 1));
+            }
+            catch (const std::exception&)
+            {
+                throw std::invalid_argument("puerto inválido: " + entry);
+            }
+            if (port == 0 || port > 65535)
+            {
+                throw std::invalid_argument("puerto inválido: " + entry);
+            }
+            nodes.push_back({entry.substr(0, colon), static_cast<uint16_t>(port)});
+        }
+        return nodes;
+    }
+
+    std::vector<std::future<std::string>> ShardCoordinator::Send(
+        const char* path, const std::string& body, const std::vector<bool>& active) const
+    {
+        // El plazo cuenta desde el envío, también si la tarea espera en la cola del pool
+        const auto deadline = std::chrono::steady_clock::now() + timeout_;
+
+        std::vector<std::future<std::string>> futures(nodes_.size());
+        for (size_t i = 0; i < nodes_.size(); ++i)
+        {
+            if (!active[i])
+            {
+                continue;
+            }
+            futures[i] = pool_->Submit(
+                [&node = nodes_[i], path, body, deadline]()
+                {
+                    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        deadline - std::chrono::steady_clock::now());
+                    if (remaining.count() <= 0)
+                    {
+                        throw std::runtime_error("tiempo de espera agotado en cola");
+                    }
+
+                    Shared::HttpResponse response =
+                        Shared::HttpClient::Post(node.host, node.port, path, body, remaining);
+                    if (response.status != 200)
+                    {
+                        throw std::runtime_error("HTTP " + std::to_string(response.status));
+                    }
+                    return std::move(response.body);
+                });
+        }
+        return futures;
+    }
+
+    std::vector<std::string> ShardCoordinator::Receive(
+        std::vector<std::future<std::string>>& futures, std::vector<bool>& active) const
+    {
+        std::vector<std::string> bodies(futures.size());
+        for (size_t i = 0; i < futures.size(); ++i)
+        {
+            if (!futures[i].valid())
+            {
+                continue;
+            }
+            try
+            {
+                bodies[i] = futures[i].get();
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "[!] Nodo " << nodes_[i].GetName() << " descartado: " << e.what()
+                          << std::endl;
+                active[i] = false;
+            }
+        }
+        return bodies;
+    }
+
+    DistributedResults ShardCoordinator::Search(const ShardedEngine& local,
+                                                const std::string& query, size_t max_results,
+                                                const QueryOptions& options) const
+    {
+        DistributedResults distributed;
+        distributed.node_count = nodes_.size();
+
+        std::unique_ptr<QueryNode> root = local.ParseQuery(query, options);
+        if (root->clauses.empty())
+        {
+            return distributed;
+        }
+
+        std::vector<bool> active(nodes_.size(), true);
+        // Descarta el nodo si su respuesta no se puede interpretar
+        auto decode = [this, &active](size_t i, auto&& function)
+        {
+            try
+            {
+                function();
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "[!] Respuesta inválida de " << nodes_[i].GetName() << ": "
+                          << e.what() << std::endl;
+                active[i] = false;
+            }
+        };
+
+        ShardRequest request;
+        request.query = query;
+        request.options = options;
+        request.max_results = max_results;
+
+        // 1. Expansiones con los diccionarios de todos los nodos
+        if (root->HasExpandableTerms())
+        {
+            auto futures = Send(ShardProtocol::EXPANSIONS_PATH,
+                                ShardProtocol::EncodeRequest(request), active);
+            QueryExpansions expansions = local.CollectExpansions(*root);
+            auto bodies = Receive(futures, active);
+            for (size_t i = 0; i < nodes_.size(); ++i)
+            {
+                if (active[i])
+                {
+                    decode(i,
+                           [&]()
+                           {
+                               expansions.Merge(ShardProtocol::BindExpansions(
+                                   *root, ShardProtocol::DecodeExpansions(bodies[i])));
+                           });
+                }
+            }
+
+            // Los workers eligen entre los mismos candidatos que el coordinador
+            request.expansions = ShardProtocol::IndexExpansions(*root, expansions);
+            local.ApplyExpansions(*root, expansions);
+        }
+
+        // 2. N, longitud total y df de toda la colección
+        auto futures = Send(ShardProtocol::STATISTICS_PATH,
+                            ShardProtocol::EncodeRequest(request), active);
+        CorpusStatistics statistics = local.CollectStatistics(*root);
+        auto bodies = Receive(futures, active);
+        for (size_t i = 0; i < nodes_.size(); ++i)
+        {
+            if (active[i])
+            {
+                decode(i,
+                       [&]()
+                       { statistics.Merge(ShardProtocol::DecodeStatistics(bodies[i])); });
+            }
+        }
+
+        if (statistics.document_count > 0)
+        {
+            // 3. Top-k de cada nodo con las estadísticas globales
+            request.statistics = statistics;
+            futures = Send(ShardProtocol::SEARCH_PATH, ShardProtocol::EncodeRequest(request),
+                           active);
+            std::vector<std::vector<SearchResult>> lists;
+            lists.push_back(local.Search(*root, statistics, max_results, options,
+                                         &distributed.facets, &distributed.coverage));
+            bodies = Receive(futures, active);
+            for (size_t i = 0; i < nodes_.size(); ++i)
+            {
+                if (active[i])
+                {
+                    decode(i,
+                           [&]()
+                           {
+                               auto decoded = ShardProtocol::DecodeResults(bodies[i]);
+                               for (auto& result : decoded.results)
+                               {
+                                   result.node = nodes_[i].GetName();
+                               }
+                               lists.push_back(std::move(decoded.results));
+                               distributed.facets.Merge(decoded.facets);
+                               distributed.coverage.Merge(decoded.coverage);
+                           });
+                }
+            }
+            distributed.results =
+                ShardedEngine::MergeTopResults(lists, max_results, options.sort);
+        }
+
+        distributed.failed_nodes = std::count(active.begin(), active.end(), false);
+        return distributed;
+    }
+
+} // namespace DocuTrace::Infrastructure
@@ -0,0 +1,332 @@
+#include "infrastructure/shard_protocol.hpp"
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+
+namespace DocuTrace::Infrastructure
+{
+    namespace
+    {
+        using nlohmann::json;
+
+        // El contenido de los documentos puede traer UTF-8 inválido: se sustituye, no se lanza
+        std::string dump(const json& value)
+        {
+            return value.dump(-1, ' ', false, json::error_handler_t::replace);
+        }
+
+        json expansions_to_json(const ExpansionList& expansions)
+        {
+            json list = json::array();
+            for (const auto& candidates : expansions)
+            {
+                json terms = json::object();
+                for (const auto& [term, expansion] : candidates)
+                {
+                    terms[term] = {expansion.distance, expansion.document_frequency};
+                }
+                list.push_back(std::move(terms));
+            }
+            return list;
+        }
+
+        ExpansionList expansions_from_json(const json& list)
+        {
+            ExpansionList expansions;
+            for (const auto& terms : list)
+            {
+                auto& candidates = expansions.emplace_back();
+                for (const auto& [term, expansion] : terms.items())
+                {
+                    candidates[term] = {expansion.at(0).get<int>(),
+                                        expansion.at(1).get<size_t>()};
+                }
+            }
+            return expansions;
+        }
+
+        json statistics_to_json(const CorpusStatistics& statistics)
+        {
+            return {{"document_count", statistics.document_count},
+                    {"total_length", statistics.total_length},
+                    {"filename_total_length", statistics.filename_total_length},
+                    {"document_frequencies", statistics.document_frequencies}};
+        }
+
+        json ranking_to_json(const RankingParameters& ranking)
+        {
+            return {{"model", RankingParameters::ModelName(ranking.model)},
+                    {"k1", ranking.k1},
+                    {"b", ranking.b},
+                    {"delta", ranking.delta},
+                    {"filename_weight", ranking.filename_weight},
+                    {"filename_b", ranking.filename_b}};
+        }
+
+        RankingParameters ranking_from_json(const json& value)
+        {
+            auto model = RankingParameters::ParseModel(value.at("model").get<std::string>());
+            if (!model)
+            {
+                throw std::invalid_argument("modelo de puntuación desconocido");
+            }
+
+            RankingParameters ranking;
+            ranking.model = *model;
+            ranking.k1 = value.at("k1").get<double>();
+            ranking.b = value.at("b").get<double>();
+            ranking.delta = value.at("delta").get<double>();
+            ranking.filename_weight = value.at("filename_weight").get<double>();
+            ranking.filename_b = value.at("filename_b").get<double>();
+            if (!ranking.IsValid())
+            {
+                throw std::invalid_argument("parámetros de puntuación fuera de rango");
+            }
+            return ranking;
+        }
+
+        CorpusStatistics statistics_from_json(const json& value)
+        {
+            CorpusStatistics statistics;
+            statistics.document_count = value.at("document_count").get<size_t>();
+            statistics.total_length = value.at("total_length").get<long long>();
+            statistics.filename_total_length = value.value("filename_total_length", 0LL);
+            statistics.document_frequencies =
+                value.at("document_frequencies")
+                    .get<std::unordered_map<std::string, size_t>>();
+            return statistics;
+        }
+    } // namespace
+
+    ExpansionList ShardProtocol::IndexExpansions(const QueryNode& root,
+                                                 const QueryExpansions& expansions)
+    {
+        std::vector<const QueryNode*> terms;
+        root.CollectExpandableTerms(terms);
+
+        ExpansionList list(terms.size());
+        for (size_t i = 0; i < terms.size(); ++i)
+        {
+            if (auto it = expansions.terms.find(terms[i]); it != expansions.terms.end())
+            {
+                list[i] = it->second;
+            }
+        }
+        return list;
+    }
+
+    QueryExpansions ShardProtocol::BindExpansions(const QueryNode& root,
+                                                  const ExpansionList& expansions)
+    {
+        std::vector<const QueryNode*> terms;
+        root.CollectExpandableTerms(terms);
+
+        // Si la consulta se analizó distinto, las posiciones sobrantes se ignoran
+        QueryExpansions bound;
+        for (size_t i = 0; i < std::min(terms.size(), expansions.size()); ++i)
+        {
+            for (const auto& [term, expansion] : expansions[i])
+            {
+                bound.Add(terms[i], term, expansion.distance, expansion.document_frequency);
+            }
+        }
+        return bound;
+    }
+
+    std::string ShardProtocol::EncodeRequest(const ShardRequest& request)
+    {
+        json body = {{"query", request.query},
+                     {"autocomplete", request.options.prefix_last},
+                     {"fuzzy", request.options.fuzzy_edits},
+                     {"limit", request.max_results},
+                     {"omit_content", request.options.omit_content}};
+        if (request.options.search_after)
+        {
+            body["after_score"] = request.options.search_after->score;
+            body["after_id"] = request.options.search_after->document_id;
+        }
+        if (request.options.ranking)
+        {
+            body["ranking"] = ranking_to_json(*request.options.ranking);
+        }
+        if (request.options.two_phase)
+        {
+            body["two_phase"] = {{"candidates", request.options.two_phase->candidates},
+                                 {"posting_budget", request.options.two_phase->posting_budget},
+                                 {"proximity", request.options.two_phase->proximity_weight}};
+        }
+        if (!request.options.facets.empty())
+        {
+            json facets = json::array();
+            for (FacetField field : request.options.facets)
+            {
+                facets.push_back(DocValues::FacetFieldName(field));
+            }
+            body["facets"] = std::move(facets);
+        }
+        if (request.options.sort)
+        {
+            body["sort"] = DocValues::SortOrderName(*request.options.sort);
+        }
+        if (request.options.deadline)
+        {
+            // Los relojes monótonos de dos nodos no se comparan: viaja el tiempo que queda
+            const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                *request.options.deadline - std::chrono::steady_clock::now());
+            body["timeout_ms"] = std::max<int64_t>(1, remaining.count());
+        }
+        if (request.expansions)
+        {
+            body["expansions"] = expansions_to_json(*request.expansions);
+        }
+        if (request.statistics)
+        {
+            body["statistics"] = statistics_to_json(*request.statistics);
+        }
+        return dump(body);
+    }
+
+    ShardRequest ShardProtocol::DecodeRequest(const std::string& body)
+    {
+        json value = json::parse(body);
+
+        ShardRequest request;
+        request.query = value.at("query").get<std::string>();
+        request.options.prefix_last = value.value("autocomplete", false);
+        request.options.fuzzy_edits = value.value("fuzzy", 0);
+        request.max_results = value.value("limit", size_t{0});
+        request.options.omit_content = value.value("omit_content", false);
+        if (value.contains("after_score"))
+        {
+            request.options.search_after =
+                SearchAfter{value.at("after_score").get<double>(),
+                            value.at("after_id").get<uint64_t>()};
+        }
+        if (value.contains("ranking"))
+        {
+            request.options.ranking = ranking_from_json(value["ranking"]);
+        }
+        if (value.contains("two_phase"))
+        {
+            const json& two_phase = value["two_phase"];
+            request.options.two_phase =
+                TwoPhaseOptions{two_phase.at("candidates").get<size_t>(),
+                                two_phase.at("posting_budget").get<size_t>(),
+                                two_phase.at("proximity").get<double>()};
+        }
+        for (const auto& name : value.value("facets", json::array()))
+        {
+            FacetField field;
+            if (!DocValues::ParseFacetField(name.get<std::string>(), field))
+            {
+                throw std::invalid_argument("faceta desconocida");
+            }
+            request.options.facets.push_back(field);
+        }
+        if (value.contains("sort"))
+        {
+            SortOrder sort;
+            if (!DocValues::ParseSortOrder(value.at("sort").get<std::string>(), sort))
+            {
+                throw std::invalid_argument("orden desconocido");
+            }
+            request.options.sort = sort;
+        }
+        if (value.contains("timeout_ms"))
+        {
+            request.options.deadline =
+                std::chrono::steady_clock::now() +
+                std::chrono::milliseconds(value.at("timeout_ms").get<int64_t>());
+        }
+        if (value.contains("expansions"))
+        {
+            request.expansions = expansions_from_json(value["expansions"]);
+        }
+        if (value.contains("statistics"))
+        {
+            request.statistics = statistics_from_json(value["statistics"]);
+        }
+        return request;
+    }
+
+    std::string ShardProtocol::EncodeExpansions(const ExpansionList& expansions)
+    {
+        return dump(expansions_to_json(expansions));
+    }
+
+    ExpansionList ShardProtocol::DecodeExpansions(const std::string& body)
+    {
+        return expansions_from_json(json::parse(body));
+    }
+
+    std::string ShardProtocol::EncodeStatistics(const CorpusStatistics& statistics)
+    {
+        return dump(statistics_to_json(statistics));
+    }
+
+    CorpusStatistics ShardProtocol::DecodeStatistics(const std::string& body)
+    {
+        return statistics_from_json(json::parse(body));
+    }
+
+    std::string ShardProtocol::EncodeResults(const ShardResults& shard_results)
+    {
+        json list = json::array();
+        for (const auto& result : shard_results.results)
+        {
+            // La puntuación y los metadatos viajan completos: el orden global no cambia
+            list.push_back({{"document_id", result.document_id},
+                            {"score", result.score},
+                            {"content", result.content},
+                            {"filename", result.filename},
+                            {"timestamp", result.timestamp}});
+        }
+
+        json facets = json::object();
+        for (const auto& [field, values] : shard_results.facets.fields)
+        {
+            facets[DocValues::FacetFieldName(field)] = values;
+        }
+        const SearchCoverage& coverage = shard_results.coverage;
+        return dump({{"results", std::move(list)},
+                     {"facets", std::move(facets)},
+                     {"coverage",
+                      {{"partial", coverage.partial},
+                       {"scored", coverage.scored_weight},
+                       {"total", coverage.total_weight}}}});
+    }
+
+    ShardResults ShardProtocol::DecodeResults(const std::string& body)
+    {
+        json value = json::parse(body);
+
+        ShardResults shard_results;
+        for (const auto& item : value.at("results"))
+        {
+            auto& result = shard_results.results.emplace_back(
+                item.at("content").get<std::string>(), item.at("score").get<double>(),
+                item.at("document_id").get<ExternalDocumentId>());
+            result.filename = item.value("filename", std::string());
+            result.timestamp = item.value("timestamp", std::time_t{0});
+        }
+        const json facets = value.value("facets", json::object());
+        for (const auto& [name, values] : facets.items())
+        {
+            FacetField field;
+            if (DocValues::ParseFacetField(name, field))
+            {
+                shard_results.facets.fields[field] =
+                    values.get<std::map<std::string, uint64_t>>();
+            }
+        }
+        // Ausente en workers anteriores: puntuación completa
+        const json coverage = value.value("coverage", json::object());
+        shard_results.coverage.partial = coverage.value("partial", false);
+        shard_results.coverage.scored_weight = coverage.value("scored", 0.0);
+        shard_results.coverage.total_weight = coverage.value("total", 0.0);
+        return shard_results;
+    }
+
+} // namespace DocuTrace::Infrastructure
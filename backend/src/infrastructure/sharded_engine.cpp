@@ -0,0 +1,614 @@
+#include "infrastructure/sharded_engine.hpp"
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+
+namespace DocuTrace::Infrastructure
+{
+    namespace
+    {
+        // Finalizador de splitmix64: IDs consecutivos se reparten de forma uniforme
+        uint64_t mix_document_id(uint64_t value)
+        {
+            value ^= value >> 30;
+            value *= 0xbf58476d1ce4e5b9ULL;
+            value ^= value >> 27;
+            value *= 0x94d049bb133111ebULL;
+            value ^= value >> 31;
+            return value;
+        }
+    } // namespace
+
+    ShardedEngine::ShardedEngine(size_t shard_count,
+                                 std::shared_ptr<const Shared::TextAnalyzer> analyzer)
+    {
+        shard_count = std::max<size_t>(1, shard_count);
+        shards_.reserve(shard_count);
+        for (size_t i = 0; i < shard_count; ++i)
+        {
+            shards_.push_back(std::make_shared<BM25Engine>(analyzer));
+        }
+
+        if (shard_count > 1)
+        {
+            pool_ = std::make_unique<Shared::ThreadPool>(
+                std::max<size_t>(shard_count, std::thread::hardware_concurrency()));
+        }
+    }
+
+    ShardedEngine::ShardedEngine(std::vector<std::shared_ptr<BM25Engine>> shards)
+        : shards_(std::move(shards))
+    {
+        if (shards_.empty())
+        {
+            shards_.push_back(std::make_shared<BM25Engine>());
+        }
+
+        if (shards_.size() > 1)
+        {
+            pool_ = std::make_unique<Shared::ThreadPool>(
+                std::max<size_t>(shards_.size(), std::thread::hardware_concurrency()));
+        }
+    }
+
+    BM25Engine& ShardedEngine::ShardFor(ExternalDocumentId document_id) const
+    {
+        return *shards_[mix_document_id(document_id) % shards_.size()];
+    }
+
+    void ShardedEngine::IndexDocument(ExternalDocumentId document_id, const std::string& content,
+                                      const DocumentMetadata& metadata)
+    {
+        ShardFor(document_id).IndexDocument(document_id, content, metadata);
+    }
+
+    size_t ShardedEngine::IndexDocuments(const std::vector<std::string>& documents,
+                                         ExternalDocumentId first_document_id,
+                                         size_t num_threads, size_t batch_size)
+    {
+        if (shards_.size() == 1)
+        {
+            return shards_.front()->IndexDocuments(documents, first_document_id, num_threads,
+                                                   batch_size);
+        }
+
+        // Documentos de cada partición; cada una indexa los suyos en un hilo del pool
+        std::vector<std::vector<size_t>> routed(shards_.size());
+        for (size_t i = 0; i < documents.size(); ++i)
+        {
+            routed[mix_document_id(first_document_id + i) % shards_.size()].push_back(i);
+        }
+
+        std::vector<std::future<void>> futures;
+        for (size_t shard = 0; shard < shards_.size(); ++shard)
+        {
+            if (routed[shard].empty())
+            {
+                continue;
+            }
+            futures.push_back(pool_->Submit(
+                [this, shard, &routed, &documents, first_document_id]()
+                {
+                    for (size_t i : routed[shard])
+                    {
+                        shards_[shard]->IndexDocument(first_document_id + i, documents[i]);
+                    }
+                }));
+        }
+
+        for (auto& future : futures)
+        {
+            future.wait();
+        }
+        for (auto& future : futures)
+        {
+            future.get();
+        }
+        return documents.size();
+    }
+
+    bool ShardedEngine::DeleteDocument(ExternalDocumentId document_id)
+    {
+        return ShardFor(document_id).DeleteDocument(document_id);
+    }
+
+    bool ShardedEngine::UpdateDocument(ExternalDocumentId document_id, const std::string& content,
+                                       const DocumentMetadata& metadata)
+    {
+        return ShardFor(document_id).UpdateDocument(document_id, content, metadata);
+    }
+
+    void ShardedEngine::SetCompactionRatio(double ratio)
+    {
+        for (auto& shard : shards_)
+        {
+            shard->SetCompactionRatio(ratio);
+        }
+    }
+
+    void ShardedEngine::SetExpansionLimits(double fuzzy_penalty, size_t max_expansions)
+    {
+        for (auto& shard : shards_)
+        {
+            shard->SetExpansionLimits(fuzzy_penalty, max_expansions);
+        }
+    }
+
+    void ShardedEngine::SetRankingParameters(const RankingParameters& ranking)
+    {
+        for (auto& shard : shards_)
+        {
+            shard->SetRankingParameters(ranking);
+        }
+    }
+
+    void ShardedEngine::SetTwoPhaseSampling(size_t every)
+    {
+        for (auto& shard : shards_)
+        {
+            shard->SetTwoPhaseSampling(every);
+        }
+    }
+
+    void ShardedEngine::SetDocumentOrder(DocumentOrder order)
+    {
+        for (auto& shard : shards_)
+        {
+            shard->SetDocumentOrder(order);
+        }
+    }
+
+    void ShardedEngine::SetScoreAccumulator(ScoreAccumulator accumulator)
+    {
+        for (auto& shard : shards_)
+        {
+            shard->SetScoreAccumulator(accumulator);
+        }
+    }
+
+    void ShardedEngine::SetMemoryBudget(size_t bytes, const std::filesystem::path& directory)
+    {
+        const size_t per_shard = (bytes + shards_.size() - 1) / shards_.size();
+        for (auto& shard : shards_)
+        {
+            shard->SetMemoryBudget(per_shard, directory);
+        }
+    }
+
+    std::unique_ptr<QueryNode> ShardedEngine::ParseQuery(const std::string& query,
+                                                         const QueryOptions& options) const
+    {
+        // Todas las particiones comparten analizador: basta con analizar una vez
+        return shards_.front()->ParseQuery(query, options);
+    }
+
+    QueryExpansions ShardedEngine::CollectExpansions(const QueryNode& root) const
+    {
+        auto partial = Scatter(
+            [&root](const BM25Engine& shard)
+            {
+                QueryExpansions expansions;
+                shard.CollectExpansions(root, expansions);
+                return expansions;
+            });
+
+        QueryExpansions expansions;
+        for (const auto& shard_expansions : partial)
+        {
+            expansions.Merge(shard_expansions);
+        }
+        return expansions;
+    }
+
+    void ShardedEngine::ApplyExpansions(QueryNode& root, const QueryExpansions& expansions) const
+    {
+        shards_.front()->ApplyExpansions(root, expansions);
+    }
+
+    CorpusStatistics ShardedEngine::CollectStatistics(const QueryNode& root) const
+    {
+        auto partial = Scatter(
+            [&root](const BM25Engine& shard)
+            {
+                CorpusStatistics statistics;
+                shard.CollectStatistics(root, statistics);
+                return statistics;
+            });
+
+        CorpusStatistics statistics;
+        for (const auto& shard_statistics : partial)
+        {
+            statistics.Merge(shard_statistics);
+        }
+        return statistics;
+    }
+
+    std::vector<SearchResult> ShardedEngine::Search(const QueryNode& root,
+                                                    const CorpusStatistics& statistics,
+                                                    size_t max_results, const QueryOptions& options,
+                                                    FacetCounts* facets,
+                                                    SearchCoverage* coverage) const
+    {
+        struct ShardSearch
+        {
+            std::vector<SearchResult> results;
+            FacetCounts facets;
+            SearchCoverage coverage;
+        };
+
+        // Cada partición cuenta sus propias facetas y su cobertura y se suman al final
+        auto partial = Scatter(
+            [&root, &statistics, max_results, &options, facets](const BM25Engine& shard)
+            {
+                ShardSearch result;
+                result.results = shard.Search(root, statistics, max_results, options,
+                                              facets ? &result.facets : nullptr,
+                                              &result.coverage);
+                return result;
+            });
+
+        std::vector<std::vector<SearchResult>> lists;
+        lists.reserve(partial.size());
+        for (auto& shard : partial)
+        {
+            lists.push_back(std::move(shard.results));
+            if (facets)
+            {
+                facets->Merge(shard.facets);
+            }
+            if (coverage)
+            {
+                coverage->Merge(shard.coverage);
+            }
+        }
+        return MergeTopResults(lists, max_results, options.sort);
+    }
+
+    std::vector<SearchResult> ShardedEngine::Search(const std::string& query, size_t max_results,
+                                                    const QueryOptions& options,
+                                                    FacetCounts* facets,
+                                                    SearchCoverage* coverage) const
+    {
+        if (shards_.size() == 1)
+        {
+            return shards_.front()->Search(query, max_results, options, facets, coverage);
+        }
+
+        std::unique_ptr<QueryNode> root = ParseQuery(query, options);
+        if (root->clauses.empty())
+        {
+            return {};
+        }
+
+        // 1. Expansiones con el diccionario de toda la colección
+        if (root->HasExpandableTerms())
+        {
+            ApplyExpansions(*root, CollectExpansions(*root));
+        }
+
+        // 2. N, longitud total y df globales
+        CorpusStatistics statistics = CollectStatistics(*root);
+        if (statistics.document_count == 0)
+        {
+            return {};
+        }
+
+        // 3. Top-k de cada partición con las estadísticas globales y mezcla
+        return Search(*root, statistics, max_results, options, facets, coverage);
+    }
+
+    std::vector<std::optional<std::string>> ShardedEngine::GetContents(
+        const std::vector<ExternalDocumentId>& document_ids) const
+    {
+        if (shards_.size() == 1)
+        {
+            return shards_.front()->GetContents(document_ids);
+        }
+
+        // Una consulta por partición con los IDs que le tocan, en el orden pedido
+        std::vector<std::vector<size_t>> positions(shards_.size());
+        std::vector<std::vector<ExternalDocumentId>> shard_ids(shards_.size());
+        for (size_t i = 0; i < document_ids.size(); ++i)
+        {
+            size_t shard = mix_document_id(document_ids[i]) % shards_.size();
+            positions[shard].push_back(i);
+            shard_ids[shard].push_back(document_ids[i]);
+        }
+
+        std::vector<std::optional<std::string>> contents(document_ids.size());
+        for (size_t shard = 0; shard < shards_.size(); ++shard)
+        {
+            if (shard_ids[shard].empty())
+            {
+                continue;
+            }
+            auto shard_contents = shards_[shard]->GetContents(shard_ids[shard]);
+            for (size_t j = 0; j < shard_contents.size(); ++j)
+            {
+                contents[positions[shard][j]] = std::move(shard_contents[j]);
+            }
+        }
+        return contents;
+    }
+
+    uint64_t ShardedEngine::EstimateCost(const std::string& query,
+                                         const QueryOptions& options) const
+    {
+        std::unique_ptr<QueryNode> root = ParseQuery(query, options);
+        uint64_t cost = 0;
+        for (const auto& shard : shards_)
+        {
+            cost += shard->EstimateCost(*root);
+        }
+        return cost;
+    }
+
+    std::vector<ExternalDocumentId> ShardedEngine::GetDocumentIds() const
+    {
+        std::vector<ExternalDocumentId> ids;
+        for (const auto& shard : shards_)
+        {
+            auto shard_ids = shard->GetDocumentIds();
+            ids.insert(ids.end(), shard_ids.begin(), shard_ids.end());
+        }
+        return ids;
+    }
+
+    std::vector<std::vector<SearchResult>> ShardedEngine::SearchBatch(
+        const std::vector<BatchQuery>& queries) const
+    {
+        if (shards_.size() == 1)
+        {
+            return shards_.front()->SearchBatch(queries);
+        }
+
+        std::vector<std::unique_ptr<QueryNode>> roots;
+        roots.reserve(queries.size());
+        for (const auto& query : queries)
+        {
+            roots.push_back(ParseQuery(query.query, query.options));
+        }
+
+        // 1. Expansiones de todas las consultas en una sola ronda
+        auto partial_expansions = Scatter(
+            [&roots](const BM25Engine& shard)
+            {
+                std::vector<QueryExpansions> expansions(roots.size());
+                for (size_t q = 0; q < roots.size(); ++q)
+                {
+                    if (roots[q]->HasExpandableTerms())
+                    {
+                        shard.CollectExpansions(*roots[q], expansions[q]);
+                    }
+                }
+                return expansions;
+            });
+        for (size_t q = 0; q < roots.size(); ++q)
+        {
+            if (!roots[q]->HasExpandableTerms())
+            {
+                continue;
+            }
+            QueryExpansions expansions;
+            for (const auto& shard_expansions : partial_expansions)
+            {
+                expansions.Merge(shard_expansions[q]);
+            }
+            ApplyExpansions(*roots[q], expansions);
+        }
+
+        // 2. Estadísticas de la unión de los términos del lote
+        auto partial_statistics = Scatter(
+            [&roots](const BM25Engine& shard)
+            {
+                CorpusStatistics statistics;
+                shard.CollectStatistics(roots, statistics);
+                return statistics;
+            });
+        CorpusStatistics statistics;
+        for (const auto& shard_statistics : partial_statistics)
+        {
+            statistics.Merge(shard_statistics);
+        }
+
+        std::vector<std::vector<SearchResult>> results(queries.size());
+        if (statistics.document_count == 0)
+        {
+            return results;
+        }
+
+        // 3. Top-k de cada consulta en cada partición; los hilos se reparten entre ellas
+        const size_t threads_per_shard =
+            std::max<size_t>(1, std::thread::hardware_concurrency() / shards_.size());
+        auto partial = Scatter([&roots, &queries, &statistics, threads_per_shard](
+                                   const BM25Engine& shard)
+                               { return shard.SearchBatch(roots, queries, statistics,
+                                                          threads_per_shard); });
+
+        std::vector<std::vector<SearchResult>> lists(shards_.size());
+        for (size_t q = 0; q < queries.size(); ++q)
+        {
+            for (size_t shard = 0; shard < shards_.size(); ++shard)
+            {
+                lists[shard] = std::move(partial[shard][q]);
+            }
+            results[q] =
+                MergeTopResults(lists, queries[q].max_results, queries[q].options.sort);
+        }
+        return results;
+    }
+
+    std::vector<SearchResult> ShardedEngine::MergeTopResults(
+        std::vector<std::vector<SearchResult>>& lists, size_t max_results,
+        const std::optional<SortOrder>& sort)
+    {
+        using Cursor = std::pair<size_t, size_t>; // (lista, posición)
+        auto after = [&lists, &sort](const Cursor& a, const Cursor& b)
+        {
+            const SearchResult& first = lists[b.first][b.second];
+            const SearchResult& second = lists[a.first][a.second];
+            return sort ? SearchResult::SortsBefore(first, second, *sort)
+                        : SearchResult::Ranks(first, second);
+        };
+        std::priority_queue<Cursor, std::vector<Cursor>, decltype(after)> heap(after);
+
+        for (size_t list = 0; list < lists.size(); ++list)
+        {
+            if (!lists[list].empty())
+            {
+                heap.push({list, 0});
+            }
+        }
+
+        std::vector<SearchResult> merged;
+        while (!heap.empty() && merged.size() < max_results)
+        {
+            auto [list, position] = heap.top();
+            heap.pop();
+            merged.push_back(std::move(lists[list][position]));
+            if (position + 1 < lists[list].size())
+            {
+                heap.push({list, position + 1});
+            }
+        }
+        return merged;
+    }
+
+    std::vector<Suggestion> ShardedEngine::Suggest(const std::string& prefix, size_t limit) const
+    {
+        if (shards_.size() == 1)
+        {
+            return shards_.front()->Suggest(prefix, limit);
+        }
+
+        // Sin pool: cada partición responde en microsegundos sin tomar su lock de documentos
+        std::unordered_map<std::string, uint32_t> frequencies;
+        for (const auto& shard : shards_)
+        {
+            for (const auto& suggestion :
+                 shard->Suggest(prefix, SuggestionIndex::MAX_SUGGESTIONS))
+            {
+                frequencies[suggestion.word] += suggestion.document_frequency;
+            }
+        }
+
+        std::vector<Suggestion> suggestions;
+        suggestions.reserve(frequencies.size());
+        for (auto& [word, frequency] : frequencies)
+        {
+            suggestions.push_back({word, frequency});
+        }
+
+        const size_t keep = std::min(suggestions.size(), limit);
+        std::partial_sort(suggestions.begin(), suggestions.begin() + keep, suggestions.end(),
+                          [](const Suggestion& a, const Suggestion& b)
+                          {
+                              if (a.document_frequency != b.document_frequency)
+                              {
+                                  return a.document_frequency > b.document_frequency;
+                              }
+                              return a.word < b.word;
+                          });
+        suggestions.resize(keep);
+        return suggestions;
+    }
+
+    void ShardedEngine::Clear()
+    {
+        for (auto& shard : shards_)
+        {
+            shard->Clear();
+        }
+    }
+
+    size_t ShardedEngine::GetDocumentCount() const
+    {
+        size_t total = 0;
+        for (const auto& shard : shards_)
+        {
+            total += shard->GetDocumentCount();
+        }
+        return total;
+    }
+
+    size_t ShardedEngine::GetTombstoneCount() const
+    {
+        size_t total = 0;
+        for (const auto& shard : shards_)
+        {
+            total += shard->GetTombstoneCount();
+        }
+        return total;
+    }
+
+    size_t ShardedEngine::GetTermCount() const
+    {
+        size_t total = 0;
+        for (const auto& shard : shards_)
+        {
+            total += shard->GetTermCount();
+        }
+        return total;
+    }
+
+    size_t ShardedEngine::GetPostingCount() const
+    {
+        size_t total = 0;
+        for (const auto& shard : shards_)
+        {
+            total += shard->GetPostingCount();
+        }
+        return total;
+    }
+
+    size_t ShardedEngine::GetSuggestionWordCount() const
+    {
+        size_t total = 0;
+        for (const auto& shard : shards_)
+        {
+            total += shard->GetSuggestionWordCount();
+        }
+        return total;
+    }
+
+    MemoryStatistics ShardedEngine::GetMemoryStatistics() const
+    {
+        MemoryStatistics total;
+        for (const auto& shard : shards_)
+        {
+            total.Merge(shard->GetMemoryStatistics());
+        }
+        return total;
+    }
+
+    TwoPhaseStatistics ShardedEngine::GetTwoPhaseStatistics() const
+    {
+        TwoPhaseStatistics total;
+        for (const auto& shard : shards_)
+        {
+            total.Merge(shard->GetTwoPhaseStatistics());
+        }
+        return total;
+    }
+
+    ReorderStatistics ShardedEngine::GetReorderStatistics() const
+    {
+        ReorderStatistics total;
+        for (const auto& shard : shards_)
+        {
+            total.Merge(shard->GetReorderStatistics());
+        }
+        return total;
+    }
+
+    TermFilterStatistics ShardedEngine::GetTermFilterStatistics() const
+    {
+        TermFilterStatistics total;
+        for (const auto& shard : shards_)
+        {
+            total.Merge(shard->GetTermFilterStatistics());
+        }
+        return total;
+    }
+
+} // namespace DocuTrace::Infrastructure
@@ -0,0 +1,295 @@
+#include "infrastructure/snapshot_store.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+#include <unordered_set>
+#include "shared/file_utils.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    namespace
+    {
+        constexpr size_t MAX_NAME_LENGTH = 64;
+
+        int64_t now_ms()
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                .count();
+        }
+
+        // AAAAMMDD-HHMMSS en UTC
+        std::string default_name()
+        {
+            const std::time_t now = std::time(nullptr);
+            char name[32];
+            std::strftime(name, sizeof(name), "%Y%m%d-%H%M%S", std::gmtime(&now));
+            return name;
+        }
+    } // namespace
+
+    // ============================================================================
+    // IMPLEMENTACIÓN DE SnapshotInfo
+    // ============================================================================
+
+    std::optional<SnapshotInfo> SnapshotInfo::Read(const std::filesystem::path& file)
+    {
+        std::ifstream in(file);
+        if (!in.is_open())
+        {
+            return std::nullopt;
+        }
+
+        try
+        {
+            nlohmann::json value;
+            in >> value;
+
+            SnapshotInfo info;
+            info.name = value.at("name").get<std::string>();
+            info.created_at_ms = value.at("created_at_ms").get<int64_t>();
+            info.duration_ms = value.value("duration_ms", int64_t{0});
+            info.documents = value.at("documents").get<size_t>();
+            info.last_id = value.at("last_id").get<uint64_t>();
+            info.linked_files = value.value("linked_files", size_t{0});
+            info.copied_files = value.value("copied_files", size_t{0});
+            info.written_segments = value.value("written_segments", size_t{0});
+            return info;
+        }
+        catch (const nlohmann::json::exception& e)
+        {
+            std::cerr << "[-] Descripción de copia inválida en " << file << ": " << e.what()
+                      << std::endl;
+            return std::nullopt;
+        }
+    }
+
+    void SnapshotInfo::Write(const std::filesystem::path& file) const
+    {
+        nlohmann::json value = {{"name", name},
+                                {"created_at_ms", created_at_ms},
+                                {"duration_ms", duration_ms},
+                                {"documents", documents},
+                                {"last_id", last_id},
+                                {"linked_files", linked_files},
+                                {"copied_files", copied_files},
+                                {"written_segments", written_segments}};
+        if (!Shared::FileUtils::WriteFileAtomic(file, value.dump(2)))
+        {
+            throw std::runtime_error("no se pudo escribir " + file.string());
+        }
+    }
+
+    // ============================================================================
+    // IMPLEMENTACIÓN DE SnapshotStore
+    // ============================================================================
+
+    SnapshotStore::SnapshotStore(std::filesystem::path directory,
+                                 std::shared_ptr<DocumentCatalog> catalog,
+                                 std::shared_ptr<ContentHashTable> content_hashes)
+        : directory_(std::move(directory)), catalog_(std::move(catalog)),
+          content_hashes_(std::move(content_hashes))
+    {
+        std::filesystem::create_directories(directory_);
+
+        // Los segmentos y las copias a medias de una ejecución anterior sobran: cada copia
+        // terminada tiene sus propios enlaces
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(directory_, error))
+        {
+            if (entry.path().filename().string().starts_with("."))
+            {
+                std::filesystem::remove_all(entry.path(), error);
+            }
+        }
+        segments_ = std::make_unique<SegmentPublisher>(SegmentsDirectory());
+    }
+
+    bool SnapshotStore::IsValidName(const std::string& name)
+    {
+        return !name.empty() && name.size() <= MAX_NAME_LENGTH && name.front() != '.' &&
+               std::all_of(name.begin(), name.end(),
+                           [](unsigned char c)
+                           { return std::isalnum(c) || c == '-' || c == '_' || c == '.'; });
+    }
+
+    SnapshotInfo SnapshotStore::Create(const std::string& name, const ShardedEngine& engine)
+    {
+        SnapshotInfo info;
+        info.name = name;
+        if (info.name.empty())
+        {
+            // Dos copias en el mismo segundo
+            const std::string base = default_name();
+            info.name = base;
+            for (int suffix = 2; std::filesystem::exists(directory_ / info.name); ++suffix)
+            {
+                info.name = base + "-" + std::to_string(suffix);
+            }
+        }
+        if (!IsValidName(info.name))
+        {
+            throw std::invalid_argument("nombre de copia inválido: " + info.name);
+        }
+        const std::filesystem::path target = directory_ / info.name;
+        if (std::filesystem::exists(target))
+        {
+            throw std::invalid_argument("ya existe la copia " + info.name);
+        }
+
+        // Se construye aparte y se publica con un renombrado: nunca se ve una copia a medias
+        const std::filesystem::path staging = directory_ / ("." + info.name + ".tmp");
+        std::filesystem::remove_all(staging);
+        const auto start = std::chrono::steady_clock::now();
+        info.created_at_ms = now_ms();
+        try
+        {
+            // Subidas, cambios y bajas esperan hasta sellar el índice: un PUT entre los dos
+            // pasos dejaría en la copia el archivo anterior y el texto nuevo indexado
+            auto mutation_lock = catalog_->LockMutations();
+
+            // 1. Catálogo y documentos, tal como están en este instante
+            CatalogSnapshot catalog = catalog_->Pin(staging / "catalog");
+            info.documents = catalog.entries.size();
+            info.last_id = catalog.last_id;
+            info.linked_files = catalog.linked_files;
+            info.copied_files = catalog.copied_files;
+            if (content_hashes_)
+            {
+                const bool copied =
+                    content_hashes_->Pin(staging / ContentHashTable::FILE_NAME);
+                info.linked_files += copied ? 0 : 1;
+                info.copied_files += copied ? 1 : 0;
+            }
+
+            // 2. Índice: solo se sellan las particiones que cambiaron desde la copia anterior
+            const auto manifest_file = SegmentsDirectory() / ReplicationManifest::FILE_NAME;
+            std::unordered_set<std::string> previous;
+            if (auto manifest = ReplicationManifest::Read(manifest_file))
+            {
+                for (const auto& segment : manifest->segments)
+                {
+                    previous.insert(segment.file);
+                }
+            }
+            segments_->Publish(engine);
+            mutation_lock.unlock();
+            auto manifest = ReplicationManifest::Read(manifest_file);
+            if (!manifest)
+            {
+                throw std::runtime_error("no se pudo sellar el índice");
+            }
+
+            const std::filesystem::path index = staging / "index";
+            std::filesystem::create_directories(index);
+            std::vector<std::string> files{ReplicationManifest::FILE_NAME};
+            for (const auto& segment : manifest->segments)
+            {
+                files.push_back(segment.file);
+                info.written_segments += previous.contains(segment.file) ? 0 : 1;
+            }
+            for (const auto& file : files)
+            {
+                bool copied = false;
+                if (!Shared::FileUtils::LinkOrCopyFile(SegmentsDirectory() / file, index / file,
+                                                       &copied))
+                {
+                    throw std::runtime_error("no se pudo enlazar " + file);
+                }
+                info.linked_files += copied ? 0 : 1;
+                info.copied_files += copied ? 1 : 0;
+            }
+
+            info.duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   std::chrono::steady_clock::now() - start)
+                                   .count();
+            info.Write(staging / SnapshotInfo::FILE_NAME);
+            std::filesystem::rename(staging, target);
+        }
+        catch (...)
+        {
+            std::error_code error;
+            std::filesystem::remove_all(staging, error);
+            throw;
+        }
+        return info;
+    }
+
+    std::vector<SnapshotInfo> SnapshotStore::List() const
+    {
+        std::vector<SnapshotInfo> snapshots;
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(directory_, error))
+        {
+            if (!entry.is_directory() || !IsValidName(entry.path().filename().string()))
+            {
+                continue;
+            }
+            if (auto info = SnapshotInfo::Read(entry.path() / SnapshotInfo::FILE_NAME))
+            {
+                snapshots.push_back(std::move(*info));
+            }
+        }
+        std::sort(snapshots.begin(), snapshots.end(),
+                  [](const SnapshotInfo& a, const SnapshotInfo& b)
+                  { return a.created_at_ms < b.created_at_ms; });
+        return snapshots;
+    }
+
+    std::optional<SnapshotInfo> SnapshotStore::Find(const std::string& name) const
+    {
+        if (!IsValidName(name))
+        {
+            return std::nullopt;
+        }
+        return SnapshotInfo::Read(directory_ / name / SnapshotInfo::FILE_NAME);
+    }
+
+    bool SnapshotStore::Remove(const std::string& name)
+    {
+        if (!Find(name))
+        {
+            return false;
+        }
+        // Solo se borran enlaces: los datos siguen mientras otra copia o el índice los usen
+        std::filesystem::remove_all(directory_ / name);
+        return true;
+    }
+
+    std::shared_ptr<ShardedEngine> SnapshotStore::Open(
+        const std::string& name, std::shared_ptr<const Shared::TextAnalyzer> analyzer) const
+    {
+        if (!Find(name))
+        {
+            throw std::runtime_error("no existe la copia " + name);
+        }
+        SegmentReplica reader(directory_ / name / "index", std::move(analyzer));
+        auto engine = reader.Refresh();
+        if (!engine)
+        {
+            throw std::runtime_error("la copia " + name + " no tiene manifiesto del índice");
+        }
+        return engine;
+    }
+
+    std::vector<CatalogEntry> SnapshotStore::RestoreCatalog(const std::string& name)
+    {
+        if (!Find(name))
+        {
+            throw std::runtime_error("no existe la copia " + name);
+        }
+        auto entries = catalog_->Restore(directory_ / name / "catalog");
+        if (content_hashes_)
+        {
+            content_hashes_->Restore(directory_ / name / ContentHashTable::FILE_NAME);
+            content_hashes_->Backfill(entries);
+        }
+        return entries;
+    }
+
+} // namespace DocuTrace::Infrastructure
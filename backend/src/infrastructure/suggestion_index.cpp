@@ -0,0 +1,250 @@
+#include "infrastructure/suggestion_index.hpp"
+#include <algorithm>
+#include <mutex>
+
+namespace DocuTrace::Infrastructure
+{
+    namespace
+    {
+        constexpr uint32_t NO_NODE = UINT32_MAX;
+        constexpr uint32_t ROOT = 0;
+    } // namespace
+
+    SuggestionIndex::SuggestionIndex() : nodes_(1)
+    {
+    }
+
+    bool SuggestionIndex::Ranks(uint32_t a, uint32_t b) const
+    {
+        if (frequencies_[a] != frequencies_[b])
+        {
+            return frequencies_[a] > frequencies_[b];
+        }
+        return words_[a] < words_[b];
+    }
+
+    uint32_t SuggestionIndex::FindChild(uint32_t node, char c) const
+    {
+        const auto& children = nodes_[node].children;
+        auto it = std::lower_bound(children.begin(), children.end(), c,
+                                   [](const std::pair<char, uint32_t>& child, char value)
+                                   { return child.first < value; });
+        return it != children.end() && it->first == c ? it->second : NO_NODE;
+    }
+
+    void SuggestionIndex::PromoteLocked(uint32_t node, uint32_t word)
+    {
+        // La frecuencia solo ha crecido: basta con recolocar la palabra en la lista
+        auto& top = nodes_[node].top;
+        auto current = std::find(top.begin(), top.end(), word);
+        if (current != top.end())
+        {
+            top.erase(current);
+        }
+        else if (top.size() == MAX_SUGGESTIONS && !Ranks(word, top.back()))
+        {
+            return;
+        }
+
+        auto position = std::lower_bound(top.begin(), top.end(), word,
+                                         [this](uint32_t a, uint32_t b) { return Ranks(a, b); });
+        top.insert(position, word);
+        if (top.size() > MAX_SUGGESTIONS)
+        {
+            top.pop_back();
+        }
+    }
+
+    void SuggestionIndex::RebuildTopLocked(uint32_t node)
+    {
+        // Las mejores del subárbol están entre la palabra del nodo y las listas de los hijos
+        std::vector<uint32_t> candidates;
+        const Node& current = nodes_[node];
+        if (current.word != NO_WORD && frequencies_[current.word] > 0)
+        {
+            candidates.push_back(current.word);
+        }
+        for (const auto& [c, child] : current.children)
+        {
+            const auto& child_top = nodes_[child].top;
+            candidates.insert(candidates.end(), child_top.begin(), child_top.end());
+        }
+
+        const size_t keep = std::min(candidates.size(), MAX_SUGGESTIONS);
+        std::partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end(),
+                          [this](uint32_t a, uint32_t b) { return Ranks(a, b); });
+        candidates.resize(keep);
+        nodes_[node].top = std::move(candidates);
+    }
+
+    void SuggestionIndex::AddWordLocked(const std::string& word, uint32_t count)
+    {
+        auto [entry, inserted] = word_ids_.try_emplace(word, static_cast<uint32_t>(words_.size()));
+        const uint32_t id = entry->second;
+        if (inserted)
+        {
+            words_.push_back(word);
+            frequencies_.push_back(0);
+        }
+        if (frequencies_[id] == 0)
+        {
+            live_words_++;
+        }
+        frequencies_[id] += count;
+
+        uint32_t node = ROOT;
+        PromoteLocked(node, id);
+        for (char c : word)
+        {
+            uint32_t child = FindChild(node, c);
+            if (child == NO_NODE)
+            {
+                child = static_cast<uint32_t>(nodes_.size());
+                nodes_.emplace_back();
+                auto& children = nodes_[node].children;
+                auto position = std::lower_bound(
+                    children.begin(), children.end(), c,
+                    [](const std::pair<char, uint32_t>& existing, char value)
+                    { return existing.first < value; });
+                children.insert(position, {c, child});
+            }
+            node = child;
+            PromoteLocked(node, id);
+        }
+        nodes_[node].word = id;
+    }
+
+    void SuggestionIndex::RemoveWordLocked(const std::string& word)
+    {
+        auto entry = word_ids_.find(word);
+        if (entry == word_ids_.end() || frequencies_[entry->second] == 0)
+        {
+            return;
+        }
+        const uint32_t id = entry->second;
+
+        std::vector<uint32_t> path = {ROOT};
+        for (char c : word)
+        {
+            path.push_back(FindChild(path.back(), c));
+        }
+
+        if (--frequencies_[id] == 0)
+        {
+            live_words_--;
+        }
+
+        // De abajo arriba: cada nodo se recalcula con las listas ya corregidas de sus hijos
+        for (auto it = path.rbegin(); it != path.rend(); ++it)
+        {
+            const auto& top = nodes_[*it].top;
+            if (std::find(top.begin(), top.end(), id) != top.end())
+            {
+                RebuildTopLocked(*it);
+            }
+        }
+    }
+
+    void SuggestionIndex::AddDocument(const std::vector<std::string>& words)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        for (const auto& word : words)
+        {
+            AddWordLocked(word);
+        }
+    }
+
+    void SuggestionIndex::AddDocuments(const std::vector<std::vector<std::string>>& documents)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        for (const auto& words : documents)
+        {
+            for (const auto& word : words)
+            {
+                AddWordLocked(word);
+            }
+        }
+    }
+
+    void SuggestionIndex::RemoveDocument(const std::vector<std::string>& words)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        for (const auto& word : words)
+        {
+            RemoveWordLocked(word);
+        }
+    }
+
+    std::vector<Suggestion> SuggestionIndex::Suggest(const std::string& prefix, size_t limit) const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        uint32_t node = ROOT;
+        for (char c : prefix)
+        {
+            node = FindChild(node, c);
+            if (node == NO_NODE)
+            {
+                return {};
+            }
+        }
+
+        const auto& top = nodes_[node].top;
+        std::vector<Suggestion> suggestions;
+        suggestions.reserve(std::min(limit, top.size()));
+        for (size_t i = 0; i < top.size() && i < limit; ++i)
+        {
+            suggestions.push_back({words_[top[i]], frequencies_[top[i]]});
+        }
+        return suggestions;
+    }
+
+    std::vector<Suggestion> SuggestionIndex::GetWords() const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::vector<Suggestion> words;
+        words.reserve(live_words_);
+        for (size_t id = 0; id < words_.size(); ++id)
+        {
+            if (frequencies_[id] > 0)
+            {
+                words.push_back({words_[id], frequencies_[id]});
+            }
+        }
+        return words;
+    }
+
+    void SuggestionIndex::Restore(const std::vector<Suggestion>& words)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        nodes_.assign(1, Node{});
+        words_.clear();
+        frequencies_.clear();
+        word_ids_.clear();
+        live_words_ = 0;
+
+        for (const auto& [word, frequency] : words)
+        {
+            if (frequency > 0)
+            {
+                AddWordLocked(word, frequency);
+            }
+        }
+    }
+
+    size_t SuggestionIndex::GetWordCount() const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return live_words_;
+    }
+
+    void SuggestionIndex::Clear()
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        nodes_.assign(1, Node{});
+        words_.clear();
+        frequencies_.clear();
+        word_ids_.clear();
+        live_words_ = 0;
+    }
+
+} // namespace DocuTrace::Infrastructure
@@ -0,0 +1,354 @@
+#include "infrastructure/term_dictionary.hpp"
+#include <algorithm>
+
+namespace DocuTrace::Infrastructure
+{
+    namespace
+    {
+        constexpr uint32_t NO_NODE = UINT32_MAX;
+        constexpr uint32_t ROOT = 0;
+    } // namespace
+
+    TermDictionary::TermDictionary()
+    {
+        Clear();
+    }
+
+    uint32_t TermDictionary::AllocateNode()
+    {
+        if (!free_nodes_.empty())
+        {
+            uint32_t node = free_nodes_.back();
+            free_nodes_.pop_back();
+            return node;
+        }
+        nodes_.emplace_back();
+        return static_cast<uint32_t>(nodes_.size() - 1);
+    }
+
+    void TermDictionary::ReleaseNode(uint32_t node)
+    {
+        nodes_[node] = Node{};
+        free_nodes_.push_back(node);
+    }
+
+    void TermDictionary::MergeWithChild(uint32_t node)
+    {
+        uint32_t child = nodes_[node].children.front();
+        nodes_[node].label += nodes_[child].label;
+        nodes_[node].children = std::move(nodes_[child].children);
+        nodes_[node].terminal = nodes_[child].terminal;
+        ReleaseNode(child);
+    }
+
+    size_t TermDictionary::FindChild(uint32_t node, char c) const
+    {
+        // Mismo orden que std::string::compare (bytes sin signo) para que los recorridos
+        // devuelvan los términos en orden lexicográfico
+        const auto& children = nodes_[node].children;
+        auto it = std::lower_bound(children.begin(), children.end(), static_cast<unsigned char>(c),
+                                   [this](uint32_t child, unsigned char value)
+                                   {
+                                       return static_cast<unsigned char>(
+                                                  nodes_[child].label.front()) < value;
+                                   });
+        return static_cast<size_t>(it - children.begin());
+    }
+
+    bool TermDictionary::Insert(const std::string& term)
+    {
+        if (term.empty())
+        {
+            return false;
+        }
+
+        uint32_t node = ROOT;
+        size_t position = 0;
+        while (position < term.size())
+        {
+            size_t index = FindChild(node, term[position]);
+            const auto& children = nodes_[node].children;
+            if (index == children.size() || nodes_[children[index]].label.front() != term[position])
+            {
+                // AllocateNode puede reubicar nodes_: no se conservan referencias
+                uint32_t leaf = AllocateNode();
+                nodes_[leaf].label = term.substr(position);
+                nodes_[leaf].terminal = true;
+                auto& siblings = nodes_[node].children;
+                siblings.insert(siblings.begin() + static_cast<std::ptrdiff_t>(index), leaf);
+                ++term_count_;
+                return true;
+            }
+
+            uint32_t child = children[index];
+            const std::string& label = nodes_[child].label;
+            size_t common = 0;
+            while (common < label.size() && position + common < term.size() &&
+                   label[common] == term[position + common])
+            {
+                ++common;
+            }
+
+            if (common < label.size())
+            {
+                // Divide la arista: nodo intermedio con la parte común
+                std::string head = label.substr(0, common);
+                uint32_t middle = AllocateNode();
+                nodes_[child].label.erase(0, common);
+                nodes_[middle].label = std::move(head);
+                nodes_[middle].children.push_back(child);
+                nodes_[node].children[index] = middle;
+                child = middle;
+            }
+
+            node = child;
+            position += common;
+        }
+
+        if (nodes_[node].terminal)
+        {
+            return false;
+        }
+        nodes_[node].terminal = true;
+        ++term_count_;
+        return true;
+    }
+
+    bool TermDictionary::Erase(const std::string& term)
+    {
+        if (term.empty())
+        {
+            return false;
+        }
+
+        uint32_t parent = ROOT;
+        size_t parent_index = 0;
+        uint32_t node = ROOT;
+        size_t position = 0;
+        while (position < term.size())
+        {
+            size_t index = FindChild(node, term[position]);
+            const auto& children = nodes_[node].children;
+            if (index == children.size())
+            {
+                return false;
+            }
+            uint32_t child = children[index];
+            const std::string& label = nodes_[child].label;
+            if (term.compare(position, label.size(), label) != 0)
+            {
+                return false;
+            }
+            parent = node;
+            parent_index = index;
+            node = child;
+            position += label.size();
+        }
+
+        if (!nodes_[node].terminal)
+        {
+            return false;
+        }
+        nodes_[node].terminal = false;
+        --term_count_;
+
+        // Poda: una hoja sin término desaparece y un nodo de paso con un solo hijo se fusiona
+        if (nodes_[node].children.empty())
+        {
+            auto& siblings = nodes_[parent].children;
+            siblings.erase(siblings.begin() + static_cast<std::ptrdiff_t>(parent_index));
+            ReleaseNode(node);
+            if (parent != ROOT && !nodes_[parent].terminal && nodes_[parent].children.size() == 1)
+            {
+                MergeWithChild(parent);
+            }
+        }
+        else if (nodes_[node].children.size() == 1)
+        {
+            MergeWithChild(node);
+        }
+        return true;
+    }
+
+    uint32_t TermDictionary::Descend(const std::string& text, std::string& path) const
+    {
+        path.clear();
+        uint32_t node = ROOT;
+        size_t position = 0;
+        while (position < text.size())
+        {
+            size_t index = FindChild(node, text[position]);
+            const auto& children = nodes_[node].children;
+            if (index == children.size())
+            {
+                return NO_NODE;
+            }
+            uint32_t child = children[index];
+            const std::string& label = nodes_[child].label;
+            size_t length = std::min(label.size(), text.size() - position);
+            if (label.compare(0, length, text, position, length) != 0)
+            {
+                return NO_NODE;
+            }
+            path += label;
+            position += length;
+            node = child;
+        }
+        return node;
+    }
+
+    bool TermDictionary::Contains(const std::string& term) const
+    {
+        std::string path;
+        uint32_t node = Descend(term, path);
+        return node != NO_NODE && path.size() == term.size() && nodes_[node].terminal;
+    }
+
+    void TermDictionary::CollectTerms(uint32_t node, std::string& path,
+                                      std::vector<std::string>& out, size_t limit) const
+    {
+        if (nodes_[node].terminal)
+        {
+            out.push_back(path);
+        }
+        for (uint32_t child : nodes_[node].children)
+        {
+            if (out.size() >= limit)
+            {
+                return;
+            }
+            const size_t length = path.size();
+            path += nodes_[child].label;
+            CollectTerms(child, path, out, limit);
+            path.resize(length);
+        }
+    }
+
+    std::vector<std::string> TermDictionary::PrefixSearch(const std::string& prefix,
+                                                          size_t limit) const
+    {
+        std::vector<std::string> terms;
+        std::string path;
+        uint32_t node = Descend(prefix, path);
+        if (node == NO_NODE || limit == 0)
+        {
+            return terms;
+        }
+        CollectTerms(node, path, terms, limit);
+        return terms;
+    }
+
+    std::vector<std::string> TermDictionary::PrefixesOf(const std::string& text,
+                                                        size_t min_length) const
+    {
+        std::vector<std::string> terms;
+        uint32_t node = ROOT;
+        size_t position = 0;
+        while (position < text.size())
+        {
+            size_t index = FindChild(node, text[position]);
+            const auto& children = nodes_[node].children;
+            if (index == children.size())
+            {
+                break;
+            }
+            uint32_t child = children[index];
+            const std::string& label = nodes_[child].label;
+            if (text.compare(position, label.size(), label) != 0)
+            {
+                break;
+            }
+            position += label.size();
+            node = child;
+            if (nodes_[node].terminal && position >= min_length)
+            {
+                terms.push_back(text.substr(0, position));
+            }
+        }
+        return terms;
+    }
+
+    void TermDictionary::FuzzyVisit(uint32_t node, const std::string& pattern, int max_distance,
+                                    std::string& path, std::vector<int>& rows,
+                                    std::vector<TermMatch>& out) const
+    {
+        // rows guarda una fila de la matriz de edición por cada carácter de path: avanzar un
+        // carácter en el trie equivale a una transición del autómata de Levenshtein
+        const size_t width = pattern.size() + 1;
+        const size_t base_depth = path.size();
+        bool alive = true;
+
+        for (char c : nodes_[node].label)
+        {
+            path.push_back(c);
+            const size_t depth = path.size();
+            rows.resize((depth + 1) * width);
+            int* row = rows.data() + depth * width;
+            const int* previous = row - width;
+
+            row[0] = static_cast<int>(depth);
+            int row_min = row[0];
+            for (size_t i = 1; i < width; ++i)
+            {
+                int cost = pattern[i - 1] == c ? 0 : 1;
+                int value = std::min({previous[i] + 1, row[i - 1] + 1, previous[i - 1] + cost});
+                if (i > 1 && depth > 1 && pattern[i - 1] == path[depth - 2] &&
+                    pattern[i - 2] == c)
+                {
+                    value = std::min(value, rows[(depth - 2) * width + i - 2] + 1);
+                }
+                row[i] = value;
+                row_min = std::min(row_min, value);
+            }
+
+            if (row_min > max_distance)
+            {
+                alive = false;
+                break;
+            }
+        }
+
+        if (alive)
+        {
+            int distance = rows[path.size() * width + width - 1];
+            if (nodes_[node].terminal && distance <= max_distance)
+            {
+                out.push_back({path, distance});
+            }
+            for (uint32_t child : nodes_[node].children)
+            {
+                FuzzyVisit(child, pattern, max_distance, path, rows, out);
+            }
+        }
+
+        path.resize(base_depth);
+        rows.resize((base_depth + 1) * width);
+    }
+
+    std::vector<TermMatch> TermDictionary::FuzzySearch(const std::string& pattern,
+                                                       int max_distance) const
+    {
+        std::vector<TermMatch> matches;
+        if (max_distance < 0)
+        {
+            return matches;
+        }
+
+        std::vector<int> rows(pattern.size() + 1);
+        for (size_t i = 0; i < rows.size(); ++i)
+        {
+            rows[i] = static_cast<int>(i);
+        }
+        std::string path;
+        FuzzyVisit(ROOT, pattern, max_distance, path, rows, matches);
+        return matches;
+    }
+
+    void TermDictionary::Clear()
+    {
+        nodes_.assign(1, Node{});
+        free_nodes_.clear();
+        term_count_ = 0;
+    }
+
+} // namespace DocuTrace::Infrastructure
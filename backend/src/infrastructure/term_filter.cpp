@@ -0,0 +1,281 @@
+#include "infrastructure/term_filter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "shared/hash_utils.hpp"
+
+namespace DocuTrace::Infrastructure
+{
+    namespace
+    {
+        // Finalizador de MurmurHash3: biyectivo, así que claves distintas siguen distintas
+        uint64_t murmur64(uint64_t h)
+        {
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+            return h;
+        }
+
+        uint64_t splitmix64(uint64_t& state)
+        {
+            uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+
+        // Parte alta de a · b con b < 2^32 (sin enteros de 128 bits)
+        uint64_t multiply_high(uint64_t a, uint32_t b)
+        {
+            const uint64_t high = (a >> 32) * b;
+            const uint64_t low = (a & 0xffffffffULL) * b;
+            return (high + (low >> 32)) >> 32;
+        }
+
+        uint8_t fingerprint(uint64_t mixed)
+        {
+            return static_cast<uint8_t>(mixed ^ (mixed >> 32));
+        }
+    } // namespace
+
+    // ============================================================================
+    // IMPLEMENTACIÓN DE TermFilter
+    // ============================================================================
+
+    uint64_t TermFilter::Hash(std::string_view term)
+    {
+        return Shared::HashUtils::Hash64(term);
+    }
+
+    void TermFilter::Allocate(uint64_t key_count)
+    {
+        // Dimensiones de Graf y Lemire para tres funciones hash: segmentos más largos cuantas
+        // más claves y un array algo mayor que las claves para que el pelado termine
+        const double size = static_cast<double>(key_count);
+        segment_length_ =
+            key_count == 0
+                ? 4
+                : 1u << static_cast<int>(std::floor(std::log(size) / std::log(3.33) + 2.25));
+        segment_length_ = std::min(segment_length_, MAX_SEGMENT_LENGTH);
+
+        const double size_factor =
+            key_count <= 1 ? 0.0 : std::max(1.125, 0.875 + 0.25 * std::log(1e6) / std::log(size));
+        const auto capacity = static_cast<uint64_t>(std::round(size * size_factor));
+        uint64_t segment_count = (capacity + segment_length_ - 1) / segment_length_;
+        segment_count = segment_count <= 2 ? 1 : segment_count - 2;
+        if ((segment_count + 2) * segment_length_ > UINT32_MAX)
+        {
+            throw std::runtime_error("demasiados términos para el filtro");
+        }
+
+        key_count_ = key_count;
+        segment_count_length_ = static_cast<uint32_t>(segment_count * segment_length_);
+        fingerprints_.assign((segment_count + 2) * segment_length_, 0);
+    }
+
+    uint32_t TermFilter::Position(int index, uint64_t mixed) const
+    {
+        // El primer segmento sale de la parte alta; los otros dos son los siguientes, con
+        // 18 bits distintos del hash en cada uno
+        uint64_t position = multiply_high(mixed, segment_count_length_);
+        position += static_cast<uint64_t>(index) * segment_length_;
+        const uint64_t bits = mixed & ((uint64_t{1} << 36) - 1);
+        position ^= (bits >> (36 - 18 * index)) & (segment_length_ - 1);
+        return static_cast<uint32_t>(position);
+    }
+
+    bool TermFilter::Build(std::vector<uint64_t> hashes)
+    {
+        std::sort(hashes.begin(), hashes.end());
+        hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+        Allocate(hashes.size());
+
+        const size_t capacity = fingerprints_.size();
+        // Por posición: claves que caen en ella (en los bits altos, de 4 en 4), el índice de
+        // la función hash que las llevó (XOR en los dos bits bajos) y el XOR de sus claves
+        std::vector<uint8_t> counts(capacity);
+        std::vector<uint64_t> xors(capacity);
+        std::vector<uint32_t> alone(capacity);
+        std::vector<uint64_t> mixed(hashes.size());
+        std::vector<uint64_t> stack(hashes.size());
+        std::vector<uint8_t> stack_index(hashes.size());
+
+        uint64_t random = 0x726b2b9d438b9d4dULL;
+        for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt)
+        {
+            seed_ = splitmix64(random);
+            std::fill(counts.begin(), counts.end(), 0);
+            std::fill(xors.begin(), xors.end(), 0);
+
+            // En orden de su posición para recorrer el array casi en secuencia
+            for (size_t i = 0; i < hashes.size(); ++i)
+            {
+                mixed[i] = murmur64(hashes[i] + seed_);
+            }
+            std::sort(mixed.begin(), mixed.end());
+
+            bool overflow = false;
+            for (uint64_t key : mixed)
+            {
+                for (int index = 0; index < 3; ++index)
+                {
+                    const uint32_t position = Position(index, key);
+                    counts[position] += 4;
+                    counts[position] ^= static_cast<uint8_t>(index);
+                    xors[position] ^= key;
+                    // Más de 63 claves en una posición desbordan el contador
+                    overflow |= counts[position] < 4;
+                }
+            }
+            if (overflow)
+            {
+                continue;
+            }
+
+            // Pelado: una posición con una sola clave la fija; quitarla puede dejar otras
+            // posiciones con una sola
+            size_t queue = 0;
+            for (uint32_t position = 0; position < capacity; ++position)
+            {
+                alone[queue] = position;
+                queue += (counts[position] >> 2) == 1 ? 1 : 0;
+            }
+            size_t stacked = 0;
+            while (queue > 0)
+            {
+                const uint32_t position = alone[--queue];
+                if ((counts[position] >> 2) != 1)
+                {
+                    continue;
+                }
+                const uint64_t key = xors[position];
+                const uint8_t found = counts[position] & 3;
+                stack[stacked] = key;
+                stack_index[stacked] = found;
+                stacked++;
+
+                for (int other = 1; other < 3; ++other)
+                {
+                    const int index = (found + other) % 3;
+                    const uint32_t next = Position(index, key);
+                    alone[queue] = next;
+                    queue += (counts[next] >> 2) == 2 ? 1 : 0;
+                    counts[next] -= 4;
+                    counts[next] ^= static_cast<uint8_t>(index);
+                    xors[next] ^= key;
+                }
+            }
+            if (stacked != hashes.size())
+            {
+                continue;
+            }
+
+            // En orden inverso al pelado cada clave fija la posición que la dejó sola
+            for (size_t i = stacked; i-- > 0;)
+            {
+                const uint64_t key = stack[i];
+                const uint32_t positions[3] = {Position(0, key), Position(1, key),
+                                               Position(2, key)};
+                const int found = stack_index[i];
+                fingerprints_[positions[found]] =
+                    fingerprint(key) ^ fingerprints_[positions[(found + 1) % 3]] ^
+                    fingerprints_[positions[(found + 2) % 3]];
+            }
+            return true;
+        }
+
+        *this = TermFilter();
+        return false;
+    }
+
+    bool TermFilter::MayContain(uint64_t hash) const
+    {
+        // Sin construir no puede descartar nada
+        if (fingerprints_.empty())
+        {
+            return true;
+        }
+        const uint64_t key = murmur64(hash + seed_);
+        const uint8_t value = fingerprint(key) ^ fingerprints_[Position(0, key)] ^
+                              fingerprints_[Position(1, key)] ^ fingerprints_[Position(2, key)];
+        return value == 0;
+    }
+
+    void TermFilter::Write(Shared::BinaryWriter& writer) const
+    {
+        writer.Write<uint64_t>(key_count_);
+        writer.Write<uint64_t>(seed_);
+        writer.WriteVector(fingerprints_);
+    }
+
+    TermFilter TermFilter::Read(Shared::BinaryReader& reader)
+    {
+        TermFilter filter;
+        const uint64_t key_count = reader.Read<uint64_t>();
+        const uint64_t seed = reader.Read<uint64_t>();
+        std::vector<uint8_t> fingerprints = reader.ReadVector<uint8_t>();
+        // Vacío si no se pudo construir: no descarta nada
+        if (fingerprints.empty() && key_count == 0)
+        {
+            return filter;
+        }
+
+        // Cada clave ocupa al menos un byte: un número corrupto no reserva de más
+        if (key_count > fingerprints.size())
+        {
+            throw std::runtime_error("filtro de términos inconsistente en el segmento");
+        }
+        filter.Allocate(key_count);
+        filter.seed_ = seed;
+        if (fingerprints.size() != filter.fingerprints_.size())
+        {
+            throw std::runtime_error("filtro de términos inconsistente en el segmento");
+        }
+        filter.fingerprints_ = std::move(fingerprints);
+        return filter;
+    }
+
+    // ============================================================================
+    // IMPLEMENTACIÓN DE TermFilterStatistics
+    // ============================================================================
+
+    double TermFilterStatistics::GetSkipRate() const
+    {
+        return GetLookups() == 0 ? 0.0
+                                 : static_cast<double>(skipped) /
+                                       static_cast<double>(GetLookups());
+    }
+
+    double TermFilterStatistics::GetHitRate() const
+    {
+        return GetLookups() == 0 ? 0.0
+                                 : static_cast<double>(passed - false_positives) /
+                                       static_cast<double>(GetLookups());
+    }
+
+    double TermFilterStatistics::GetFalsePositiveRate() const
+    {
+        const uint64_t absent = skipped + false_positives;
+        return absent == 0 ? 0.0
+                           : static_cast<double>(false_positives) / static_cast<double>(absent);
+    }
+
+    double TermFilterStatistics::GetBitsPerTerm() const
+    {
+        return terms == 0 ? 0.0 : static_cast<double>(bytes * 8) / static_cast<double>(terms);
+    }
+
+    void TermFilterStatistics::Merge(const TermFilterStatistics& other)
+    {
+        terms += other.terms;
+        unsealed_terms += other.unsealed_terms;
+        bytes += other.bytes;
+        skipped += other.skipped;
+        passed += other.passed;
+        false_positives += other.false_positives;
+    }
+
+} // namespace DocuTrace::Infrastructure
@@ -1,13 +1,23 @@
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <thread>
+#include "controllers/document_controller.hpp"
 #include "controllers/health_controller.hpp"
 #include "controllers/search_controller.hpp"
+#include "controllers/shard_controller.hpp"
+#include "controllers/snapshot_controller.hpp"
 #include "controllers/upload_controller.hpp"
 #include "crow/app.h"
 #include "crow/middlewares/cors.h"
+#include "infrastructure/content_hash_table.hpp"
+#include "infrastructure/document_catalog.hpp"
+#include "services/admission_control.hpp"
+#include "services/folder_crawler.hpp"
 #include "services/search_service.hpp"
 #include "shared/env_utils.hpp"
+#include "shared/file_utils.hpp"
+#include "shared/simd_kernels.hpp"
 
 int main()
 {
@@ -17,29 +27,99 @@ int main()
 
         const auto PORT = std::stoi(DocuTrace::Shared::EnvUtils::GetEnv("PORT", "8000"));
 
+        // Nivel SIMD de los kernels de postings (auto detecta la CPU)
+        DocuTrace::Shared::SimdLevel simd_level;
+        const auto simd_setting = DocuTrace::Shared::EnvUtils::GetEnv("SIMD_LEVEL", "auto");
+        if (!DocuTrace::Shared::SimdKernels::ParseLevel(simd_setting, simd_level))
+        {
+            std::cerr << "[!] SIMD_LEVEL desconocido: " << simd_setting << ", usando auto"
+                      << std::endl;
+            simd_level = DocuTrace::Shared::SimdKernels::DetectLevel();
+        }
+        simd_level = DocuTrace::Shared::SimdKernels::SetLevel(simd_level);
+        std::cout << "[+] Kernels de postings: "
+                  << DocuTrace::Shared::SimdKernels::LevelName(simd_level) << std::endl;
+
         crow::App<crow::CORSHandler> app;
 
         // Configurar CORS para permitir peticiones del frontend de Tauri
         auto& cors = app.get_middleware<crow::CORSHandler>();
         cors.global()
             .origin("http://localhost:1420")
-            .methods("GET"_method, "POST"_method, "OPTIONS"_method)
+            .methods("GET"_method, "POST"_method, "PUT"_method, "DELETE"_method,
+                     "OPTIONS"_method)
             .headers("Content-Type", "Authorization");
 
         // Registrar rutas de salud
         auto health_controller = std::make_unique<DocuTrace::Controllers::HealthController>();
         health_controller->RegisterRoutes(app);
 
+        // Catálogo de documentos compartido por búsqueda, subida y edición
+        const auto data_dir = DocuTrace::Shared::FileUtils::GetAppDataDir();
+        std::cout << "[+] Directorio de datos: " << data_dir << std::endl;
+        auto catalog = std::make_shared<DocuTrace::Infrastructure::DocumentCatalog>(data_dir);
+
+        // Hashes de contenido para deduplicar subidas; las copias de seguridad los guardan
+        DocuTrace::Infrastructure::NearDuplicateOptions near_duplicates;
+        near_duplicates.enabled =
+            DocuTrace::Shared::EnvUtils::GetEnv("NEAR_DUPLICATE_DETECTION", "false") == "true";
+        near_duplicates.max_distance =
+            std::stoi(DocuTrace::Shared::EnvUtils::GetEnv("NEAR_DUPLICATE_MAX_DISTANCE", "3"));
+        auto content_hashes = std::make_shared<DocuTrace::Infrastructure::ContentHashTable>(
+            data_dir / DocuTrace::Infrastructure::ContentHashTable::FILE_NAME, near_duplicates);
+
         // Crear servicio y controlador de búsqueda
-        auto search_service = std::make_shared<DocuTrace::Services::SearchService>();
-        auto search_controller =
-            std::make_unique<DocuTrace::Controllers::SearchController>(search_service);
+        auto search_service =
+            std::make_shared<DocuTrace::Services::SearchService>(catalog, content_hashes);
+
+        // Carpetas locales que se mantienen indexadas (CRAWL_DIRS); una réplica no indexa
+        std::shared_ptr<DocuTrace::Services::FolderCrawler> crawler;
+        auto crawl_options = DocuTrace::Services::FolderCrawler::ReadOptions();
+        if (!crawl_options.roots.empty() && !search_service->IsReadOnly())
+        {
+            crawler = std::make_shared<DocuTrace::Services::FolderCrawler>(
+                search_service, catalog, std::move(crawl_options));
+        }
+
+        // Turnos por coste estimado: búsquedas antes que lotes y lotes antes que la ingesta
+        auto admission = std::make_shared<DocuTrace::Services::AdmissionControl>(
+            DocuTrace::Services::AdmissionControl::ReadOptions());
+
+        // gzip/deflate de los resultados si el cliente lo acepta (0 = nunca, 1 = más rápido)
+        const int compression_level = std::clamp(
+            std::stoi(DocuTrace::Shared::EnvUtils::GetEnv("RESPONSE_COMPRESSION_LEVEL", "1")), 0,
+            9);
+        auto search_controller = std::make_unique<DocuTrace::Controllers::SearchController>(
+            search_service, compression_level, admission, crawler);
         search_controller->RegisterRoutes(app);
 
+        // Fases internas de la búsqueda distribuida (solo en workers)
+        auto shard_controller =
+            std::make_unique<DocuTrace::Controllers::ShardController>(search_service);
+        if (search_service->GetNodeRole() == DocuTrace::Services::NodeRole::WORKER)
+        {
+            shard_controller->RegisterRoutes(app);
+        }
+
         // Crear servicio y controlador de subida
-        auto upload_controller =
-            std::make_unique<DocuTrace::Controllers::UploadController>(search_service);
-        upload_controller->RegisterRoutes(app);
+        auto upload_controller = std::make_unique<DocuTrace::Controllers::UploadController>(
+            search_service, catalog, content_hashes, admission);
+
+        // Controlador para eliminar y reemplazar documentos
+        auto document_controller = std::make_unique<DocuTrace::Controllers::DocumentController>(
+            search_service, catalog, content_hashes, admission);
+
+        // Copias de seguridad en caliente del directorio de datos y del índice
+        auto snapshot_controller = std::make_unique<DocuTrace::Controllers::SnapshotController>(
+            search_service, crawler);
+
+        // Una réplica solo sirve búsquedas: los cambios llegan del nodo que publica
+        if (!search_service->IsReadOnly())
+        {
+            upload_controller->RegisterRoutes(app);
+            document_controller->RegisterRoutes(app);
+            snapshot_controller->RegisterRoutes(app);
+        }
 
         std::cout << "[+] DocuTrace Search API iniciado en puerto " << PORT << std::endl;
         std::cout << "[+] Health check: http://localhost:" << PORT << "/health" << std::endl;
@@ -47,7 +127,16 @@ int main()
         std::cout << "[+] Documentos indexados: " << search_service->GetDocumentCount()
                   << std::endl;
 
-        app.port(PORT).concurrency(std::thread::hardware_concurrency()).run();
+        // Las peticiones en cola esperan en un hilo de Crow: hacen falta hilos para las que se
+        // ejecutan, para las que esperan y para seguir respondiendo a /health
+        unsigned threads = std::thread::hardware_concurrency();
+        const auto& admission_options = admission->GetOptions();
+        if (admission_options.enabled)
+        {
+            threads = std::max<unsigned>(
+                threads, admission_options.max_concurrent + admission_options.queue_size + 1);
+        }
+        app.port(PORT).concurrency(threads).run();
     }
     catch (const std::exception& e)
     {
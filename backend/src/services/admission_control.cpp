@@ -0,0 +1,332 @@
+#include "services/admission_control.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <utility>
+#include "shared/env_utils.hpp"
+
+namespace DocuTrace::Services
+{
+    namespace
+    {
+        // Peso de la última petición en la media móvil de su duración
+        constexpr double SERVICE_TIME_SMOOTHING = 0.1;
+        constexpr std::chrono::seconds MAX_RETRY_AFTER{60};
+
+        size_t index_of(RequestPriority priority)
+        {
+            return static_cast<size_t>(priority);
+        }
+
+        double milliseconds_since(std::chrono::steady_clock::time_point start)
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                             start)
+                .count();
+        }
+    } // namespace
+
+    // ============================================================================
+    // IMPLEMENTACIÓN DE Admission
+    // ============================================================================
+
+    Admission::Admission(Admission&& other) noexcept
+        : control_(std::exchange(other.control_, nullptr)), priority_(other.priority_),
+          charge_(other.charge_), start_(other.start_), status_(other.status_),
+          retry_after_(other.retry_after_)
+    {
+    }
+
+    Admission& Admission::operator=(Admission&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (control_)
+            {
+                control_->Release(*this);
+            }
+            control_ = std::exchange(other.control_, nullptr);
+            priority_ = other.priority_;
+            charge_ = other.charge_;
+            start_ = other.start_;
+            status_ = other.status_;
+            retry_after_ = other.retry_after_;
+        }
+        return *this;
+    }
+
+    Admission::~Admission()
+    {
+        if (control_)
+        {
+            control_->Release(*this);
+        }
+    }
+
+    // ============================================================================
+    // IMPLEMENTACIÓN DE AdmissionControl
+    // ============================================================================
+
+    AdmissionControl::AdmissionControl(AdmissionOptions options) : options_(std::move(options))
+    {
+        if (options_.max_concurrent == 0)
+        {
+            options_.max_concurrent = std::max(1u, std::thread::hardware_concurrency());
+        }
+    }
+
+    AdmissionOptions AdmissionControl::ReadOptions()
+    {
+        AdmissionOptions options;
+        options.enabled = Shared::EnvUtils::GetEnv("ADMISSION_CONTROL", "true") != "false";
+        try
+        {
+            options.max_concurrent =
+                std::stoul(Shared::EnvUtils::GetEnv("ADMISSION_MAX_CONCURRENT", "0"));
+            options.cost_budget =
+                std::stoull(Shared::EnvUtils::GetEnv("ADMISSION_COST_BUDGET", "50000000"));
+            options.queue_size =
+                std::stoul(Shared::EnvUtils::GetEnv("ADMISSION_QUEUE_SIZE", "64"));
+            options.queue_timeout = std::chrono::milliseconds(
+                std::stoul(Shared::EnvUtils::GetEnv("ADMISSION_QUEUE_TIMEOUT_MS", "500")));
+        }
+        catch (const std::exception&)
+        {
+            options = AdmissionOptions{options.enabled};
+            std::cerr << "[-] ADMISSION_MAX_CONCURRENT, ADMISSION_COST_BUDGET, "
+                         "ADMISSION_QUEUE_SIZE o ADMISSION_QUEUE_TIMEOUT_MS inválidos, usando "
+                         "0, 50000000, 64 y 500"
+                      << std::endl;
+        }
+        return options;
+    }
+
+    const char* AdmissionControl::PriorityName(RequestPriority priority)
+    {
+        switch (priority)
+        {
+        case RequestPriority::INTERACTIVE:
+            return "interactive";
+        case RequestPriority::BATCH:
+            return "batch";
+        case RequestPriority::INGEST:
+            return "ingest";
+        }
+        return "interactive";
+    }
+
+    size_t AdmissionControl::SlotLimit(RequestPriority priority) const
+    {
+        switch (priority)
+        {
+        case RequestPriority::BATCH:
+            return std::max<size_t>(1, options_.max_concurrent / 2);
+        case RequestPriority::INGEST:
+            return std::max<size_t>(1, options_.max_concurrent / 4);
+        default:
+            return options_.max_concurrent;
+        }
+    }
+
+    uint64_t AdmissionControl::CostLimit(RequestPriority priority) const
+    {
+        if (options_.cost_budget == 0)
+        {
+            return std::numeric_limits<uint64_t>::max();
+        }
+        switch (priority)
+        {
+        case RequestPriority::BATCH:
+            return options_.cost_budget / 2;
+        case RequestPriority::INGEST:
+            return options_.cost_budget / 4;
+        default:
+            return options_.cost_budget;
+        }
+    }
+
+    bool AdmissionControl::Fits(RequestPriority priority, uint64_t charge) const
+    {
+        // Ocioso: nada que proteger
+        if (total_running_ == 0)
+        {
+            return true;
+        }
+        return total_running_ < SlotLimit(priority) &&
+               cost_in_flight_ + charge <= CostLimit(priority);
+    }
+
+    void AdmissionControl::Start(RequestPriority priority, uint64_t charge)
+    {
+        running_[index_of(priority)]++;
+        total_running_++;
+        cost_in_flight_ += charge;
+        stats_[index_of(priority)].admitted++;
+    }
+
+    bool AdmissionControl::HasWaitersAhead(RequestPriority priority) const
+    {
+        for (size_t i = 0; i <= index_of(priority); ++i)
+        {
+            if (!waiting_[i].empty())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool AdmissionControl::AdmitWaiters()
+    {
+        bool admitted = false;
+        for (auto& queue : waiting_)
+        {
+            while (!queue.empty())
+            {
+                Waiter* waiter = queue.front();
+                if (!Fits(waiter->priority, waiter->charge))
+                {
+                    return admitted;
+                }
+                Start(waiter->priority, waiter->charge);
+                waiter->admitted = true;
+                total_waiting_--;
+                queue.pop_front();
+                admitted = true;
+            }
+        }
+        return admitted;
+    }
+
+    void AdmissionControl::RecordQueueTime(RequestPriority priority, double queue_ms)
+    {
+        auto& stats = stats_[index_of(priority)];
+        total_queue_ms_[index_of(priority)] += queue_ms;
+        stats.max_queue_ms = std::max(stats.max_queue_ms, queue_ms);
+    }
+
+    std::chrono::seconds AdmissionControl::RetryAfter() const
+    {
+        // Lo que tardarían en vaciarse la cola y los huecos ocupados al ritmo actual
+        const double drain_ms = avg_service_ms_ * static_cast<double>(total_waiting_ + 1) /
+                                static_cast<double>(options_.max_concurrent);
+        const std::chrono::seconds seconds(static_cast<long>(std::ceil(drain_ms / 1000.0)));
+        return std::clamp(seconds, std::chrono::seconds(1), MAX_RETRY_AFTER);
+    }
+
+    Admission AdmissionControl::Admit(RequestPriority priority, uint64_t cost)
+    {
+        Admission admission;
+        admission.priority_ = priority;
+        if (!options_.enabled)
+        {
+            return admission;
+        }
+        // Una consulta nunca cuenta más de medio presupuesto: siempre queda sitio
+        const uint64_t max_charge = options_.cost_budget / 2;
+        admission.charge_ = options_.cost_budget == 0 ? 0 : std::min(cost, max_charge);
+
+        const auto arrival = std::chrono::steady_clock::now();
+        auto& stats = stats_[index_of(priority)];
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        auto reject = [&](AdmissionStatus status)
+        {
+            admission.status_ = status;
+            admission.retry_after_ = RetryAfter();
+            return std::move(admission);
+        };
+
+        const bool fits = Fits(priority, admission.charge_);
+        if (!fits && max_charge > 0 && admission.charge_ == max_charge)
+        {
+            stats.rejected_cost++;
+            return reject(AdmissionStatus::TOO_EXPENSIVE);
+        }
+
+        // Aunque quepa, espera detrás de las que llegaron antes con su prioridad o más
+        if (!fits || HasWaitersAhead(priority))
+        {
+            if (total_waiting_ >= options_.queue_size)
+            {
+                stats.rejected_queue_full++;
+                return reject(AdmissionStatus::QUEUE_FULL);
+            }
+
+            Waiter waiter{priority, admission.charge_};
+            auto& queue = waiting_[index_of(priority)];
+            queue.push_back(&waiter);
+            total_waiting_++;
+            const bool admitted = wakeup_.wait_until(lock, arrival + options_.queue_timeout,
+                                                     [&waiter] { return waiter.admitted; });
+            const double queue_ms = milliseconds_since(arrival);
+            RecordQueueTime(priority, queue_ms);
+            if (!admitted)
+            {
+                queue.erase(std::find(queue.begin(), queue.end(), &waiter));
+                total_waiting_--;
+                stats.timed_out++;
+                // Si era el primero de la cola, los que esperaban detrás quizá ya quepan
+                if (AdmitWaiters())
+                {
+                    wakeup_.notify_all();
+                }
+                return reject(AdmissionStatus::TIMED_OUT);
+            }
+            stats.queued++;
+        }
+        else
+        {
+            Start(priority, admission.charge_);
+        }
+
+        admission.control_ = this;
+        admission.start_ = std::chrono::steady_clock::now();
+        return admission;
+    }
+
+    void AdmissionControl::Release(const Admission& admission)
+    {
+        const double service_ms = milliseconds_since(admission.start_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_[index_of(admission.priority_)]--;
+            total_running_--;
+            cost_in_flight_ -= admission.charge_;
+            avg_service_ms_ = avg_service_ms_ == 0.0
+                                  ? service_ms
+                                  : avg_service_ms_ + SERVICE_TIME_SMOOTHING *
+                                                          (service_ms - avg_service_ms_);
+            if (!AdmitWaiters())
+            {
+                return;
+            }
+        }
+        wakeup_.notify_all();
+    }
+
+    AdmissionStats AdmissionControl::GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        AdmissionStats stats;
+        stats.enabled = options_.enabled;
+        stats.max_concurrent = options_.max_concurrent;
+        stats.cost_budget = options_.cost_budget;
+        stats.cost_in_flight = cost_in_flight_;
+        stats.avg_service_ms = avg_service_ms_;
+        stats.classes = stats_;
+        for (size_t i = 0; i < stats.classes.size(); ++i)
+        {
+            auto& class_stats = stats.classes[i];
+            class_stats.running = running_[i];
+            class_stats.waiting = waiting_[i].size();
+            const uint64_t finished = class_stats.admitted + class_stats.timed_out;
+            class_stats.avg_queue_ms =
+                finished == 0 ? 0.0 : total_queue_ms_[i] / static_cast<double>(finished);
+        }
+        return stats;
+    }
+
+} // namespace DocuTrace::Services
@@ -0,0 +1,563 @@
+#include "services/folder_crawler.hpp"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <nlohmann/json.hpp>
+#include <unordered_set>
+#include "shared/env_utils.hpp"
+#include "shared/file_utils.hpp"
+#include "shared/text_utils.hpp"
+
+namespace DocuTrace::Services
+{
+    namespace
+    {
+        // Tareas del pool por hilo en cada nivel del recorrido y en la indexación
+        constexpr size_t TASKS_PER_THREAD = 4;
+        // Una ráfaga que no cesa se aplica como mucho cada MAX_DEBOUNCE_FACTOR * debounce
+        constexpr int MAX_DEBOUNCE_FACTOR = 10;
+        // Recorrido completo periódico si inotify no cubre todo el árbol
+        constexpr std::chrono::seconds FALLBACK_RESCAN_INTERVAL{300};
+
+        // Tabla de archivos indexados, en el directorio de datos
+        constexpr const char* TABLE_FILE_NAME = "crawler_files.json";
+
+        constexpr char SEPARATOR = static_cast<char>(std::filesystem::path::preferred_separator);
+
+        bool is_hidden(const std::filesystem::path& path)
+        {
+            return path.filename().string().starts_with('.');
+        }
+
+        bool is_within(const std::filesystem::path& path, const std::filesystem::path& directory)
+        {
+            auto [directory_end, path_end] =
+                std::mismatch(directory.begin(), directory.end(), path.begin(), path.end());
+            return directory_end == directory.end();
+        }
+
+        std::time_t to_time_t(std::filesystem::file_time_type::rep modified)
+        {
+            const std::filesystem::file_time_type time{
+                std::filesystem::file_time_type::duration(modified)};
+            return std::chrono::system_clock::to_time_t(
+                std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+                    std::chrono::file_clock::to_sys(time)));
+        }
+
+        long long milliseconds_since(std::chrono::steady_clock::time_point start)
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - start)
+                .count();
+        }
+    } // namespace
+
+    FolderCrawler::FolderCrawler(std::shared_ptr<SearchService> search_service,
+                                 std::shared_ptr<Infrastructure::DocumentCatalog> catalog,
+                                 CrawlerOptions options)
+        : search_service_(std::move(search_service)), catalog_(std::move(catalog)),
+          options_(std::move(options)), pool_(options_.threads),
+          table_file_(catalog_->GetDataRoot() / TABLE_FILE_NAME)
+    {
+        thread_ = std::jthread([this](std::stop_token stop) { Run(std::move(stop)); });
+    }
+
+    CrawlerOptions FolderCrawler::ReadOptions()
+    {
+        CrawlerOptions options;
+        for (const auto& directory :
+             Shared::TextUtils::splitString(Shared::EnvUtils::GetEnv("CRAWL_DIRS", ""), ','))
+        {
+            std::error_code ec;
+            std::filesystem::path root = std::filesystem::canonical(directory, ec);
+            if (ec || !std::filesystem::is_directory(root))
+            {
+                std::cerr << "[-] CRAWL_DIRS: " << directory << " no es un directorio, se omite"
+                          << std::endl;
+                continue;
+            }
+            options.roots.push_back(std::move(root));
+        }
+
+        const auto extensions = Shared::TextUtils::splitString(
+            Shared::EnvUtils::GetEnv("CRAWL_EXTENSIONS", ".txt"), ',');
+        if (!extensions.empty())
+        {
+            options.extensions.clear();
+            for (std::string extension : extensions)
+            {
+                std::transform(extension.begin(), extension.end(), extension.begin(),
+                               [](unsigned char c) { return std::tolower(c); });
+                options.extensions.push_back(extension.starts_with('.') ? extension
+                                                                        : '.' + extension);
+            }
+        }
+
+        try
+        {
+            options.threads = std::stoul(Shared::EnvUtils::GetEnv("CRAWL_THREADS", "0"));
+            options.debounce = std::chrono::milliseconds(
+                std::stoul(Shared::EnvUtils::GetEnv("CRAWL_DEBOUNCE_MS", "500")));
+            options.rescan_interval = std::chrono::seconds(
+                std::stoul(Shared::EnvUtils::GetEnv("CRAWL_RESCAN_SECONDS", "0")));
+        }
+        catch (const std::exception&)
+        {
+            options = CrawlerOptions{std::move(options.roots), std::move(options.extensions)};
+            std::cerr << "[-] CRAWL_THREADS, CRAWL_DEBOUNCE_MS o CRAWL_RESCAN_SECONDS inválidos, "
+                         "usando 0, 500 y 0"
+                      << std::endl;
+        }
+        return options;
+    }
+
+    bool FolderCrawler::IsIndexable(const std::filesystem::path& path) const
+    {
+        // Ocultos y copias de los editores (.archivo.swp, archivo.txt~)
+        if (is_hidden(path) || path.filename().string().ends_with('~'))
+        {
+            return false;
+        }
+        std::string extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        return std::find(options_.extensions.begin(), options_.extensions.end(), extension) !=
+               options_.extensions.end();
+    }
+
+    void FolderCrawler::LoadTable()
+    {
+        std::ifstream in(table_file_);
+        if (!in.is_open())
+        {
+            return;
+        }
+
+        try
+        {
+            nlohmann::json table;
+            in >> table;
+            if (!table.is_array())
+            {
+                return;
+            }
+
+            for (const auto& item : table)
+            {
+                const std::filesystem::path path(item.at("path").get<std::string>());
+                // Carpetas que ya no están en CRAWL_DIRS: nadie revisaría sus archivos
+                if (std::none_of(options_.roots.begin(), options_.roots.end(),
+                                 [&path](const auto& root) { return is_within(path, root); }))
+                {
+                    continue;
+                }
+                // Ningún archivo mide esto: se vuelven a leer y conservan su ID
+                files_[path.string()] = {item.at("id").get<uint64_t>(),
+                                         std::numeric_limits<uintmax_t>::max(),
+                                         item.at("modified").get<int64_t>()};
+            }
+        }
+        catch (const nlohmann::json::exception& e)
+        {
+            std::cerr << "[-] Error al parsear " << table_file_ << ": " << e.what() << std::endl;
+            files_.clear();
+        }
+    }
+
+    void FolderCrawler::SaveTable() const
+    {
+        nlohmann::json table = nlohmann::json::array();
+        for (const auto& [path, file] : files_)
+        {
+            table.push_back({{"path", path},
+                             {"id", file.document_id},
+                             {"size", file.size},
+                             {"modified", static_cast<int64_t>(file.modified)}});
+        }
+        Shared::FileUtils::WriteFileAtomic(table_file_, table.dump());
+    }
+
+    std::vector<FolderCrawler::FileState> FolderCrawler::Walk(
+        std::vector<std::filesystem::path> directories, std::stop_token stop)
+    {
+        struct Listing
+        {
+            std::vector<FileState> files;
+            std::vector<std::filesystem::path> directories;
+        };
+
+        std::vector<FileState> files;
+        while (!directories.empty() && !stop.stop_requested())
+        {
+            for (const auto& directory : directories)
+            {
+                if (!watcher_.Watch(directory) && watcher_.IsOpen() && !watch_limit_reached_)
+                {
+                    watch_limit_reached_ = true;
+                    std::cerr << "[!] No se pudo vigilar " << directory
+                              << " (¿fs.inotify.max_user_watches?): las carpetas se recorrerán "
+                                 "enteras cada "
+                              << FALLBACK_RESCAN_INTERVAL.count() << " s" << std::endl;
+                }
+            }
+
+            const size_t tasks = pool_.GetThreadCount() * TASKS_PER_THREAD;
+            const size_t chunk = std::max<size_t>(1, (directories.size() + tasks - 1) / tasks);
+            std::vector<std::future<Listing>> listings;
+            for (size_t begin = 0; begin < directories.size(); begin += chunk)
+            {
+                const size_t end = std::min(directories.size(), begin + chunk);
+                listings.push_back(pool_.Submit(
+                    [this, &directories, begin, end]()
+                    {
+                        Listing listing;
+                        for (size_t d = begin; d < end; ++d)
+                        {
+                            std::error_code ec;
+                            std::filesystem::directory_iterator it(
+                                directories[d],
+                                std::filesystem::directory_options::skip_permission_denied, ec);
+                            for (; !ec && it != std::filesystem::directory_iterator();
+                                 it.increment(ec))
+                            {
+                                const std::filesystem::path& path = it->path();
+                                std::error_code status_error;
+                                // Los enlaces simbólicos no se siguen
+                                const auto status = it->symlink_status(status_error);
+                                if (status_error || is_hidden(path))
+                                {
+                                    continue;
+                                }
+                                if (std::filesystem::is_directory(status))
+                                {
+                                    listing.directories.push_back(path);
+                                }
+                                else if (std::filesystem::is_regular_file(status) &&
+                                         IsIndexable(path))
+                                {
+                                    const uintmax_t size = it->file_size(status_error);
+                                    const auto modified = it->last_write_time(status_error);
+                                    if (!status_error)
+                                    {
+                                        listing.files.push_back(
+                                            {path.string(), size,
+                                             modified.time_since_epoch().count()});
+                                    }
+                                }
+                            }
+                        }
+                        return listing;
+                    }));
+            }
+
+            std::vector<std::filesystem::path> next;
+            for (auto& future : listings)
+            {
+                Listing listing = future.get();
+                std::move(listing.files.begin(), listing.files.end(), std::back_inserter(files));
+                std::move(listing.directories.begin(), listing.directories.end(),
+                          std::back_inserter(next));
+            }
+            directories = std::move(next);
+        }
+        return files;
+    }
+
+    void FolderCrawler::Synchronize(std::vector<std::filesystem::path> scopes,
+                                    std::stop_token stop)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        // Un directorio ya incluye lo que cuelga de él (los hijos van justo detrás al ordenar)
+        std::sort(scopes.begin(), scopes.end());
+        std::vector<std::filesystem::path> unique;
+        for (auto& scope : scopes)
+        {
+            if (unique.empty() || !is_within(scope, unique.back()))
+            {
+                unique.push_back(std::move(scope));
+            }
+        }
+
+        std::vector<std::filesystem::path> directories;
+        std::vector<FileState> found;
+        for (const auto& scope : unique)
+        {
+            std::error_code ec;
+            const auto status = std::filesystem::symlink_status(scope, ec);
+            if (ec)
+            {
+                continue;
+            }
+            if (std::filesystem::is_directory(status))
+            {
+                directories.push_back(scope);
+            }
+            else if (std::filesystem::is_regular_file(status) && IsIndexable(scope))
+            {
+                const uintmax_t size = std::filesystem::file_size(scope, ec);
+                const auto modified = std::filesystem::last_write_time(scope, ec);
+                if (!ec)
+                {
+                    found.push_back({scope.string(), size, modified.time_since_epoch().count()});
+                }
+            }
+        }
+        std::vector<FileState> walked = Walk(std::move(directories), stop);
+        // Con el recorrido a medias, lo que falta no se puede dar por borrado
+        if (stop.stop_requested())
+        {
+            return;
+        }
+        std::move(walked.begin(), walked.end(), std::back_inserter(found));
+
+        // Altas y cambios: solo los archivos cuyo tamaño o fecha difieren de lo indexado
+        struct Change
+        {
+            FileState file;
+            uint64_t document_id;
+            bool known;
+        };
+        std::unordered_set<std::string> present;
+        present.reserve(found.size());
+        std::vector<Change> changes;
+        uint64_t unchanged = 0;
+        for (auto& file : found)
+        {
+            present.insert(file.path);
+            auto it = files_.find(file.path);
+            if (it == files_.end())
+            {
+                changes.push_back({std::move(file), 0, false});
+            }
+            else if (it->second.size != file.size || it->second.modified != file.modified)
+            {
+                changes.push_back({std::move(file), it->second.document_id, true});
+            }
+            else
+            {
+                ++unchanged;
+            }
+        }
+
+        // Bajas: lo indexado dentro de las rutas revisadas que ya no está
+        std::vector<std::string> gone;
+        for (const auto& scope : unique)
+        {
+            const std::string path = scope.string();
+            if (files_.contains(path) && !present.contains(path))
+            {
+                gone.push_back(path);
+            }
+            const std::string prefix = path.ends_with(SEPARATOR) ? path : path + SEPARATOR;
+            for (auto it = files_.lower_bound(prefix);
+                 it != files_.end() && it->first.starts_with(prefix); ++it)
+            {
+                if (!present.contains(it->first))
+                {
+                    gone.push_back(it->first);
+                }
+            }
+        }
+
+        const size_t new_files = static_cast<size_t>(std::count_if(
+            changes.begin(), changes.end(), [](const Change& change) { return !change.known; }));
+        if (new_files > 0)
+        {
+            uint64_t next_id = catalog_->ReserveIds(new_files);
+            for (auto& change : changes)
+            {
+                if (!change.known)
+                {
+                    change.document_id = next_id++;
+                }
+            }
+        }
+
+        // Lectura e indexación en paralelo: el motor analiza el texto fuera de su lock
+        std::vector<uint8_t> indexed(changes.size(), 0);
+        const size_t tasks = pool_.GetThreadCount() * TASKS_PER_THREAD;
+        const size_t chunk = std::max<size_t>(1, (changes.size() + tasks - 1) / tasks);
+        std::vector<std::future<void>> indexing;
+        for (size_t begin = 0; begin < changes.size(); begin += chunk)
+        {
+            const size_t end = std::min(changes.size(), begin + chunk);
+            indexing.push_back(pool_.Submit(
+                [this, &changes, &indexed, begin, end]()
+                {
+                    for (size_t c = begin; c < end; ++c)
+                    {
+                        const FileState& file = changes[c].file;
+                        // Vacío o ya ilegible: se trata como borrado
+                        std::string content =
+                            file.size > 0 ? Shared::FileUtils::ExtractText(file.path) : "";
+                        const std::filesystem::path path(file.path);
+                        Models::IndexDocumentRequest request{
+                            changes[c].document_id, std::move(content),
+                            path.filename().string(), to_time_t(file.modified),
+                            path.parent_path().string()};
+                        indexed[c] = search_service_->IndexDocument(request) ? 1 : 0;
+                    }
+                }));
+        }
+        for (auto& future : indexing)
+        {
+            future.get();
+        }
+
+        uint64_t added = 0;
+        uint64_t updated = 0;
+        for (size_t c = 0; c < changes.size(); ++c)
+        {
+            if (indexed[c])
+            {
+                const FileState& file = changes[c].file;
+                files_[file.path] = {changes[c].document_id, file.size, file.modified};
+                (changes[c].known ? updated : added)++;
+            }
+            else if (changes[c].known)
+            {
+                gone.push_back(changes[c].file.path);
+            }
+        }
+
+        uint64_t removed = 0;
+        for (const auto& path : gone)
+        {
+            auto it = files_.find(path);
+            if (it == files_.end())
+            {
+                continue;
+            }
+            search_service_->DeleteDocument(it->second.document_id);
+            files_.erase(it);
+            removed++;
+        }
+
+        added_ += added;
+        updated_ += updated;
+        removed_ += removed;
+        unchanged_ += unchanged;
+        file_count_ = files_.size();
+        watches_ = watcher_.GetWatchCount();
+        if (added + updated + removed > 0)
+        {
+            SaveTable();
+            std::cout << "[+] Carpetas vigiladas: " << added << " nuevos, " << updated
+                      << " modificados, " << removed << " eliminados (" << unchanged
+                      << " sin cambios) en " << milliseconds_since(start) << " ms" << std::endl;
+        }
+    }
+
+    void FolderCrawler::Run(std::stop_token stop)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        Clock::time_point last_rescan = Clock::now();
+        LoadTable();
+        Synchronize(options_.roots, stop);
+        std::cout << "[+] Carpetas vigiladas: " << files_.size() << " archivos indexados en "
+                  << milliseconds_since(last_rescan) << " ms, " << watcher_.GetWatchCount()
+                  << " directorios vigilados" << std::endl;
+        if (!watcher_.IsOpen())
+        {
+            std::cout << "[!] Sin inotify: las carpetas se recorrerán enteras cada "
+                      << FALLBACK_RESCAN_INTERVAL.count() << " s" << std::endl;
+        }
+
+        std::vector<std::filesystem::path> pending;
+        bool overflowed = false;
+        Clock::time_point first_change;
+        Clock::time_point last_change;
+        while (!stop.stop_requested())
+        {
+            for (auto& event : watcher_.Poll(options_.debounce))
+            {
+                if (event.kind == Shared::WatchEventKind::OVERFLOW)
+                {
+                    overflowed = true;
+                    std::cerr << "[!] Se perdieron eventos de inotify, recorriendo las carpetas"
+                              << std::endl;
+                }
+                else if (event.directory ? !is_hidden(event.path) : IsIndexable(event.path))
+                {
+                    pending.push_back(std::move(event.path));
+                }
+                else
+                {
+                    continue;
+                }
+                const Clock::time_point now = Clock::now();
+                if (pending.size() + (overflowed ? 1 : 0) == 1)
+                {
+                    first_change = now;
+                }
+                last_change = now;
+            }
+
+            if (reindex_requested_.exchange(false))
+            {
+                // Ningún archivo mide esto: todos cuentan como cambiados y conservan su ID
+                for (auto& [path, file] : files_)
+                {
+                    file.size = std::numeric_limits<uintmax_t>::max();
+                }
+                rescans_++;
+                Synchronize(options_.roots, stop);
+                last_rescan = Clock::now();
+                pending.clear();
+                overflowed = false;
+                continue;
+            }
+
+            const Clock::time_point now = Clock::now();
+            std::chrono::seconds interval = options_.rescan_interval;
+            if (watch_limit_reached_ || !watcher_.IsOpen())
+            {
+                interval = interval.count() > 0 ? std::min(interval, FALLBACK_RESCAN_INTERVAL)
+                                                : FALLBACK_RESCAN_INTERVAL;
+            }
+            const bool rescan_due = interval.count() > 0 && now - last_rescan >= interval;
+
+            // Se espera a que la ráfaga termine, salvo que dure demasiado
+            const bool settled = now - last_change >= options_.debounce ||
+                                 now - first_change >= options_.debounce * MAX_DEBOUNCE_FACTOR;
+            if (rescan_due || (overflowed && settled))
+            {
+                rescans_++;
+                Synchronize(options_.roots, stop);
+                last_rescan = now;
+                pending.clear();
+                overflowed = false;
+            }
+            else if (!pending.empty() && settled)
+            {
+                Synchronize(std::move(pending), stop);
+                pending.clear();
+            }
+        }
+    }
+
+    void FolderCrawler::RequestReindex()
+    {
+        reindex_requested_ = true;
+    }
+
+    CrawlerStats FolderCrawler::GetStats() const
+    {
+        CrawlerStats stats;
+        stats.files = file_count_.load();
+        stats.added = added_.load();
+        stats.updated = updated_.load();
+        stats.removed = removed_.load();
+        stats.unchanged = unchanged_.load();
+        stats.rescans = rescans_.load();
+        stats.watches = watches_.load();
+        return stats;
+    }
+
+} // namespace DocuTrace::Services
@@ -1,163 +1,902 @@
 #include "services/search_service.hpp"
-#include <filesystem>
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <iostream>
-#include <nlohmann/json.hpp>
 #include <sstream>
+#include <stdexcept>
 #include <thread>
+#include <unordered_set>
+#include "shared/env_utils.hpp"
+#include "shared/file_utils.hpp"
+#include "shared/text_analyzer.hpp"
 
 namespace DocuTrace::Services
 {
-    // Función helper para obtener el directorio de datos del sistema
-    std::filesystem::path get_system_data_dir()
+    namespace
     {
-        std::filesystem::path data_dir;
+        std::shared_ptr<const Shared::TextAnalyzer> create_analyzer()
+        {
+            Shared::AnalyzerOptions options;
+            options.stemming = Shared::EnvUtils::GetEnv("ANALYZER_STEMMING", "true") == "true";
+            options.stopwords = Shared::EnvUtils::GetEnv("ANALYZER_STOPWORDS", "true") == "true";
+            options.stopwords_file = Shared::EnvUtils::GetEnv("ANALYZER_STOPWORDS_FILE", "");
+
+            auto analyzer = std::make_shared<const Shared::TextAnalyzer>(options);
+            std::cout << "[+] Analizador: stemming " << (options.stemming ? "activo" : "inactivo")
+                      << ", " << analyzer->GetStopwordCount() << " stopwords" << std::endl;
+            return analyzer;
+        }
 
-#ifdef _WIN32
-        // Windows: %APPDATA%\DocuTrace
-        const char* appdata = std::getenv("APPDATA");
-        if (appdata)
+        size_t read_shard_count()
         {
-            data_dir = std::filesystem::path(appdata) / "DocuTrace";
+            try
+            {
+                size_t shards = std::stoul(Shared::EnvUtils::GetEnv("INDEX_SHARDS", "1"));
+                // 0 = una partición por hilo del hardware
+                return shards != 0 ? shards : std::max(1u, std::thread::hardware_concurrency());
+            }
+            catch (const std::exception&)
+            {
+                std::cerr << "[-] INDEX_SHARDS inválido, usando 1" << std::endl;
+                return 1;
+            }
         }
-        else
+
+        std::unique_ptr<Infrastructure::CursorCache> create_cursor_cache()
         {
-            const char* userprofile = std::getenv("USERPROFILE");
-            if (userprofile)
+            long ttl_seconds = 60;
+            size_t capacity = 256;
+            try
             {
-                data_dir = std::filesystem::path(userprofile) / "AppData" / "Roaming" / "DocuTrace";
+                ttl_seconds = std::stol(Shared::EnvUtils::GetEnv("CURSOR_TTL_SECONDS", "60"));
+                capacity = std::stoul(Shared::EnvUtils::GetEnv("CURSOR_CACHE_SIZE", "256"));
             }
-            else
+            catch (const std::exception&)
             {
-                data_dir = std::filesystem::current_path() / "data";
+                std::cerr << "[-] CURSOR_TTL_SECONDS o CURSOR_CACHE_SIZE inválidos, usando 60 y "
+                             "256"
+                          << std::endl;
+                ttl_seconds = 60;
+                capacity = 256;
             }
+            return std::make_unique<Infrastructure::CursorCache>(std::chrono::seconds(ttl_seconds),
+                                                                 capacity);
         }
-#elif __APPLE__
-        // macOS: ~/Library/Application Support/DocuTrace
-        const char* home = std::getenv("HOME");
-        if (home)
+
+        /**
+         * @param ranking Modelo del servidor, base de lo que cambie la petición
+         * @param two_phase Cascada del servidor, base de candidates y proximity
+         * @param two_phase_default TWO_PHASE: cascada en las peticiones que no la eligen
+         */
+        Infrastructure::QueryOptions query_options(const Models::SearchRequest& request,
+                                                   const Infrastructure::RankingParameters& ranking,
+                                                   const Infrastructure::TwoPhaseOptions& two_phase,
+                                                   bool two_phase_default)
         {
-            data_dir =
-                std::filesystem::path(home) / "Library" / "Application Support" / "DocuTrace";
+            Infrastructure::QueryOptions options;
+            options.prefix_last = request.autocomplete;
+            options.fuzzy_edits = request.fuzzy;
+            if (request.search_after)
+            {
+                options.search_after = Infrastructure::SearchAfter{
+                    request.search_after->score, request.search_after->document_id};
+            }
+
+            for (const auto& name : request.facets)
+            {
+                Infrastructure::FacetField field;
+                if (Infrastructure::DocValues::ParseFacetField(name, field) &&
+                    std::find(options.facets.begin(), options.facets.end(), field) ==
+                        options.facets.end())
+                {
+                    options.facets.push_back(field);
+                }
+            }
+            Infrastructure::SortOrder sort;
+            if (Infrastructure::DocValues::ParseSortOrder(request.sort, sort))
+            {
+                options.sort = sort;
+            }
+
+            if (request.timeout_ms)
+            {
+                options.deadline = std::chrono::steady_clock::now() +
+                                   std::chrono::milliseconds(*request.timeout_ms);
+            }
+
+            if (request.two_phase.value_or(two_phase_default || request.candidates ||
+                                           request.proximity))
+            {
+                Infrastructure::TwoPhaseOptions cascade = two_phase;
+                cascade.candidates = request.candidates.value_or(cascade.candidates);
+                cascade.proximity_weight = request.proximity.value_or(cascade.proximity_weight);
+                options.two_phase = cascade;
+            }
+
+            // Sin cambios se puntúa con el modelo de cada motor (también en los workers)
+            if (request.ranking.empty() && !request.k1 && !request.b)
+            {
+                return options;
+            }
+            Infrastructure::RankingParameters parameters = ranking;
+            if (auto model = Infrastructure::RankingParameters::ParseModel(request.ranking);
+                model && *model != ranking.model)
+            {
+                parameters.model = *model;
+                parameters.delta = Infrastructure::RankingParameters::ForModel(*model).delta;
+            }
+            parameters.k1 = request.k1.value_or(parameters.k1);
+            parameters.b = request.b.value_or(parameters.b);
+            options.ranking = parameters;
+            return options;
         }
-        else
+
+        /**
+         * @brief Facetas pedidas en su orden: los meses en orden cronológico y el resto los
+         *        MAX_FACET_BUCKETS valores con más documentos
+         */
+        std::vector<Models::Facet> to_facets(const Infrastructure::FacetCounts& counts,
+                                             const std::vector<Infrastructure::FacetField>& fields)
+        {
+            constexpr size_t MAX_FACET_BUCKETS = 50;
+
+            std::vector<Models::Facet> facets;
+            for (Infrastructure::FacetField field : fields)
+            {
+                auto& facet = facets.emplace_back();
+                facet.field = Infrastructure::DocValues::FacetFieldName(field);
+                auto values = counts.fields.find(field);
+                if (values == counts.fields.end())
+                {
+                    continue;
+                }
+                for (const auto& [value, count] : values->second)
+                {
+                    facet.buckets.push_back({value, count});
+                }
+                if (field == Infrastructure::FacetField::MONTH)
+                {
+                    continue;
+                }
+                auto more_documents = [](const Models::FacetBucket& a, const Models::FacetBucket& b)
+                { return a.count != b.count ? a.count > b.count : a.value < b.value; };
+                const size_t keep = std::min(facet.buckets.size(), MAX_FACET_BUCKETS);
+                std::partial_sort(facet.buckets.begin(), facet.buckets.begin() + keep,
+                                  facet.buckets.end(), more_documents);
+                facet.buckets.resize(keep);
+            }
+            return facets;
+        }
+
+        Models::SnapshotInfo to_model(const Infrastructure::SnapshotInfo& info)
         {
-            data_dir = std::filesystem::current_path() / "data";
+            return {info.name,         info.created_at_ms, info.duration_ms,
+                    info.documents,    info.last_id,       info.linked_files,
+                    info.copied_files, info.written_segments};
         }
-#else
-        // Linux: ~/.local/share/DocuTrace
-        const char* home = std::getenv("HOME");
-        if (home)
+    } // namespace
+
+    SearchService::SearchService(std::shared_ptr<Infrastructure::DocumentCatalog> catalog,
+                                 std::shared_ptr<Infrastructure::ContentHashTable> content_hashes)
+        : analyzer_(create_analyzer()), catalog_(std::move(catalog)),
+          cursors_(create_cursor_cache()), content_hashes_(std::move(content_hashes))
+    {
+        engine_.store(
+            std::make_shared<Infrastructure::ShardedEngine>(read_shard_count(), analyzer_));
+        std::cout << "[+] Índice en " << Engine()->GetShardCount() << " particiones" << std::endl;
+
+        ReadEngineSettings();
+        ApplyEngineSettings(*Engine());
+
+        ConfigureNodeRole();
+        ConfigureReplication();
+        if (replication_mode_ != ReplicationMode::REPLICA)
+        {
+            ConfigureSnapshots();
+        }
+
+        // Una réplica recibe el índice ya construido: no vuelve a analizar los documentos
+        if (replication_mode_ == ReplicationMode::REPLICA)
         {
-            data_dir = std::filesystem::path(home) / ".local" / "share" / "DocuTrace";
+            Replicate();
         }
         else
         {
-            data_dir = std::filesystem::current_path() / "data";
+            // Cargar documentos existentes al inicializar
+            LoadExistingDocuments();
         }
-#endif
 
-        return data_dir;
+        if (replication_mode_ != ReplicationMode::NONE)
+        {
+            replication_thread_ = std::jthread([this](std::stop_token stop)
+                                               { RunReplication(std::move(stop)); });
+        }
     }
 
-    SearchService::SearchService() : engine_(std::make_unique<Infrastructure::BM25Engine>())
+    void SearchService::ReadEngineSettings()
     {
-        // Cargar documentos existentes al inicializar
-        LoadExistingDocuments();
+        try
+        {
+            compaction_ratio_ =
+                std::stod(Shared::EnvUtils::GetEnv("COMPACTION_TOMBSTONE_RATIO", "0.2"));
+        }
+        catch (const std::exception&)
+        {
+            std::cerr << "[-] COMPACTION_TOMBSTONE_RATIO inválido, usando 0.2" << std::endl;
+        }
+
+        try
+        {
+            double fuzzy_penalty =
+                std::stod(Shared::EnvUtils::GetEnv("SEARCH_FUZZY_PENALTY", "0.5"));
+            size_t max_expansions =
+                std::stoul(Shared::EnvUtils::GetEnv("SEARCH_MAX_EXPANSIONS", "50"));
+            fuzzy_penalty_ = fuzzy_penalty;
+            max_expansions_ = max_expansions;
+        }
+        catch (const std::exception&)
+        {
+            std::cerr << "[-] SEARCH_FUZZY_PENALTY o SEARCH_MAX_EXPANSIONS inválidos, usando "
+                         "0.5 y 50"
+                      << std::endl;
+        }
+
+        try
+        {
+            memory_budget_ =
+                std::stoul(Shared::EnvUtils::GetEnv("INDEX_MEMORY_MB", "0")) * 1024 * 1024;
+        }
+        catch (const std::exception&)
+        {
+            std::cerr << "[-] INDEX_MEMORY_MB inválido, sin límite de memoria" << std::endl;
+        }
+
+        // En el volumen de datos y no en /tmp, que en contenedores suele ser RAM (tmpfs)
+        const std::string cold_directory = Shared::EnvUtils::GetEnv("INDEX_COLD_DIR", "");
+        cold_directory_ = cold_directory.empty() ? Shared::FileUtils::GetAppDataDir() / "cold"
+                                                 : std::filesystem::path(cold_directory);
+        if (memory_budget_ > 0)
+        {
+            std::cout << "[+] Presupuesto del índice: " << memory_budget_ / (1024 * 1024)
+                      << " MB, nivel frío en " << cold_directory_ << std::endl;
+        }
+
+        const std::string model = Shared::EnvUtils::GetEnv("RANKING_MODEL", "bm25");
+        auto ranking_model = Infrastructure::RankingParameters::ParseModel(model);
+        if (!ranking_model)
+        {
+            std::cerr << "[-] RANKING_MODEL desconocido (" << model << "), usando bm25"
+                      << std::endl;
+            ranking_model = Infrastructure::RankingModel::BM25;
+        }
+
+        Infrastructure::RankingParameters ranking =
+            Infrastructure::RankingParameters::ForModel(*ranking_model);
+        bool valid = true;
+        try
+        {
+            ranking.k1 = std::stod(Shared::EnvUtils::GetEnv("BM25_K1", "1.2"));
+            ranking.b = std::stod(Shared::EnvUtils::GetEnv("BM25_B", "0.75"));
+            const std::string delta = Shared::EnvUtils::GetEnv("BM25_DELTA", "");
+            if (!delta.empty())
+            {
+                ranking.delta = std::stod(delta);
+            }
+            ranking.filename_weight =
+                std::stod(Shared::EnvUtils::GetEnv("BM25F_FILENAME_WEIGHT", "2.0"));
+        }
+        catch (const std::exception&)
+        {
+            valid = false;
+        }
+        if (!valid || !ranking.IsValid())
+        {
+            std::cerr << "[-] BM25_K1, BM25_B, BM25_DELTA o BM25F_FILENAME_WEIGHT inválidos, "
+                         "usando los valores por defecto"
+                      << std::endl;
+            ranking = Infrastructure::RankingParameters::ForModel(*ranking_model);
+        }
+        ranking_ = ranking;
+        std::cout << "[+] Puntuación: "
+                  << Infrastructure::RankingParameters::ModelName(ranking_.model)
+                  << " (k1=" << ranking_.k1 << ", b=" << ranking_.b << ")" << std::endl;
+
+        const std::string accumulator = Shared::EnvUtils::GetEnv("SCORE_ACCUMULATOR", "double");
+        if (!Infrastructure::BM25Engine::ParseScoreAccumulator(accumulator, score_accumulator_))
+        {
+            std::cerr << "[-] SCORE_ACCUMULATOR desconocido (" << accumulator
+                      << "), usando double" << std::endl;
+        }
+        else if (score_accumulator_ != Infrastructure::ScoreAccumulator::DOUBLE)
+        {
+            std::cout << "[+] Acumuladores de puntuación en "
+                      << Infrastructure::BM25Engine::ScoreAccumulatorName(score_accumulator_)
+                      << std::endl;
+        }
+
+        const std::string order = Shared::EnvUtils::GetEnv("DOCUMENT_ORDER", "arrival");
+        if (!Infrastructure::DocumentReordering::ParseOrder(order, document_order_))
+        {
+            std::cerr << "[-] DOCUMENT_ORDER desconocido (" << order << "), usando arrival"
+                      << std::endl;
+        }
+        else if (document_order_ != Infrastructure::DocumentOrder::ARRIVAL)
+        {
+            std::cout << "[+] Orden de documentos al compactar: "
+                      << Infrastructure::DocumentReordering::OrderName(document_order_)
+                      << std::endl;
+        }
+
+        two_phase_default_ = Shared::EnvUtils::GetEnv("TWO_PHASE", "false") == "true";
+        try
+        {
+            Infrastructure::TwoPhaseOptions two_phase;
+            two_phase.candidates =
+                std::stoul(Shared::EnvUtils::GetEnv("TWO_PHASE_CANDIDATES", "300"));
+            two_phase.posting_budget =
+                std::stoul(Shared::EnvUtils::GetEnv("TWO_PHASE_POSTING_BUDGET", "100000"));
+            two_phase.proximity_weight =
+                std::stod(Shared::EnvUtils::GetEnv("TWO_PHASE_PROXIMITY_WEIGHT", "0"));
+            const size_t sampling =
+                std::stoul(Shared::EnvUtils::GetEnv("TWO_PHASE_SAMPLE_EVERY", "100"));
+            if (two_phase.candidates == 0 || two_phase.proximity_weight < 0.0)
+            {
+                throw std::invalid_argument("TWO_PHASE");
+            }
+            two_phase_ = two_phase;
+            two_phase_sampling_ = sampling;
+        }
+        catch (const std::exception&)
+        {
+            std::cerr << "[-] TWO_PHASE_CANDIDATES, TWO_PHASE_POSTING_BUDGET, "
+                         "TWO_PHASE_PROXIMITY_WEIGHT o TWO_PHASE_SAMPLE_EVERY inválidos, usando "
+                         "300, 100000, 0 y 100"
+                      << std::endl;
+        }
+        if (two_phase_default_)
+        {
+            std::cout << "[+] Búsqueda en dos fases: " << two_phase_.candidates
+                      << " candidatos, " << two_phase_.posting_budget
+                      << " postings en la primera fase" << std::endl;
+        }
     }
 
-    void SearchService::LoadExistingDocuments()
+    void SearchService::ApplyEngineSettings(Infrastructure::ShardedEngine& engine) const
     {
-        try
+        engine.SetCompactionRatio(compaction_ratio_);
+        engine.SetExpansionLimits(fuzzy_penalty_, max_expansions_);
+        engine.SetRankingParameters(ranking_);
+        engine.SetScoreAccumulator(score_accumulator_);
+        engine.SetTwoPhaseSampling(two_phase_sampling_);
+        engine.SetDocumentOrder(document_order_);
+        if (memory_budget_ > 0)
         {
-            auto data_dir = get_system_data_dir();
-            auto index_file = data_dir / "document_index.json";
+            engine.SetMemoryBudget(memory_budget_, cold_directory_);
+        }
+    }
 
-            if (!std::filesystem::exists(index_file))
+    void SearchService::ConfigureNodeRole()
+    {
+        const std::string role = Shared::EnvUtils::GetEnv("NODE_ROLE", "standalone");
+        if (role == "worker")
+        {
+            role_ = NodeRole::WORKER;
+            std::cout << "[+] Nodo worker: fases de búsqueda en /internal/shard/" << std::endl;
+            return;
+        }
+        if (role != "coordinator")
+        {
+            if (role != "standalone")
             {
-                return;
+                std::cerr << "[-] NODE_ROLE desconocido: " << role << ", usando standalone"
+                          << std::endl;
             }
+            return;
+        }
 
-            std::ifstream file(index_file);
-            if (!file.is_open())
+        try
+        {
+            auto nodes = Infrastructure::ShardCoordinator::ParseNodes(
+                Shared::EnvUtils::GetEnv("SHARD_NODES", ""));
+            if (nodes.empty())
             {
+                std::cerr << "[-] NODE_ROLE=coordinator sin SHARD_NODES, usando standalone"
+                          << std::endl;
                 return;
             }
 
-            nlohmann::json index;
-            file >> index;
+            std::chrono::milliseconds timeout(
+                std::stoul(Shared::EnvUtils::GetEnv("SHARD_TIMEOUT_MS", "2000")));
+            coordinator_ =
+                std::make_unique<Infrastructure::ShardCoordinator>(std::move(nodes), timeout);
+            role_ = NodeRole::COORDINATOR;
+            std::cout << "[+] Nodo coordinador con " << coordinator_->GetNodeCount()
+                      << " workers (plazo " << timeout.count() << " ms)" << std::endl;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "[-] SHARD_NODES o SHARD_TIMEOUT_MS inválidos (" << e.what()
+                      << "), usando standalone" << std::endl;
+        }
+    }
+
+    void SearchService::ConfigureReplication()
+    {
+        const std::string mode = Shared::EnvUtils::GetEnv("REPLICATION_MODE", "none");
+        if (mode == "none")
+        {
+            return;
+        }
+        if (mode != "publisher" && mode != "replica")
+        {
+            std::cerr << "[-] REPLICATION_MODE desconocido: " << mode << ", sin replicación"
+                      << std::endl;
+            return;
+        }
 
-            if (!index.is_array())
+        const std::string directory = Shared::EnvUtils::GetEnv("REPLICATION_DIR", "");
+        if (directory.empty())
+        {
+            std::cerr << "[-] REPLICATION_MODE=" << mode << " sin REPLICATION_DIR, sin replicación"
+                      << std::endl;
+            return;
+        }
+
+        try
+        {
+            replication_interval_ = std::chrono::milliseconds(
+                std::stoul(Shared::EnvUtils::GetEnv("REPLICATION_INTERVAL_MS", "1000")));
+        }
+        catch (const std::exception&)
+        {
+            std::cerr << "[-] REPLICATION_INTERVAL_MS inválido, usando 1000" << std::endl;
+        }
+
+        try
+        {
+            if (mode == "publisher")
+            {
+                publisher_ = std::make_unique<Infrastructure::SegmentPublisher>(directory);
+                replication_mode_ = ReplicationMode::PUBLISHER;
+                std::cout << "[+] Publicando segmentos en " << directory << std::endl;
+            }
+            else
+            {
+                replica_ = std::make_unique<Infrastructure::SegmentReplica>(directory, analyzer_);
+                replication_mode_ = ReplicationMode::REPLICA;
+                std::cout << "[+] Réplica de solo lectura de " << directory << std::endl;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "[-] No se pudo preparar " << directory << " (" << e.what()
+                      << "), sin replicación" << std::endl;
+        }
+    }
+
+    void SearchService::ConfigureSnapshots()
+    {
+        // Por defecto dentro del directorio de datos: los enlaces duros no cruzan volúmenes
+        const std::string directory = Shared::EnvUtils::GetEnv("SNAPSHOT_DIR", "");
+        const std::filesystem::path path = directory.empty()
+                                               ? catalog_->GetDataRoot() / "snapshots"
+                                               : std::filesystem::path(directory);
+        try
+        {
+            snapshots_ =
+                std::make_unique<Infrastructure::SnapshotStore>(path, catalog_, content_hashes_);
+            std::cout << "[+] Copias de seguridad en " << path << std::endl;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "[-] No se pudo preparar SNAPSHOT_DIR (" << path << "): " << e.what()
+                      << std::endl;
+        }
+    }
+
+    void SearchService::Replicate()
+    {
+        try
+        {
+            if (publisher_)
             {
+                if (publisher_->Publish(*Engine()))
+                {
+                    std::cout << "[+] Generación " << publisher_->GetStatus().generation
+                              << " publicada" << std::endl;
+                }
                 return;
             }
 
-            size_t loaded_count = 0;
-            for (const auto& doc : index)
+            if (auto engine = replica_->Refresh())
             {
-                if (doc.contains("id") && doc.contains("path"))
+                ApplyEngineSettings(*engine);
+                // Las búsquedas en curso terminan con el índice anterior
+                engine_.store(std::move(engine));
+                std::cout << "[+] Réplica: generación " << replica_->GetStatus().generation
+                          << " cargada (" << GetDocumentCount() << " documentos)" << std::endl;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "[-] Error de replicación: " << e.what() << std::endl;
+        }
+    }
+
+    void SearchService::RunReplication(std::stop_token stop)
+    {
+        std::unique_lock<std::mutex> lock(replication_mutex_);
+        while (!stop.stop_requested())
+        {
+            lock.unlock();
+            Replicate();
+            lock.lock();
+            replication_wakeup_.wait_for(lock, stop, replication_interval_, []() { return false; });
+        }
+    }
+
+    void SearchService::LoadExistingDocuments()
+    {
+        for (const auto& entry : catalog_->GetEntries())
+        {
+            try
+            {
+                // Leer contenido del archivo
+                std::ifstream doc_file(entry.path);
+                if (doc_file.is_open())
                 {
-                    try
-                    {
-                        std::string file_path = doc["path"];
-
-                        // Leer contenido del archivo
-                        std::ifstream doc_file(file_path);
-                        if (doc_file.is_open())
-                        {
-                            std::stringstream buffer;
-                            buffer << doc_file.rdbuf();
-                            std::string content = buffer.str();
-
-                            if (!content.empty())
-                            {
-                                engine_->IndexDocument(static_cast<size_t>(loaded_count), content);
-                                loaded_count++;
-                            }
-                        }
-                    }
-                    catch (const std::exception& e)
+                    std::stringstream buffer;
+                    buffer << doc_file.rdbuf();
+                    std::string content = buffer.str();
+
+                    // Mismo ID estable que en la subida
+                    if (!content.empty())
                     {
-                        std::cerr << "[-] Error al procesar documento: " << e.what() << std::endl;
+                        Engine()->IndexDocument(entry.id, content,
+                                                {entry.filename, entry.timestamp});
                     }
                 }
             }
+            catch (const std::exception& e)
+            {
+                std::cerr << "[-] Error al procesar documento: " << e.what() << std::endl;
+            }
         }
-        catch (const std::exception& e)
+    }
+
+    Models::SearchResponse SearchService::Search(const Models::SearchRequest& request) const
+    {
+        Infrastructure::QueryOptions options =
+            query_options(request, ranking_, two_phase_, two_phase_default_);
+
+        auto engine = Engine();
+        if (request.paginate)
+        {
+            return OpenCursor(std::move(engine), request.query, options, request.limit);
+        }
+
+        Models::SearchResponse response;
+        std::vector<Infrastructure::SearchResult> results;
+        Infrastructure::FacetCounts facets;
+        Infrastructure::SearchCoverage coverage;
+        if (coordinator_)
+        {
+            auto distributed =
+                coordinator_->Search(*engine, request.query, request.limit, options);
+            results = std::move(distributed.results);
+            facets = std::move(distributed.facets);
+            coverage = distributed.coverage;
+            response.nodes_total = distributed.node_count;
+            response.nodes_failed = distributed.failed_nodes;
+        }
+        else
+        {
+            results = engine->Search(request.query, request.limit, options, &facets, &coverage);
+        }
+        response.timed_out = coverage.partial;
+        response.quality = coverage.GetQuality();
+
+        response.results.reserve(results.size());
+        for (auto& result : results)
+        {
+            auto& item =
+                response.results.emplace_back(result.content, result.score, result.document_id);
+            item.node = std::move(result.node);
+            item.filename = std::move(result.filename);
+            item.timestamp = result.timestamp;
+        }
+        response.facets = to_facets(facets, options.facets);
+
+        return response;
+    }
+
+    std::vector<Models::SearchResponse> SearchService::SearchBatch(
+        const Models::SearchBatchRequest& request) const
+    {
+        std::vector<Models::SearchResponse> responses;
+        responses.reserve(request.queries.size());
+        if (coordinator_)
+        {
+            // El protocolo entre nodos es de una consulta por petición
+            for (const auto& query : request.queries)
+            {
+                responses.push_back(Search(query));
+            }
+            return responses;
+        }
+
+        // El lote solo devuelve resultados y no tiene hora límite: las consultas con facetas
+        // o timeout_ms van por separado
+        std::vector<Infrastructure::BatchQuery> queries;
+        std::vector<size_t> batched;
+        responses.resize(request.queries.size());
+        for (size_t q = 0; q < request.queries.size(); ++q)
+        {
+            const Models::SearchRequest& query = request.queries[q];
+            if (!query.facets.empty() || query.timeout_ms)
+            {
+                responses[q] = Search(query);
+                continue;
+            }
+            auto& batch_query = queries.emplace_back();
+            batch_query.query = query.query;
+            batch_query.max_results = query.limit;
+            batch_query.options = query_options(query, ranking_, two_phase_, two_phase_default_);
+            batched.push_back(q);
+        }
+
+        auto batch_results = Engine()->SearchBatch(queries);
+        for (size_t i = 0; i < batched.size(); ++i)
+        {
+            auto& response = responses[batched[i]];
+            response.results.reserve(batch_results[i].size());
+            for (auto& result : batch_results[i])
+            {
+                auto& item = response.results.emplace_back(result.content, result.score,
+                                                           result.document_id);
+                item.filename = std::move(result.filename);
+                item.timestamp = result.timestamp;
+            }
+        }
+        return responses;
+    }
+
+    uint64_t SearchService::EstimateCost(const Models::SearchRequest& request) const
+    {
+        return Engine()->EstimateCost(
+            request.query, query_options(request, ranking_, two_phase_, two_phase_default_));
+    }
+
+    uint64_t SearchService::EstimateCost(const Models::SearchBatchRequest& request) const
+    {
+        auto engine = Engine();
+        uint64_t cost = 0;
+        for (const auto& query : request.queries)
+        {
+            cost += engine->EstimateCost(
+                query.query, query_options(query, ranking_, two_phase_, two_phase_default_));
+        }
+        return cost;
+    }
+
+    Models::SearchResponse SearchService::OpenCursor(
+        std::shared_ptr<const Infrastructure::ShardedEngine> engine, const std::string& query,
+        const Infrastructure::QueryOptions& options, size_t limit) const
+    {
+        auto snapshot = std::make_shared<Infrastructure::CursorSnapshot>();
+        snapshot->query = query;
+        snapshot->options = options;
+        // Las facetas solo acompañan a la primera página
+        snapshot->options.facets.clear();
+        Infrastructure::FacetCounts facets;
+        if (coordinator_)
+        {
+            // El texto llega de los workers junto a los resultados: se guarda con ellos
+            auto distributed = coordinator_->Search(
+                *engine, query, Infrastructure::CursorCache::MAX_RANKING, options);
+            snapshot->ranking = std::move(distributed.results);
+            facets = std::move(distributed.facets);
+            snapshot->nodes_total = distributed.node_count;
+            snapshot->nodes_failed = distributed.failed_nodes;
+        }
+        else
+        {
+            // Solo IDs, puntuaciones y metadatos: el texto se lee al servir cada página
+            Infrastructure::QueryOptions ranking_options = options;
+            ranking_options.omit_content = true;
+            snapshot->ranking = engine->Search(query, Infrastructure::CursorCache::MAX_RANKING,
+                                               ranking_options, &facets);
+            snapshot->engine = std::move(engine);
+        }
+        snapshot->truncated = snapshot->ranking.size() == Infrastructure::CursorCache::MAX_RANKING;
+
+        Infrastructure::CursorPosition position{snapshot};
+        position.id = cursors_->Insert(std::move(snapshot));
+        Models::SearchResponse response = ReadPage(position, limit);
+        response.facets = to_facets(facets, options.facets);
+        return response;
+    }
+
+    Models::SearchResponse SearchService::ReadPage(const Infrastructure::CursorPosition& position,
+                                                   size_t limit) const
+    {
+        const Infrastructure::CursorSnapshot& snapshot = *position.snapshot;
+        const auto& ranking = snapshot.ranking;
+        const size_t begin = std::min(position.offset, ranking.size());
+        const size_t end = std::min(begin + limit, ranking.size());
+
+        Models::SearchResponse response;
+        response.nodes_total = snapshot.nodes_total;
+        response.nodes_failed = snapshot.nodes_failed;
+        response.results.reserve(end - begin);
+        if (snapshot.engine)
+        {
+            std::vector<Infrastructure::ExternalDocumentId> document_ids;
+            document_ids.reserve(end - begin);
+            for (size_t i = begin; i < end; ++i)
+            {
+                document_ids.push_back(ranking[i].document_id);
+            }
+
+            auto contents = snapshot.engine->GetContents(document_ids);
+            for (size_t i = begin; i < end; ++i)
+            {
+                // Sin texto: se eliminó después de abrir el cursor
+                if (const auto& content = contents[i - begin])
+                {
+                    auto& item = response.results.emplace_back(*content, ranking[i].score,
+                                                                ranking[i].document_id);
+                    item.filename = ranking[i].filename;
+                    item.timestamp = ranking[i].timestamp;
+                }
+            }
+        }
+        else
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                auto& item = response.results.emplace_back(ranking[i].content, ranking[i].score,
+                                                           ranking[i].document_id);
+                item.node = ranking[i].node;
+                item.filename = ranking[i].filename;
+                item.timestamp = ranking[i].timestamp;
+            }
+        }
+
+        if (end < ranking.size() || snapshot.truncated)
+        {
+            response.next_cursor = Infrastructure::CursorCache::MakeToken(position.id, end);
+        }
+        return response;
+    }
+
+    std::optional<Models::SearchResponse> SearchService::SearchPage(
+        const Models::SearchPageRequest& request) const
+    {
+        auto position = cursors_->Find(request.cursor);
+        if (!position)
+        {
+            return std::nullopt;
+        }
+
+        const Infrastructure::CursorSnapshot& snapshot = *position->snapshot;
+        if (position->offset < snapshot.ranking.size() || !snapshot.truncated)
+        {
+            return ReadPage(*position, request.limit);
+        }
+
+        // Fin de la clasificación guardada: otro cursor tras el último resultado, sobre el
+        // mismo índice fijado
+        const auto& last = snapshot.ranking.back();
+        Infrastructure::QueryOptions options = snapshot.options;
+        options.search_after = Infrastructure::SearchAfter{last.score, last.document_id};
+        return OpenCursor(snapshot.engine ? snapshot.engine : Engine(), snapshot.query, options,
+                          request.limit);
+    }
+
+    std::unique_ptr<Infrastructure::QueryNode> SearchService::PrepareShardQuery(
+        const Infrastructure::ShardedEngine& engine,
+        const Infrastructure::ShardRequest& request) const
+    {
+        auto root = engine.ParseQuery(request.query, request.options);
+        if (request.expansions)
         {
-            std::cerr << "[-] Error al cargar documentos existentes: " << e.what() << std::endl;
+            engine.ApplyExpansions(
+                *root, Infrastructure::ShardProtocol::BindExpansions(*root, *request.expansions));
         }
+        return root;
+    }
+
+    std::string SearchService::ShardExpansions(const std::string& body) const
+    {
+        auto engine = Engine();
+        auto request = Infrastructure::ShardProtocol::DecodeRequest(body);
+        auto root = engine->ParseQuery(request.query, request.options);
+        return Infrastructure::ShardProtocol::EncodeExpansions(
+            Infrastructure::ShardProtocol::IndexExpansions(*root,
+                                                           engine->CollectExpansions(*root)));
     }
 
-    std::vector<Models::SearchResult> SearchService::Search(
-        const Models::SearchRequest& request) const
+    std::string SearchService::ShardStatistics(const std::string& body) const
     {
-        auto results = engine_->Search(request.query, request.limit);
-        std::vector<Models::SearchResult> model_results;
-        model_results.reserve(results.size());
+        auto engine = Engine();
+        auto root =
+            PrepareShardQuery(*engine, Infrastructure::ShardProtocol::DecodeRequest(body));
+        return Infrastructure::ShardProtocol::EncodeStatistics(engine->CollectStatistics(*root));
+    }
 
-        for (const auto& result : results)
+    std::string SearchService::ShardSearch(const std::string& body) const
+    {
+        auto request = Infrastructure::ShardProtocol::DecodeRequest(body);
+        if (!request.statistics)
         {
-            model_results.emplace_back(result.content, result.score, result.document_id);
+            throw std::invalid_argument("faltan las estadísticas globales");
         }
 
-        return model_results;
+        auto engine = Engine();
+        auto root = PrepareShardQuery(*engine, request);
+        Infrastructure::ShardResults shard_results;
+        shard_results.results = engine->Search(*root, *request.statistics, request.max_results,
+                                               request.options, &shard_results.facets,
+                                               &shard_results.coverage);
+        return Infrastructure::ShardProtocol::EncodeResults(shard_results);
+    }
+
+    std::vector<Models::Suggestion> SearchService::Suggest(
+        const Models::SuggestRequest& request) const
+    {
+        // Se conserva lo escrito antes de la última palabra tal cual lo tecleó el usuario
+        size_t last_space = request.prefix.find_last_of(" \t");
+        std::string head =
+            last_space == std::string::npos ? "" : request.prefix.substr(0, last_space + 1);
+
+        std::vector<Models::Suggestion> suggestions;
+        for (auto& suggestion : Engine()->Suggest(request.prefix, request.limit))
+        {
+            std::string text = head + suggestion.word;
+            suggestions.push_back(
+                {std::move(text), std::move(suggestion.word), suggestion.document_frequency});
+        }
+        return suggestions;
     }
 
     bool SearchService::IndexDocument(const Models::IndexDocumentRequest& request)
     {
-        if (!request.IsValid())
+        if (!request.IsValid() || IsReadOnly())
         {
             return false;
         }
 
-        engine_->IndexDocument(request.document_id, request.content);
+        Engine()->IndexDocument(request.document_id, request.content,
+                                {request.filename, request.timestamp, request.directory});
         return true;
     }
 
+    bool SearchService::DeleteDocument(uint64_t document_id)
+    {
+        return !IsReadOnly() && Engine()->DeleteDocument(document_id);
+    }
+
+    bool SearchService::UpdateDocument(const Models::IndexDocumentRequest& request)
+    {
+        if (!request.IsValid() || IsReadOnly())
+        {
+            return false;
+        }
+
+        return Engine()->UpdateDocument(request.document_id, request.content,
+                                        {request.filename, request.timestamp, request.directory});
+    }
+
     size_t SearchService::IndexDocuments(const Models::IndexDocumentsRequest& request)
     {
         size_t indexed_count = 0;
+        if (IsReadOnly())
+        {
+            return indexed_count;
+        }
+
         try
         {
             // Usar el número óptimo de hilos basado en el hardware
@@ -172,7 +911,13 @@ namespace DocuTrace::Services
             // Usar un tamaño de batch apropiado
             size_t batch_size = std::max(size_t(100), request.documents.size() / (num_threads * 2));
 
-            indexed_count = engine_->IndexDocuments(request.documents, num_threads, batch_size);
+            // Sin ID inicial se reservan IDs del catálogo para no chocar con las subidas
+            uint64_t first_id = request.first_document_id != 0
+                                    ? request.first_document_id
+                                    : catalog_->ReserveIds(request.documents.size());
+
+            indexed_count =
+                Engine()->IndexDocuments(request.documents, first_id, num_threads, batch_size);
         }
         catch (const std::exception& e)
         {
@@ -183,18 +928,204 @@ namespace DocuTrace::Services
 
     Models::SystemStats SearchService::GetStats() const
     {
+        auto engine = Engine();
         Models::SystemStats stats;
-        stats.total_documents = GetDocumentCount();
+        stats.total_documents = engine->GetDocumentCount();
+        stats.pending_deletions = engine->GetTombstoneCount();
+        stats.total_terms = engine->GetTermCount();
+        stats.total_postings = engine->GetPostingCount();
+        stats.suggestion_words = engine->GetSuggestionWordCount();
         stats.engine_type = "BM25 Concurrent";
         stats.version = "2.0.0";
+
+        Infrastructure::ReplicationStatus replication;
+        if (publisher_)
+        {
+            stats.replication_mode = "publisher";
+            replication = publisher_->GetStatus();
+        }
+        else if (replica_)
+        {
+            stats.replication_mode = "replica";
+            replication = replica_->GetStatus();
+        }
+        stats.replication_generation = replication.generation;
+        stats.replication_latest_generation = replication.latest_generation;
+        stats.replication_lag_ms = replication.lag_ms;
+
+        Infrastructure::MemoryStatistics memory = engine->GetMemoryStatistics();
+        stats.memory_budget_bytes = memory.budget_bytes;
+        stats.memory_resident_bytes = memory.resident_bytes;
+        stats.memory_cold_bytes = memory.cold_bytes;
+        stats.memory_metadata_bytes = memory.metadata_bytes;
+        stats.posting_hits_resident = memory.posting_hits_resident;
+        stats.posting_hits_cold = memory.posting_hits_cold;
+        stats.document_hits_resident = memory.document_hits_resident;
+        stats.document_hits_cold = memory.document_hits_cold;
+        stats.open_cursors = cursors_->Size();
+        stats.ranking_model = Infrastructure::RankingParameters::ModelName(ranking_.model);
+
+        Infrastructure::TwoPhaseStatistics two_phase = engine->GetTwoPhaseStatistics();
+        stats.two_phase_queries = two_phase.queries;
+        if (two_phase.queries > 0)
+        {
+            const double queries = static_cast<double>(two_phase.queries);
+            stats.two_phase_candidates = static_cast<double>(two_phase.candidates) / queries;
+            stats.two_phase_deferred_terms =
+                static_cast<double>(two_phase.deferred_terms) / queries;
+            stats.two_phase_first_phase_ms =
+                static_cast<double>(two_phase.first_phase_us) / queries / 1000.0;
+            stats.two_phase_second_phase_ms =
+                static_cast<double>(two_phase.second_phase_us) / queries / 1000.0;
+        }
+        stats.two_phase_sampled_queries = two_phase.sampled_queries;
+        stats.two_phase_recall = two_phase.GetRecall();
+
+        Infrastructure::ReorderStatistics reorder = engine->GetReorderStatistics();
+        stats.document_order = Infrastructure::DocumentReordering::OrderName(document_order_);
+        stats.reorder_runs = reorder.runs;
+        stats.reorder_documents = reorder.documents;
+        stats.reorder_bits_per_posting_before = reorder.GetBitsPerPostingBefore();
+        stats.reorder_bits_per_posting_after = reorder.GetBitsPerPostingAfter();
+        stats.reorder_duration_ms = reorder.duration_ms;
+
+        Infrastructure::TermFilterStatistics filter = engine->GetTermFilterStatistics();
+        stats.term_filter_terms = filter.terms;
+        stats.term_filter_unsealed_terms = filter.unsealed_terms;
+        stats.term_filter_bits_per_term = filter.GetBitsPerTerm();
+        stats.term_filter_lookups = filter.GetLookups();
+        stats.term_filter_skip_rate = filter.GetSkipRate();
+        stats.term_filter_hit_rate = filter.GetHitRate();
+        stats.term_filter_false_positive_rate = filter.GetFalsePositiveRate();
         return stats;
     }
 
+    Models::SnapshotInfo SearchService::CreateSnapshot(const std::string& name)
+    {
+        if (!snapshots_)
+        {
+            throw std::runtime_error("copias de seguridad no disponibles");
+        }
+
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        auto info = snapshots_->Create(name, *Engine());
+        std::cout << "[+] Copia '" << info.name << "': " << info.documents << " documentos, "
+                  << info.linked_files << " enlaces, " << info.copied_files << " copiados, "
+                  << info.written_segments << " particiones selladas en " << info.duration_ms
+                  << " ms" << std::endl;
+        return to_model(info);
+    }
+
+    std::vector<Models::SnapshotInfo> SearchService::ListSnapshots() const
+    {
+        std::vector<Models::SnapshotInfo> snapshots;
+        if (snapshots_)
+        {
+            for (const auto& info : snapshots_->List())
+            {
+                snapshots.push_back(to_model(info));
+            }
+        }
+        return snapshots;
+    }
+
+    bool SearchService::DeleteSnapshot(const std::string& name)
+    {
+        if (!snapshots_)
+        {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        return snapshots_->Remove(name);
+    }
+
+    std::optional<Models::SnapshotRestoreResult> SearchService::RestoreSnapshot(
+        const std::string& name)
+    {
+        if (!snapshots_)
+        {
+            return std::nullopt;
+        }
+
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        auto info = snapshots_->Find(name);
+        if (!info)
+        {
+            return std::nullopt;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        // Se lee y se verifica entero antes de tocar el directorio de datos
+        auto engine = snapshots_->Open(name, analyzer_);
+        ApplyEngineSettings(*engine);
+
+        // Subidas, cambios y bajas esperan hasta publicar el índice nuevo: una que cayera entre
+        // restaurar el catálogo y sustituir el índice solo quedaría en el índice descartado
+        auto mutation_lock = catalog_->LockMutations();
+        std::unordered_set<uint64_t> removed;
+        for (const auto& entry : catalog_->GetEntries())
+        {
+            removed.insert(entry.id);
+        }
+        const auto entries = snapshots_->RestoreCatalog(name);
+
+        Models::SnapshotRestoreResult result;
+        result.snapshot = to_model(*info);
+        std::unordered_set<uint64_t> missing;
+        for (const auto& entry : entries)
+        {
+            removed.erase(entry.id);
+            missing.insert(entry.id);
+        }
+        result.removed_documents.assign(removed.begin(), removed.end());
+        std::sort(result.removed_documents.begin(), result.removed_documents.end());
+
+        // El índice se selló sin cambios de documentos desde que se fijó el catálogo: se
+        // quita lo que no está en él (carpetas rastreadas) y se recupera lo que faltaba
+        for (uint64_t document_id : engine->GetDocumentIds())
+        {
+            if (missing.erase(document_id) == 0)
+            {
+                engine->DeleteDocument(document_id);
+            }
+        }
+        for (const auto& entry : entries)
+        {
+            if (!missing.contains(entry.id))
+            {
+                continue;
+            }
+            std::string content = Shared::FileUtils::ExtractText(entry.path);
+            if (!content.empty())
+            {
+                engine->IndexDocument(entry.id, content, {entry.filename, entry.timestamp});
+                result.reindexed_documents++;
+            }
+        }
+        result.documents = engine->GetDocumentCount();
+
+        // Las búsquedas y los cursores en curso terminan con el índice anterior
+        engine_.store(std::move(engine));
+        result.duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
+        std::cout << "[+] Restaurada la copia '" << name << "': " << result.documents
+                  << " documentos (" << result.reindexed_documents << " reindexados, "
+                  << result.removed_documents.size() << " eliminados) en " << result.duration_ms
+                  << " ms" << std::endl;
+        return result;
+    }
+
     bool SearchService::ClearIndex()
     {
+        if (IsReadOnly())
+        {
+            return false;
+        }
+
         try
         {
-            engine_->Clear();
+            Engine()->Clear();
             return true;
         }
         catch (const std::exception& e)
@@ -235,7 +1166,7 @@ namespace DocuTrace::Services
 
     size_t SearchService::GetDocumentCount() const
     {
-        return engine_->GetDocumentCount();
+        return Engine()->GetDocumentCount();
     }
 
 } // namespace DocuTrace::Services
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "shared/binary_io.hpp"
+#include <stdexcept>
+
+namespace DocuTrace::Shared
+{
+    BinaryWriter::BinaryWriter(std::ostream& out) : out_(out)
+    {
+    }
+
+    void BinaryWriter::WriteBytes(const void* data, size_t length)
+    {
+        if (length == 0)
+        {
+            return;
+        }
+        out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(length));
+        if (!out_)
+        {
+            throw std::runtime_error("error de escritura");
+        }
+        hasher_.Update(data, length);
+        size_ += length;
+    }
+
+    void BinaryWriter::WriteString(std::string_view value)
+    {
+        Write<uint64_t>(value.size());
+        WriteBytes(value.data(), value.size());
+    }
+
+    BinaryReader::BinaryReader(std::istream& in) : in_(in)
+    {
+        std::streampos start = in_.tellg();
+        if (start != std::streampos(-1) && in_.seekg(0, std::ios::end))
+        {
+            remaining_ = static_cast<uint64_t>(in_.tellg() - start);
+            in_.seekg(start);
+        }
+        in_.clear();
+    }
+
+    void BinaryReader::ReadBytes(void* data, size_t length)
+    {
+        if (length == 0)
+        {
+            return;
+        }
+        if (length > remaining_ ||
+            !in_.read(static_cast<char*>(data), static_cast<std::streamsize>(length)))
+        {
+            throw std::runtime_error("datos truncados");
+        }
+        hasher_.Update(data, length);
+        size_ += length;
+        if (remaining_ != UINT64_MAX)
+        {
+            remaining_ -= length;
+        }
+    }
+
+    std::string BinaryReader::ReadString()
+    {
+        std::string value(CheckedCount(Read<uint64_t>(), 1), '\0');
+        ReadBytes(value.data(), value.size());
+        return value;
+    }
+
+    size_t BinaryReader::CheckedCount(uint64_t count, size_t element_size)
+    {
+        if (element_size != 0 && count > remaining_ / element_size)
+        {
+            throw std::runtime_error("datos truncados");
+        }
+        return static_cast<size_t>(count);
+    }
+
+} // namespace DocuTrace::Shared
@@ -0,0 +1,61 @@
+#include "shared/compression.hpp"
+#include <stdexcept>
+
+namespace DocuTrace::Shared
+{
+    namespace
+    {
+        constexpr size_t OUTPUT_STEP = 16 * 1024;
+    } // namespace
+
+    StreamCompressor::StreamCompressor(ContentEncoding encoding, int level)
+    {
+        // Ventana de 32 KB; +16 añade la cabecera y el CRC de gzip en lugar de los de zlib
+        const int window_bits = encoding == ContentEncoding::GZIP ? 15 + 16 : 15;
+        if (deflateInit2(&stream_, level, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            throw std::runtime_error("No se pudo inicializar zlib");
+        }
+    }
+
+    StreamCompressor::~StreamCompressor()
+    {
+        deflateEnd(&stream_);
+    }
+
+    void StreamCompressor::Deflate(std::string_view input, int flush, std::string& output)
+    {
+        stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        stream_.avail_in = static_cast<uInt>(input.size());
+
+        // Con Z_NO_FLUSH basta con consumir la entrada; con Z_FINISH hay que llegar al final
+        int result = Z_OK;
+        do
+        {
+            const size_t used = output.size();
+            output.resize(used + OUTPUT_STEP);
+            stream_.next_out = reinterpret_cast<Bytef*>(output.data() + used);
+            stream_.avail_out = static_cast<uInt>(OUTPUT_STEP);
+            result = deflate(&stream_, flush);
+            output.resize(used + OUTPUT_STEP - stream_.avail_out);
+            if (result == Z_STREAM_ERROR)
+            {
+                throw std::runtime_error("Error de zlib al comprimir");
+            }
+        } while (stream_.avail_out == 0 || (flush == Z_FINISH && result != Z_STREAM_END));
+    }
+
+    void StreamCompressor::Write(std::string_view input, std::string& output)
+    {
+        if (!input.empty())
+        {
+            Deflate(input, Z_NO_FLUSH, output);
+        }
+    }
+
+    void StreamCompressor::Finish(std::string& output)
+    {
+        Deflate({}, Z_FINISH, output);
+    }
+
+} // namespace DocuTrace::Shared
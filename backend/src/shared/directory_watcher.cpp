@@ -0,0 +1,153 @@
+#include "shared/directory_watcher.hpp"
+#include <algorithm>
+#include <thread>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace DocuTrace::Shared
+{
+    namespace
+    {
+#ifdef __linux__
+        // Cierre de una escritura, creación, borrado y movimientos; IN_MODIFY no, porque
+        // llega una vez por cada write() del editor
+        constexpr uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM |
+                                        IN_MOVED_TO | IN_ATTRIB | IN_ONLYDIR;
+
+        // Suficiente para cientos de eventos por lectura
+        constexpr size_t EVENT_BUFFER_SIZE = 64 * 1024;
+
+        bool is_within(const std::filesystem::path& path, const std::filesystem::path& directory)
+        {
+            auto [directory_end, path_end] =
+                std::mismatch(directory.begin(), directory.end(), path.begin(), path.end());
+            return directory_end == directory.end();
+        }
+#endif
+    } // namespace
+
+    DirectoryWatcher::DirectoryWatcher()
+    {
+#ifdef __linux__
+        descriptor_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+    }
+
+    DirectoryWatcher::~DirectoryWatcher()
+    {
+#ifdef __linux__
+        if (descriptor_ >= 0)
+        {
+            ::close(descriptor_);
+        }
+#endif
+    }
+
+    bool DirectoryWatcher::Watch(const std::filesystem::path& directory)
+    {
+#ifdef __linux__
+        if (descriptor_ < 0)
+        {
+            return false;
+        }
+        // El mismo directorio (p. ej. movido dentro del árbol) devuelve el mismo descriptor
+        const int watch = ::inotify_add_watch(descriptor_, directory.c_str(), WATCH_MASK);
+        if (watch < 0)
+        {
+            return false;
+        }
+        directories_[watch] = directory;
+        return true;
+#else
+        (void)directory;
+        return false;
+#endif
+    }
+
+    void DirectoryWatcher::Unwatch(const std::filesystem::path& directory)
+    {
+#ifdef __linux__
+        for (auto it = directories_.begin(); it != directories_.end();)
+        {
+            if (is_within(it->second, directory))
+            {
+                ::inotify_rm_watch(descriptor_, it->first);
+                it = directories_.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+#else
+        (void)directory;
+#endif
+    }
+
+    std::vector<WatchEvent> DirectoryWatcher::Poll(std::chrono::milliseconds timeout)
+    {
+        std::vector<WatchEvent> events;
+#ifdef __linux__
+        if (descriptor_ >= 0)
+        {
+            pollfd ready{descriptor_, POLLIN, 0};
+            if (::poll(&ready, 1, static_cast<int>(timeout.count())) <= 0)
+            {
+                return events;
+            }
+
+            alignas(inotify_event) char buffer[EVENT_BUFFER_SIZE];
+            ssize_t length;
+            while ((length = ::read(descriptor_, buffer, sizeof(buffer))) > 0)
+            {
+                for (ssize_t offset = 0; offset < length;)
+                {
+                    const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                    offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+                    if (event->mask & IN_Q_OVERFLOW)
+                    {
+                        events.push_back({WatchEventKind::OVERFLOW, {}, false});
+                        continue;
+                    }
+                    auto directory = directories_.find(event->wd);
+                    if (directory == directories_.end())
+                    {
+                        continue;
+                    }
+                    // El directorio se borró o se desmontó: el kernel ya quitó la vigilancia
+                    if (event->mask & IN_IGNORED)
+                    {
+                        directories_.erase(directory);
+                        continue;
+                    }
+                    if (event->len == 0)
+                    {
+                        continue;
+                    }
+
+                    const bool removed = event->mask & (IN_DELETE | IN_MOVED_FROM);
+                    const bool is_directory = event->mask & IN_ISDIR;
+                    std::filesystem::path path = directory->second / event->name;
+                    // Uno borrado ya no está vigilado (IN_IGNORED); uno movido sí, con la ruta
+                    // de antes
+                    if (is_directory && (event->mask & IN_MOVED_FROM))
+                    {
+                        Unwatch(path);
+                    }
+                    events.push_back({removed ? WatchEventKind::REMOVED : WatchEventKind::CHANGED,
+                                      std::move(path), is_directory});
+                }
+            }
+            return events;
+        }
+#endif
+        std::this_thread::sleep_for(timeout);
+        return events;
+    }
+
+} // namespace DocuTrace::Shared
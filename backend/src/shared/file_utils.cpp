@@ -0,0 +1,196 @@
+#include "shared/file_utils.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace DocuTrace::Shared
+{
+    std::filesystem::path FileUtils::GetAppDataDir()
+    {
+        std::filesystem::path data_dir;
+
+#ifdef _WIN32
+        // Windows: %APPDATA%\DocuTrace
+        const char* appdata = std::getenv("APPDATA");
+        if (appdata)
+        {
+            data_dir = std::filesystem::path(appdata) / "DocuTrace";
+        }
+        else
+        {
+            const char* userprofile = std::getenv("USERPROFILE");
+            if (userprofile)
+            {
+                data_dir = std::filesystem::path(userprofile) / "AppData" / "Roaming" / "DocuTrace";
+            }
+            else
+            {
+                data_dir = std::filesystem::current_path() / "data";
+            }
+        }
+#elif __APPLE__
+        // macOS: ~/Library/Application Support/DocuTrace
+        const char* home = std::getenv("HOME");
+        if (home)
+        {
+            data_dir =
+                std::filesystem::path(home) / "Library" / "Application Support" / "DocuTrace";
+        }
+        else
+        {
+            data_dir = std::filesystem::current_path() / "data";
+        }
+#else
+        // Linux: ~/.local/share/DocuTrace
+        const char* home = std::getenv("HOME");
+        if (home)
+        {
+            data_dir = std::filesystem::path(home) / ".local" / "share" / "DocuTrace";
+        }
+        else
+        {
+            data_dir = std::filesystem::current_path() / "data";
+        }
+#endif
+
+        // DATA_DIR separa los datos de varias instancias en una misma máquina
+        const char* custom_dir = std::getenv("DATA_DIR");
+        if (custom_dir && *custom_dir)
+        {
+            data_dir = custom_dir;
+        }
+
+        // Crear el directorio si no existe
+        std::error_code ec;
+        std::filesystem::create_directories(data_dir, ec);
+
+        if (ec)
+        {
+            std::cerr << "[-] Error al crear directorio de datos: " << ec.message() << std::endl;
+            data_dir = std::filesystem::current_path() / "data";
+            std::filesystem::create_directories(data_dir);
+        }
+
+        return data_dir;
+    }
+
+    std::string FileUtils::ExtractText(const std::string& filepath)
+    {
+        // Verificar que el archivo existe
+        std::error_code ec;
+        if (!std::filesystem::exists(filepath, ec))
+        {
+            std::cerr << "[-] Archivo no existe: " << filepath << std::endl;
+            return "";
+        }
+
+        if (ec)
+        {
+            std::cerr << "[-] Error al verificar archivo: " << ec.message() << std::endl;
+            return "";
+        }
+
+        // Verificar que es un archivo regular
+        if (!std::filesystem::is_regular_file(filepath, ec))
+        {
+            std::cerr << "[-] No es un archivo regular: " << filepath << std::endl;
+            return "";
+        }
+
+        // Leer contenido del archivo
+        std::ifstream file(filepath, std::ios::in);
+        if (!file.is_open())
+        {
+            std::cerr << "[-] No se pudo abrir archivo para lectura: " << filepath << std::endl;
+            return "";
+        }
+
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+
+        if (file.bad())
+        {
+            std::cerr << "[-] Error al leer archivo: " << filepath << std::endl;
+            return "";
+        }
+
+        return buffer.str();
+    }
+
+    bool FileUtils::WriteFileAtomic(const std::filesystem::path& filepath, std::string_view data)
+    {
+        auto temp_path = filepath;
+        temp_path += ".tmp";
+
+        {
+            std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+            if (!out.is_open())
+            {
+                std::cerr << "[-] No se pudo abrir " << temp_path << " para escritura" << std::endl;
+                return false;
+            }
+
+            out.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (out.fail())
+            {
+                std::cerr << "[-] Error al escribir " << temp_path << std::endl;
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(temp_path, filepath, ec);
+        if (ec)
+        {
+            std::cerr << "[-] Error al reemplazar " << filepath << ": " << ec.message() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool FileUtils::LinkOrCopyFile(const std::filesystem::path& source,
+                                   const std::filesystem::path& target, bool* copied)
+    {
+        std::error_code ec;
+        if (std::filesystem::equivalent(source, target, ec))
+        {
+            // Ya es el mismo archivo: rename() no haría nada y dejaría el temporal
+            if (copied)
+            {
+                *copied = false;
+            }
+            return true;
+        }
+
+        auto temp_path = target;
+        temp_path += ".tmp";
+        std::filesystem::remove(temp_path, ec);
+        std::filesystem::create_hard_link(source, temp_path, ec);
+        const bool linked = !ec;
+        if (!linked)
+        {
+            std::filesystem::copy_file(source, temp_path, ec);
+            if (ec)
+            {
+                std::cerr << "[-] No se pudo enlazar ni copiar " << source << ": " << ec.message()
+                          << std::endl;
+                return false;
+            }
+        }
+
+        std::filesystem::rename(temp_path, target, ec);
+        if (ec)
+        {
+            std::cerr << "[-] Error al reemplazar " << target << ": " << ec.message() << std::endl;
+            std::filesystem::remove(temp_path, ec);
+            return false;
+        }
+        if (copied)
+        {
+            *copied = !linked;
+        }
+        return true;
+    }
+
+} // namespace DocuTrace::Shared
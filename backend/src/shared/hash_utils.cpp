@@ -0,0 +1,227 @@
+#include "shared/hash_utils.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+
+namespace DocuTrace::Shared
+{
+    namespace
+    {
+        constexpr uint64_t PRIME1 = 11400714785074694791ULL;
+        constexpr uint64_t PRIME2 = 14029467366897019727ULL;
+        constexpr uint64_t PRIME3 = 1609587929392839161ULL;
+        constexpr uint64_t PRIME4 = 9650029242287828579ULL;
+        constexpr uint64_t PRIME5 = 2870177450012600261ULL;
+
+        uint64_t read64(const unsigned char* p)
+        {
+            uint64_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        uint32_t read32(const unsigned char* p)
+        {
+            uint32_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        uint64_t round(uint64_t acc, uint64_t input)
+        {
+            acc += input * PRIME2;
+            acc = std::rotl(acc, 31);
+            return acc * PRIME1;
+        }
+
+        uint64_t merge_round(uint64_t acc, uint64_t value)
+        {
+            acc ^= round(0, value);
+            return acc * PRIME1 + PRIME4;
+        }
+    } // namespace
+
+    // ============================================================================
+    // IMPLEMENTACIÓN DE ContentHasher (XXH64)
+    // ============================================================================
+
+    ContentHasher::ContentHasher(uint64_t seed)
+    {
+        Reset(seed);
+    }
+
+    void ContentHasher::Reset(uint64_t seed)
+    {
+        seed_ = seed;
+        accumulators_ = {seed + PRIME1 + PRIME2, seed + PRIME2, seed, seed - PRIME1};
+        buffer_size_ = 0;
+        total_length_ = 0;
+    }
+
+    void ContentHasher::Update(const void* data, size_t length)
+    {
+        const auto* input = static_cast<const unsigned char*>(data);
+        total_length_ += length;
+
+        // Completar el bloque pendiente de la llamada anterior
+        if (buffer_size_ > 0)
+        {
+            size_t to_copy = std::min(length, STRIPE_SIZE - buffer_size_);
+            std::memcpy(buffer_.data() + buffer_size_, input, to_copy);
+            buffer_size_ += to_copy;
+            input += to_copy;
+            length -= to_copy;
+
+            if (buffer_size_ < STRIPE_SIZE)
+            {
+                return;
+            }
+
+            for (size_t lane = 0; lane < 4; ++lane)
+            {
+                accumulators_[lane] = round(accumulators_[lane], read64(buffer_.data() + lane * 8));
+            }
+            buffer_size_ = 0;
+        }
+
+        while (length >= STRIPE_SIZE)
+        {
+            for (size_t lane = 0; lane < 4; ++lane)
+            {
+                accumulators_[lane] = round(accumulators_[lane], read64(input + lane * 8));
+            }
+            input += STRIPE_SIZE;
+            length -= STRIPE_SIZE;
+        }
+
+        if (length > 0)
+        {
+            std::memcpy(buffer_.data(), input, length);
+            buffer_size_ = length;
+        }
+    }
+
+    void ContentHasher::Update(std::string_view data)
+    {
+        Update(data.data(), data.size());
+    }
+
+    uint64_t ContentHasher::Digest() const
+    {
+        uint64_t hash;
+        if (total_length_ >= STRIPE_SIZE)
+        {
+            hash = std::rotl(accumulators_[0], 1) + std::rotl(accumulators_[1], 7) +
+                   std::rotl(accumulators_[2], 12) + std::rotl(accumulators_[3], 18);
+            for (uint64_t acc : accumulators_)
+            {
+                hash = merge_round(hash, acc);
+            }
+        }
+        else
+        {
+            hash = seed_ + PRIME5;
+        }
+
+        hash += total_length_;
+
+        // Procesar los bytes que quedaron en el buffer
+        const unsigned char* p = buffer_.data();
+        size_t remaining = buffer_size_;
+        while (remaining >= 8)
+        {
+            hash ^= round(0, read64(p));
+            hash = std::rotl(hash, 27) * PRIME1 + PRIME4;
+            p += 8;
+            remaining -= 8;
+        }
+        if (remaining >= 4)
+        {
+            hash ^= static_cast<uint64_t>(read32(p)) * PRIME1;
+            hash = std::rotl(hash, 23) * PRIME2 + PRIME3;
+            p += 4;
+            remaining -= 4;
+        }
+        while (remaining > 0)
+        {
+            hash ^= static_cast<uint64_t>(*p) * PRIME5;
+            hash = std::rotl(hash, 11) * PRIME1;
+            ++p;
+            --remaining;
+        }
+
+        // Avalancha final
+        hash ^= hash >> 33;
+        hash *= PRIME2;
+        hash ^= hash >> 29;
+        hash *= PRIME3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+    // ============================================================================
+    // IMPLEMENTACIÓN DE HashUtils
+    // ============================================================================
+
+    uint64_t HashUtils::Hash64(std::string_view data, uint64_t seed)
+    {
+        ContentHasher hasher(seed);
+        hasher.Update(data);
+        return hasher.Digest();
+    }
+
+    uint64_t HashUtils::SimHash(const std::vector<std::string>& tokens)
+    {
+        if (tokens.empty())
+        {
+            return 0;
+        }
+
+        // Cada token vota +1/-1 en cada bit según su propio hash
+        std::array<int64_t, 64> votes{};
+        for (const auto& token : tokens)
+        {
+            uint64_t token_hash = Hash64(token);
+            for (size_t bit = 0; bit < 64; ++bit)
+            {
+                votes[bit] += ((token_hash >> bit) & 1ULL) ? 1 : -1;
+            }
+        }
+
+        uint64_t signature = 0;
+        for (size_t bit = 0; bit < 64; ++bit)
+        {
+            if (votes[bit] > 0)
+            {
+                signature |= (1ULL << bit);
+            }
+        }
+        return signature;
+    }
+
+    int HashUtils::HammingDistance(uint64_t a, uint64_t b)
+    {
+        return std::popcount(a ^ b);
+    }
+
+    std::string HashUtils::ToHex(uint64_t value)
+    {
+        char buffer[17];
+        std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+        return std::string(buffer);
+    }
+
+    uint64_t HashUtils::FromHex(const std::string& hex)
+    {
+        try
+        {
+            return std::stoull(hex, nullptr, 16);
+        }
+        catch (const std::exception&)
+        {
+            return 0;
+        }
+    }
+
+} // namespace DocuTrace::Shared
@@ -0,0 +1,250 @@
+#include "shared/http_client.hpp"
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace DocuTrace::Shared
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // Cierra el descriptor al salir de ámbito, también si se lanza una excepción
+        class Socket
+        {
+          private:
+            int fd_;
+
+          public:
+            explicit Socket(int fd) : fd_(fd)
+            {
+            }
+            ~Socket()
+            {
+                if (fd_ >= 0)
+                {
+                    ::close(fd_);
+                }
+            }
+            Socket(const Socket&) = delete;
+            Socket& operator=(const Socket&) = delete;
+
+            int Get() const
+            {
+                return fd_;
+            }
+        };
+
+        // Espera a que el socket esté listo para events sin pasarse de deadline
+        void wait_ready(int fd, short events, Clock::time_point deadline)
+        {
+            while (true)
+            {
+                auto remaining =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+                if (remaining.count() <= 0)
+                {
+                    throw std::runtime_error("tiempo de espera agotado");
+                }
+
+                pollfd descriptor{fd, events, 0};
+                int ready = ::poll(&descriptor, 1, static_cast<int>(remaining.count()));
+                if (ready > 0)
+                {
+                    return;
+                }
+                if (ready < 0 && errno != EINTR)
+                {
+                    throw std::runtime_error(std::string("poll: ") + std::strerror(errno));
+                }
+            }
+        }
+
+        int connect_to(const std::string& host, uint16_t port, Clock::time_point deadline)
+        {
+            addrinfo hints{};
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+
+            addrinfo* addresses = nullptr;
+            int status = ::getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints,
+                                       &addresses);
+            if (status != 0)
+            {
+                throw std::runtime_error("no se resuelve " + host + ": " + ::gai_strerror(status));
+            }
+
+            std::string last_error = "sin direcciones";
+            for (addrinfo* address = addresses; address; address = address->ai_next)
+            {
+                int fd = ::socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC,
+                                  address->ai_protocol);
+                if (fd < 0)
+                {
+                    last_error = std::strerror(errno);
+                    continue;
+                }
+                ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+                // Conexión no bloqueante para poder limitar su duración
+                if (::connect(fd, address->ai_addr, address->ai_addrlen) == 0 ||
+                    errno == EINPROGRESS)
+                {
+                    try
+                    {
+                        wait_ready(fd, POLLOUT, deadline);
+                        int error = 0;
+                        socklen_t length = sizeof(error);
+                        ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length);
+                        if (error == 0)
+                        {
+                            ::freeaddrinfo(addresses);
+                            return fd;
+                        }
+                        last_error = std::strerror(error);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        last_error = e.what();
+                    }
+                }
+                else
+                {
+                    last_error = std::strerror(errno);
+                }
+                ::close(fd);
+            }
+
+            ::freeaddrinfo(addresses);
+            throw std::runtime_error("no se pudo conectar a " + host + ":" +
+                                     std::to_string(port) + ": " + last_error);
+        }
+
+        // Longitud del cuerpo según Content-Length (npos si la cabecera no está)
+        size_t content_length(const std::string& headers)
+        {
+            size_t line = 0;
+            while ((line = headers.find("\r\n", line)) != std::string::npos)
+            {
+                line += 2;
+                size_t colon = headers.find(':', line);
+                if (colon == std::string::npos)
+                {
+                    break;
+                }
+
+                std::string name = headers.substr(line, colon - line);
+                for (auto& c : name)
+                {
+                    c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+                }
+                if (name == "content-length")
+                {
+                    return std::stoul(headers.substr(colon + 1));
+                }
+            }
+            return std::string::npos;
+        }
+    } // namespace
+
+    HttpResponse HttpClient::Post(const std::string& host, uint16_t port, const std::string& path,
+                                  const std::string& body, std::chrono::milliseconds timeout)
+    {
+        const Clock::time_point deadline = Clock::now() + timeout;
+        Socket socket(connect_to(host, port, deadline));
+
+        std::string request = "POST " + path + " HTTP/1.1\r\n" + "Host: " + host + ":" +
+                              std::to_string(port) + "\r\n" +
+                              "Content-Type: application/json\r\n" +
+                              "Content-Length: " + std::to_string(body.size()) + "\r\n" +
+                              "Connection: close\r\n\r\n" + body;
+
+        size_t sent = 0;
+        while (sent < request.size())
+        {
+            wait_ready(socket.Get(), POLLOUT, deadline);
+            ssize_t written =
+                ::send(socket.Get(), request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+            if (written < 0)
+            {
+                if (errno == EAGAIN || errno == EINTR)
+                {
+                    continue;
+                }
+                throw std::runtime_error(std::string("send: ") + std::strerror(errno));
+            }
+            sent += static_cast<size_t>(written);
+        }
+
+        // Leer hasta completar Content-Length o hasta que el servidor cierre
+        std::string response;
+        size_t header_end = std::string::npos;
+        size_t expected = std::string::npos;
+        char buffer[16384];
+        while (true)
+        {
+            if (header_end != std::string::npos && expected != std::string::npos &&
+                response.size() >= header_end + 4 + expected)
+            {
+                break;
+            }
+
+            wait_ready(socket.Get(), POLLIN, deadline);
+            ssize_t received = ::recv(socket.Get(), buffer, sizeof(buffer), 0);
+            if (received < 0)
+            {
+                if (errno == EAGAIN || errno == EINTR)
+                {
+                    continue;
+                }
+                throw std::runtime_error(std::string("recv: ") + std::strerror(errno));
+            }
+            if (received == 0)
+            {
+                break;
+            }
+            response.append(buffer, static_cast<size_t>(received));
+
+            if (header_end == std::string::npos)
+            {
+                header_end = response.find("\r\n\r\n");
+                if (header_end != std::string::npos)
+                {
+                    expected = content_length(response.substr(0, header_end + 2));
+                }
+            }
+        }
+
+        // Línea de estado: "HTTP/1.1 200 OK"
+        if (header_end == std::string::npos || response.compare(0, 5, "HTTP/") != 0)
+        {
+            throw std::runtime_error("respuesta HTTP inválida de " + host);
+        }
+        size_t space = response.find(' ');
+        if (space == std::string::npos || space > header_end)
+        {
+            throw std::runtime_error("respuesta HTTP inválida de " + host);
+        }
+
+        HttpResponse result;
+        result.status = std::atoi(response.c_str() + space + 1);
+        result.body = response.substr(header_end + 4);
+        if (expected != std::string::npos)
+        {
+            if (result.body.size() < expected)
+            {
+                throw std::runtime_error("respuesta incompleta de " + host);
+            }
+            result.body.resize(expected);
+        }
+        return result;
+    }
+
+} // namespace DocuTrace::Shared
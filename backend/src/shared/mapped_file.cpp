@@ -0,0 +1,123 @@
+#include "shared/mapped_file.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace DocuTrace::Shared
+{
+    namespace
+    {
+        constexpr size_t MIN_MAPPING_SIZE = 1 << 20;
+
+        size_t page_size()
+        {
+            static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            return size;
+        }
+
+        std::string system_error(const std::string& message)
+        {
+            return message + ": " + std::strerror(errno);
+        }
+    } // namespace
+
+    MappedFile::MappedFile(int descriptor) : descriptor_(descriptor)
+    {
+    }
+
+    std::unique_ptr<MappedFile> MappedFile::CreateTemporary(const std::filesystem::path& directory)
+    {
+        std::filesystem::create_directories(directory);
+
+        std::string path = (directory / "docutrace-cold-XXXXXX").string();
+        int descriptor = ::mkstemp(path.data());
+        if (descriptor < 0)
+        {
+            throw std::runtime_error(system_error("no se pudo crear " + path));
+        }
+        ::unlink(path.c_str());
+        return std::unique_ptr<MappedFile>(new MappedFile(descriptor));
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (mapping_)
+        {
+            ::munmap(mapping_, mapped_size_);
+        }
+        if (descriptor_ >= 0)
+        {
+            ::close(descriptor_);
+        }
+    }
+
+    void MappedFile::Remap(uint64_t minimum_size)
+    {
+        // Crecer al doble evita rehacer el mapeo en cada escritura
+        size_t new_size = std::max({static_cast<size_t>(minimum_size), mapped_size_ * 2,
+                                    MIN_MAPPING_SIZE});
+        new_size = (new_size + page_size() - 1) / page_size() * page_size();
+
+        // El mapeo puede ir más allá del final del archivo: solo se lee lo ya escrito
+        void* mapping = ::mmap(nullptr, new_size, PROT_READ, MAP_SHARED, descriptor_, 0);
+        if (mapping == MAP_FAILED)
+        {
+            throw std::runtime_error(system_error("mmap"));
+        }
+        // Acceso aleatorio: sin lectura anticipada de páginas vecinas que no se van a usar
+        ::madvise(mapping, new_size, MADV_RANDOM);
+
+        if (mapping_)
+        {
+            ::munmap(mapping_, mapped_size_);
+        }
+        mapping_ = static_cast<char*>(mapping);
+        mapped_size_ = new_size;
+    }
+
+    uint64_t MappedFile::Append(const void* data, size_t length)
+    {
+        const uint64_t offset = size_;
+        const char* bytes = static_cast<const char*>(data);
+        size_t written = 0;
+        while (written < length)
+        {
+            ssize_t result = ::pwrite(descriptor_, bytes + written, length - written,
+                                      static_cast<off_t>(offset + written));
+            if (result < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                throw std::runtime_error(system_error("escritura en el archivo frío"));
+            }
+            written += static_cast<size_t>(result);
+        }
+
+        if (offset + length > mapped_size_)
+        {
+            Remap(offset + length);
+        }
+        size_ = offset + length;
+        return offset;
+    }
+
+    void MappedFile::Advise(uint64_t offset, size_t length, MappedAccess access) const
+    {
+        if (!mapping_ || length == 0)
+        {
+            return;
+        }
+
+        // madvise exige una dirección alineada a página
+        const uint64_t start = offset / page_size() * page_size();
+        const int advice = access == MappedAccess::WILL_NEED ? MADV_WILLNEED : MADV_RANDOM;
+        ::madvise(mapping_ + start, static_cast<size_t>(offset + length - start), advice);
+    }
+
+} // namespace DocuTrace::Shared
@@ -0,0 +1,622 @@
+#include "shared/simd_kernels.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define DOCUTRACE_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace DocuTrace::Shared
+{
+    namespace
+    {
+        // Tamaño de la ventana que LowerBound resuelve por comparación lineal
+        constexpr size_t LINEAR_WINDOW = 16;
+
+        std::atomic<SimdLevel>& active_level()
+        {
+            static std::atomic<SimdLevel> level{SimdKernels::DetectLevel()};
+            return level;
+        }
+
+        size_t count_less_scalar(const uint32_t* values, size_t size, uint32_t target)
+        {
+            size_t count = 0;
+            for (size_t i = 0; i < size; ++i)
+            {
+                count += values[i] < target;
+            }
+            return count;
+        }
+
+        /**
+         * @brief Decodifica un bloque de count valores que empieza en input[position]
+         * @return false si el bloque está truncado o su ancho no es válido
+         */
+        bool unpack_block(const uint8_t* input, size_t size, size_t& position, size_t count,
+                          uint32_t* out)
+        {
+            if (position >= size || input[position] > 32)
+            {
+                return false;
+            }
+            const unsigned width = input[position++];
+            if (size - position < (count * width + 7) / 8)
+            {
+                return false;
+            }
+
+            const uint64_t mask = (uint64_t{1} << width) - 1;
+            uint64_t buffer = 0;
+            unsigned bits = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                for (; bits < width; bits += 8)
+                {
+                    buffer |= static_cast<uint64_t>(input[position++]) << bits;
+                }
+                out[i] = static_cast<uint32_t>(buffer & mask);
+                buffer >>= width;
+                bits -= width;
+            }
+            return true;
+        }
+
+#ifdef DOCUTRACE_SIMD_X86
+        __attribute__((target("avx2"))) size_t count_less_avx2(const uint32_t* values,
+                                                                size_t size, uint32_t target)
+        {
+            // Comparación sin signo mediante cambio del bit de signo
+            const __m256i bias = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+            const __m256i pivot =
+                _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(target)), bias);
+
+            size_t count = 0;
+            size_t i = 0;
+            for (; i + 8 <= size; i += 8)
+            {
+                __m256i chunk = _mm256_xor_si256(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)), bias);
+                __m256i less = _mm256_cmpgt_epi32(pivot, chunk);
+                unsigned mask =
+                    static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(less)));
+                count += static_cast<size_t>(std::popcount(mask));
+            }
+            return count + count_less_scalar(values + i, size - i, target);
+        }
+
+        size_t count_less_sse(const uint32_t* values, size_t size, uint32_t target)
+        {
+            const __m128i bias = _mm_set1_epi32(static_cast<int>(0x80000000u));
+            const __m128i pivot = _mm_xor_si128(_mm_set1_epi32(static_cast<int>(target)), bias);
+
+            size_t count = 0;
+            size_t i = 0;
+            for (; i + 4 <= size; i += 4)
+            {
+                __m128i chunk = _mm_xor_si128(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)), bias);
+                __m128i less = _mm_cmplt_epi32(chunk, pivot);
+                unsigned mask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(less)));
+                count += static_cast<size_t>(std::popcount(mask));
+            }
+            return count + count_less_scalar(values + i, size - i, target);
+        }
+#endif
+    } // namespace
+
+    // ============================================================================
+    // Despacho
+    // ============================================================================
+
+    SimdLevel SimdKernels::DetectLevel()
+    {
+#ifdef DOCUTRACE_SIMD_X86
+        __builtin_cpu_init();
+        const bool sse = __builtin_cpu_supports("ssse3") && __builtin_cpu_supports("sse4.1");
+        if (sse && __builtin_cpu_supports("avx2"))
+        {
+            return SimdLevel::AVX2;
+        }
+        if (sse)
+        {
+            return SimdLevel::SSE;
+        }
+#endif
+        return SimdLevel::SCALAR;
+    }
+
+    SimdLevel SimdKernels::GetLevel()
+    {
+        return active_level().load(std::memory_order_relaxed);
+    }
+
+    SimdLevel SimdKernels::SetLevel(SimdLevel level)
+    {
+        const SimdLevel effective = std::min(level, DetectLevel());
+        active_level().store(effective, std::memory_order_relaxed);
+        return effective;
+    }
+
+    const char* SimdKernels::LevelName(SimdLevel level)
+    {
+        switch (level)
+        {
+        case SimdLevel::AVX2:
+            return "avx2";
+        case SimdLevel::SSE:
+            return "sse";
+        case SimdLevel::SCALAR:
+            return "scalar";
+        }
+        return "scalar";
+    }
+
+    bool SimdKernels::ParseLevel(const std::string& value, SimdLevel& level)
+    {
+        if (value.empty() || value == "auto")
+        {
+            level = DetectLevel();
+        }
+        else if (value == "scalar")
+        {
+            level = SimdLevel::SCALAR;
+        }
+        else if (value == "sse")
+        {
+            level = SimdLevel::SSE;
+        }
+        else if (value == "avx2")
+        {
+            level = SimdLevel::AVX2;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    // ============================================================================
+    // Búsqueda
+    // ============================================================================
+
+    size_t SimdKernels::LowerBound(const uint32_t* values, size_t size, uint32_t target)
+    {
+        size_t low = 0;
+        size_t high = size;
+        while (high - low > LINEAR_WINDOW)
+        {
+            const size_t middle = low + (high - low) / 2;
+            if (values[middle] < target)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+
+        // En una lista ordenada, la posición es el número de valores menores
+#ifdef DOCUTRACE_SIMD_X86
+        switch (GetLevel())
+        {
+        case SimdLevel::AVX2:
+            return low + count_less_avx2(values + low, high - low, target);
+        case SimdLevel::SSE:
+            return low + count_less_sse(values + low, high - low, target);
+        case SimdLevel::SCALAR:
+            break;
+        }
+#endif
+        return low + count_less_scalar(values + low, high - low, target);
+    }
+
+    size_t SimdKernels::GallopLowerBound(const uint32_t* values, size_t size, size_t begin,
+                                         uint32_t target)
+    {
+        size_t step = 1;
+        size_t low = begin;
+        size_t high = begin;
+        while (high < size && values[high] < target)
+        {
+            low = high + 1;
+            high = begin + step;
+            step <<= 1;
+        }
+        high = std::min(high, size);
+        return static_cast<size_t>(std::lower_bound(values + low, values + high, target) -
+                                   values);
+    }
+
+    // ============================================================================
+    // Intersección y diferencia
+    // ============================================================================
+
+    size_t SimdKernels::Intersect(const uint32_t* a, size_t size_a, const uint32_t* b,
+                                  size_t size_b, uint32_t* out)
+    {
+        if (size_a == 0 || size_b == 0)
+        {
+            return 0;
+        }
+
+        if (size_a * GALLOP_RATIO < size_b || size_b * GALLOP_RATIO < size_a)
+        {
+            return IntersectGalloping(a, size_a, b, size_b, out);
+        }
+
+        switch (GetLevel())
+        {
+        case SimdLevel::AVX2:
+            return IntersectAvx2(a, size_a, b, size_b, out);
+        case SimdLevel::SSE:
+            return IntersectSse(a, size_a, b, size_b, out);
+        case SimdLevel::SCALAR:
+            break;
+        }
+        return IntersectScalar(a, size_a, b, size_b, out);
+    }
+
+    size_t SimdKernels::IntersectScalar(const uint32_t* a, size_t size_a, const uint32_t* b,
+                                        size_t size_b, uint32_t* out)
+    {
+        size_t i = 0;
+        size_t j = 0;
+        size_t count = 0;
+        while (i < size_a && j < size_b)
+        {
+            if (a[i] < b[j])
+            {
+                i++;
+            }
+            else if (b[j] < a[i])
+            {
+                j++;
+            }
+            else
+            {
+                out[count++] = a[i];
+                i++;
+                j++;
+            }
+        }
+        return count;
+    }
+
+    size_t SimdKernels::IntersectGalloping(const uint32_t* a, size_t size_a, const uint32_t* b,
+                                           size_t size_b, uint32_t* out)
+    {
+        // Recorrer la lista pequeña galopando en la grande
+        const uint32_t* small = size_a <= size_b ? a : b;
+        const uint32_t* large = size_a <= size_b ? b : a;
+        const size_t small_size = std::min(size_a, size_b);
+        const size_t large_size = std::max(size_a, size_b);
+
+        size_t count = 0;
+        size_t position = 0;
+        for (size_t i = 0; i < small_size; ++i)
+        {
+            position = GallopLowerBound(large, large_size, position, small[i]);
+            if (position == large_size)
+            {
+                break;
+            }
+            if (large[position] == small[i])
+            {
+                out[count++] = small[i];
+            }
+        }
+        return count;
+    }
+
+    size_t SimdKernels::IntersectSse(const uint32_t* a, size_t size_a, const uint32_t* b,
+                                     size_t size_b, uint32_t* out)
+    {
+#ifdef DOCUTRACE_SIMD_X86
+        size_t i = 0;
+        size_t j = 0;
+        size_t count = 0;
+
+        // Compara cada bloque de 4 de a contra las 4 rotaciones del bloque de b
+        while (i + 4 <= size_a && j + 4 <= size_b)
+        {
+            const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+
+            __m128i equal = _mm_cmpeq_epi32(va, vb);
+            equal = _mm_or_si128(
+                equal, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+            equal = _mm_or_si128(
+                equal, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+            equal = _mm_or_si128(
+                equal, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+
+            unsigned mask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(equal)));
+            while (mask)
+            {
+                out[count++] = a[i + std::countr_zero(mask)];
+                mask &= mask - 1;
+            }
+
+            // Avanzar el bloque (o ambos) cuyo máximo sea menor
+            const uint32_t max_a = a[i + 3];
+            const uint32_t max_b = b[j + 3];
+            if (max_a <= max_b)
+            {
+                i += 4;
+            }
+            if (max_b <= max_a)
+            {
+                j += 4;
+            }
+        }
+
+        return count + IntersectScalar(a + i, size_a - i, b + j, size_b - j, out + count);
+#else
+        return IntersectScalar(a, size_a, b, size_b, out);
+#endif
+    }
+
+#ifdef DOCUTRACE_SIMD_X86
+    __attribute__((target("avx2")))
+#endif
+    size_t SimdKernels::IntersectAvx2(const uint32_t* a, size_t size_a, const uint32_t* b,
+                                      size_t size_b, uint32_t* out)
+    {
+#ifdef DOCUTRACE_SIMD_X86
+        size_t i = 0;
+        size_t j = 0;
+        size_t count = 0;
+        const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+
+        // Igual que la versión SSE con bloques de 8 y 8 rotaciones
+        while (i + 8 <= size_a && j + 8 <= size_b)
+        {
+            const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+
+            __m256i equal = _mm256_cmpeq_epi32(va, vb);
+            for (int r = 1; r < 8; ++r)
+            {
+                vb = _mm256_permutevar8x32_epi32(vb, rotate);
+                equal = _mm256_or_si256(equal, _mm256_cmpeq_epi32(va, vb));
+            }
+
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(equal)));
+            while (mask)
+            {
+                out[count++] = a[i + std::countr_zero(mask)];
+                mask &= mask - 1;
+            }
+
+            const uint32_t max_a = a[i + 7];
+            const uint32_t max_b = b[j + 7];
+            if (max_a <= max_b)
+            {
+                i += 8;
+            }
+            if (max_b <= max_a)
+            {
+                j += 8;
+            }
+        }
+
+        return count + IntersectScalar(a + i, size_a - i, b + j, size_b - j, out + count);
+#else
+        return IntersectScalar(a, size_a, b, size_b, out);
+#endif
+    }
+
+    size_t SimdKernels::Difference(const uint32_t* a, size_t size_a, const uint32_t* b,
+                                   size_t size_b, uint32_t* out)
+    {
+        size_t count = 0;
+
+        if (size_a * GALLOP_RATIO < size_b)
+        {
+            size_t position = 0;
+            for (size_t i = 0; i < size_a; ++i)
+            {
+                position = GallopLowerBound(b, size_b, position, a[i]);
+                if (position == size_b || b[position] != a[i])
+                {
+                    out[count++] = a[i];
+                }
+            }
+            return count;
+        }
+
+        size_t j = 0;
+        for (size_t i = 0; i < size_a; ++i)
+        {
+            while (j < size_b && b[j] < a[i])
+            {
+                j++;
+            }
+            if (j == size_b || b[j] != a[i])
+            {
+                out[count++] = a[i];
+            }
+        }
+        return count;
+    }
+
+    // ============================================================================
+    // Compresión por bloques empaquetados
+    // ============================================================================
+
+    size_t SimdKernels::PackedMaxBytes(size_t count)
+    {
+        return (count + PACKED_BLOCK_SIZE - 1) / PACKED_BLOCK_SIZE + count * sizeof(uint32_t);
+    }
+
+    size_t SimdKernels::EncodePacked(const uint32_t* values, size_t count, uint8_t* out)
+    {
+        uint8_t* data = out;
+        for (size_t begin = 0; begin < count; begin += PACKED_BLOCK_SIZE)
+        {
+            const size_t block = std::min(PACKED_BLOCK_SIZE, count - begin);
+            const auto width = static_cast<unsigned>(
+                std::bit_width(*std::max_element(values + begin, values + begin + block)));
+            *data++ = static_cast<uint8_t>(width);
+
+            uint64_t buffer = 0;
+            unsigned bits = 0;
+            for (size_t i = begin; i < begin + block; ++i)
+            {
+                buffer |= static_cast<uint64_t>(values[i]) << bits;
+                bits += width;
+                for (; bits >= 8; bits -= 8)
+                {
+                    *data++ = static_cast<uint8_t>(buffer);
+                    buffer >>= 8;
+                }
+            }
+            if (bits > 0)
+            {
+                *data++ = static_cast<uint8_t>(buffer);
+            }
+        }
+        return static_cast<size_t>(data - out);
+    }
+
+    size_t SimdKernels::DecodePacked(const uint8_t* input, size_t size, size_t count,
+                                     uint32_t* out)
+    {
+        if (GetLevel() == SimdLevel::AVX2)
+        {
+            return DecodePackedAvx2(input, size, count, out);
+        }
+        return DecodePackedScalar(input, size, count, out);
+    }
+
+    size_t SimdKernels::DecodePackedScalar(const uint8_t* input, size_t size, size_t count,
+                                           uint32_t* out)
+    {
+        size_t position = 0;
+        for (size_t begin = 0; begin < count; begin += PACKED_BLOCK_SIZE)
+        {
+            if (!unpack_block(input, size, position, std::min(PACKED_BLOCK_SIZE, count - begin),
+                              out + begin))
+            {
+                return 0;
+            }
+        }
+        return position;
+    }
+
+#ifdef DOCUTRACE_SIMD_X86
+    __attribute__((target("avx2")))
+#endif
+    size_t SimdKernels::DecodePackedAvx2(const uint8_t* input, size_t size, size_t count,
+                                         uint32_t* out)
+    {
+#ifdef DOCUTRACE_SIMD_X86
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i low_bits = _mm256_set1_epi32(7);
+
+        size_t position = 0;
+        for (size_t begin = 0; begin < count; begin += PACKED_BLOCK_SIZE)
+        {
+            const size_t block = std::min(PACKED_BLOCK_SIZE, count - begin);
+            const unsigned width = position < size ? input[position] : 0;
+            const size_t bytes = (block * width + 7) / 8;
+
+            // Hasta 25 bits un valor cabe en los 4 bytes que empiezan en su primer byte: un
+            // gather por cada 8 valores, si se pueden leer 4 bytes más allá del bloque
+            if (block < PACKED_BLOCK_SIZE || position >= size || width > 25 ||
+                size - position - 1 < bytes + 4)
+            {
+                if (!unpack_block(input, size, position, block, out + begin))
+                {
+                    return 0;
+                }
+                continue;
+            }
+
+            const auto* data = reinterpret_cast<const int*>(input + position + 1);
+            const __m256i mask = _mm256_set1_epi32(static_cast<int>((1u << width) - 1));
+            const __m256i step = _mm256_set1_epi32(static_cast<int>(width));
+            for (size_t half = 0; half < PACKED_BLOCK_SIZE; half += 8)
+            {
+                const __m256i bit = _mm256_mullo_epi32(
+                    _mm256_add_epi32(lanes, _mm256_set1_epi32(static_cast<int>(half))), step);
+                const __m256i raw = _mm256_i32gather_epi32(data, _mm256_srli_epi32(bit, 3), 1);
+                const __m256i values = _mm256_and_si256(
+                    _mm256_srlv_epi32(raw, _mm256_and_si256(bit, low_bits)), mask);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + begin + half), values);
+            }
+            position += 1 + bytes;
+        }
+        return position;
+#else
+        return DecodePackedScalar(input, size, count, out);
+#endif
+    }
+
+    // ============================================================================
+    // Puntuación
+    // ============================================================================
+
+    void SimdKernels::SaturatedScores(const uint32_t* documents, const uint32_t* frequencies,
+                                      size_t count, const uint32_t* lengths, float a, float c,
+                                      float d, float* out)
+    {
+        if (GetLevel() == SimdLevel::AVX2)
+        {
+            SaturatedScoresAvx2(documents, frequencies, count, lengths, a, c, d, out);
+            return;
+        }
+        SaturatedScoresScalar(documents, frequencies, count, lengths, a, c, d, out);
+    }
+
+    void SimdKernels::SaturatedScoresScalar(const uint32_t* documents, const uint32_t* frequencies,
+                                            size_t count, const uint32_t* lengths, float a,
+                                            float c, float d, float* out)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float f = static_cast<float>(frequencies[i]);
+            const float dl = static_cast<float>(lengths[documents[i]]);
+            out[i] = (a * f) / ((f + c) + d * dl);
+        }
+    }
+
+#ifdef DOCUTRACE_SIMD_X86
+    __attribute__((target("avx2")))
+#endif
+    void SimdKernels::SaturatedScoresAvx2(const uint32_t* documents, const uint32_t* frequencies,
+                                          size_t count, const uint32_t* lengths, float a, float c,
+                                          float d, float* out)
+    {
+#ifdef DOCUTRACE_SIMD_X86
+        const __m256 va = _mm256_set1_ps(a);
+        const __m256 vc = _mm256_set1_ps(c);
+        const __m256 vd = _mm256_set1_ps(d);
+        size_t i = 0;
+
+        // Mismo orden de operaciones que la versión escalar (sin FMA) para no cambiar el
+        // redondeo; frecuencias, longitudes e IDs caben en int32
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256i ids = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(documents + i));
+            const __m256 f = _mm256_cvtepi32_ps(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(frequencies + i)));
+            const __m256 dl = _mm256_cvtepi32_ps(
+                _mm256_i32gather_epi32(reinterpret_cast<const int*>(lengths), ids, 4));
+            const __m256 denominator = _mm256_add_ps(_mm256_add_ps(f, vc), _mm256_mul_ps(vd, dl));
+            _mm256_storeu_ps(out + i, _mm256_div_ps(_mm256_mul_ps(va, f), denominator));
+        }
+
+        SaturatedScoresScalar(documents + i, frequencies + i, count - i, lengths, a, c, d,
+                              out + i);
+#else
+        SaturatedScoresScalar(documents, frequencies, count, lengths, a, c, d, out);
+#endif
+    }
+
+} // namespace DocuTrace::Shared
@@ -0,0 +1,403 @@
+#include "shared/structured_writer.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cmath>
+
+namespace DocuTrace::Shared
+{
+    namespace
+    {
+        // Bytes que JSON obliga a escapar: comillas, barra invertida y controles
+        constexpr std::array<bool, 256> make_escape_table()
+        {
+            std::array<bool, 256> table{};
+            for (int c = 0; c < 0x20; ++c)
+            {
+                table[c] = true;
+            }
+            table['"'] = true;
+            table['\\'] = true;
+            return table;
+        }
+        constexpr std::array<bool, 256> NEEDS_ESCAPE = make_escape_table();
+
+        constexpr char HEX_DIGITS[] = "0123456789abcdef";
+    } // namespace
+
+    StructuredWriter::StructuredWriter(WireFormat format, Sink sink, size_t chunk_size)
+        : format_(format), sink_(std::move(sink)), chunk_size_(chunk_size)
+    {
+        // Margen para el valor que cruza el límite antes de vaciar
+        buffer_.reserve(chunk_size_ + 256);
+    }
+
+    void StructuredWriter::BeforeValue()
+    {
+        if (after_key_)
+        {
+            after_key_ = false;
+            return;
+        }
+        if (!first_in_container_.empty())
+        {
+            if (!first_in_container_.back())
+            {
+                buffer_ += ',';
+            }
+            first_in_container_.back() = false;
+        }
+    }
+
+    void StructuredWriter::Append(const char* data, size_t length)
+    {
+        // Un documento largo pasa por el búfer en trozos en lugar de hacerlo crecer entero
+        while (length > 0)
+        {
+            if (buffer_.size() >= chunk_size_)
+            {
+                Flush();
+            }
+            const size_t piece = std::min(length, chunk_size_ - buffer_.size());
+            buffer_.append(data, piece);
+            data += piece;
+            length -= piece;
+        }
+    }
+
+    void StructuredWriter::WriteBigEndian(uint64_t value, size_t bytes)
+    {
+        for (size_t i = bytes; i-- > 0;)
+        {
+            buffer_ += static_cast<char>((value >> (8 * i)) & 0xff);
+        }
+    }
+
+    void StructuredWriter::WriteMsgpackLength(uint8_t fix_base, size_t fix_limit, uint8_t code8,
+                                              uint8_t code16, uint8_t code32, size_t length)
+    {
+        if (length < fix_limit)
+        {
+            buffer_ += static_cast<char>(fix_base | length);
+        }
+        else if (code8 != 0 && length <= 0xff)
+        {
+            buffer_ += static_cast<char>(code8);
+            WriteBigEndian(length, 1);
+        }
+        else if (length <= 0xffff)
+        {
+            buffer_ += static_cast<char>(code16);
+            WriteBigEndian(length, 2);
+        }
+        else
+        {
+            buffer_ += static_cast<char>(code32);
+            WriteBigEndian(length, 4);
+        }
+    }
+
+    void StructuredWriter::WriteCborHead(uint8_t major, uint64_t value)
+    {
+        const uint8_t type = static_cast<uint8_t>(major << 5);
+        if (value < 24)
+        {
+            buffer_ += static_cast<char>(type | value);
+        }
+        else if (value <= 0xff)
+        {
+            buffer_ += static_cast<char>(type | 24);
+            WriteBigEndian(value, 1);
+        }
+        else if (value <= 0xffff)
+        {
+            buffer_ += static_cast<char>(type | 25);
+            WriteBigEndian(value, 2);
+        }
+        else if (value <= 0xffffffff)
+        {
+            buffer_ += static_cast<char>(type | 26);
+            WriteBigEndian(value, 4);
+        }
+        else
+        {
+            buffer_ += static_cast<char>(type | 27);
+            WriteBigEndian(value, 8);
+        }
+    }
+
+    void StructuredWriter::WriteJsonString(std::string_view text)
+    {
+        buffer_ += '"';
+        size_t run_start = 0;
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            const unsigned char c = static_cast<unsigned char>(text[i]);
+            if (!NEEDS_ESCAPE[c])
+            {
+                continue;
+            }
+
+            // Los tramos sin escapes se copian de una vez
+            Append(text.data() + run_start, i - run_start);
+            run_start = i + 1;
+            switch (c)
+            {
+            case '"':
+                buffer_ += "\\\"";
+                break;
+            case '\\':
+                buffer_ += "\\\\";
+                break;
+            case '\n':
+                buffer_ += "\\n";
+                break;
+            case '\r':
+                buffer_ += "\\r";
+                break;
+            case '\t':
+                buffer_ += "\\t";
+                break;
+            default:
+                buffer_ += "\\u00";
+                buffer_ += HEX_DIGITS[c >> 4];
+                buffer_ += HEX_DIGITS[c & 0xf];
+                break;
+            }
+        }
+        Append(text.data() + run_start, text.size() - run_start);
+        buffer_ += '"';
+    }
+
+    void StructuredWriter::BeginObject(size_t fields)
+    {
+        switch (format_)
+        {
+        case WireFormat::JSON:
+            BeforeValue();
+            buffer_ += '{';
+            first_in_container_.push_back(true);
+            break;
+        case WireFormat::MSGPACK:
+            WriteMsgpackLength(0x80, 16, 0, 0xde, 0xdf, fields);
+            break;
+        case WireFormat::CBOR:
+            WriteCborHead(5, fields);
+            break;
+        }
+    }
+
+    void StructuredWriter::EndObject()
+    {
+        if (format_ == WireFormat::JSON)
+        {
+            first_in_container_.pop_back();
+            buffer_ += '}';
+        }
+        FlushIfFull();
+    }
+
+    void StructuredWriter::BeginArray(size_t count)
+    {
+        switch (format_)
+        {
+        case WireFormat::JSON:
+            BeforeValue();
+            buffer_ += '[';
+            first_in_container_.push_back(true);
+            break;
+        case WireFormat::MSGPACK:
+            WriteMsgpackLength(0x90, 16, 0, 0xdc, 0xdd, count);
+            break;
+        case WireFormat::CBOR:
+            WriteCborHead(4, count);
+            break;
+        }
+    }
+
+    void StructuredWriter::EndArray()
+    {
+        if (format_ == WireFormat::JSON)
+        {
+            first_in_container_.pop_back();
+            buffer_ += ']';
+        }
+        FlushIfFull();
+    }
+
+    void StructuredWriter::Key(std::string_view key)
+    {
+        String(key);
+        if (format_ == WireFormat::JSON)
+        {
+            buffer_ += ':';
+            after_key_ = true;
+        }
+    }
+
+    void StructuredWriter::String(std::string_view value)
+    {
+        switch (format_)
+        {
+        case WireFormat::JSON:
+            BeforeValue();
+            WriteJsonString(value);
+            break;
+        case WireFormat::MSGPACK:
+            WriteMsgpackLength(0xa0, 32, 0xd9, 0xda, 0xdb, value.size());
+            Append(value.data(), value.size());
+            break;
+        case WireFormat::CBOR:
+            WriteCborHead(3, value.size());
+            Append(value.data(), value.size());
+            break;
+        }
+        FlushIfFull();
+    }
+
+    void StructuredWriter::UInt(uint64_t value)
+    {
+        switch (format_)
+        {
+        case WireFormat::JSON:
+        {
+            BeforeValue();
+            char digits[20];
+            auto [end, error] = std::to_chars(digits, digits + sizeof(digits), value);
+            buffer_.append(digits, end);
+            break;
+        }
+        case WireFormat::MSGPACK:
+            if (value < 0x80)
+            {
+                buffer_ += static_cast<char>(value);
+            }
+            else if (value <= 0xff)
+            {
+                buffer_ += static_cast<char>(0xcc);
+                WriteBigEndian(value, 1);
+            }
+            else if (value <= 0xffff)
+            {
+                buffer_ += static_cast<char>(0xcd);
+                WriteBigEndian(value, 2);
+            }
+            else if (value <= 0xffffffff)
+            {
+                buffer_ += static_cast<char>(0xce);
+                WriteBigEndian(value, 4);
+            }
+            else
+            {
+                buffer_ += static_cast<char>(0xcf);
+                WriteBigEndian(value, 8);
+            }
+            break;
+        case WireFormat::CBOR:
+            WriteCborHead(0, value);
+            break;
+        }
+    }
+
+    void StructuredWriter::Int(int64_t value)
+    {
+        if (value >= 0)
+        {
+            UInt(static_cast<uint64_t>(value));
+            return;
+        }
+        switch (format_)
+        {
+        case WireFormat::JSON:
+        {
+            BeforeValue();
+            char digits[21];
+            auto [end, error] = std::to_chars(digits, digits + sizeof(digits), value);
+            buffer_.append(digits, end);
+            break;
+        }
+        case WireFormat::MSGPACK:
+            if (value >= -32)
+            {
+                // negative fixint
+                buffer_ += static_cast<char>(value);
+            }
+            else
+            {
+                buffer_ += static_cast<char>(0xd3);
+                WriteBigEndian(static_cast<uint64_t>(value), 8);
+            }
+            break;
+        case WireFormat::CBOR:
+            // Tipo mayor 1: el valor es -1 - n
+            WriteCborHead(1, static_cast<uint64_t>(-(value + 1)));
+            break;
+        }
+    }
+
+    void StructuredWriter::Double(double value)
+    {
+        switch (format_)
+        {
+        case WireFormat::JSON:
+        {
+            BeforeValue();
+            if (!std::isfinite(value))
+            {
+                buffer_ += "null";
+                break;
+            }
+            // Representación más corta que vuelve a dar el mismo double
+            char digits[32];
+            auto [end, error] = std::to_chars(digits, digits + sizeof(digits), value);
+            buffer_.append(digits, end);
+            break;
+        }
+        case WireFormat::MSGPACK:
+            buffer_ += static_cast<char>(0xcb);
+            WriteBigEndian(std::bit_cast<uint64_t>(value), 8);
+            break;
+        case WireFormat::CBOR:
+            buffer_ += static_cast<char>(0xfb);
+            WriteBigEndian(std::bit_cast<uint64_t>(value), 8);
+            break;
+        }
+    }
+
+    void StructuredWriter::Bool(bool value)
+    {
+        switch (format_)
+        {
+        case WireFormat::JSON:
+            BeforeValue();
+            buffer_ += value ? "true" : "false";
+            break;
+        case WireFormat::MSGPACK:
+            buffer_ += static_cast<char>(value ? 0xc3 : 0xc2);
+            break;
+        case WireFormat::CBOR:
+            buffer_ += static_cast<char>(value ? 0xf5 : 0xf4);
+            break;
+        }
+    }
+
+    void StructuredWriter::EndRecord()
+    {
+        if (format_ == WireFormat::JSON)
+        {
+            buffer_ += '\n';
+        }
+        FlushIfFull();
+    }
+
+    void StructuredWriter::Flush()
+    {
+        if (!buffer_.empty())
+        {
+            sink_(buffer_);
+            buffer_.clear();
+        }
+    }
+
+} // namespace DocuTrace::Shared
@@ -0,0 +1,424 @@
+#include "shared/text_analyzer.hpp"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include "shared/text_utils.hpp"
+
+namespace DocuTrace::Shared
+{
+    // ============================================================================
+    // IMPLEMENTACIÓN DE SpanishStemmer
+    // ============================================================================
+
+    namespace
+    {
+        bool is_vowel(char c)
+        {
+            return c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u';
+        }
+
+        bool ends_with(const std::string& word, std::string_view suffix)
+        {
+            return word.size() >= suffix.size() &&
+                   word.compare(word.size() - suffix.size(), suffix.size(), suffix) == 0;
+        }
+
+        // Sufijo más largo de la lista con el que termina la palabra (vacío si ninguno)
+        std::string_view longest_suffix(const std::string& word,
+                                        std::initializer_list<std::string_view> suffixes)
+        {
+            std::string_view best;
+            for (std::string_view suffix : suffixes)
+            {
+                if (suffix.size() > best.size() && ends_with(word, suffix))
+                {
+                    best = suffix;
+                }
+            }
+            return best;
+        }
+
+        bool in_region(const std::string& word, std::string_view suffix, size_t region)
+        {
+            return word.size() - suffix.size() >= region;
+        }
+
+        void remove_suffix(std::string& word, std::string_view suffix)
+        {
+            word.erase(word.size() - suffix.size());
+        }
+
+        // Inicio de la región tras la primera consonante precedida de vocal desde start
+        size_t region_after(const std::string& word, size_t start)
+        {
+            for (size_t i = std::max<size_t>(start, 1); i < word.size(); ++i)
+            {
+                if (!is_vowel(word[i]) && is_vowel(word[i - 1]))
+                {
+                    return i + 1;
+                }
+            }
+            return word.size();
+        }
+
+        size_t region_rv(const std::string& word)
+        {
+            if (word.size() < 2)
+            {
+                return word.size();
+            }
+
+            if (!is_vowel(word[1]))
+            {
+                // Tras la siguiente vocal
+                for (size_t i = 2; i < word.size(); ++i)
+                {
+                    if (is_vowel(word[i]))
+                    {
+                        return i + 1;
+                    }
+                }
+                return word.size();
+            }
+
+            if (is_vowel(word[0]))
+            {
+                // Dos vocales iniciales: tras la siguiente consonante
+                for (size_t i = 2; i < word.size(); ++i)
+                {
+                    if (!is_vowel(word[i]))
+                    {
+                        return i + 1;
+                    }
+                }
+                return word.size();
+            }
+
+            return std::min<size_t>(3, word.size());
+        }
+    } // namespace
+
+    std::string SpanishStemmer::Stem(const std::string& input)
+    {
+        if (input.size() < 3 || !std::all_of(input.begin(), input.end(),
+                                             [](char c) { return c >= 'a' && c <= 'z'; }))
+        {
+            return input;
+        }
+
+        std::string word = input;
+        const size_t rv = region_rv(word);
+        const size_t r1 = region_after(word, 1);
+        const size_t r2 = region_after(word, r1 + 1);
+
+        // Paso 0: pronombres enclíticos tras gerundio o infinitivo
+        {
+            std::string_view pronoun =
+                longest_suffix(word, {"me", "se", "sela", "selo", "selas", "selos", "la", "le",
+                                      "lo", "las", "les", "los", "nos"});
+            if (!pronoun.empty() && in_region(word, pronoun, rv))
+            {
+                std::string stem = word.substr(0, word.size() - pronoun.size());
+                std::string_view verb =
+                    longest_suffix(stem, {"iendo", "ando", "ar", "er", "ir", "yendo"});
+                if (!verb.empty() && in_region(stem, verb, rv) &&
+                    (verb != "yendo" || ends_with(stem.substr(0, stem.size() - 5), "u")))
+                {
+                    word = std::move(stem);
+                }
+            }
+        }
+
+        // Paso 1: sufijos derivativos
+        bool step1_removed = false;
+        {
+            std::string_view suffix = longest_suffix(
+                word,
+                {"anza", "anzas", "ico", "ica", "icos", "icas", "ismo", "ismos", "able", "ables",
+                 "ible", "ibles", "ista", "istas", "oso", "osa", "osos", "osas", "amiento",
+                 "amientos", "imiento", "imientos", "adora", "ador", "acion", "adoras", "adores",
+                 "aciones", "ante", "antes", "ancia", "ancias", "logia", "logias", "ucion",
+                 "uciones", "encia", "encias", "amente", "mente", "idad", "idades", "iva", "ivo",
+                 "ivas", "ivos"});
+
+            auto remove_preceding = [&](std::initializer_list<std::string_view> options)
+            {
+                std::string_view previous = longest_suffix(word, options);
+                if (!previous.empty() && in_region(word, previous, r2))
+                {
+                    remove_suffix(word, previous);
+                    return previous;
+                }
+                return std::string_view{};
+            };
+
+            if (suffix == "amente")
+            {
+                if (in_region(word, suffix, r1))
+                {
+                    remove_suffix(word, suffix);
+                    step1_removed = true;
+                    if (remove_preceding({"iv"}) == "iv")
+                    {
+                        remove_preceding({"at"});
+                    }
+                    else
+                    {
+                        remove_preceding({"os", "ic", "ad"});
+                    }
+                }
+            }
+            else if (!suffix.empty() && in_region(word, suffix, r2))
+            {
+                step1_removed = true;
+                if (suffix == "logia" || suffix == "logias")
+                {
+                    word.replace(word.size() - suffix.size(), suffix.size(), "log");
+                }
+                else if (suffix == "ucion" || suffix == "uciones")
+                {
+                    word.replace(word.size() - suffix.size(), suffix.size(), "u");
+                }
+                else if (suffix == "encia" || suffix == "encias")
+                {
+                    word.replace(word.size() - suffix.size(), suffix.size(), "ente");
+                }
+                else
+                {
+                    remove_suffix(word, suffix);
+                    if (suffix == "adora" || suffix == "ador" || suffix == "acion" ||
+                        suffix == "adoras" || suffix == "adores" || suffix == "aciones" ||
+                        suffix == "ante" || suffix == "antes" || suffix == "ancia" ||
+                        suffix == "ancias")
+                    {
+                        remove_preceding({"ic"});
+                    }
+                    else if (suffix == "mente")
+                    {
+                        remove_preceding({"ante", "able", "ible"});
+                    }
+                    else if (suffix == "idad" || suffix == "idades")
+                    {
+                        remove_preceding({"abil", "ic", "iv"});
+                    }
+                    else if (suffix == "iva" || suffix == "ivo" || suffix == "ivas" ||
+                             suffix == "ivos")
+                    {
+                        remove_preceding({"at"});
+                    }
+                }
+            }
+        }
+
+        // Pasos 2a y 2b: sufijos verbales
+        if (!step1_removed)
+        {
+            std::string_view y_suffix = longest_suffix(
+                word, {"ya", "ye", "yan", "yen", "yeron", "yendo", "yo", "yas", "yes", "yais",
+                       "yamos"});
+            if (!y_suffix.empty() && in_region(word, y_suffix, rv) &&
+                ends_with(word.substr(0, word.size() - y_suffix.size()), "u"))
+            {
+                remove_suffix(word, y_suffix);
+            }
+            else
+            {
+                std::string_view suffix = longest_suffix(
+                    word,
+                    {"en", "es", "eis", "emos", "arian", "arias", "aran", "aras", "ariais", "aria",
+                     "areis", "ariamos", "aremos", "ara", "are", "erian", "erias", "eran", "eras",
+                     "eriais", "eria", "ereis", "eriamos", "eremos", "era", "ere", "irian", "irias",
+                     "iran", "iras", "iriais", "iria", "ireis", "iriamos", "iremos", "ira", "ire",
+                     "aba", "ada", "ida", "ia", "iera", "ad", "ed", "id", "ase", "iese", "aste",
+                     "iste", "an", "aban", "ian", "ieran", "asen", "iesen", "aron", "ieron", "ado",
+                     "ido", "ando", "iendo", "io", "ar", "er", "ir", "as", "abas", "adas", "idas",
+                     "ias", "ieras", "ases", "ieses", "is", "ais", "abais", "iais", "arais",
+                     "ierais", "aseis", "ieseis", "asteis", "isteis", "ados", "idos", "amos",
+                     "abamos", "iamos", "imos", "aramos", "ieramos", "iesemos", "asemos"});
+                if (!suffix.empty() && in_region(word, suffix, rv))
+                {
+                    remove_suffix(word, suffix);
+                    if ((suffix == "en" || suffix == "es" || suffix == "eis" || suffix == "emos") &&
+                        ends_with(word, "gu"))
+                    {
+                        word.pop_back();
+                    }
+                }
+            }
+        }
+
+        // Paso 3: vocal residual
+        {
+            std::string_view suffix = longest_suffix(word, {"os", "a", "o", "e"});
+            if (!suffix.empty() && in_region(word, suffix, rv))
+            {
+                remove_suffix(word, suffix);
+                if (suffix == "e" && ends_with(word, "gu") && word.size() - 1 >= rv)
+                {
+                    word.pop_back();
+                }
+            }
+        }
+
+        return word;
+    }
+
+    // ============================================================================
+    // IMPLEMENTACIÓN DE TextAnalyzer
+    // ============================================================================
+
+    const std::vector<std::string>& TextAnalyzer::DefaultSpanishStopwords()
+    {
+        // Lista de stopwords de Snowball para el español, sin acentos
+        static const std::vector<std::string> stopwords = {
+            "de", "la", "que", "el", "en", "y", "a", "los", "del", "se", "las", "por", "un", "para",
+            "con", "no", "una", "su", "al", "lo", "como", "mas", "pero", "sus", "le", "ya", "o",
+            "este", "si", "porque", "esta", "entre", "cuando", "muy", "sin", "sobre", "tambien",
+            "me", "hasta", "hay", "donde", "quien", "desde", "todo", "nos", "durante", "todos",
+            "uno", "les", "ni", "contra", "otros", "ese", "eso", "ante", "ellos", "e", "esto", "mi",
+            "antes", "algunos", "unos", "yo", "otro", "otras", "otra", "tanto", "esa", "estos",
+            "mucho", "quienes", "nada", "muchos", "cual", "poco", "ella", "estar", "estas",
+            "algunas", "algo", "nosotros", "mis", "tu", "te", "ti", "tus", "ellas", "nosotras",
+            "vosotros", "vosotras", "os", "mio", "mia", "mios", "mias", "tuyo", "tuya", "tuyos",
+            "tuyas", "suyo", "suya", "suyos", "suyas", "nuestro", "nuestra", "nuestros", "nuestras",
+            "vuestro", "vuestra", "vuestros", "vuestras", "esos", "esas", "estoy", "estamos",
+            "estais", "estan", "estes", "estemos", "esteis", "esten", "estare", "estaras", "estara",
+            "estaremos", "estareis", "estaran", "estaria", "estarias", "estariamos", "estariais",
+            "estarian", "estaba", "estabas", "estabamos", "estabais", "estaban", "estuve",
+            "estuviste", "estuvo", "estuvimos", "estuvisteis", "estuvieron", "he", "has", "ha",
+            "hemos", "habeis", "han", "haya", "hayas", "hayamos", "hayais", "hayan", "habre",
+            "habras", "habra", "habremos", "habreis", "habran", "habria", "habrias", "habriamos",
+            "habriais", "habrian", "habia", "habias", "habiamos", "habiais", "habian", "hube",
+            "hubiste", "hubo", "hubimos", "hubisteis", "hubieron", "soy", "eres", "es", "somos",
+            "sois", "son", "sea", "seas", "seamos", "seais", "sean", "sere", "seras", "sera",
+            "seremos", "sereis", "seran", "seria", "serias", "seriamos", "seriais", "serian", "era",
+            "eras", "eramos", "erais", "eran", "fui", "fuiste", "fue", "fuimos", "fuisteis",
+            "fueron", "tengo", "tienes", "tiene", "tenemos", "teneis", "tienen", "tenga", "tengas",
+            "tengamos", "tengais", "tengan", "tendre", "tendras", "tendra", "tendremos", "tendreis",
+            "tendran", "tendria", "tendrias", "tendriamos", "tendriais", "tendrian", "tenia",
+            "tenias", "teniamos", "teniais", "tenian", "tuve", "tuviste", "tuvo", "tuvimos",
+            "tuvisteis", "tuvieron", "sido", "siendo", "tenido", "teniendo", "habido", "habiendo",
+            "estado", "estando", "ser", "haber", "tener"};
+        return stopwords;
+    }
+
+    TextAnalyzer::TextAnalyzer(AnalyzerOptions options) : options_(std::move(options))
+    {
+        if (!options_.stopwords)
+        {
+            return;
+        }
+
+        if (options_.stopwords_file.empty())
+        {
+            const auto& defaults = DefaultSpanishStopwords();
+            stopwords_.insert(defaults.begin(), defaults.end());
+            return;
+        }
+
+        std::ifstream file(options_.stopwords_file);
+        if (!file.is_open())
+        {
+            std::cerr << "[!] No se pudo abrir " << options_.stopwords_file
+                      << ", usando stopwords por defecto" << std::endl;
+            const auto& defaults = DefaultSpanishStopwords();
+            stopwords_.insert(defaults.begin(), defaults.end());
+            return;
+        }
+
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (line.empty() || line[0] == '#')
+            {
+                continue;
+            }
+            // Normalizar igual que el texto para que coincidan
+            for (auto& word : Tokenize(line))
+            {
+                stopwords_.insert(std::move(word));
+            }
+        }
+    }
+
+    std::vector<std::string> TextAnalyzer::Tokenize(const std::string& text)
+    {
+        std::string normalized = text;
+        std::transform(normalized.begin(), normalized.end(), normalized.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        normalized = TextUtils::removeSpanishAccents(normalized);
+
+        std::vector<std::string> tokens;
+        std::string current;
+        auto flush = [&]()
+        {
+            if (!current.empty())
+            {
+                tokens.push_back(std::move(current));
+                current.clear();
+            }
+        };
+
+        for (size_t i = 0; i < normalized.size(); ++i)
+        {
+            const auto c = static_cast<unsigned char>(normalized[i]);
+            if (c >= 0xE0)
+            {
+                // Secuencias UTF-8 de 3-4 bytes (comillas tipográficas, guiones, símbolos)
+                // separan palabras
+                i += c >= 0xF0 ? 3 : 2;
+                flush();
+            }
+            else if (c >= 0x80)
+            {
+                // Letras latinas restantes y signos como ¿ ¡ « »: se descartan
+                continue;
+            }
+            else if (std::isalnum(c))
+            {
+                current += static_cast<char>(c);
+            }
+            else
+            {
+                flush();
+            }
+        }
+        flush();
+
+        return tokens;
+    }
+
+    bool TextAnalyzer::IsStopword(const std::string& token) const
+    {
+        return stopwords_.contains(token);
+    }
+
+    std::string TextAnalyzer::AnalyzeToken(const std::string& token) const
+    {
+        if (IsStopword(token))
+        {
+            return {};
+        }
+        return options_.stemming ? SpanishStemmer::Stem(token) : token;
+    }
+
+    std::vector<std::string> TextAnalyzer::Analyze(const std::string& text) const
+    {
+        std::vector<std::string> terms = Tokenize(text);
+
+        size_t write = 0;
+        for (size_t read = 0; read < terms.size(); ++read)
+        {
+            std::string term = AnalyzeToken(terms[read]);
+            if (!term.empty())
+            {
+                terms[write++] = std::move(term);
+            }
+        }
+        terms.resize(write);
+        return terms;
+    }
+
+} // namespace DocuTrace::Shared
@@ -76,6 +76,8 @@ namespace DocuTrace::Shared
             {"\xC3\x8D", 'I'}, // Í
             {"\xC3\x93", 'O'}, // Ó
             {"\xC3\x9A", 'U'}, // Ú
+            {"\xC3\xBC", 'u'}, // ü
+            {"\xC3\x9C", 'U'}, // Ü
             {"\xC3\xB1", 'n'}, // ñ
             {"\xC3\x91", 'N'}  // Ñ
         };